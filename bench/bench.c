@@ -0,0 +1,1029 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../src/meh.h"
+
+/**
+ * Micro-benchmarks for libmeh. Run with no arguments to run every
+ * benchmark, or name the ones you want.
+ */
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define CONTEXT_COUNT 100000
+#define CONTEXT_ROUNDS 20
+#define UPDATE_SIZE 16
+
+/**
+ * Cycle round-robin through many live SHA-256 contexts, feeding each a
+ * small update, the way a server juggling connections would. This is
+ * dominated by cache misses on context state.
+ */
+static void bench_many_contexts(void)
+{
+    MehHash* hashes;
+    unsigned char data[UPDATE_SIZE], out[MEH_SHA256_HASH_SIZE];
+    size_t i, j;
+    double start, elapsed;
+
+    memset(data, 0xa5, sizeof (data));
+
+    if (NULL == (hashes = malloc(CONTEXT_COUNT * sizeof (MehHash))))
+        return;
+
+    for (i = 0; i < CONTEXT_COUNT; i++)
+        hashes[i] = meh_get_hash(MEH_SHA256);
+
+    start = now();
+    for (j = 0; j < CONTEXT_ROUNDS; j++)
+        for (i = 0; i < CONTEXT_COUNT; i++)
+            meh_update_hash(hashes[i], data, sizeof (data));
+    elapsed = now() - start;
+
+    for (i = 0; i < CONTEXT_COUNT; i++)
+    {
+        meh_finish_hash(hashes[i], out);
+        meh_destroy_hash(hashes[i]);
+    }
+    free(hashes);
+
+    printf("many-contexts: %d SHA-256 contexts, %d-byte updates: "
+           "%.1f ns/update\n", CONTEXT_COUNT, UPDATE_SIZE,
+           elapsed * 1e9 / ((double)CONTEXT_COUNT * CONTEXT_ROUNDS));
+}
+
+#define CALL_COUNT 4000000
+
+/**
+ * Per-call cost of the generic entry points on small inputs, where
+ * dispatch overhead is a noticeable share of the work.
+ */
+static void bench_small_updates(void)
+{
+    static const size_t sizes[] = { 16, 32, 64 };
+    unsigned char data[64], out[64];
+    size_t i, j, got;
+    double start, elapsed;
+    MehHash hash;
+    MehCipher cipher;
+
+    memset(data, 0x5a, sizeof (data));
+
+    for (j = 0; j < sizeof (sizes) / sizeof (sizes[0]); j++)
+    {
+        hash = meh_get_hash(MEH_MD5);
+        start = now();
+        for (i = 0; i < CALL_COUNT; i++)
+            meh_update_hash(hash, data, sizes[j]);
+        elapsed = now() - start;
+        meh_finish_hash(hash, out);
+        meh_destroy_hash(hash);
+
+        printf("small-updates: MD5 update, %2lu bytes: %.1f ns/call\n",
+               (unsigned long)sizes[j], elapsed * 1e9 / CALL_COUNT);
+
+        cipher = meh_get_cipher(MEH_RC4, data, (size_t)16);
+        start = now();
+        for (i = 0; i < CALL_COUNT; i++)
+            meh_update_cipher(cipher, data, out, sizes[j], &got);
+        elapsed = now() - start;
+        meh_destroy_cipher(cipher);
+
+        printf("small-updates: RC4 update, %2lu bytes: %.1f ns/call\n",
+               (unsigned long)sizes[j], elapsed * 1e9 / CALL_COUNT);
+    }
+}
+
+#define BULK_SIZE (1 << 20)
+#define BULK_ROUNDS 64
+
+static void _bench_bulk_hash(const char* name, meh_hash_id id,
+                             unsigned int threads)
+{
+    unsigned char* data, out[MEH_HASH_MAX_OUTPUT_SIZE];
+    double start, elapsed;
+    MehHash hash;
+    size_t i;
+
+    if (NULL == (data = calloc(BULK_SIZE, 1)))
+        return;
+
+    hash = meh_get_hash(id);
+    start = now();
+    for (i = 0; i < BULK_ROUNDS; i++)
+        meh_update_hash_parallel(hash, data, BULK_SIZE, threads);
+    meh_finish_hash(hash, out);
+    elapsed = now() - start;
+    meh_destroy_hash(hash);
+    free(data);
+
+    printf("bulk-hash: %-17s %7.1f MB/s\n", name,
+           (double)BULK_SIZE * BULK_ROUNDS / elapsed / 1e6);
+}
+
+/**
+ * Throughput on large inputs, with and without the CPU-specific code,
+ * and BLAKE3 at each chunk width and across threads.
+ */
+static void bench_bulk_hash(void)
+{
+    _bench_bulk_hash("SHA-1", MEH_SHA1, 1);
+    _bench_bulk_hash("SHA-256", MEH_SHA256, 1);
+    _bench_bulk_hash("SHA-512", MEH_SHA512, 1);
+    _bench_bulk_hash("BLAKE2b", MEH_BLAKE2B, 1);
+    _bench_bulk_hash("BLAKE2s", MEH_BLAKE2S, 1);
+    _bench_bulk_hash("BLAKE3 16 chunks", MEH_BLAKE3, 1);
+    _bench_bulk_hash("BLAKE3 4 threads", MEH_BLAKE3, 4);
+    _bench_bulk_hash("SHA3-256", MEH_SHA3_256, 1);
+    _bench_bulk_hash("SHAKE128", MEH_SHAKE128, 1);
+
+    meh_mask_cpu_features(MEH_CPU_AVX2 | MEH_CPU_SSE2);
+    _bench_bulk_hash("BLAKE3 8 chunks", MEH_BLAKE3, 1);
+    meh_mask_cpu_features(MEH_CPU_SSE2);
+    _bench_bulk_hash("BLAKE3 4 chunks", MEH_BLAKE3, 1);
+
+    meh_mask_cpu_features(0);
+    printf("bulk-hash: (portable code only)\n");
+    _bench_bulk_hash("SHA-1", MEH_SHA1, 1);
+    _bench_bulk_hash("SHA-256", MEH_SHA256, 1);
+    _bench_bulk_hash("SHA-512", MEH_SHA512, 1);
+    _bench_bulk_hash("BLAKE2b", MEH_BLAKE2B, 1);
+    _bench_bulk_hash("BLAKE2s", MEH_BLAKE2S, 1);
+    _bench_bulk_hash("BLAKE3", MEH_BLAKE3, 1);
+    _bench_bulk_hash("SHA3-256", MEH_SHA3_256, 1);
+    meh_mask_cpu_features(MEH_CPU_ALL);
+}
+
+static void _bench_bulk_cipher(const char* name, MehCipher cipher,
+                               unsigned int threads)
+{
+    unsigned char* data;
+    double start, elapsed;
+    size_t i, got;
+
+    if (NULL == (data = calloc(BULK_SIZE, 1)))
+        return;
+
+    start = now();
+    for (i = 0; i < BULK_ROUNDS; i++)
+        meh_update_cipher_parallel(cipher, data, data, BULK_SIZE, &got,
+                                   threads);
+    elapsed = now() - start;
+    free(data);
+
+    printf("bulk-cipher: %-19s %7.1f MB/s\n", name,
+           (double)BULK_SIZE * BULK_ROUNDS / elapsed / 1e6);
+}
+
+/**
+ * Stream cipher throughput on large buffers, at each block width and
+ * split across threads.
+ */
+static void bench_bulk_cipher(void)
+{
+    static const struct
+    {
+        const char* name,
+                  * chacha20;
+        unsigned int mask;
+    } paths[] =
+    {
+        { "Salsa20 16 blocks", "ChaCha20 16 blocks", MEH_CPU_ALL },
+        { "Salsa20 8 blocks", "ChaCha20 8 blocks", MEH_CPU_AVX2 | MEH_CPU_SSE2 },
+        { "Salsa20 4 blocks", "ChaCha20 4 blocks", MEH_CPU_SSE2 },
+        { "Salsa20 portable", "ChaCha20 portable", 0 }
+    };
+    unsigned char key[32] = {0}, iv[8] = {0}, nonce[12] = {0};
+    MehCipher cipher;
+    size_t j;
+
+    cipher = meh_get_cipher(MEH_RC4, key, (size_t)16);
+    _bench_bulk_cipher("RC4", cipher, 1);
+    meh_destroy_cipher(cipher);
+
+    for (j = 0; j < sizeof (paths) / sizeof (paths[0]); j++)
+    {
+        meh_mask_cpu_features(paths[j].mask);
+        cipher = meh_get_cipher(MEH_SALSA20, key, iv, (size_t)32);
+        _bench_bulk_cipher(paths[j].name, cipher, 1);
+        meh_destroy_cipher(cipher);
+    }
+
+    for (j = 0; j < sizeof (paths) / sizeof (paths[0]); j++)
+    {
+        meh_mask_cpu_features(paths[j].mask);
+        cipher = meh_get_cipher(MEH_CHACHA20, key, nonce, (size_t)32);
+        _bench_bulk_cipher(paths[j].chacha20, cipher, 1);
+        meh_destroy_cipher(cipher);
+    }
+
+    meh_mask_cpu_features(MEH_CPU_ALL);
+
+    cipher = meh_get_cipher(MEH_SALSA20, key, iv, (size_t)32);
+    _bench_bulk_cipher("Salsa20 4 threads", cipher, 4);
+    meh_destroy_cipher(cipher);
+}
+
+#define AEAD_SIZE (16 << 20)
+#define AEAD_ROUNDS 4
+
+/**
+ * Encrypt-and-authenticate over a buffer much larger than the cache:
+ * the cipher then a MAC in two passes, against one fused AEAD pass.
+ */
+static void bench_aead(void)
+{
+    unsigned char key[32] = {0}, nonce[12] = {0},
+                  tag[MEH_SHA256_HASH_SIZE];
+    unsigned char* data;
+    double start, elapsed;
+    meh_poly1305_state_t poly;
+    MehCipher cipher;
+    MehHMAC hmac;
+    MehAEAD aead;
+    size_t i, got;
+
+    if (NULL == (data = calloc(AEAD_SIZE, 1)))
+        return;
+
+    cipher = meh_get_cipher(MEH_CHACHA20, key, nonce, (size_t)32);
+    hmac = meh_get_hmac(MEH_SHA256, key, sizeof (key));
+    start = now();
+    for (i = 0; i < AEAD_ROUNDS; i++)
+    {
+        meh_update_cipher(cipher, data, data, AEAD_SIZE, &got);
+        meh_update_hmac(hmac, data, AEAD_SIZE);
+        meh_finish_hmac(hmac, tag);
+    }
+    elapsed = now() - start;
+    meh_destroy_hmac(hmac);
+    meh_destroy_cipher(cipher);
+
+    printf("aead: ChaCha20, then HMAC-SHA256: %7.1f MB/s\n",
+           (double)AEAD_SIZE * AEAD_ROUNDS / elapsed / 1e6);
+
+    cipher = meh_get_cipher(MEH_CHACHA20, key, nonce, (size_t)32);
+    start = now();
+    for (i = 0; i < AEAD_ROUNDS; i++)
+    {
+        meh_update_cipher(cipher, data, data, AEAD_SIZE, &got);
+        meh_reset_poly1305(&poly, key);
+        meh_update_poly1305(&poly, data, AEAD_SIZE);
+        meh_finish_poly1305(&poly, tag);
+    }
+    elapsed = now() - start;
+    meh_destroy_cipher(cipher);
+
+    printf("aead: ChaCha20, then Poly1305:    %7.1f MB/s\n",
+           (double)AEAD_SIZE * AEAD_ROUNDS / elapsed / 1e6);
+
+    aead = meh_get_aead(MEH_CHACHA20_POLY1305, key, sizeof (key));
+    start = now();
+    for (i = 0; i < AEAD_ROUNDS; i++)
+        meh_aead_seal(aead, nonce, sizeof (nonce), NULL, 0,
+                      data, AEAD_SIZE, data, tag);
+    elapsed = now() - start;
+    meh_destroy_aead(aead);
+
+    printf("aead: ChaCha20-Poly1305 seal:     %7.1f MB/s\n",
+           (double)AEAD_SIZE * AEAD_ROUNDS / elapsed / 1e6);
+
+    free(data);
+}
+
+#define MANY_COUNT 100000
+#define MANY_SIZE 48
+
+static void _bench_hash_many(const char* name, meh_hash_id id,
+                             const unsigned char** msgs, const size_t* lens,
+                             unsigned char* out)
+{
+    static const struct { const char* name; unsigned int mask; } paths[] =
+    {
+        { "16 lanes", MEH_CPU_ALL },
+        { "8 lanes", MEH_CPU_ALL & ~(MEH_CPU_AVX512 | MEH_CPU_SHA) },
+        { "4 lanes", MEH_CPU_SSE2 },
+        { "SHA-NI", MEH_CPU_SHA },
+        { "portable", 0 }
+    };
+    double start, elapsed;
+    size_t i, j;
+
+    start = now();
+    for (i = 0; i < MANY_COUNT; i++)
+        meh_hash(id, msgs[i], lens[i], out);
+    elapsed = now() - start;
+
+    printf("hash-many: %-8s one by one: %6.1f ns/message\n", name,
+           elapsed * 1e9 / MANY_COUNT);
+
+    for (j = 0; j < sizeof (paths) / sizeof (paths[0]); j++)
+    {
+        meh_mask_cpu_features(paths[j].mask);
+        start = now();
+        meh_hash_many(id, msgs, lens, MANY_COUNT, out);
+        elapsed = now() - start;
+
+        printf("hash-many: %-8s %-10s: %6.1f ns/message\n", name,
+               paths[j].name, elapsed * 1e9 / MANY_COUNT);
+    }
+
+    meh_mask_cpu_features(MEH_CPU_ALL);
+}
+
+/* SHAKE sponges side by side: 64-bit lanes, so half as many per vector. */
+static void _bench_squeeze_many(const char* name, meh_hash_id id,
+                                const unsigned char** msgs,
+                                const size_t* lens, unsigned char* out)
+{
+    static const struct { const char* name; unsigned int mask; } paths[] =
+    {
+        { "8 lanes", MEH_CPU_ALL },
+        { "4 lanes", MEH_CPU_AVX2 | MEH_CPU_SSE2 },
+        { "portable", 0 }
+    };
+    double start, elapsed;
+    size_t j;
+
+    for (j = 0; j < sizeof (paths) / sizeof (paths[0]); j++)
+    {
+        meh_mask_cpu_features(paths[j].mask);
+        start = now();
+        meh_squeeze_many(id, msgs, lens, MANY_COUNT, out, 32);
+        elapsed = now() - start;
+
+        printf("hash-many: %-8s %-10s: %6.1f ns/message\n", name,
+               paths[j].name, elapsed * 1e9 / MANY_COUNT);
+    }
+
+    meh_mask_cpu_features(MEH_CPU_ALL);
+}
+
+/**
+ * Many short independent messages, hashed one at a time and across
+ * vector lanes.
+ */
+static void bench_hash_many(void)
+{
+    const unsigned char** msgs;
+    unsigned char* data,
+                 * out;
+    size_t* lens;
+    size_t i;
+
+    msgs = malloc(MANY_COUNT * sizeof (*msgs));
+    lens = malloc(MANY_COUNT * sizeof (*lens));
+    data = malloc(MANY_COUNT * MANY_SIZE);
+    out = malloc(MANY_COUNT * MEH_HASH_MAX_OUTPUT_SIZE);
+
+    if (NULL != msgs && NULL != lens && NULL != data && NULL != out)
+    {
+        for (i = 0; i < MANY_COUNT * MANY_SIZE; i++)
+            data[i] = (unsigned char)i;
+
+        for (i = 0; i < MANY_COUNT; i++)
+        {
+            msgs[i] = data + i * MANY_SIZE;
+            lens[i] = MANY_SIZE;
+        }
+
+        _bench_hash_many("MD5", MEH_MD5, msgs, lens, out);
+        _bench_hash_many("SHA-1", MEH_SHA1, msgs, lens, out);
+        _bench_hash_many("SHA-256", MEH_SHA256, msgs, lens, out);
+        _bench_squeeze_many("SHAKE128", MEH_SHAKE128, msgs, lens, out);
+    }
+
+    free(msgs);
+    free(lens);
+    free(data);
+    free(out);
+}
+
+#define PATH_SIZE (64 << 20)
+#define PATH_NAME "bench_path.tmp"
+
+/**
+ * SHA-256 over a file already in the page cache, through stdio and
+ * through a mapping.
+ */
+static void bench_hash_path(void)
+{
+    unsigned char* data, out[MEH_SHA256_HASH_SIZE];
+    double start, elapsed;
+    MehHash hash;
+    FILE* fd;
+
+    if (NULL == (data = calloc(PATH_SIZE, 1)))
+        return;
+    fd = fopen(PATH_NAME, "wb");
+    if (NULL != fd)
+    {
+        fwrite(data, 1, PATH_SIZE, fd);
+        fclose(fd);
+    }
+    free(data);
+
+    hash = meh_get_hash(MEH_SHA256);
+
+    /* Warm the page cache */
+    meh_hash_path(hash, PATH_NAME);
+    meh_reset_hash(hash);
+
+    if (NULL != (fd = fopen(PATH_NAME, "rb")))
+    {
+        start = now();
+        meh_hash_file(hash, fd);
+        meh_finish_hash(hash, out);
+        elapsed = now() - start;
+        fclose(fd);
+
+        printf("hash-path: meh_hash_file: %7.1f MB/s\n",
+               PATH_SIZE / elapsed / 1e6);
+    }
+
+    meh_reset_hash(hash);
+    start = now();
+    meh_hash_path(hash, PATH_NAME);
+    meh_finish_hash(hash, out);
+    elapsed = now() - start;
+
+    printf("hash-path: meh_hash_path: %7.1f MB/s\n",
+           PATH_SIZE / elapsed / 1e6);
+
+    meh_destroy_hash(hash);
+    remove(PATH_NAME);
+}
+
+/**
+ * scrypt's memory-hard loop at two costs, one thread and four across
+ * the p lanes, with and without SSE2.
+ */
+static void bench_scrypt(void)
+{
+    static const struct
+    {
+        unsigned int N, p, threads, mask;
+        const char* name;
+    } runs[] =
+    {
+        { 1U << 14, 1, 1, MEH_CPU_ALL, "N=2^14 r=8 p=1   " },
+        { 1U << 17, 1, 1, MEH_CPU_ALL, "N=2^17 r=8 p=1   " },
+        { 1U << 17, 1, 1, 0, "N=2^17 portable  " },
+        { 1U << 14, 4, 1, MEH_CPU_ALL, "N=2^14 p=4 1 thr " },
+        { 1U << 14, 4, 4, MEH_CPU_ALL, "N=2^14 p=4 4 thr " }
+    };
+    unsigned char key[64];
+    double start, elapsed;
+    size_t i, got;
+
+    for (i = 0; i < sizeof (runs) / sizeof (runs[0]); i++)
+    {
+        meh_mask_cpu_features(runs[i].mask);
+        start = now();
+        meh_kdf(MEH_SCRYPT, (const unsigned char *)"password", (size_t)8,
+                (const unsigned char *)"NaCl", (size_t)4,
+                runs[i].N, 8U, runs[i].p, runs[i].threads,
+                key, sizeof (key), &got);
+        elapsed = now() - start;
+        printf("scrypt: %s %8.1f ms\n", runs[i].name, elapsed * 1e3);
+    }
+    meh_mask_cpu_features(MEH_CPU_ALL);
+}
+
+/**
+ * Argon2id at t=3, m=64 MiB, p=4: building a context maps its memory,
+ * while a reset reuses it.
+ */
+static void bench_argon2(void)
+{
+    static const struct
+    {
+        unsigned int threads, mask;
+        const char* name;
+    } runs[] =
+    {
+        { 4, MEH_CPU_ALL, "4 threads        " },
+        { 1, MEH_CPU_ALL, "1 thread         " },
+        { 1, MEH_CPU_AVX2 | MEH_CPU_SSE2, "1 thread, AVX2   " },
+        { 1, 0, "1 thread, scalar " }
+    };
+    unsigned char tag[32];
+    double start, elapsed;
+    size_t i, got;
+    MehKDF k;
+
+    for (i = 0; i < sizeof (runs) / sizeof (runs[0]); i++)
+    {
+        meh_mask_cpu_features(runs[i].mask);
+
+        start = now();
+        k = meh_get_kdf(MEH_ARGON2ID, (const unsigned char *)"password",
+                        (size_t)8, (const unsigned char *)"somesalt",
+                        (size_t)8, 3U, 65536U, 4U, 32U, runs[i].threads);
+        elapsed = now() - start;
+        printf("argon2: %s new   %8.1f ms\n", runs[i].name, elapsed * 1e3);
+
+        start = now();
+        meh_reset_kdf(k, (const unsigned char *)"password", (size_t)8,
+                      (const unsigned char *)"somesalt", (size_t)8,
+                      3U, 65536U, 4U, 32U);
+        elapsed = now() - start;
+        printf("argon2: %s reset %8.1f ms\n", runs[i].name, elapsed * 1e3);
+
+        meh_update_kdf(k, tag, sizeof (tag), &got);
+        meh_destroy_kdf(k);
+    }
+    meh_mask_cpu_features(MEH_CPU_ALL);
+}
+
+#define VERIFY_COUNT 20000
+#define VERIFY_SIZE 256
+
+/**
+ * Webhook-style HMAC-SHA256 checks, each message under its own key: a
+ * loop over meh_hmac against meh_hmac_verify_many, on each set of CPU
+ * features.
+ */
+static void bench_hmac_verify(void)
+{
+    static const struct
+    {
+        unsigned int mask;
+        const char* name;
+    } paths[] =
+    {
+        { MEH_CPU_ALL, "all     " },
+        { MEH_CPU_AVX2 | MEH_CPU_SSE2, "AVX2    " },
+        { MEH_CPU_SSE2, "SSE2    " },
+        { 0, "portable" }
+    };
+    unsigned char* data, * tag_data, mac[MEH_SHA256_HASH_SIZE], * results;
+    const unsigned char** msgs, ** keys, ** tags;
+    size_t* lens, * key_lens, i, j, ok;
+    double start, elapsed;
+
+    data = calloc(VERIFY_COUNT, VERIFY_SIZE);
+    tag_data = malloc((size_t)VERIFY_COUNT * MEH_SHA256_HASH_SIZE);
+    results = malloc((VERIFY_COUNT + 7) / 8);
+    msgs = malloc(VERIFY_COUNT * sizeof (*msgs));
+    keys = malloc(VERIFY_COUNT * sizeof (*keys));
+    tags = malloc(VERIFY_COUNT * sizeof (*tags));
+    lens = malloc(VERIFY_COUNT * sizeof (*lens));
+    key_lens = malloc(VERIFY_COUNT * sizeof (*key_lens));
+
+    if (NULL != data && NULL != tag_data && NULL != results &&
+        NULL != msgs && NULL != keys && NULL != tags && NULL != lens &&
+        NULL != key_lens)
+    {
+        for (i = 0; i < VERIFY_COUNT; i++)
+        {
+            memset(data + i * VERIFY_SIZE, (int)i, VERIFY_SIZE);
+            keys[i] = data + i * VERIFY_SIZE;
+            key_lens[i] = 32;
+            msgs[i] = data + i * VERIFY_SIZE + 32;
+            lens[i] = VERIFY_SIZE - 32 - i % 64;
+            tags[i] = tag_data + i * MEH_SHA256_HASH_SIZE;
+            meh_hmac(MEH_SHA256, msgs[i], lens[i], keys[i], key_lens[i],
+                     tag_data + i * MEH_SHA256_HASH_SIZE);
+        }
+
+        for (j = 0; j < sizeof (paths) / sizeof (paths[0]); j++)
+        {
+            meh_mask_cpu_features(paths[j].mask);
+
+            start = now();
+            for (i = 0, ok = 0; i < VERIFY_COUNT; i++)
+            {
+                meh_hmac(MEH_SHA256, msgs[i], lens[i], keys[i], key_lens[i],
+                         mac);
+                ok += (0 == memcmp(mac, tags[i], sizeof (mac)));
+            }
+            elapsed = now() - start;
+            printf("hmac-verify: %s meh_hmac loop %9.0f items/s\n",
+                   paths[j].name, VERIFY_COUNT / elapsed);
+
+            start = now();
+            meh_hmac_verify_many(MEH_SHA256, msgs, lens, keys, key_lens,
+                                 tags, VERIFY_COUNT, results);
+            elapsed = now() - start;
+            printf("hmac-verify: %s verify_many   %9.0f items/s\n",
+                   paths[j].name, VERIFY_COUNT / elapsed);
+        }
+        meh_mask_cpu_features(MEH_CPU_ALL);
+    }
+
+    free(data);
+    free(tag_data);
+    free(results);
+    free(msgs);
+    free(keys);
+    free(tags);
+    free(lens);
+    free(key_lens);
+}
+
+#define GATEWAY_KEYS 300
+#define GATEWAY_KEY_SIZE 100
+#define GATEWAY_REQUESTS 200000
+
+/**
+ * An API gateway signing small requests under a few hundred long keys:
+ * meh_get_hmac per request against contexts keyed through a
+ * MehHMACKeyCache, both allocated and built in place.
+ */
+static void bench_hmac_cache(void)
+{
+    unsigned char keys[GATEWAY_KEYS][GATEWAY_KEY_SIZE], msg[256],
+                  mac[MEH_SHA256_HASH_SIZE];
+    MehHMACKeyCache cache;
+    meh_hmac_t storage;
+    uint64_t hits, misses;
+    MehHMAC m;
+    size_t i, k;
+    double start, elapsed;
+
+    for (i = 0; i < GATEWAY_KEYS; i++)
+    {
+        memset(keys[i], (int)i, GATEWAY_KEY_SIZE);
+        keys[i][0] = (unsigned char)(i >> 8);
+    }
+    memset(msg, 0x42, sizeof (msg));
+
+    start = now();
+    for (i = 0; i < GATEWAY_REQUESTS; i++)
+    {
+        k = (i * 7919) % GATEWAY_KEYS;
+        m = meh_get_hmac(MEH_SHA256, keys[k], GATEWAY_KEY_SIZE);
+        meh_update_hmac(m, msg, sizeof (msg));
+        meh_finish_hmac(m, mac);
+        meh_destroy_hmac(m);
+    }
+    elapsed = now() - start;
+    printf("hmac-cache: meh_get_hmac         %9.0f requests/s\n",
+           GATEWAY_REQUESTS / elapsed);
+
+    if (NULL == (cache = meh_get_hmac_cache(GATEWAY_KEYS * 2)))
+        return;
+
+    start = now();
+    for (i = 0; i < GATEWAY_REQUESTS; i++)
+    {
+        k = (i * 7919) % GATEWAY_KEYS;
+        m = meh_get_hmac_cached(cache, MEH_SHA256, keys[k],
+                                GATEWAY_KEY_SIZE);
+        meh_update_hmac(m, msg, sizeof (msg));
+        meh_finish_hmac(m, mac);
+        meh_destroy_hmac(m);
+    }
+    elapsed = now() - start;
+    printf("hmac-cache: meh_get_hmac_cached  %9.0f requests/s\n",
+           GATEWAY_REQUESTS / elapsed);
+
+    start = now();
+    for (i = 0; i < GATEWAY_REQUESTS; i++)
+    {
+        k = (i * 7919) % GATEWAY_KEYS;
+        m = meh_init_hmac_cached(cache, &storage, sizeof (storage),
+                                 MEH_SHA256, keys[k], GATEWAY_KEY_SIZE);
+        meh_update_hmac(m, msg, sizeof (msg));
+        meh_finish_hmac(m, mac);
+    }
+    elapsed = now() - start;
+    printf("hmac-cache: meh_init_hmac_cached %9.0f requests/s\n",
+           GATEWAY_REQUESTS / elapsed);
+
+    meh_hmac_cache_stats(cache, &hits, &misses);
+    printf("hmac-cache: %llu hits, %llu misses\n",
+           (unsigned long long)hits, (unsigned long long)misses);
+
+    meh_destroy_hmac_cache(cache);
+}
+
+#define PBKDF2_PASSWORDS 64
+#define PBKDF2_ITERATIONS 2000
+
+/**
+ * PBKDF2 with SHA-1, SHA-256 and SHA-512 on each set of CPU features:
+ * a key of four output blocks, then a batch of passwords derived in a
+ * loop over meh_kdf against one meh_pbkdf2_many call.
+ */
+static void bench_pbkdf2(void)
+{
+    static const struct
+    {
+        unsigned int mask;
+        const char* name;
+    } paths[] =
+    {
+        { MEH_CPU_ALL, "all     " },
+        { MEH_CPU_AVX2 | MEH_CPU_SSE2, "AVX2    " },
+        { MEH_CPU_SSE2, "SSE2    " },
+        { 0, "portable" }
+    };
+    static const struct
+    {
+        meh_hash_id id;
+        const char* name;
+    } prfs[] =
+    {
+        { MEH_SHA1, "sha1  " },
+        { MEH_SHA256, "sha256" },
+        { MEH_SHA512, "sha512" }
+    };
+    unsigned char passwords[PBKDF2_PASSWORDS][16], salt[16],
+                  key[4 * MEH_SHA512_HASH_SIZE],
+                  out[PBKDF2_PASSWORDS * MEH_SHA256_HASH_SIZE];
+    const unsigned char* pws[PBKDF2_PASSWORDS], * salts[PBKDF2_PASSWORDS];
+    size_t pw_lens[PBKDF2_PASSWORDS], salt_lens[PBKDF2_PASSWORDS], i, j, k,
+           got, len;
+    double start, elapsed;
+
+    memset(salt, 0x5a, sizeof (salt));
+    for (i = 0; i < PBKDF2_PASSWORDS; i++)
+    {
+        memset(passwords[i], (int)i, sizeof (passwords[i]));
+        pws[i] = passwords[i];
+        pw_lens[i] = sizeof (passwords[i]);
+        salts[i] = salt;
+        salt_lens[i] = sizeof (salt);
+    }
+
+    for (j = 0; j < sizeof (paths) / sizeof (paths[0]); j++)
+    {
+        meh_mask_cpu_features(paths[j].mask);
+
+        for (k = 0; k < sizeof (prfs) / sizeof (prfs[0]); k++)
+        {
+            len = 4 * meh_hash_ops(prfs[k].id)->output_size;
+
+            start = now();
+            meh_kdf(MEH_PBKDF2, prfs[k].id, passwords[0], sizeof (passwords[0]),
+                    salt, sizeof (salt), PBKDF2_ITERATIONS * 10U, key, len,
+                    &got);
+            elapsed = now() - start;
+            printf("pbkdf2: %s %s %3u-byte key     %8.1f ms\n",
+                   paths[j].name, prfs[k].name, (unsigned int)len,
+                   elapsed * 1e3);
+
+            start = now();
+            for (i = 0; i < PBKDF2_PASSWORDS; i++)
+                meh_kdf(MEH_PBKDF2, prfs[k].id, pws[i], pw_lens[i], salt,
+                        sizeof (salt), PBKDF2_ITERATIONS, out + 32 * i,
+                        (size_t)32, &got);
+            elapsed = now() - start;
+            printf("pbkdf2: %s %s meh_kdf loop     %8.0f passwords/s\n",
+                   paths[j].name, prfs[k].name, PBKDF2_PASSWORDS / elapsed);
+
+            start = now();
+            meh_pbkdf2_many(prfs[k].id, pws, pw_lens, salts, salt_lens,
+                            PBKDF2_PASSWORDS, PBKDF2_ITERATIONS, out, 32);
+            elapsed = now() - start;
+            printf("pbkdf2: %s %s meh_pbkdf2_many  %8.0f passwords/s\n",
+                   paths[j].name, prfs[k].name, PBKDF2_PASSWORDS / elapsed);
+        }
+    }
+    meh_mask_cpu_features(MEH_CPU_ALL);
+}
+
+/**
+ * One block of PBKDF2 at iteration counts from 1 to 100000, per
+ * iteration: meh_kdf, whose rounds stay in hash words, against the
+ * same rounds spelled out with meh_restart_hmac, meh_update_hmac and
+ * meh_finish_hmac.
+ */
+static void bench_pbkdf2_iterations(void)
+{
+    static const struct
+    {
+        meh_hash_id id;
+        const char* name;
+    } prfs[] =
+    {
+        { MEH_SHA1, "sha1  " },
+        { MEH_SHA256, "sha256" },
+        { MEH_SHA512, "sha512" }
+    };
+    static const unsigned int counts[] = { 1, 10, 100, 1000, 10000, 100000 };
+    unsigned char key[MEH_SHA512_HASH_SIZE], u[MEH_SHA512_HASH_SIZE],
+                  one[4] = { 0, 0, 0, 1 };
+    MehHMAC m;
+    size_t i, j, k, r, runs, got, len;
+    double start, elapsed;
+
+    for (k = 0; k < sizeof (prfs) / sizeof (prfs[0]); k++)
+    {
+        len = meh_hash_ops(prfs[k].id)->output_size;
+
+        if (NULL == (m = meh_get_hmac(prfs[k].id,
+                                      (const unsigned char*)"password", 8)))
+            return;
+
+        for (j = 0; j < sizeof (counts) / sizeof (counts[0]); j++)
+        {
+            runs = (counts[j] < 100000) ? 100000 / counts[j] : 1;
+
+            start = now();
+            for (r = 0; r < runs; r++)
+                meh_kdf(MEH_PBKDF2, prfs[k].id,
+                        (const unsigned char*)"password", (size_t)8,
+                        (const unsigned char*)"salt", (size_t)4, counts[j],
+                        key, len, &got);
+            elapsed = now() - start;
+            printf("pbkdf2-iterations: %s %6u  meh_kdf   %8.1f ns/iteration\n",
+                   prfs[k].name, counts[j],
+                   elapsed * 1e9 / ((double)runs * counts[j]));
+
+            start = now();
+            for (r = 0; r < runs; r++)
+            {
+                meh_restart_hmac(m);
+                meh_update_hmac(m, (const unsigned char*)"salt", 4);
+                meh_update_hmac(m, one, sizeof (one));
+                meh_finish_hmac(m, u);
+                memcpy(key, u, len);
+
+                for (i = 1; i < counts[j]; i++)
+                {
+                    meh_restart_hmac(m);
+                    meh_update_hmac(m, u, len);
+                    meh_finish_hmac(m, u);
+                    for (got = 0; got < len; got++)
+                        key[got] ^= u[got];
+                }
+            }
+            elapsed = now() - start;
+            printf("pbkdf2-iterations: %s %6u  HMAC loop %8.1f ns/iteration\n",
+                   prfs[k].name, counts[j],
+                   elapsed * 1e9 / ((double)runs * counts[j]));
+        }
+
+        meh_destroy_hmac(m);
+    }
+}
+
+/**
+ * Latency of multi-block PBKDF2-HMAC-SHA1 keys with the blocks spread
+ * over threads.
+ */
+static void bench_pbkdf2_threads(void)
+{
+    static const size_t blocks[] = { 1, 5, 20, 80 };
+    static const unsigned int threads[] = { 1, 2, 4 };
+    unsigned char key[80 * MEH_SHA1_HASH_SIZE];
+    MehKDF k;
+    size_t i, j, got;
+    double start, elapsed;
+
+    for (i = 0; i < sizeof (blocks) / sizeof (blocks[0]); i++)
+    {
+        for (j = 0; j < sizeof (threads) / sizeof (threads[0]); j++)
+        {
+            if (NULL == (k = meh_get_kdf(MEH_PBKDF2, MEH_SHA1,
+                                         (const unsigned char*)"password",
+                                         (size_t)8,
+                                         (const unsigned char*)"salt",
+                                         (size_t)4, 20000U)))
+                return;
+
+            meh_set_threads_kdf(k, threads[j]);
+
+            start = now();
+            meh_update_kdf(k, key, blocks[i] * MEH_SHA1_HASH_SIZE, &got);
+            elapsed = now() - start;
+            printf("pbkdf2-threads: sha1 %2u blocks  %u threads %8.2f ms\n",
+                   (unsigned int)blocks[i], threads[j], elapsed * 1e3);
+
+            meh_destroy_kdf(k);
+        }
+    }
+}
+
+#define HKDF_LABELS 100000
+
+/**
+ * Many 32-byte subkeys of one secret: a context per label, against
+ * expanding every label from one extraction.
+ */
+static void bench_hkdf(void)
+{
+    static const unsigned char secret[32] = {0};
+    unsigned char label[16], * keys;
+    const unsigned char** labels;
+    size_t* lens, i, got;
+    double start, elapsed;
+    MehKDF k;
+
+    keys = malloc((size_t)HKDF_LABELS * 32);
+    labels = malloc(HKDF_LABELS * sizeof (*labels));
+    lens = malloc(HKDF_LABELS * sizeof (*lens));
+    if (NULL == keys || NULL == labels || NULL == lens)
+    {
+        free(keys);
+        free(labels);
+        free(lens);
+        return;
+    }
+
+    memset(label, 'L', sizeof (label));
+    for (i = 0; i < HKDF_LABELS; i++)
+    {
+        labels[i] = label;
+        lens[i] = sizeof (label);
+    }
+
+    start = now();
+    for (i = 0; i < HKDF_LABELS; i++)
+        meh_kdf(MEH_HKDF, MEH_SHA256, secret, sizeof (secret), NULL, (size_t)0,
+                label, sizeof (label), keys + 32 * i, (size_t)32, &got);
+    elapsed = now() - start;
+    printf("hkdf: context per label:   %8.0f keys/s\n",
+           HKDF_LABELS / elapsed);
+
+    start = now();
+    k = meh_get_kdf(MEH_HKDF, MEH_SHA256, secret, sizeof (secret), NULL,
+                    (size_t)0, NULL, (size_t)0);
+    meh_expand_many_kdf(k, labels, lens, HKDF_LABELS, keys, 32);
+    meh_destroy_kdf(k);
+    elapsed = now() - start;
+    printf("hkdf: meh_expand_many_kdf: %8.0f keys/s\n",
+           HKDF_LABELS / elapsed);
+
+    free(keys);
+    free(labels);
+    free(lens);
+}
+
+typedef struct bench_s
+{
+    const char* name;
+    void (*run)(void);
+} bench_t;
+
+static const bench_t benches[] =
+{
+    { "many-contexts", bench_many_contexts },
+    { "small-updates", bench_small_updates },
+    { "bulk-hash", bench_bulk_hash },
+    { "bulk-cipher", bench_bulk_cipher },
+    { "aead", bench_aead },
+    { "hash-many", bench_hash_many },
+    { "hash-path", bench_hash_path },
+    { "scrypt", bench_scrypt },
+    { "argon2", bench_argon2 },
+    { "hkdf", bench_hkdf },
+    { "hmac-verify", bench_hmac_verify },
+    { "hmac-cache", bench_hmac_cache },
+    { "pbkdf2", bench_pbkdf2 },
+    { "pbkdf2-iterations", bench_pbkdf2_iterations },
+    { "pbkdf2-threads", bench_pbkdf2_threads },
+    { NULL, NULL }
+};
+
+int main(int argc, char** argv)
+{
+    const bench_t* b;
+    int i, found;
+
+    for (b = benches; NULL != b->name; b++)
+    {
+        found = (argc < 2);
+        for (i = 1; i < argc; i++)
+            if (0 == strcmp(argv[i], b->name))
+                found = 1;
+        if (found)
+            b->run();
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "aead.h"
+
+static meh_error_t _meh_reset_chacha20poly1305(meh_aead_state_t* s,
+                                               const unsigned char* key,
+                                               size_t key_size)
+{
+    return meh_reset_chacha20poly1305(&s->chacha20poly1305, key, key_size);
+}
+
+static meh_error_t _meh_seal_chacha20poly1305(meh_aead_state_t* s,
+                                              const unsigned char* nonce,
+                                              size_t nonce_size,
+                                              const unsigned char* ad,
+                                              size_t ad_len,
+                                              const unsigned char* in,
+                                              size_t len, unsigned char* out,
+                                              unsigned char* tag)
+{
+    return meh_seal_chacha20poly1305(&s->chacha20poly1305, nonce, nonce_size,
+                                     ad, ad_len, in, len, out, tag);
+}
+
+static meh_error_t _meh_open_chacha20poly1305(meh_aead_state_t* s,
+                                              const unsigned char* nonce,
+                                              size_t nonce_size,
+                                              const unsigned char* ad,
+                                              size_t ad_len,
+                                              const unsigned char* in,
+                                              size_t len, unsigned char* out,
+                                              const unsigned char* tag)
+{
+    return meh_open_chacha20poly1305(&s->chacha20poly1305, nonce, nonce_size,
+                                     ad, ad_len, in, len, out, tag);
+}
+
+static const meh_aead_ops_t meh_chacha20poly1305_ops =
+{
+    MEH_CHACHA20_POLY1305,
+    MEH_CHACHA20POLY1305_KEY_SIZE,
+    MEH_CHACHA20POLY1305_NONCE_SIZE,
+    MEH_CHACHA20POLY1305_TAG_SIZE,
+    _meh_reset_chacha20poly1305,
+    _meh_seal_chacha20poly1305,
+    _meh_open_chacha20poly1305
+};
+
+/* The one place an AEAD id is mapped to its implementation. */
+const meh_aead_ops_t* meh_aead_ops(const meh_aead_id aead_id)
+{
+    switch (aead_id)
+    {
+        case MEH_CHACHA20_POLY1305: return &meh_chacha20poly1305_ops;
+        default:
+            return NULL;
+    }
+}
+
+size_t meh_aead_context_size(const meh_aead_id aead_id)
+{
+    return (NULL == meh_aead_ops(aead_id)) ? 0 : sizeof (meh_aead_t);
+}
+
+MehAEAD meh_init_aead(void* mem, size_t size, const meh_aead_id aead_id,
+                      const unsigned char* key, size_t key_size)
+{
+    MehAEAD r = mem;
+    size_t need = meh_aead_context_size(aead_id);
+
+    if (0 == need || NULL == mem || size < need || !MEH_IS_ALIGNED(mem))
+    {
+        meh_warn("invalid AEAD or storage passed to meh_init_aead");
+        return NULL;
+    }
+
+    r->ops = meh_aead_ops(aead_id);
+    r->id = aead_id;
+    r->allocated = 0;
+
+    return (MEH_OK == r->ops->reset(&r->state, key, key_size)) ? r : NULL;
+}
+
+MehAEAD meh_get_aead(const meh_aead_id aead_id, const unsigned char* key,
+                     size_t key_size)
+{
+    MehAEAD r;
+    void* mem;
+    size_t size = meh_aead_context_size(aead_id);
+
+    if (0 == size)
+    {
+        meh_warn("invalid AEAD id passed to meh_get_aead");
+        return NULL;
+    }
+
+    if (NULL == (mem = malloc(size)))
+    {
+        meh_warn("could not allocate AEAD context in meh_get_aead");
+        return NULL;
+    }
+
+    if (NULL == (r = meh_init_aead(mem, size, aead_id, key, key_size)))
+    {
+        free(mem);
+        return NULL;
+    }
+
+    r->allocated = 1;
+
+    return r;
+}
+
+/* Switch to a new key. */
+meh_error_t meh_reset_aead(MehAEAD aead, const unsigned char* key,
+                           size_t key_size)
+{
+    return aead->ops->reset(&aead->state, key, key_size);
+}
+
+size_t meh_aead_nonce_size(MehAEAD aead)
+{
+    return aead->ops->nonce_size;
+}
+
+size_t meh_aead_tag_size(MehAEAD aead)
+{
+    return aead->ops->tag_size;
+}
+
+/* Encrypt len bytes of in to out and write the tag covering them and
+   the associated data. A nonce must never be reused under one key. */
+meh_error_t meh_aead_seal(MehAEAD aead,
+                          const unsigned char* nonce, size_t nonce_size,
+                          const unsigned char* ad, size_t ad_len,
+                          const unsigned char* in, size_t len,
+                          unsigned char* out, unsigned char* tag)
+{
+    return aead->ops->seal(&aead->state, nonce, nonce_size, ad, ad_len,
+                           in, len, out, tag);
+}
+
+/* Decrypt len bytes of in to out, returning MEH_AUTH_FAILED (and no
+   plaintext) if the tag does not match. */
+meh_error_t meh_aead_open(MehAEAD aead,
+                          const unsigned char* nonce, size_t nonce_size,
+                          const unsigned char* ad, size_t ad_len,
+                          const unsigned char* in, size_t len,
+                          unsigned char* out, const unsigned char* tag)
+{
+    return aead->ops->open(&aead->state, nonce, nonce_size, ad, ad_len,
+                           in, len, out, tag);
+}
+
+void meh_destroy_aead(MehAEAD aead)
+{
+    if (NULL == aead)
+    {
+        meh_warn("invalid argument passed to meh_destroy_aead");
+        return;
+    }
+
+    /* Scrub the key, whoever owns the storage */
+    memset(&aead->state, 0, sizeof (aead->state));
+
+    if (aead->allocated)
+        free(aead);
+}
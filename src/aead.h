@@ -0,0 +1,92 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_AEAD_H
+#define MEH_AEAD_H
+
+#include "include.h"
+#include "error.h"
+#include "chacha20poly1305.h"
+
+typedef enum
+{
+    MEH_CHACHA20_POLY1305
+} meh_aead_id;
+
+#define MEH_AEAD_MAX_TAG_SIZE 16
+
+/* Held by value so a context is one contiguous object. */
+typedef union meh_aead_state_u
+{
+    meh_chacha20poly1305_state_t chacha20poly1305;
+} meh_aead_state_t;
+
+/* Resolved once when a context is built. seal and open take the nonce,
+   associated data, input, output and tag, in that order. */
+typedef struct meh_aead_ops_s
+{
+    meh_aead_id id;
+    size_t key_size,
+           nonce_size,
+           tag_size;
+
+    meh_error_t (*reset)(meh_aead_state_t*, const unsigned char*, size_t);
+    meh_error_t (*seal)(meh_aead_state_t*, const unsigned char*, size_t,
+                        const unsigned char*, size_t,
+                        const unsigned char*, size_t,
+                        unsigned char*, unsigned char*);
+    meh_error_t (*open)(meh_aead_state_t*, const unsigned char*, size_t,
+                        const unsigned char*, size_t,
+                        const unsigned char*, size_t,
+                        unsigned char*, const unsigned char*);
+} meh_aead_ops_t;
+
+typedef struct meh_aead_s
+{
+    const meh_aead_ops_t* ops;
+    meh_aead_state_t state;
+    meh_aead_id id;
+
+    int allocated; /* storage came from meh_get_aead */
+} meh_aead_t;
+
+typedef meh_aead_t* MehAEAD;
+
+const meh_aead_ops_t* meh_aead_ops(const meh_aead_id);
+MehAEAD meh_get_aead(const meh_aead_id, const unsigned char*, size_t);
+size_t meh_aead_context_size(const meh_aead_id);
+MehAEAD meh_init_aead(void*, size_t, const meh_aead_id,
+                      const unsigned char*, size_t);
+meh_error_t meh_reset_aead(MehAEAD, const unsigned char*, size_t);
+size_t meh_aead_nonce_size(MehAEAD);
+size_t meh_aead_tag_size(MehAEAD);
+meh_error_t meh_aead_seal(MehAEAD, const unsigned char*, size_t,
+                          const unsigned char*, size_t,
+                          const unsigned char*, size_t,
+                          unsigned char*, unsigned char*);
+meh_error_t meh_aead_open(MehAEAD, const unsigned char*, size_t,
+                          const unsigned char*, size_t,
+                          const unsigned char*, size_t,
+                          unsigned char*, const unsigned char*);
+void meh_destroy_aead(MehAEAD);
+
+#endif
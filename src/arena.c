@@ -0,0 +1,110 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/* Anonymous mappings and madvise are outside what -std=c99 exposes. */
+#define _DEFAULT_SOURCE
+
+#include "arena.h"
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#    include <sys/mman.h>
+#    if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#        define MAP_ANONYMOUS MAP_ANON
+#    endif
+#endif
+
+#if defined(MAP_ANONYMOUS)
+#    define MEH_HAVE_ANON_MMAP 1
+#else
+#    define MEH_HAVE_ANON_MMAP 0
+#endif
+
+/* Arenas this big are mapped, rounded up to whole huge pages. */
+#define MEH_ARENA_HUGE ((size_t)2 << 20)
+
+/* Called through a volatile pointer so the wipe of an arena about to be
+   released is not dropped as a dead store. */
+static void* (* volatile _meh_arena_memset)(void*, int, size_t) = memset;
+
+void _meh_init_arena(meh_arena_t* arena)
+{
+    arena->base = NULL;
+    arena->size = 0;
+    arena->mapped = 0;
+}
+
+/* Make the arena at least size bytes. Its contents are not kept when it
+   has to grow. */
+meh_error_t _meh_reserve_arena(meh_arena_t* arena, size_t size)
+{
+#if MEH_HAVE_ANON_MMAP
+    size_t rounded;
+    void* map;
+#endif
+
+    if (size <= arena->size)
+        return MEH_OK;
+
+    _meh_release_arena(arena);
+
+#if MEH_HAVE_ANON_MMAP
+    if (size >= MEH_ARENA_HUGE && size <= SIZE_MAX - MEH_ARENA_HUGE)
+    {
+        rounded = (size + MEH_ARENA_HUGE - 1) & ~(MEH_ARENA_HUGE - 1);
+        map = mmap(NULL, rounded, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED != map)
+        {
+#    ifdef MADV_HUGEPAGE
+            madvise(map, rounded, MADV_HUGEPAGE);
+#    endif
+            arena->base = map;
+            arena->size = rounded;
+            arena->mapped = 1;
+            return MEH_OK;
+        }
+    }
+#endif
+
+    if (NULL == (arena->base = malloc(size)))
+        return meh_error("could not allocate KDF arena", MEH_OUT_OF_MEMORY);
+
+    arena->size = size;
+
+    return MEH_OK;
+}
+
+/* The contents are derived from a password, so they are wiped first. */
+void _meh_release_arena(meh_arena_t* arena)
+{
+    if (NULL != arena->base)
+        _meh_arena_memset(arena->base, 0, arena->size);
+
+#if MEH_HAVE_ANON_MMAP
+    if (arena->mapped)
+        munmap(arena->base, arena->size);
+    else
+#endif
+        free(arena->base);
+
+    _meh_init_arena(arena);
+}
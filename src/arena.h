@@ -0,0 +1,43 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_ARENA_H
+#define MEH_ARENA_H
+
+#include "include.h"
+#include "error.h"
+
+/* A large scratch allocation owned by a memory-hard KDF and kept across
+   resets. Big arenas are mapped directly so the kernel can back them
+   with huge pages. */
+typedef struct meh_arena_s
+{
+    unsigned char* base;
+    size_t size;
+    int mapped; /* base came from mmap rather than malloc */
+} meh_arena_t;
+
+void _meh_init_arena(meh_arena_t*);
+meh_error_t _meh_reserve_arena(meh_arena_t*, size_t);
+void _meh_release_arena(meh_arena_t*);
+
+#endif
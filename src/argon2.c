@@ -0,0 +1,733 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "argon2.h"
+#include "blake2b.h"
+#include "bitwise.h"
+#include "cpu.h"
+#include "thread.h"
+
+#if MEH_HAVE_X86
+#    include <immintrin.h>
+#endif
+
+#define MEH_ARGON2_WORDS     (MEH_ARGON2_BLOCK_SIZE / 8)
+#define MEH_ARGON2_SLICES    4
+#define MEH_ARGON2_ID        2
+#define MEH_ARGON2_MAX_LANES 0xFFFFFF
+
+/* next = G(prev, ref), XORed into what next held before when the last
+   argument is set. next may be ref. */
+typedef void (*meh_argon2_fill_fn)(const uint64_t*, const uint64_t*,
+                                   uint64_t*, int);
+
+/* BLAKE2b's G with each addition a + b replaced by a + b + 2ab over the
+   low 32 bits of each word. */
+#define BLAMKA(x, y) \
+    ((x) + (y) + 2 * ((x) & UINT64_C(0xFFFFFFFF)) * ((y) & UINT64_C(0xFFFFFFFF)))
+
+#define G(a, b, c, d)                     \
+    do {                                  \
+        a = BLAMKA(a, b);                 \
+        d = ROTR64(d ^ a, 32);            \
+        c = BLAMKA(c, d);                 \
+        b = ROTR64(b ^ c, 24);            \
+        a = BLAMKA(a, b);                 \
+        d = ROTR64(d ^ a, 16);            \
+        c = BLAMKA(c, d);                 \
+        b = ROTR64(b ^ c, 63);            \
+    } while (0)
+
+/* The permutation P on 16 words of R taken in pairs: words first and
+   first + 1, then first + step and first + step + 1, and so on. Rows
+   are runs of 16 words (step 2), columns pairs 16 words apart. */
+static void _meh_argon2_round(uint64_t* R, size_t first, size_t step)
+{
+    uint64_t v[16];
+    int j;
+
+    for (j = 0; j < 16; j++)
+        v[j] = R[first + (j & 1) + step * (j >> 1)];
+
+    G(v[0], v[4],  v[8], v[12]);
+    G(v[1], v[5],  v[9], v[13]);
+    G(v[2], v[6], v[10], v[14]);
+    G(v[3], v[7], v[11], v[15]);
+    G(v[0], v[5], v[10], v[15]);
+    G(v[1], v[6], v[11], v[12]);
+    G(v[2], v[7],  v[8], v[13]);
+    G(v[3], v[4],  v[9], v[14]);
+
+    for (j = 0; j < 16; j++)
+        R[first + (j & 1) + step * (j >> 1)] = v[j];
+}
+
+#undef G
+#undef BLAMKA
+
+static void _meh_argon2_fill(const uint64_t* prev, const uint64_t* ref,
+                             uint64_t* next, int with_xor)
+{
+    uint64_t R[MEH_ARGON2_WORDS], Z[MEH_ARGON2_WORDS];
+    size_t i;
+
+    for (i = 0; i < MEH_ARGON2_WORDS; i++)
+    {
+        R[i] = prev[i] ^ ref[i];
+        Z[i] = R[i] ^ (with_xor ? next[i] : 0);
+    }
+
+    for (i = 0; i < 8; i++)
+        _meh_argon2_round(R, 16 * i, 2);
+    for (i = 0; i < 8; i++)
+        _meh_argon2_round(R, 2 * i, 16);
+
+    for (i = 0; i < MEH_ARGON2_WORDS; i++)
+        next[i] = R[i] ^ Z[i];
+}
+
+#if MEH_HAVE_X86
+
+#define MEH_ARGON2_AVX2 __attribute__((target("avx2")))
+
+#define BLAMKA_AVX2(x, y)                                                \
+    (t = _mm256_mul_epu32(x, y),                                         \
+     _mm256_add_epi64(_mm256_add_epi64(x, y), _mm256_add_epi64(t, t)))
+
+#define G_AVX2(a, b, c, d)                                               \
+    do {                                                                 \
+        a = BLAMKA_AVX2(a, b);                                           \
+        d = _mm256_shuffle_epi32(_mm256_xor_si256(d, a),                 \
+                                 _MM_SHUFFLE(2, 3, 0, 1));               \
+        c = BLAMKA_AVX2(c, d);                                           \
+        b = _mm256_shuffle_epi8(_mm256_xor_si256(b, c), rot24);          \
+        a = BLAMKA_AVX2(a, b);                                           \
+        d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot16);          \
+        c = BLAMKA_AVX2(c, d);                                           \
+        b = _mm256_xor_si256(b, c);                                      \
+        b = _mm256_or_si256(_mm256_srli_epi64(b, 63),                    \
+                            _mm256_add_epi64(b, b));                     \
+    } while (0)
+
+/* Rows hold four consecutive words per register and line up their
+   diagonals by rotating registers, as BLAKE2b does. Columns are taken
+   two at a time, one per 128-bit half, so their diagonals need only
+   in-lane byte shifts between register pairs. */
+MEH_ARGON2_AVX2
+static void _meh_argon2_fill_avx2(const uint64_t* prev, const uint64_t* ref,
+                                  uint64_t* next, int with_xor)
+{
+    const __m256i rot24 = _mm256_setr_epi8(
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    const __m256i rot16 = _mm256_setr_epi8(
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    __m256i R[32], Z[32], a0, a1, b0, b1, c0, c1, d0, d1, t;
+    int i;
+
+    for (i = 0; i < 32; i++)
+    {
+        R[i] = _mm256_xor_si256(
+            _mm256_loadu_si256((const __m256i*)prev + i),
+            _mm256_loadu_si256((const __m256i*)ref + i));
+        Z[i] = with_xor ?
+            _mm256_xor_si256(R[i],
+                             _mm256_loadu_si256((const __m256i*)next + i)) :
+            R[i];
+    }
+
+    for (i = 0; i < 32; i += 4)
+    {
+        a0 = R[i]; b0 = R[i + 1]; c0 = R[i + 2]; d0 = R[i + 3];
+
+        G_AVX2(a0, b0, c0, d0);
+
+        b0 = _mm256_permute4x64_epi64(b0, _MM_SHUFFLE(0, 3, 2, 1));
+        c0 = _mm256_permute4x64_epi64(c0, _MM_SHUFFLE(1, 0, 3, 2));
+        d0 = _mm256_permute4x64_epi64(d0, _MM_SHUFFLE(2, 1, 0, 3));
+
+        G_AVX2(a0, b0, c0, d0);
+
+        R[i] = a0;
+        R[i + 1] = _mm256_permute4x64_epi64(b0, _MM_SHUFFLE(2, 1, 0, 3));
+        R[i + 2] = _mm256_permute4x64_epi64(c0, _MM_SHUFFLE(1, 0, 3, 2));
+        R[i + 3] = _mm256_permute4x64_epi64(d0, _MM_SHUFFLE(0, 3, 2, 1));
+    }
+
+    /* Register i holds words 4i to 4i + 3: pairs 0 and 1 of columns
+       2i and 2i + 1, with the next pair of each 16 words further on. */
+    for (i = 0; i < 4; i++)
+    {
+        a0 = R[i];      a1 = R[i + 4];
+        b0 = R[i + 8];  b1 = R[i + 12];
+        c0 = R[i + 16]; c1 = R[i + 20];
+        d0 = R[i + 24]; d1 = R[i + 28];
+
+        G_AVX2(a0, b0, c0, d0);
+        G_AVX2(a1, b1, c1, d1);
+
+        t = _mm256_alignr_epi8(b1, b0, 8);
+        b1 = _mm256_alignr_epi8(b0, b1, 8);
+        b0 = t;
+        t = c0; c0 = c1; c1 = t;
+        t = _mm256_alignr_epi8(d0, d1, 8);
+        d1 = _mm256_alignr_epi8(d1, d0, 8);
+        d0 = t;
+
+        G_AVX2(a0, b0, c0, d0);
+        G_AVX2(a1, b1, c1, d1);
+
+        R[i] = a0;
+        R[i + 4] = a1;
+        R[i + 8] = _mm256_alignr_epi8(b0, b1, 8);
+        R[i + 12] = _mm256_alignr_epi8(b1, b0, 8);
+        R[i + 16] = c1;
+        R[i + 20] = c0;
+        R[i + 24] = _mm256_alignr_epi8(d1, d0, 8);
+        R[i + 28] = _mm256_alignr_epi8(d0, d1, 8);
+    }
+
+    for (i = 0; i < 32; i++)
+        _mm256_storeu_si256((__m256i*)next + i,
+                            _mm256_xor_si256(R[i], Z[i]));
+}
+
+#undef G_AVX2
+#undef BLAMKA_AVX2
+
+#define MEH_ARGON2_AVX512 __attribute__((target("avx512f")))
+
+#define BLAMKA_AVX512(x, y)                                              \
+    (t = _mm512_mul_epu32(x, y),                                         \
+     _mm512_add_epi64(_mm512_add_epi64(x, y), _mm512_add_epi64(t, t)))
+
+#define G_AVX512(a, b, c, d)                                             \
+    do {                                                                 \
+        a = BLAMKA_AVX512(a, b);                                         \
+        d = _mm512_ror_epi64(_mm512_xor_si512(d, a), 32);                \
+        c = BLAMKA_AVX512(c, d);                                         \
+        b = _mm512_ror_epi64(_mm512_xor_si512(b, c), 24);                \
+        a = BLAMKA_AVX512(a, b);                                         \
+        d = _mm512_ror_epi64(_mm512_xor_si512(d, a), 16);                \
+        c = BLAMKA_AVX512(c, d);                                         \
+        b = _mm512_ror_epi64(_mm512_xor_si512(b, c), 63);                \
+    } while (0)
+
+/* The AVX2 layout twice over: two rows per register, one per 256-bit
+   half, and four columns, one per 128-bit lane. */
+MEH_ARGON2_AVX512
+static void _meh_argon2_fill_avx512(const uint64_t* prev,
+                                    const uint64_t* ref,
+                                    uint64_t* next, int with_xor)
+{
+    /* Per 128-bit lane, the high word of one register then the low
+       word of the other */
+    const __m512i cross = _mm512_setr_epi64(1, 8, 3, 10, 5, 12, 7, 14);
+    __m512i R[16], Z[16], a0, a1, b0, b1, c0, c1, d0, d1, t;
+    int i;
+
+    for (i = 0; i < 16; i++)
+    {
+        R[i] = _mm512_xor_si512(
+            _mm512_loadu_si512((const __m512i*)prev + i),
+            _mm512_loadu_si512((const __m512i*)ref + i));
+        Z[i] = with_xor ?
+            _mm512_xor_si512(R[i],
+                             _mm512_loadu_si512((const __m512i*)next + i)) :
+            R[i];
+    }
+
+    /* Registers i to i + 3 are two rows of 16 words */
+    for (i = 0; i < 16; i += 4)
+    {
+        a0 = _mm512_shuffle_i64x2(R[i], R[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        b0 = _mm512_shuffle_i64x2(R[i], R[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        c0 = _mm512_shuffle_i64x2(R[i + 1], R[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        d0 = _mm512_shuffle_i64x2(R[i + 1], R[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+
+        G_AVX512(a0, b0, c0, d0);
+
+        b0 = _mm512_permutex_epi64(b0, _MM_SHUFFLE(0, 3, 2, 1));
+        c0 = _mm512_permutex_epi64(c0, _MM_SHUFFLE(1, 0, 3, 2));
+        d0 = _mm512_permutex_epi64(d0, _MM_SHUFFLE(2, 1, 0, 3));
+
+        G_AVX512(a0, b0, c0, d0);
+
+        b0 = _mm512_permutex_epi64(b0, _MM_SHUFFLE(2, 1, 0, 3));
+        c0 = _mm512_permutex_epi64(c0, _MM_SHUFFLE(1, 0, 3, 2));
+        d0 = _mm512_permutex_epi64(d0, _MM_SHUFFLE(0, 3, 2, 1));
+
+        R[i] = _mm512_shuffle_i64x2(a0, b0, _MM_SHUFFLE(1, 0, 1, 0));
+        R[i + 1] = _mm512_shuffle_i64x2(c0, d0, _MM_SHUFFLE(1, 0, 1, 0));
+        R[i + 2] = _mm512_shuffle_i64x2(a0, b0, _MM_SHUFFLE(3, 2, 3, 2));
+        R[i + 3] = _mm512_shuffle_i64x2(c0, d0, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        a0 = R[i];      a1 = R[i + 2];
+        b0 = R[i + 4];  b1 = R[i + 6];
+        c0 = R[i + 8];  c1 = R[i + 10];
+        d0 = R[i + 12]; d1 = R[i + 14];
+
+        G_AVX512(a0, b0, c0, d0);
+        G_AVX512(a1, b1, c1, d1);
+
+        t = _mm512_permutex2var_epi64(b0, cross, b1);
+        b1 = _mm512_permutex2var_epi64(b1, cross, b0);
+        b0 = t;
+        t = c0; c0 = c1; c1 = t;
+        t = _mm512_permutex2var_epi64(d1, cross, d0);
+        d1 = _mm512_permutex2var_epi64(d0, cross, d1);
+        d0 = t;
+
+        G_AVX512(a0, b0, c0, d0);
+        G_AVX512(a1, b1, c1, d1);
+
+        R[i] = a0;
+        R[i + 2] = a1;
+        R[i + 4] = _mm512_permutex2var_epi64(b1, cross, b0);
+        R[i + 6] = _mm512_permutex2var_epi64(b0, cross, b1);
+        R[i + 8] = c1;
+        R[i + 10] = c0;
+        R[i + 12] = _mm512_permutex2var_epi64(d0, cross, d1);
+        R[i + 14] = _mm512_permutex2var_epi64(d1, cross, d0);
+    }
+
+    for (i = 0; i < 16; i++)
+        _mm512_storeu_si512((__m512i*)next + i,
+                            _mm512_xor_si512(R[i], Z[i]));
+}
+
+#undef G_AVX512
+#undef BLAMKA_AVX512
+
+#endif
+
+static meh_argon2_fill_fn _meh_argon2_filler(void)
+{
+#if MEH_HAVE_X86
+    if (meh_cpu_features() & MEH_CPU_AVX512)
+        return _meh_argon2_fill_avx512;
+    if (meh_cpu_features() & MEH_CPU_AVX2)
+        return _meh_argon2_fill_avx2;
+#endif
+    return _meh_argon2_fill;
+}
+
+/* The variable-length hash H': BLAKE2b of the output length and input,
+   chained 32 bytes at a time for outputs longer than 64 bytes. */
+static void _meh_argon2_hash(unsigned char* out, size_t out_len,
+                             const unsigned char* in, size_t in_len)
+{
+    meh_blake2b_state_t b;
+    unsigned char length[4], V[MEH_BLAKE2B_HASH_SIZE];
+
+    U32TO8_LITTLE(length, (uint32_t)out_len, 0);
+
+    if (out_len <= MEH_BLAKE2B_HASH_SIZE)
+    {
+        meh_configure_blake2b(&b, NULL, 0, out_len);
+        meh_update_blake2b(&b, length, 4);
+        meh_update_blake2b(&b, in, in_len);
+        meh_finish_blake2b(&b, out);
+        return;
+    }
+
+    meh_configure_blake2b(&b, NULL, 0, MEH_BLAKE2B_HASH_SIZE);
+    meh_update_blake2b(&b, length, 4);
+    meh_update_blake2b(&b, in, in_len);
+    meh_finish_blake2b(&b, V);
+
+    for (;;)
+    {
+        memcpy(out, V, 32);
+        out += 32;
+        out_len -= 32;
+
+        if (out_len <= MEH_BLAKE2B_HASH_SIZE)
+            break;
+
+        meh_configure_blake2b(&b, NULL, 0, MEH_BLAKE2B_HASH_SIZE);
+        meh_update_blake2b(&b, V, MEH_BLAKE2B_HASH_SIZE);
+        meh_finish_blake2b(&b, V);
+    }
+
+    meh_configure_blake2b(&b, NULL, 0, out_len);
+    meh_update_blake2b(&b, V, MEH_BLAKE2B_HASH_SIZE);
+    meh_finish_blake2b(&b, out);
+}
+
+/* One lane's segment of one slice of one pass. */
+typedef struct meh_argon2_task_s
+{
+    uint64_t* memory;
+    uint32_t pass, passes,
+             slice,
+             lane, lanes,
+             lane_len,
+             segment_len;
+    meh_argon2_fill_fn fill;
+} meh_argon2_task_t;
+
+/* Map a 32-bit pseudo-random value to a block of the reference lane:
+   any block already finished in this pass or left from the last one,
+   biased towards recent blocks. */
+static uint32_t _meh_argon2_index(const meh_argon2_task_t* t, uint32_t i,
+                                  uint32_t rand, int same_lane)
+{
+    uint64_t relative;
+    uint32_t base, area, start;
+
+    if (0 == t->pass)
+    {
+        base = t->slice * t->segment_len;
+        start = 0;
+    }
+    else
+    {
+        base = t->lane_len - t->segment_len;
+        start = (MEH_ARGON2_SLICES - 1 == t->slice) ?
+                0 : (t->slice + 1) * t->segment_len;
+    }
+
+    /* Never the block being made; only this lane's previous one */
+    area = same_lane ? base + i - 1 : base - (0 == i);
+
+    relative = ((uint64_t)rand * rand) >> 32;
+    relative = area - 1 - (((uint64_t)area * relative) >> 32);
+
+    return (uint32_t)((start + relative) % t->lane_len);
+}
+
+/* Argon2id takes references from a counter-driven address stream for
+   the first half of the first pass and from the previous block after. */
+static void _meh_argon2_addresses(const meh_argon2_task_t* t,
+                                  uint64_t* input, uint64_t* address)
+{
+    uint64_t zero[MEH_ARGON2_WORDS];
+
+    memset(zero, 0, sizeof (zero));
+
+    input[6]++;
+    t->fill(zero, input, address, 0);
+    t->fill(zero, address, address, 0);
+}
+
+static meh_error_t _meh_argon2_segment(void* arg)
+{
+    meh_argon2_task_t* t = arg;
+    uint64_t input[MEH_ARGON2_WORDS], address[MEH_ARGON2_WORDS],
+             * lane = t->memory + (size_t)t->lane * t->lane_len *
+                                  MEH_ARGON2_WORDS,
+             * prev, * ref, rand;
+    uint32_t i, index, ref_lane;
+    int independent = (0 == t->pass && t->slice < MEH_ARGON2_SLICES / 2),
+        first = (0 == t->pass && 0 == t->slice);
+
+    if (independent)
+    {
+        memset(input, 0, sizeof (input));
+        input[0] = t->pass;
+        input[1] = t->lane;
+        input[2] = t->slice;
+        input[3] = (uint64_t)t->lane_len * t->lanes;
+        input[4] = t->passes;
+        input[5] = MEH_ARGON2_ID;
+    }
+
+    /* The first two blocks of each lane are seeded from H0 */
+    i = first ? 2 : 0;
+    if (independent && first)
+        _meh_argon2_addresses(t, input, address);
+
+    for (; i < t->segment_len; i++)
+    {
+        index = t->slice * t->segment_len + i;
+        prev = lane + (size_t)((0 == index) ? t->lane_len - 1 : index - 1) *
+                      MEH_ARGON2_WORDS;
+
+        if (independent)
+        {
+            if (0 == i % MEH_ARGON2_WORDS)
+                _meh_argon2_addresses(t, input, address);
+            rand = address[i % MEH_ARGON2_WORDS];
+        }
+        else
+            rand = prev[0];
+
+        ref_lane = first ? t->lane : (uint32_t)((rand >> 32) % t->lanes);
+        ref = t->memory + ((size_t)ref_lane * t->lane_len +
+                           _meh_argon2_index(t, i, (uint32_t)rand,
+                                             ref_lane == t->lane)) *
+                          MEH_ARGON2_WORDS;
+
+        t->fill(prev, ref, lane + (size_t)index * MEH_ARGON2_WORDS,
+                0 != t->pass);
+    }
+
+    return MEH_OK;
+}
+
+size_t meh_argon2_context_size(void)
+{
+    return sizeof (meh_argon2_state_t);
+}
+
+MehArgon2 meh_get_argon2id(const unsigned char* password, size_t pass_len,
+                           const unsigned char* salt, size_t salt_len,
+                           unsigned int passes, unsigned int memory,
+                           unsigned int lanes, unsigned int tag_len,
+                           unsigned int threads)
+{
+    MehArgon2 kdf;
+    void* mem;
+    size_t size = meh_argon2_context_size();
+
+    if (NULL == (mem = malloc(size)))
+        return NULL;
+
+    if (NULL == (kdf = meh_init_argon2id(mem, size, password, pass_len, salt,
+                                         salt_len, passes, memory, lanes,
+                                         tag_len, threads)))
+    {
+        free(mem);
+        return NULL;
+    }
+
+    kdf->allocated = 1;
+
+    return kdf;
+}
+
+/* memory is in KiB; threads caps how many lanes are filled at once. */
+MehArgon2 meh_init_argon2id(void* mem, size_t size,
+                            const unsigned char* password, size_t pass_len,
+                            const unsigned char* salt, size_t salt_len,
+                            unsigned int passes, unsigned int memory,
+                            unsigned int lanes, unsigned int tag_len,
+                            unsigned int threads)
+{
+    MehArgon2 kdf = mem;
+
+    if (NULL == mem || size < meh_argon2_context_size() ||
+        !MEH_IS_ALIGNED(mem))
+    {
+        meh_warn("invalid storage passed to meh_init_argon2id");
+        return NULL;
+    }
+
+    _meh_init_arena(&kdf->arena);
+    kdf->threads = (0 == threads) ? 1 : threads;
+    kdf->allocated = 0;
+
+    if (MEH_OK != meh_reset_argon2id(kdf, password, pass_len, salt, salt_len,
+                                     passes, memory, lanes, tag_len))
+    {
+        _meh_release_arena(&kdf->arena);
+        return NULL;
+    }
+
+    return kdf;
+}
+
+/* Fill memory for a new password and salt and compute the tag, ready
+   to read. The arena is kept from one reset to the next, growing only
+   when the new parameters need more. */
+meh_error_t meh_reset_argon2id(MehArgon2 kdf,
+                               const unsigned char* password, size_t pass_len,
+                               const unsigned char* salt, size_t salt_len,
+                               unsigned int passes, unsigned int memory,
+                               unsigned int lanes, unsigned int tag_len)
+{
+    meh_blake2b_state_t b;
+    meh_argon2_task_t* tasks;
+    meh_argon2_fill_fn fill;
+    meh_error_t error = MEH_OK;
+    unsigned char h0[MEH_BLAKE2B_HASH_SIZE + 8],
+                  block[MEH_ARGON2_BLOCK_SIZE],
+                  field[4];
+    uint64_t* words, * last;
+    uint32_t pass, slice, lane, lane_len, i, j;
+    size_t blocks;
+
+    if (NULL == kdf)
+        return meh_error("invalid argument passed to meh_reset_argon2id",
+                         MEH_INVALID_ARGUMENT);
+
+    /* Nothing is readable until this reset succeeds: the old tag is for
+       another password, and the arena holding it may be released */
+    kdf->tag = NULL;
+    kdf->tag_len = kdf->position = 0;
+
+    if ((NULL == password && 0 != pass_len) ||
+        (NULL == salt && 0 != salt_len) ||
+        (uint64_t)pass_len > 0xFFFFFFFF || (uint64_t)salt_len > 0xFFFFFFFF ||
+        0 == passes || 0 == lanes || lanes > MEH_ARGON2_MAX_LANES ||
+        memory / 8 < lanes || tag_len < 4)
+        return meh_error("invalid argument passed to meh_reset_argon2id",
+                         MEH_INVALID_ARGUMENT);
+
+    /* Memory is rounded down to whole segments in every lane */
+    lane_len = memory / (MEH_ARGON2_SLICES * lanes) * MEH_ARGON2_SLICES;
+    blocks = (size_t)lane_len * lanes;
+
+    if (blocks > ((size_t)-1 - tag_len) / MEH_ARGON2_BLOCK_SIZE)
+        return meh_error("Argon2 parameters too large in meh_reset_argon2id",
+                         MEH_OUT_OF_MEMORY);
+
+    if (NULL == (tasks = malloc(lanes * sizeof (*tasks))))
+        return meh_error("could not allocate tasks in meh_reset_argon2id",
+                         MEH_OUT_OF_MEMORY);
+
+    if (MEH_OK != (error = _meh_reserve_arena(&kdf->arena,
+                                              blocks * MEH_ARGON2_BLOCK_SIZE +
+                                              tag_len)))
+    {
+        free(tasks);
+        return error;
+    }
+
+    words = (uint64_t*)kdf->arena.base;
+    fill = _meh_argon2_filler();
+
+    /* H0 covers every parameter, with no secret and no associated data */
+    meh_configure_blake2b(&b, NULL, 0, MEH_BLAKE2B_HASH_SIZE);
+#define MEH_ARGON2_FIELD(x)                                 \
+    U32TO8_LITTLE(field, (uint32_t)(x), 0);                 \
+    meh_update_blake2b(&b, field, 4)
+    MEH_ARGON2_FIELD(lanes);
+    MEH_ARGON2_FIELD(tag_len);
+    MEH_ARGON2_FIELD(memory);
+    MEH_ARGON2_FIELD(passes);
+    MEH_ARGON2_FIELD(MEH_ARGON2_VERSION);
+    MEH_ARGON2_FIELD(MEH_ARGON2_ID);
+    MEH_ARGON2_FIELD(pass_len);
+    meh_update_blake2b(&b, password, pass_len);
+    MEH_ARGON2_FIELD(salt_len);
+    meh_update_blake2b(&b, salt, salt_len);
+    MEH_ARGON2_FIELD(0);
+    MEH_ARGON2_FIELD(0);
+#undef MEH_ARGON2_FIELD
+    meh_finish_blake2b(&b, h0);
+
+    /* B[lane][0..1] = H'(H0 || block || lane) */
+    for (lane = 0; lane < lanes; lane++)
+    {
+        for (i = 0; i < 2; i++)
+        {
+            U32TO8_LITTLE(h0, i, MEH_BLAKE2B_HASH_SIZE);
+            U32TO8_LITTLE(h0, lane, MEH_BLAKE2B_HASH_SIZE + 4);
+            _meh_argon2_hash(block, MEH_ARGON2_BLOCK_SIZE, h0, sizeof (h0));
+
+            last = words + ((size_t)lane * lane_len + i) * MEH_ARGON2_WORDS;
+            for (j = 0; j < MEH_ARGON2_WORDS; j++)
+                last[j] = U8TO64_LITTLE(block, 8 * j);
+        }
+
+        tasks[lane].memory = words;
+        tasks[lane].passes = passes;
+        tasks[lane].lane = lane;
+        tasks[lane].lanes = lanes;
+        tasks[lane].lane_len = lane_len;
+        tasks[lane].segment_len = lane_len / MEH_ARGON2_SLICES;
+        tasks[lane].fill = fill;
+    }
+
+    /* Lanes only read each other's finished slices, so each slice is a
+       round of independent tasks */
+    for (pass = 0; pass < passes && MEH_OK == error; pass++)
+    {
+        for (slice = 0; slice < MEH_ARGON2_SLICES && MEH_OK == error; slice++)
+        {
+            for (lane = 0; lane < lanes; lane++)
+            {
+                tasks[lane].pass = pass;
+                tasks[lane].slice = slice;
+            }
+
+            error = _meh_run_parallel(_meh_argon2_segment, tasks,
+                                      sizeof (*tasks), lanes, kdf->threads);
+        }
+    }
+
+    free(tasks);
+
+    if (MEH_OK != error)
+        return error;
+
+    /* The tag is H' of the last blocks of every lane XORed together */
+    for (j = 0; j < MEH_ARGON2_WORDS; j++)
+    {
+        last = words + ((size_t)lane_len - 1) * MEH_ARGON2_WORDS + j;
+        for (lane = 1; lane < lanes; lane++)
+            *last ^= last[(size_t)lane * lane_len * MEH_ARGON2_WORDS];
+        U64TO8_LITTLE(block, *last, 8 * j);
+    }
+
+    kdf->tag = kdf->arena.base + blocks * MEH_ARGON2_BLOCK_SIZE;
+    kdf->tag_len = tag_len;
+    kdf->position = 0;
+    _meh_argon2_hash(kdf->tag, tag_len, block, MEH_ARGON2_BLOCK_SIZE);
+
+    return MEH_OK;
+}
+
+meh_error_t meh_update_argon2id(MehArgon2 kdf, unsigned char* output,
+                                size_t want_len, size_t* get_len)
+{
+    size_t n;
+
+    if (NULL == kdf || NULL == get_len || (NULL == output && 0 != want_len))
+        return meh_error("invalid argument passed to meh_update_argon2id",
+                         MEH_INVALID_ARGUMENT);
+
+    n = kdf->tag_len - kdf->position;
+    if (n > want_len)
+        n = want_len;
+
+    if (n > 0)
+        memcpy(output, kdf->tag + kdf->position, n);
+    kdf->position += n;
+    *get_len = n;
+
+    if (n < want_len)
+        return meh_error("source exhausted in meh_update_argon2id",
+                         MEH_SOURCE_EXHAUSTED);
+
+    return MEH_OK;
+}
+
+void meh_destroy_argon2id(MehArgon2 kdf)
+{
+    if (NULL == kdf)
+    {
+        meh_warn("invalid argument passed to meh_destroy_argon2id");
+        return;
+    }
+
+    _meh_release_arena(&kdf->arena);
+
+    if (kdf->allocated)
+        free(kdf);
+}
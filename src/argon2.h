@@ -0,0 +1,63 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_ARGON2_H
+#define MEH_ARGON2_H
+
+#include "include.h"
+#include "error.h"
+#include "arena.h"
+
+#define MEH_ARGON2_BLOCK_SIZE 1024
+#define MEH_ARGON2_VERSION    0x13
+
+typedef struct meh_argon2_state_s
+{
+    meh_arena_t arena; /* the memory blocks, then the tag */
+
+    unsigned char* tag; /* in the arena, read out by update */
+    size_t tag_len,
+           position;
+
+    unsigned int threads;
+
+    int allocated; /* storage came from meh_get_argon2id */
+} meh_argon2_state_t;
+
+typedef meh_argon2_state_t* MehArgon2;
+
+MehArgon2 meh_get_argon2id(const unsigned char*, size_t, const unsigned char*,
+                           size_t, unsigned int, unsigned int, unsigned int,
+                           unsigned int, unsigned int);
+size_t meh_argon2_context_size(void);
+MehArgon2 meh_init_argon2id(void*, size_t, const unsigned char*, size_t,
+                            const unsigned char*, size_t, unsigned int,
+                            unsigned int, unsigned int, unsigned int,
+                            unsigned int);
+meh_error_t meh_reset_argon2id(MehArgon2, const unsigned char*, size_t,
+                               const unsigned char*, size_t, unsigned int,
+                               unsigned int, unsigned int, unsigned int);
+meh_error_t meh_update_argon2id(MehArgon2, unsigned char*, size_t, size_t*);
+#define meh_finish_argon2id(x) MEH_OK
+void meh_destroy_argon2id(MehArgon2);
+
+#endif
@@ -0,0 +1,372 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "blake2b.h"
+#include "bitwise.h"
+#include "cpu.h"
+
+#if MEH_HAVE_X86
+#    include <immintrin.h>
+#endif
+
+static const uint64_t IV[8] = {
+    UINT64_C(0x6A09E667F3BCC908), UINT64_C(0xBB67AE8584CAA73B),
+    UINT64_C(0x3C6EF372FE94F82B), UINT64_C(0xA54FF53A5F1D36F1),
+    UINT64_C(0x510E527FADE682D1), UINT64_C(0x9B05688C2B3E6C1F),
+    UINT64_C(0x1F83D9ABFB41BD6B), UINT64_C(0x5BE0CD19137E2179)
+};
+
+static const uint8_t SIGMA[12][16] = {
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+    { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+    {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+    {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+    {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+    { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+    { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+    {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+    { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 }
+};
+
+typedef void (*meh_blake2b_compress_fn)(uint64_t*, const unsigned char*,
+                                        const uint64_t*, uint64_t);
+
+#define G(a, b, c, d, x, y)               \
+    do {                                  \
+        a = a + b + (x);                  \
+        d = ROTR64(d ^ a, 32);            \
+        c = c + d;                        \
+        b = ROTR64(b ^ c, 24);            \
+        a = a + b + (y);                  \
+        d = ROTR64(d ^ a, 16);            \
+        c = c + d;                        \
+        b = ROTR64(b ^ c, 63);            \
+    } while (0)
+
+/* One block; f is all ones for the final block and zero otherwise. */
+static void _meh_compress_blake2b(uint64_t* h, const unsigned char* block,
+                                  const uint64_t* t, uint64_t f)
+{
+    uint64_t m[16], v0, v1, v2, v3, v4, v5, v6, v7,
+             v8, v9, v10, v11, v12, v13, v14, v15;
+    const uint8_t* s;
+    int i;
+
+    for (i = 0; i < 16; i++)
+        m[i] = U8TO64_LITTLE(block, 8*i);
+
+    v0 = h[0]; v1 = h[1]; v2 = h[2]; v3 = h[3];
+    v4 = h[4]; v5 = h[5]; v6 = h[6]; v7 = h[7];
+    v8 = IV[0]; v9 = IV[1]; v10 = IV[2]; v11 = IV[3];
+    v12 = IV[4] ^ t[0]; v13 = IV[5] ^ t[1];
+    v14 = IV[6] ^ f; v15 = IV[7];
+
+    for (i = 0; i < 12; i++)
+    {
+        s = SIGMA[i];
+
+        G(v0, v4,  v8, v12, m[s[ 0]], m[s[ 1]]);
+        G(v1, v5,  v9, v13, m[s[ 2]], m[s[ 3]]);
+        G(v2, v6, v10, v14, m[s[ 4]], m[s[ 5]]);
+        G(v3, v7, v11, v15, m[s[ 6]], m[s[ 7]]);
+        G(v0, v5, v10, v15, m[s[ 8]], m[s[ 9]]);
+        G(v1, v6, v11, v12, m[s[10]], m[s[11]]);
+        G(v2, v7,  v8, v13, m[s[12]], m[s[13]]);
+        G(v3, v4,  v9, v14, m[s[14]], m[s[15]]);
+    }
+
+    h[0] ^= v0 ^ v8;  h[1] ^= v1 ^ v9;
+    h[2] ^= v2 ^ v10; h[3] ^= v3 ^ v11;
+    h[4] ^= v4 ^ v12; h[5] ^= v5 ^ v13;
+    h[6] ^= v6 ^ v14; h[7] ^= v7 ^ v15;
+}
+
+#undef G
+
+#if MEH_HAVE_X86
+
+#define MEH_BLAKE2B_AVX2 __attribute__((target("avx2")))
+
+/* The state as four rows of four words; each G runs on all four columns
+   at once and the rows are rotated so the diagonals line up. */
+#define G_AVX2(a, b, c, d, x, y)                                         \
+    do {                                                                 \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), x);                 \
+        d = _mm256_shuffle_epi32(_mm256_xor_si256(d, a),                 \
+                                 _MM_SHUFFLE(2, 3, 0, 1));               \
+        c = _mm256_add_epi64(c, d);                                      \
+        b = _mm256_shuffle_epi8(_mm256_xor_si256(b, c), rot24);          \
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), y);                 \
+        d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot16);          \
+        c = _mm256_add_epi64(c, d);                                      \
+        b = _mm256_xor_si256(b, c);                                      \
+        b = _mm256_or_si256(_mm256_srli_epi64(b, 63),                    \
+                            _mm256_add_epi64(b, b));                     \
+    } while (0)
+
+MEH_BLAKE2B_AVX2
+static void _meh_compress_blake2b_avx2(uint64_t* h,
+                                       const unsigned char* block,
+                                       const uint64_t* t, uint64_t f)
+{
+    const __m256i rot24 = _mm256_setr_epi8(
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    const __m256i rot16 = _mm256_setr_epi8(
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    __m256i a, b, c, d, x, y, ha, hb;
+    uint64_t m[16];
+    const uint8_t* s;
+    int i;
+
+    memcpy(m, block, MEH_BLAKE2B_BLOCK_SIZE); /* x86 is little-endian */
+
+    ha = a = _mm256_loadu_si256((const __m256i*)&h[0]);
+    hb = b = _mm256_loadu_si256((const __m256i*)&h[4]);
+    c = _mm256_loadu_si256((const __m256i*)&IV[0]);
+    d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)&IV[4]),
+                         _mm256_set_epi64x(0, (long long)f,
+                                           (long long)t[1],
+                                           (long long)t[0]));
+
+    for (i = 0; i < 12; i++)
+    {
+        s = SIGMA[i];
+
+        x = _mm256_set_epi64x(m[s[6]], m[s[4]], m[s[2]], m[s[0]]);
+        y = _mm256_set_epi64x(m[s[7]], m[s[5]], m[s[3]], m[s[1]]);
+        G_AVX2(a, b, c, d, x, y);
+
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));
+
+        x = _mm256_set_epi64x(m[s[14]], m[s[12]], m[s[10]], m[s[8]]);
+        y = _mm256_set_epi64x(m[s[15]], m[s[13]], m[s[11]], m[s[9]]);
+        G_AVX2(a, b, c, d, x, y);
+
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));
+    }
+
+    _mm256_storeu_si256((__m256i*)&h[0],
+                        _mm256_xor_si256(ha, _mm256_xor_si256(a, c)));
+    _mm256_storeu_si256((__m256i*)&h[4],
+                        _mm256_xor_si256(hb, _mm256_xor_si256(b, d)));
+}
+
+#undef G_AVX2
+
+#endif
+
+static meh_blake2b_compress_fn _meh_blake2b_compressor(void)
+{
+#if MEH_HAVE_X86
+    if (meh_cpu_features() & MEH_CPU_AVX2)
+        return _meh_compress_blake2b_avx2;
+#endif
+    return _meh_compress_blake2b;
+}
+
+/* Compress whole blocks known not to be the last of the message. */
+static void _meh_blocks_blake2b(MehBLAKE2b ctx, const unsigned char* data,
+                                size_t blocks)
+{
+    meh_blake2b_compress_fn compress = _meh_blake2b_compressor();
+
+    for (; blocks > 0; blocks--, data += MEH_BLAKE2B_BLOCK_SIZE)
+    {
+        ctx->total[0] += MEH_BLAKE2B_BLOCK_SIZE;
+        ctx->total[1] += (ctx->total[0] < MEH_BLAKE2B_BLOCK_SIZE);
+
+        compress(ctx->state, data, ctx->total, 0);
+    }
+}
+
+MehBLAKE2b meh_get_blake2b(void)
+{
+    MehBLAKE2b r = malloc(sizeof (meh_blake2b_state_t));
+
+    if (NULL == r)
+    {
+        meh_warn("could not allocate hash context in meh_get_blake2b");
+        return NULL;
+    }
+
+    meh_configure_blake2b(r, NULL, 0, MEH_BLAKE2B_HASH_SIZE);
+
+    return r;
+}
+
+/* Set the key (up to 64 bytes, none when key_size is 0) and digest
+   length (1 to 64 bytes), then start over. */
+meh_error_t meh_configure_blake2b(MehBLAKE2b ctx, const unsigned char* key,
+                                  size_t key_size, size_t hash_size)
+{
+    if (NULL == ctx || (NULL == key && 0 != key_size))
+        return meh_error("invalid argument passed to meh_configure_blake2b",
+                         MEH_INVALID_ARGUMENT);
+
+    if (key_size > MEH_BLAKE2B_KEY_SIZE ||
+        0 == hash_size || hash_size > MEH_BLAKE2B_HASH_SIZE)
+        return meh_error("invalid key or digest size passed to "
+                         "meh_configure_blake2b", MEH_INVALID_ARGUMENT);
+
+    memset(ctx->key, 0, MEH_BLAKE2B_KEY_SIZE);
+    if (key_size)
+        memcpy(ctx->key, key, key_size);
+
+    ctx->key_size = (uint32_t)key_size;
+    ctx->hash_size = (uint32_t)hash_size;
+
+    meh_reset_blake2b(ctx);
+
+    return MEH_OK;
+}
+
+void meh_reset_blake2b(MehBLAKE2b ctx)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+        ctx->state[i] = IV[i];
+
+    /* Parameter block: digest length, key length, fanout 1, depth 1. */
+    ctx->state[0] ^= UINT64_C(0x01010000) ^
+                     ((uint64_t)ctx->key_size << 8) ^ ctx->hash_size;
+
+    ctx->total[0] = ctx->total[1] = 0;
+    ctx->length = 0;
+
+    memset(ctx->buffer, 0, MEH_BLAKE2B_BLOCK_SIZE);
+
+    /* A keyed hash starts with the key padded out to a full block. */
+    if (ctx->key_size)
+    {
+        memcpy(ctx->buffer, ctx->key, ctx->key_size);
+        ctx->length = MEH_BLAKE2B_BLOCK_SIZE;
+    }
+}
+
+/* The final block is compressed differently, so a full buffer is held
+   back until more input shows it was not the last. */
+void meh_update_blake2b(MehBLAKE2b ctx, const unsigned char* input,
+                        size_t len)
+{
+    size_t fill, blocks;
+
+    if (0 == len)
+        return;
+
+    fill = MEH_BLAKE2B_BLOCK_SIZE - ctx->length;
+
+    if (len > fill)
+    {
+        memcpy(ctx->buffer + ctx->length, input, fill);
+        _meh_blocks_blake2b(ctx, ctx->buffer, 1);
+        ctx->length = 0;
+        input += fill;
+        len -= fill;
+
+        blocks = (len - 1) / MEH_BLAKE2B_BLOCK_SIZE;
+        _meh_blocks_blake2b(ctx, input, blocks);
+        input += blocks * MEH_BLAKE2B_BLOCK_SIZE;
+        len -= blocks * MEH_BLAKE2B_BLOCK_SIZE;
+    }
+
+    memcpy(ctx->buffer + ctx->length, input, len);
+    ctx->length += (uint32_t)len;
+}
+
+void meh_finish_blake2b(MehBLAKE2b ctx, unsigned char* output)
+{
+    uint8_t digest[MEH_BLAKE2B_HASH_SIZE];
+    int i;
+
+    ctx->total[0] += ctx->length;
+    ctx->total[1] += (ctx->total[0] < ctx->length);
+
+    memset(ctx->buffer + ctx->length, 0,
+           MEH_BLAKE2B_BLOCK_SIZE - ctx->length);
+    _meh_blake2b_compressor()(ctx->state, ctx->buffer, ctx->total,
+                              ~UINT64_C(0));
+
+    for (i = 0; i < 8; i++)
+        U64TO8_LITTLE(digest, ctx->state[i], 8*i);
+
+    memcpy(output, digest, ctx->hash_size);
+}
+
+/* Only an unkeyed context can be exported: a keyed one holds its key,
+   and until more input arrives so does the buffered first block. */
+meh_error_t meh_export_blake2b(MehBLAKE2b ctx, unsigned char* output)
+{
+    int i;
+
+    if (ctx->key_size)
+        return meh_error("keyed context passed to meh_export_blake2b",
+                         MEH_INVALID_ARGUMENT);
+
+    for (i = 0; i < 8; i++)
+        U64TO8_LITTLE(output, ctx->state[i], 8*i);
+
+    U64TO8_LITTLE(output, ctx->total[0], 64);
+    U64TO8_LITTLE(output, ctx->total[1], 72);
+
+    output[80] = (uint8_t)ctx->length;
+    output[81] = (uint8_t)ctx->hash_size;
+
+    memcpy(output + 82, ctx->buffer, MEH_BLAKE2B_BLOCK_SIZE);
+
+    return MEH_OK;
+}
+
+void meh_import_blake2b(MehBLAKE2b ctx, const unsigned char* input)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+        ctx->state[i] = U8TO64_LITTLE(input, 8*i);
+
+    ctx->total[0] = U8TO64_LITTLE(input, 64);
+    ctx->total[1] = U8TO64_LITTLE(input, 72);
+
+    ctx->length = input[80];
+    ctx->hash_size = input[81];
+
+    /* Exported states are never keyed. */
+    memset(ctx->key, 0, MEH_BLAKE2B_KEY_SIZE);
+    ctx->key_size = 0;
+
+    memcpy(ctx->buffer, input + 82, MEH_BLAKE2B_BLOCK_SIZE);
+
+    /* Keep a damaged state from reaching past the buffers. */
+    if (ctx->length > MEH_BLAKE2B_BLOCK_SIZE)
+        ctx->length = MEH_BLAKE2B_BLOCK_SIZE;
+    if (0 == ctx->hash_size || ctx->hash_size > MEH_BLAKE2B_HASH_SIZE)
+        ctx->hash_size = MEH_BLAKE2B_HASH_SIZE;
+}
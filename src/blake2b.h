@@ -0,0 +1,61 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_BLAKE2B_H
+#define MEH_BLAKE2B_H
+
+#include "include.h"
+#include "error.h"
+
+#define MEH_BLAKE2B_HASH_SIZE   64
+#define MEH_BLAKE2B_BLOCK_SIZE  128
+#define MEH_BLAKE2B_KEY_SIZE    64
+#define MEH_BLAKE2B_EXPORT_SIZE (64 + 16 + 2 + MEH_BLAKE2B_BLOCK_SIZE)
+
+typedef struct meh_blake2b_state_s
+{
+    uint64_t state[8],
+             total[2];
+
+    /* The key and digest length are kept so a reset starts over with
+       the same parameters. */
+    uint32_t length,
+             hash_size,
+             key_size;
+
+    uint8_t buffer[MEH_BLAKE2B_BLOCK_SIZE],
+            key[MEH_BLAKE2B_KEY_SIZE];
+} meh_blake2b_state_t;
+
+typedef meh_blake2b_state_t* MehBLAKE2b;
+
+MehBLAKE2b meh_get_blake2b(void);
+void meh_reset_blake2b(MehBLAKE2b);
+meh_error_t meh_configure_blake2b(MehBLAKE2b, const unsigned char*, size_t,
+                                  size_t);
+void meh_update_blake2b(MehBLAKE2b, const unsigned char*, size_t);
+void meh_finish_blake2b(MehBLAKE2b, unsigned char*);
+#define meh_destroy_blake2b(x) free(x)
+meh_error_t meh_export_blake2b(MehBLAKE2b, unsigned char*);
+void meh_import_blake2b(MehBLAKE2b, const unsigned char*);
+
+#endif
@@ -0,0 +1,661 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "blake3.h"
+#include "bitwise.h"
+#include "cpu.h"
+#include "thread.h"
+
+/* Domain flags */
+#define MEH_BLAKE3_CHUNK_START 1
+#define MEH_BLAKE3_CHUNK_END   2
+#define MEH_BLAKE3_PARENT      4
+#define MEH_BLAKE3_ROOT        8
+#define MEH_BLAKE3_KEYED       16
+
+#define MEH_BLAKE3_LANES 16 /* widest multi-chunk kernel */
+
+/* Smallest subtree handed to a thread of its own. */
+#define MEH_BLAKE3_PARALLEL_MIN ((size_t)128 << 10)
+
+static const uint32_t IV[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+    0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+/* The message permutation applied r times, for round r. */
+static const uint8_t SCHEDULE[7][16] = {
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    {  2,  6,  3, 10,  7,  0,  4, 13,  1, 11, 12,  5,  9, 14, 15,  8 },
+    {  3,  4, 10, 12, 13,  2,  7, 14,  6,  5,  9,  0, 11, 15,  8,  1 },
+    { 10,  7, 12,  9, 14,  3, 13, 15,  4,  0, 11,  2,  5,  8,  1,  6 },
+    { 12, 13,  9, 11, 15, 10, 14,  8,  7,  2,  5,  3,  0,  1,  6,  4 },
+    {  9, 14, 11,  5,  8, 12, 15,  1, 13,  3,  0, 10,  2,  6,  4,  7 },
+    { 11, 15,  5,  0,  1,  9,  8,  6, 14, 10,  2, 12,  3,  4,  7, 13 }
+};
+
+#if MEH_HAVE_X86
+#    define MEH_BLAKE3_N 4
+#    define MEH_BLAKE3_ATTR __attribute__((target("sse2")))
+#    define MEH_BLAKE3_SUFFIX x4
+#    include "blake3_lanes.h"
+#    undef MEH_BLAKE3_N
+#    undef MEH_BLAKE3_ATTR
+#    undef MEH_BLAKE3_SUFFIX
+
+#    define MEH_BLAKE3_N 8
+#    define MEH_BLAKE3_ATTR __attribute__((target("avx2")))
+#    define MEH_BLAKE3_SUFFIX x8
+#    include "blake3_lanes.h"
+#    undef MEH_BLAKE3_N
+#    undef MEH_BLAKE3_ATTR
+#    undef MEH_BLAKE3_SUFFIX
+
+#    define MEH_BLAKE3_N 16
+#    define MEH_BLAKE3_ATTR __attribute__((target("avx512f")))
+#    define MEH_BLAKE3_SUFFIX x16
+#    include "blake3_lanes.h"
+#    undef MEH_BLAKE3_N
+#    undef MEH_BLAKE3_ATTR
+#    undef MEH_BLAKE3_SUFFIX
+#endif
+
+typedef struct meh_blake3_subtree_s
+{
+    const uint32_t* key;
+    const unsigned char* input;
+    uint64_t chunks,
+             counter;
+    uint32_t flags,
+             cv[8];
+} meh_blake3_subtree_t;
+
+#define G(a, b, c, d, x, y)               \
+    do {                                  \
+        a = a + b + (x);                  \
+        d = ROTR32(d ^ a, 16);            \
+        c = c + d;                        \
+        b = ROTR32(b ^ c, 12);            \
+        a = a + b + (y);                  \
+        d = ROTR32(d ^ a, 8);             \
+        c = c + d;                        \
+        b = ROTR32(b ^ c, 7);             \
+    } while (0)
+
+/* All 16 output words: the first 8 are the chaining value, and all 16
+   are a block of output at the root. out may alias cv. */
+static void _meh_blake3_compress(const uint32_t* cv, const uint32_t* m,
+                                 uint64_t counter, uint32_t length,
+                                 uint32_t flags, uint32_t* out)
+{
+    uint32_t v0, v1, v2, v3, v4, v5, v6, v7,
+             v8, v9, v10, v11, v12, v13, v14, v15;
+    const uint8_t* s;
+    int r;
+
+    v0 = cv[0]; v1 = cv[1]; v2 = cv[2]; v3 = cv[3];
+    v4 = cv[4]; v5 = cv[5]; v6 = cv[6]; v7 = cv[7];
+    v8 = IV[0]; v9 = IV[1]; v10 = IV[2]; v11 = IV[3];
+    v12 = (uint32_t)counter; v13 = (uint32_t)(counter >> 32);
+    v14 = length; v15 = flags;
+
+    for (r = 0; r < 7; r++)
+    {
+        s = SCHEDULE[r];
+
+        G(v0, v4,  v8, v12, m[s[ 0]], m[s[ 1]]);
+        G(v1, v5,  v9, v13, m[s[ 2]], m[s[ 3]]);
+        G(v2, v6, v10, v14, m[s[ 4]], m[s[ 5]]);
+        G(v3, v7, v11, v15, m[s[ 6]], m[s[ 7]]);
+        G(v0, v5, v10, v15, m[s[ 8]], m[s[ 9]]);
+        G(v1, v6, v11, v12, m[s[10]], m[s[11]]);
+        G(v2, v7,  v8, v13, m[s[12]], m[s[13]]);
+        G(v3, v4,  v9, v14, m[s[14]], m[s[15]]);
+    }
+
+    out[8] = v8 ^ cv[0];   out[9] = v9 ^ cv[1];
+    out[10] = v10 ^ cv[2]; out[11] = v11 ^ cv[3];
+    out[12] = v12 ^ cv[4]; out[13] = v13 ^ cv[5];
+    out[14] = v14 ^ cv[6]; out[15] = v15 ^ cv[7];
+
+    out[0] = v0 ^ v8;  out[1] = v1 ^ v9;
+    out[2] = v2 ^ v10; out[3] = v3 ^ v11;
+    out[4] = v4 ^ v12; out[5] = v5 ^ v13;
+    out[6] = v6 ^ v14; out[7] = v7 ^ v15;
+}
+
+#undef G
+
+static void _meh_blake3_words(uint32_t* m, const unsigned char* block)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+        m[i] = U8TO32_LITTLE(block, 4*i);
+}
+
+/* The chaining value of one whole chunk. */
+static void _meh_blake3_chunk(const uint32_t* key, uint32_t flags,
+                              const unsigned char* input, uint64_t counter,
+                              uint32_t* cv)
+{
+    uint32_t m[16], out[16], f;
+    int b;
+
+    memcpy(out, key, 32);
+
+    for (b = 0; b < 16; b++, input += MEH_BLAKE3_BLOCK_SIZE)
+    {
+        f = flags;
+        if (0 == b)
+            f |= MEH_BLAKE3_CHUNK_START;
+        if (15 == b)
+            f |= MEH_BLAKE3_CHUNK_END;
+
+        _meh_blake3_words(m, input);
+        _meh_blake3_compress(out, m, counter, MEH_BLAKE3_BLOCK_SIZE, f, out);
+    }
+
+    memcpy(cv, out, 32);
+}
+
+/* Chaining values of n whole chunks, as many at a time as the vector
+   units allow. */
+static void _meh_blake3_chunks(const uint32_t* key, uint32_t flags,
+                               const unsigned char* input, size_t n,
+                               uint64_t counter, uint32_t* cvs)
+{
+#if MEH_HAVE_X86
+    unsigned int features = meh_cpu_features();
+
+    if (features & MEH_CPU_AVX512)
+        for (; n >= 16; n -= 16, counter += 16, cvs += 8 * 16,
+                        input += 16 * MEH_BLAKE3_CHUNK_SIZE)
+            _meh_blake3_chunks_x16(key, flags, input, counter, cvs);
+
+    if (features & MEH_CPU_AVX2)
+        for (; n >= 8; n -= 8, counter += 8, cvs += 8 * 8,
+                       input += 8 * MEH_BLAKE3_CHUNK_SIZE)
+            _meh_blake3_chunks_x8(key, flags, input, counter, cvs);
+
+    if (features & MEH_CPU_SSE2)
+        for (; n >= 4; n -= 4, counter += 4, cvs += 8 * 4,
+                       input += 4 * MEH_BLAKE3_CHUNK_SIZE)
+            _meh_blake3_chunks_x4(key, flags, input, counter, cvs);
+#endif
+
+    for (; n > 0; n--, counter++, cvs += 8, input += MEH_BLAKE3_CHUNK_SIZE)
+        _meh_blake3_chunk(key, flags, input, counter, cvs);
+}
+
+static void _meh_blake3_parent(const uint32_t* key, uint32_t flags,
+                               const uint32_t* left, const uint32_t* right,
+                               meh_blake3_node_t* node)
+{
+    memcpy(node->cv, key, 32);
+    memcpy(node->block, left, 32);
+    memcpy(node->block + 8, right, 32);
+    node->counter = 0;
+    node->length = MEH_BLAKE3_BLOCK_SIZE;
+    node->flags = flags | MEH_BLAKE3_PARENT;
+}
+
+static void _meh_blake3_node_cv(const meh_blake3_node_t* node, uint32_t* cv)
+{
+    uint32_t out[16];
+
+    _meh_blake3_compress(node->cv, node->block, node->counter, node->length,
+                         node->flags, out);
+    memcpy(cv, out, 32);
+}
+
+/* cv may alias left or right. */
+static void _meh_blake3_parent_cv(const uint32_t* key, uint32_t flags,
+                                  const uint32_t* left, const uint32_t* right,
+                                  uint32_t* cv)
+{
+    meh_blake3_node_t node;
+
+    _meh_blake3_parent(key, flags, left, right, &node);
+    _meh_blake3_node_cv(&node, cv);
+}
+
+/* The chaining value of a subtree of chunks (a power of two) whole
+   chunks, which is never the root. */
+static void _meh_blake3_subtree(const uint32_t* key, uint32_t flags,
+                                const unsigned char* input, uint64_t chunks,
+                                uint64_t counter, uint32_t* cv)
+{
+    uint32_t cvs[8 * MEH_BLAKE3_LANES], left[8], right[8];
+    uint64_t half, n, i;
+
+    if (chunks > MEH_BLAKE3_LANES)
+    {
+        half = chunks / 2;
+        _meh_blake3_subtree(key, flags, input, half, counter, left);
+        _meh_blake3_subtree(key, flags,
+                            input + half * MEH_BLAKE3_CHUNK_SIZE,
+                            half, counter + half, right);
+        _meh_blake3_parent_cv(key, flags, left, right, cv);
+        return;
+    }
+
+    _meh_blake3_chunks(key, flags, input, (size_t)chunks, counter, cvs);
+
+    for (n = chunks; n > 1; n /= 2)
+        for (i = 0; i < n / 2; i++)
+            _meh_blake3_parent_cv(key, flags, cvs + 16 * i, cvs + 16 * i + 8,
+                                  cvs + 8 * i);
+
+    memcpy(cv, cvs, 32);
+}
+
+static meh_error_t _meh_blake3_subtree_task(void* arg)
+{
+    meh_blake3_subtree_t* t = arg;
+
+    _meh_blake3_subtree(t->key, t->flags, t->input, t->chunks, t->counter,
+                        t->cv);
+
+    return MEH_OK;
+}
+
+/* As _meh_blake3_subtree, cut into equal subtrees hashed on up to
+   threads threads. Several pieces per thread even out the load. */
+static void _meh_blake3_subtree_parallel(const uint32_t* key, uint32_t flags,
+                                         const unsigned char* input,
+                                         uint64_t chunks, uint64_t counter,
+                                         unsigned int threads, uint32_t* cv)
+{
+    const uint64_t min = MEH_BLAKE3_PARALLEL_MIN / MEH_BLAKE3_CHUNK_SIZE;
+    meh_blake3_subtree_t* pieces;
+    uint64_t n = 1, i;
+
+    while (threads > 1 && n < 4 * (uint64_t)threads && chunks / n >= 2 * min)
+        n *= 2;
+
+    if (n < 2 || NULL == (pieces = malloc((size_t)n * sizeof (*pieces))))
+    {
+        _meh_blake3_subtree(key, flags, input, chunks, counter, cv);
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        pieces[i].key = key;
+        pieces[i].flags = flags;
+        pieces[i].chunks = chunks / n;
+        pieces[i].counter = counter + i * (chunks / n);
+        pieces[i].input = input + i * (chunks / n) * MEH_BLAKE3_CHUNK_SIZE;
+    }
+
+    _meh_run_parallel(_meh_blake3_subtree_task, pieces, sizeof (*pieces),
+                      (size_t)n, threads);
+
+    for (; n > 1; n /= 2)
+        for (i = 0; i < n / 2; i++)
+            _meh_blake3_parent_cv(key, flags, pieces[2 * i].cv,
+                                  pieces[2 * i + 1].cv, pieces[i].cv);
+
+    memcpy(cv, pieces[0].cv, 32);
+    free(pieces);
+}
+
+static unsigned int _meh_popcount64(uint64_t x)
+{
+    unsigned int n;
+
+    for (n = 0; x; n++)
+        x &= x - 1;
+
+    return n;
+}
+
+/* Add a finished subtree of chunks chunks. The stack keeps one subtree
+   per set bit of the chunk count, so equal neighbours merge as a
+   binary carry would. */
+static void _meh_blake3_push(MehBLAKE3 ctx, const uint32_t* cv,
+                             uint64_t chunks)
+{
+    uint32_t* top;
+
+    memcpy(ctx->stack + 8 * ctx->depth++, cv, 32);
+    ctx->chunks += chunks;
+
+    while (ctx->depth > _meh_popcount64(ctx->chunks))
+    {
+        top = ctx->stack + 8 * --ctx->depth;
+        _meh_blake3_parent_cv(ctx->key, ctx->flags, top - 8, top, top - 8);
+    }
+}
+
+/* Feed the chunk in progress, which the caller keeps within one chunk.
+   A full block is held back until more input shows it was not the
+   chunk's last. */
+static void _meh_blake3_chunk_update(MehBLAKE3 ctx, const unsigned char* input,
+                                     size_t len)
+{
+    uint32_t m[16], out[16];
+    size_t take;
+
+    while (len > 0)
+    {
+        if (MEH_BLAKE3_BLOCK_SIZE == ctx->length)
+        {
+            _meh_blake3_words(m, ctx->buffer);
+            _meh_blake3_compress(ctx->cv, m, ctx->chunks,
+                                 MEH_BLAKE3_BLOCK_SIZE,
+                                 ctx->flags | (ctx->blocks ? 0 :
+                                               MEH_BLAKE3_CHUNK_START),
+                                 out);
+            memcpy(ctx->cv, out, 32);
+            ctx->blocks++;
+            ctx->length = 0;
+        }
+
+        take = MEH_BLAKE3_BLOCK_SIZE - ctx->length;
+        if (take > len)
+            take = len;
+
+        memcpy(ctx->buffer + ctx->length, input, take);
+        ctx->length += (uint32_t)take;
+        input += take;
+        len -= take;
+    }
+}
+
+/* The last block of the chunk in progress. */
+static void _meh_blake3_chunk_node(MehBLAKE3 ctx, meh_blake3_node_t* node)
+{
+    uint8_t block[MEH_BLAKE3_BLOCK_SIZE] = {0};
+
+    memcpy(block, ctx->buffer, ctx->length);
+    _meh_blake3_words(node->block, block);
+    memcpy(node->cv, ctx->cv, 32);
+
+    node->counter = ctx->chunks;
+    node->length = ctx->length;
+    node->flags = ctx->flags | MEH_BLAKE3_CHUNK_END |
+                  (ctx->blocks ? 0 : MEH_BLAKE3_CHUNK_START);
+}
+
+static void _meh_blake3_update(MehBLAKE3 ctx, const unsigned char* input,
+                               size_t len, unsigned int threads)
+{
+    meh_blake3_node_t node;
+    uint32_t cv[8];
+    uint64_t n, size;
+    size_t have;
+
+    have = ctx->blocks * MEH_BLAKE3_BLOCK_SIZE + ctx->length;
+
+    if (have > 0)
+    {
+        size = MEH_BLAKE3_CHUNK_SIZE - have;
+        if (size > len)
+            size = len;
+
+        _meh_blake3_chunk_update(ctx, input, (size_t)size);
+        input += size;
+        len -= (size_t)size;
+
+        if (0 == len)
+            return;
+
+        /* The chunk is full and more follows, so it was not the last */
+        _meh_blake3_chunk_node(ctx, &node);
+        _meh_blake3_node_cv(&node, cv);
+        _meh_blake3_push(ctx, cv, 1);
+
+        memcpy(ctx->cv, ctx->key, 32);
+        ctx->blocks = ctx->length = 0;
+    }
+
+    /* Whole chunks with input behind them go through as the largest
+       subtrees the chunk count so far lines up with. */
+    while (len > MEH_BLAKE3_CHUNK_SIZE)
+    {
+        n = (len - 1) / MEH_BLAKE3_CHUNK_SIZE;
+
+        for (size = 1; size * 2 <= n; size *= 2)
+            ;
+        while (ctx->chunks & (size - 1))
+            size /= 2;
+
+        _meh_blake3_subtree_parallel(ctx->key, ctx->flags, input, size,
+                                     ctx->chunks, threads, cv);
+        _meh_blake3_push(ctx, cv, size);
+
+        input += size * MEH_BLAKE3_CHUNK_SIZE;
+        len -= (size_t)(size * MEH_BLAKE3_CHUNK_SIZE);
+    }
+
+    _meh_blake3_chunk_update(ctx, input, len);
+}
+
+/* The root node of everything hashed so far; the state is untouched. */
+static void _meh_blake3_root(MehBLAKE3 ctx, meh_blake3_node_t* node)
+{
+    uint32_t cv[8], i;
+
+    _meh_blake3_chunk_node(ctx, node);
+
+    for (i = ctx->depth; i > 0; i--)
+    {
+        _meh_blake3_node_cv(node, cv);
+        _meh_blake3_parent(ctx->key, ctx->flags, ctx->stack + 8 * (i - 1), cv,
+                           node);
+    }
+}
+
+/* len bytes of the root's output stream, starting offset bytes in. */
+static void _meh_blake3_emit(const meh_blake3_node_t* node, uint64_t offset,
+                             unsigned char* output, size_t len)
+{
+    uint32_t words[16];
+    uint8_t block[MEH_BLAKE3_BLOCK_SIZE];
+    size_t skip, take;
+    int i;
+
+    while (len > 0)
+    {
+        _meh_blake3_compress(node->cv, node->block,
+                             offset / MEH_BLAKE3_BLOCK_SIZE, node->length,
+                             node->flags | MEH_BLAKE3_ROOT, words);
+
+        for (i = 0; i < 16; i++)
+            U32TO8_LITTLE(block, words[i], 4*i);
+
+        skip = (size_t)(offset % MEH_BLAKE3_BLOCK_SIZE);
+        take = MEH_BLAKE3_BLOCK_SIZE - skip;
+        if (take > len)
+            take = len;
+
+        memcpy(output, block + skip, take);
+        output += take;
+        offset += take;
+        len -= take;
+    }
+}
+
+MehBLAKE3 meh_get_blake3(void)
+{
+    MehBLAKE3 r = malloc(sizeof (meh_blake3_state_t));
+
+    if (NULL == r)
+    {
+        meh_warn("could not allocate hash context in meh_get_blake3");
+        return NULL;
+    }
+
+    meh_configure_blake3(r, NULL, 0, MEH_BLAKE3_HASH_SIZE);
+
+    return r;
+}
+
+/* Set a 32-byte key (or none, when key_size is 0) and the length of
+   meh_finish_blake3's output, 1 to 64 bytes, then start over. Longer
+   output comes from meh_squeeze_blake3. */
+meh_error_t meh_configure_blake3(MehBLAKE3 ctx, const unsigned char* key,
+                                 size_t key_size, size_t hash_size)
+{
+    int i;
+
+    if (NULL == ctx || (NULL == key && 0 != key_size))
+        return meh_error("invalid argument passed to meh_configure_blake3",
+                         MEH_INVALID_ARGUMENT);
+
+    if ((0 != key_size && MEH_BLAKE3_KEY_SIZE != key_size) ||
+        0 == hash_size || hash_size > 2 * MEH_BLAKE3_HASH_SIZE)
+        return meh_error("invalid key or digest size passed to "
+                         "meh_configure_blake3", MEH_INVALID_ARGUMENT);
+
+    for (i = 0; i < 8; i++)
+        ctx->key[i] = key_size ? U8TO32_LITTLE(key, 4*i) : IV[i];
+
+    ctx->flags = key_size ? MEH_BLAKE3_KEYED : 0;
+    ctx->hash_size = (uint32_t)hash_size;
+
+    meh_reset_blake3(ctx);
+
+    return MEH_OK;
+}
+
+void meh_reset_blake3(MehBLAKE3 ctx)
+{
+    memcpy(ctx->cv, ctx->key, 32);
+
+    ctx->chunks = ctx->squeezed = 0;
+    ctx->blocks = ctx->length = ctx->depth = ctx->squeezing = 0;
+
+    memset(ctx->buffer, 0, MEH_BLAKE3_BLOCK_SIZE);
+}
+
+void meh_update_blake3(MehBLAKE3 ctx, const unsigned char* input, size_t len)
+{
+    _meh_blake3_update(ctx, input, len, 1);
+}
+
+/* As meh_update_blake3, hashing large inputs as subtrees spread over
+   up to threads threads. The digest is the same either way. */
+meh_error_t meh_update_blake3_parallel(MehBLAKE3 ctx,
+                                       const unsigned char* input,
+                                       size_t len, unsigned int threads)
+{
+    _meh_blake3_update(ctx, input, len, threads);
+
+    return MEH_OK;
+}
+
+void meh_finish_blake3(MehBLAKE3 ctx, unsigned char* output)
+{
+    meh_blake3_node_t root;
+
+    _meh_blake3_root(ctx, &root);
+    _meh_blake3_emit(&root, 0, output, ctx->hash_size);
+}
+
+/* The next len bytes of extendable output. The first call ends the
+   input; further updates need a reset first. */
+void meh_squeeze_blake3(MehBLAKE3 ctx, unsigned char* output, size_t len)
+{
+    if (!ctx->squeezing)
+    {
+        _meh_blake3_root(ctx, &ctx->root);
+        ctx->squeezing = 1;
+        ctx->squeezed = 0;
+    }
+
+    _meh_blake3_emit(&ctx->root, ctx->squeezed, output, len);
+    ctx->squeezed += len;
+}
+
+/* A keyed context starts every chunk from its key, so only unkeyed ones
+   can be exported. */
+meh_error_t meh_export_blake3(MehBLAKE3 ctx, unsigned char* output)
+{
+    uint32_t i;
+
+    if (ctx->flags & MEH_BLAKE3_KEYED)
+        return meh_error("keyed context passed to meh_export_blake3",
+                         MEH_INVALID_ARGUMENT);
+
+    for (i = 0; i < 8; i++)
+    {
+        U32TO8_LITTLE(output, ctx->key[i], 4*i);
+        U32TO8_LITTLE(output, ctx->cv[i], 32 + 4*i);
+    }
+
+    for (i = 0; i < 8 * MEH_BLAKE3_MAX_DEPTH; i++)
+        U32TO8_LITTLE(output, ctx->stack[i], 64 + 4*i);
+
+    output += 64 + 32 * MEH_BLAKE3_MAX_DEPTH;
+
+    U64TO8_LITTLE(output, ctx->chunks, 0);
+    U32TO8_LITTLE(output, ctx->flags, 8);
+    U32TO8_LITTLE(output, ctx->blocks, 12);
+    U32TO8_LITTLE(output, ctx->length, 16);
+    U32TO8_LITTLE(output, ctx->depth, 20);
+    U32TO8_LITTLE(output, ctx->hash_size, 24);
+
+    memcpy(output + 28, ctx->buffer, MEH_BLAKE3_BLOCK_SIZE);
+
+    return MEH_OK;
+}
+
+void meh_import_blake3(MehBLAKE3 ctx, const unsigned char* input)
+{
+    uint32_t i;
+
+    for (i = 0; i < 8; i++)
+    {
+        ctx->key[i] = U8TO32_LITTLE(input, 4*i);
+        ctx->cv[i] = U8TO32_LITTLE(input, 32 + 4*i);
+    }
+
+    for (i = 0; i < 8 * MEH_BLAKE3_MAX_DEPTH; i++)
+        ctx->stack[i] = U8TO32_LITTLE(input, 64 + 4*i);
+
+    input += 64 + 32 * MEH_BLAKE3_MAX_DEPTH;
+
+    ctx->chunks = U8TO64_LITTLE(input, 0);
+    ctx->flags = 0; /* exported states are never keyed */
+    ctx->blocks = U8TO32_LITTLE(input, 12);
+    ctx->length = U8TO32_LITTLE(input, 16);
+    ctx->depth = U8TO32_LITTLE(input, 20);
+    ctx->hash_size = U8TO32_LITTLE(input, 24);
+
+    memcpy(ctx->buffer, input + 28, MEH_BLAKE3_BLOCK_SIZE);
+
+    ctx->squeezing = 0;
+    ctx->squeezed = 0;
+
+    /* Keep a damaged state from reaching past the buffers. */
+    if (ctx->blocks > 15)
+        ctx->blocks = 15;
+    if (ctx->length > MEH_BLAKE3_BLOCK_SIZE)
+        ctx->length = MEH_BLAKE3_BLOCK_SIZE;
+    if (ctx->depth > MEH_BLAKE3_MAX_DEPTH - 1)
+        ctx->depth = MEH_BLAKE3_MAX_DEPTH - 1;
+    if (0 == ctx->hash_size || ctx->hash_size > 2 * MEH_BLAKE3_HASH_SIZE)
+        ctx->hash_size = MEH_BLAKE3_HASH_SIZE;
+}
@@ -0,0 +1,85 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_BLAKE3_H
+#define MEH_BLAKE3_H
+
+#include "include.h"
+#include "error.h"
+
+#define MEH_BLAKE3_HASH_SIZE   32
+#define MEH_BLAKE3_BLOCK_SIZE  64
+#define MEH_BLAKE3_CHUNK_SIZE  1024
+#define MEH_BLAKE3_KEY_SIZE    32
+#define MEH_BLAKE3_MAX_DEPTH   54 /* enough for 2^64 bytes */
+#define MEH_BLAKE3_EXPORT_SIZE (32 + 32 + 32 * MEH_BLAKE3_MAX_DEPTH + 8 + \
+                                4 * 5 + MEH_BLAKE3_BLOCK_SIZE)
+
+/* A node whose compression yields either a chaining value or, as the
+   root, any amount of output. */
+typedef struct meh_blake3_node_s
+{
+    uint32_t cv[8],
+             block[16],
+             length,
+             flags;
+
+    uint64_t counter;
+} meh_blake3_node_t;
+
+typedef struct meh_blake3_state_s
+{
+    uint32_t key[8],   /* the key, or the IV when unkeyed */
+             cv[8],    /* chaining value of the chunk being hashed */
+             stack[8 * MEH_BLAKE3_MAX_DEPTH]; /* finished subtrees */
+
+    uint64_t chunks,   /* whole chunks before the current one */
+             squeezed; /* output already produced */
+
+    uint32_t flags,
+             blocks,   /* blocks compressed in the current chunk */
+             length,   /* bytes in buffer */
+             depth,    /* chaining values on the stack */
+             hash_size,
+             squeezing;
+
+    uint8_t buffer[MEH_BLAKE3_BLOCK_SIZE];
+
+    meh_blake3_node_t root;
+} meh_blake3_state_t;
+
+typedef meh_blake3_state_t* MehBLAKE3;
+
+MehBLAKE3 meh_get_blake3(void);
+void meh_reset_blake3(MehBLAKE3);
+meh_error_t meh_configure_blake3(MehBLAKE3, const unsigned char*, size_t,
+                                 size_t);
+void meh_update_blake3(MehBLAKE3, const unsigned char*, size_t);
+meh_error_t meh_update_blake3_parallel(MehBLAKE3, const unsigned char*,
+                                       size_t, unsigned int);
+void meh_finish_blake3(MehBLAKE3, unsigned char*);
+void meh_squeeze_blake3(MehBLAKE3, unsigned char*, size_t);
+#define meh_destroy_blake3(x) free(x)
+meh_error_t meh_export_blake3(MehBLAKE3, unsigned char*);
+void meh_import_blake3(MehBLAKE3, const unsigned char*);
+
+#endif
@@ -0,0 +1,145 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/* Multi-chunk BLAKE3 compression. Not a normal header: blake3.c
+   includes it once per vector width, defining
+
+     MEH_BLAKE3_N       chunks per call (4, 8 or 16)
+     MEH_BLAKE3_ATTR    function attributes, e.g. a GCC target
+     MEH_BLAKE3_SUFFIX  appended to every name defined here
+
+   Each lane runs one whole chunk; lane k hashes the chunk at
+   input + k * MEH_BLAKE3_CHUNK_SIZE with counter + k. */
+
+#define MEH_BLAKE3_CAT2(a, b) a##_##b
+#define MEH_BLAKE3_CAT(a, b) MEH_BLAKE3_CAT2(a, b)
+#define MEH_BLAKE3_FN(x) MEH_BLAKE3_CAT(x, MEH_BLAKE3_SUFFIX)
+#define V MEH_BLAKE3_FN(meh_blake3_v)
+
+typedef uint32_t V __attribute__((vector_size(4 * MEH_BLAKE3_N)));
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define G(a, b, c, d, x, y)                 \
+    do {                                    \
+        a = a + b + (x);                    \
+        d = ROTR(d ^ a, 16);                \
+        c = c + d;                          \
+        b = ROTR(b ^ c, 12);                \
+        a = a + b + (y);                    \
+        d = ROTR(d ^ a, 8);                 \
+        c = c + d;                          \
+        b = ROTR(b ^ c, 7);                 \
+    } while (0)
+
+MEH_BLAKE3_ATTR
+static void MEH_BLAKE3_FN(_meh_blake3_chunks)(const uint32_t* key,
+                                              uint32_t flags,
+                                              const unsigned char* input,
+                                              uint64_t counter,
+                                              uint32_t* out)
+{
+    V h0, h1, h2, h3, h4, h5, h6, h7, lo, hi, m[16],
+      x0, x1, x2, x3, x4, x5, x6, x7,
+      x8, x9, x10, x11, x12, x13, x14, x15;
+    const V zero = {0};
+    uint32_t tmp[16 * MEH_BLAKE3_N], f;
+    const uint8_t* s;
+    unsigned int b, i, k, r;
+
+    h0 = zero + key[0]; h1 = zero + key[1];
+    h2 = zero + key[2]; h3 = zero + key[3];
+    h4 = zero + key[4]; h5 = zero + key[5];
+    h6 = zero + key[6]; h7 = zero + key[7];
+
+    for (k = 0; k < MEH_BLAKE3_N; k++)
+    {
+        tmp[k] = (uint32_t)(counter + k);
+        tmp[MEH_BLAKE3_N + k] = (uint32_t)((counter + k) >> 32);
+    }
+    memcpy(&lo, tmp, sizeof (V));
+    memcpy(&hi, tmp + MEH_BLAKE3_N, sizeof (V));
+
+    for (b = 0; b < 16; b++)
+    {
+        /* Word i of every lane's block b lands in m[i] */
+        for (k = 0; k < MEH_BLAKE3_N; k++)
+            for (i = 0; i < 16; i++)
+                tmp[i * MEH_BLAKE3_N + k] =
+                    U8TO32_LITTLE(input, k * MEH_BLAKE3_CHUNK_SIZE +
+                                         b * MEH_BLAKE3_BLOCK_SIZE + 4 * i);
+        for (i = 0; i < 16; i++)
+            memcpy(&m[i], tmp + i * MEH_BLAKE3_N, sizeof (V));
+
+        f = flags;
+        if (0 == b)
+            f |= MEH_BLAKE3_CHUNK_START;
+        if (15 == b)
+            f |= MEH_BLAKE3_CHUNK_END;
+
+        x0 = h0; x1 = h1; x2 = h2; x3 = h3;
+        x4 = h4; x5 = h5; x6 = h6; x7 = h7;
+        x8 = zero + IV[0]; x9 = zero + IV[1];
+        x10 = zero + IV[2]; x11 = zero + IV[3];
+        x12 = lo; x13 = hi;
+        x14 = zero + MEH_BLAKE3_BLOCK_SIZE; x15 = zero + f;
+
+        for (r = 0; r < 7; r++)
+        {
+            s = SCHEDULE[r];
+
+            G(x0, x4,  x8, x12, m[s[ 0]], m[s[ 1]]);
+            G(x1, x5,  x9, x13, m[s[ 2]], m[s[ 3]]);
+            G(x2, x6, x10, x14, m[s[ 4]], m[s[ 5]]);
+            G(x3, x7, x11, x15, m[s[ 6]], m[s[ 7]]);
+            G(x0, x5, x10, x15, m[s[ 8]], m[s[ 9]]);
+            G(x1, x6, x11, x12, m[s[10]], m[s[11]]);
+            G(x2, x7,  x8, x13, m[s[12]], m[s[13]]);
+            G(x3, x4,  x9, x14, m[s[14]], m[s[15]]);
+        }
+
+        h0 = x0 ^ x8;  h1 = x1 ^ x9;
+        h2 = x2 ^ x10; h3 = x3 ^ x11;
+        h4 = x4 ^ x12; h5 = x5 ^ x13;
+        h6 = x6 ^ x14; h7 = x7 ^ x15;
+    }
+
+    memcpy(tmp + 0 * MEH_BLAKE3_N, &h0, sizeof (V));
+    memcpy(tmp + 1 * MEH_BLAKE3_N, &h1, sizeof (V));
+    memcpy(tmp + 2 * MEH_BLAKE3_N, &h2, sizeof (V));
+    memcpy(tmp + 3 * MEH_BLAKE3_N, &h3, sizeof (V));
+    memcpy(tmp + 4 * MEH_BLAKE3_N, &h4, sizeof (V));
+    memcpy(tmp + 5 * MEH_BLAKE3_N, &h5, sizeof (V));
+    memcpy(tmp + 6 * MEH_BLAKE3_N, &h6, sizeof (V));
+    memcpy(tmp + 7 * MEH_BLAKE3_N, &h7, sizeof (V));
+
+    for (k = 0; k < MEH_BLAKE3_N; k++)
+        for (i = 0; i < 8; i++)
+            out[8 * k + i] = tmp[i * MEH_BLAKE3_N + k];
+}
+
+#undef G
+#undef ROTR
+#undef V
+#undef MEH_BLAKE3_FN
+#undef MEH_BLAKE3_CAT
+#undef MEH_BLAKE3_CAT2
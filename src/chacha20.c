@@ -0,0 +1,298 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "chacha20.h"
+#include "cpu.h"
+
+#if MEH_HAVE_X86
+#    define MEH_CHACHA20_N 4
+#    define MEH_CHACHA20_ATTR __attribute__((target("sse2")))
+#    define MEH_CHACHA20_SUFFIX x4
+#    define MEH_CHACHA20_BYTES 0
+#    include "chacha20_lanes.h"
+#    undef MEH_CHACHA20_N
+#    undef MEH_CHACHA20_ATTR
+#    undef MEH_CHACHA20_SUFFIX
+#    undef MEH_CHACHA20_BYTES
+
+#    define MEH_CHACHA20_N 8
+#    define MEH_CHACHA20_ATTR __attribute__((target("avx2")))
+#    define MEH_CHACHA20_SUFFIX x8
+#    define MEH_CHACHA20_BYTES 1
+#    include "chacha20_lanes.h"
+#    undef MEH_CHACHA20_N
+#    undef MEH_CHACHA20_ATTR
+#    undef MEH_CHACHA20_SUFFIX
+#    undef MEH_CHACHA20_BYTES
+
+#    define MEH_CHACHA20_N 16
+#    define MEH_CHACHA20_ATTR __attribute__((target("avx512f")))
+#    define MEH_CHACHA20_SUFFIX x16
+#    define MEH_CHACHA20_BYTES 0
+#    include "chacha20_lanes.h"
+#    undef MEH_CHACHA20_N
+#    undef MEH_CHACHA20_ATTR
+#    undef MEH_CHACHA20_SUFFIX
+#    undef MEH_CHACHA20_BYTES
+#endif
+
+MehChaCha20 meh_get_chacha20(const unsigned char* key,
+                             const unsigned char* nonce,
+                             size_t key_size)
+{
+    MehChaCha20 r = malloc(sizeof (meh_chacha20_state_t));
+
+    if (NULL == r)
+    {
+        meh_warn("could not allocate cipher context in meh_get_chacha20");
+        return NULL;
+    }
+
+    if (MEH_OK != meh_reset_chacha20(r, key, nonce, key_size))
+    {
+        free(r);
+        return NULL;
+    }
+
+    return r;
+}
+
+/* RFC 8439 layout: constants, 256-bit key, 32-bit block counter and
+   96-bit nonce. The counter starts at 0; seek to 64 to start at 1. */
+meh_error_t meh_reset_chacha20(MehChaCha20 cc20,
+                               const unsigned char* key,
+                               const unsigned char* nonce,
+                               size_t key_size)
+{
+    uint32_t* state;
+    int i;
+
+    if (NULL == key || NULL == nonce || NULL == cc20)
+        return meh_error("null reference passed to meh_reset_chacha20",
+                         MEH_INVALID_ARGUMENT);
+
+    if (MEH_CHACHA20_KEY_SIZE != key_size)
+        return meh_error("invalid key size passed to meh_reset_chacha20",
+                         MEH_INVALID_KEY_SIZE);
+
+    state = cc20->state;
+
+    state[0] = U8TO32_LITTLE("expand 32-byte k", 0);
+    state[1] = U8TO32_LITTLE("expand 32-byte k", 4);
+    state[2] = U8TO32_LITTLE("expand 32-byte k", 8);
+    state[3] = U8TO32_LITTLE("expand 32-byte k", 12);
+
+    for (i = 0; i < 8; i++)
+        state[4 + i] = U8TO32_LITTLE(key, 4 * i);
+
+    state[12] = 0;
+    state[13] = U8TO32_LITTLE(nonce, 0);
+    state[14] = U8TO32_LITTLE(nonce, 4);
+    state[15] = U8TO32_LITTLE(nonce, 8);
+
+    cc20->wrapped = 0;
+
+    /* Force the core to be called */
+    cc20->index = 64;
+
+    return MEH_OK;
+}
+
+#define QUARTER(a, b, c, d)                                             \
+    do {                                                                \
+        x[a] += x[b]; x[d] = ROTL32(x[d] ^ x[a], 16);                   \
+        x[c] += x[d]; x[b] = ROTL32(x[b] ^ x[c], 12);                   \
+        x[a] += x[b]; x[d] = ROTL32(x[d] ^ x[a],  8);                   \
+        x[c] += x[d]; x[b] = ROTL32(x[b] ^ x[c],  7);                   \
+    } while (0)
+
+static void meh_chacha20_core(uint8_t* output, const uint32_t* input)
+{
+    uint32_t x[16];
+    int i;
+
+    for (i = 0; i < 16; ++i)
+        x[i] = input[i];
+
+    for (i = 20; i > 0; i -= 2)
+    {
+        QUARTER(0, 4,  8, 12);
+        QUARTER(1, 5,  9, 13);
+        QUARTER(2, 6, 10, 14);
+        QUARTER(3, 7, 11, 15);
+        QUARTER(0, 5, 10, 15);
+        QUARTER(1, 6, 11, 12);
+        QUARTER(2, 7,  8, 13);
+        QUARTER(3, 4,  9, 14);
+    }
+
+    for (i = 0; i < 16; ++i)
+        U32TO8_LITTLE(output, x[i] + input[i], 4*i);
+}
+
+#undef QUARTER
+
+static void _meh_chacha20_advance(MehChaCha20 cc20, uint32_t blocks)
+{
+    cc20->state[12] += blocks;
+    if (cc20->state[12] < blocks)
+        cc20->wrapped = 1;
+}
+
+/* XOR keystream into in, eight bytes at a time. */
+static void _meh_chacha20_xor(unsigned char* out, const unsigned char* in,
+                              const uint8_t* keystream, size_t len)
+{
+    uint64_t a, b;
+    size_t i;
+
+    for (i = 0; i + 8 <= len; i += 8)
+    {
+        memcpy(&a, in + i, 8);
+        memcpy(&b, keystream + i, 8);
+        a ^= b;
+        memcpy(out + i, &a, 8);
+    }
+
+    for (; i < len; i++)
+        out[i] = in[i] ^ keystream[i];
+}
+
+meh_error_t meh_update_chacha20(MehChaCha20 cc20, const unsigned char* in,
+                                unsigned char* out, size_t len, size_t* got)
+{
+    uint32_t index;
+    uint32_t* state;
+    uint8_t* keystream;
+    size_t n;
+#if MEH_HAVE_X86
+    unsigned int features;
+#endif
+
+    if (NULL == in || NULL == got ||  NULL == out || NULL == cc20)
+        return meh_error("null reference passed to meh_update_chacha20",
+                         MEH_INVALID_ARGUMENT);
+
+    if (len > MEH_CHACHA20_MAX_OFFSET - meh_tell_chacha20(cc20))
+        return meh_error("keystream exhausted in meh_update_chacha20",
+                         MEH_SOURCE_EXHAUSTED);
+
+    state = cc20->state;
+    keystream = cc20->keystream;
+    index = cc20->index;
+    *got = len;
+
+    /* Use up what is left of the last block */
+    n = (len < 64 - index) ? len : 64 - index;
+    _meh_chacha20_xor(out, in, keystream + index, n);
+    in += n;
+    out += n;
+    len -= n;
+    index += n;
+
+    /* Whole blocks, as many at a time as the CPU allows. The length
+       check above keeps the counter from wrapping inside a batch. */
+#if MEH_HAVE_X86
+    features = meh_cpu_features();
+
+    if (features & MEH_CPU_AVX512)
+        for (; len >= 16 * 64; in += 16 * 64, out += 16 * 64, len -= 16 * 64)
+        {
+            _meh_chacha20_blocks_x16(state, in, out);
+            _meh_chacha20_advance(cc20, 16);
+        }
+
+    if (features & MEH_CPU_AVX2)
+        for (; len >= 8 * 64; in += 8 * 64, out += 8 * 64, len -= 8 * 64)
+        {
+            _meh_chacha20_blocks_x8(state, in, out);
+            _meh_chacha20_advance(cc20, 8);
+        }
+
+    if (features & MEH_CPU_SSE2)
+        for (; len >= 4 * 64; in += 4 * 64, out += 4 * 64, len -= 4 * 64)
+        {
+            _meh_chacha20_blocks_x4(state, in, out);
+            _meh_chacha20_advance(cc20, 4);
+        }
+#endif
+
+    for (; len > 0; in += n, out += n, len -= n)
+    {
+        meh_chacha20_core(keystream, state);
+        _meh_chacha20_advance(cc20, 1);
+
+        n = (len < 64) ? len : 64;
+        _meh_chacha20_xor(out, in, keystream, n);
+        index = n;
+    }
+
+    cc20->index = index;
+
+    return MEH_OK;
+}
+
+/* Position the keystream at byte offset, as though that many bytes had
+   been run through meh_update_chacha20 since the last reset. */
+meh_error_t meh_seek_chacha20(MehChaCha20 cc20, uint64_t offset)
+{
+    uint64_t block = offset / 64;
+
+    if (NULL == cc20)
+        return meh_error("null reference passed to meh_seek_chacha20",
+                         MEH_INVALID_ARGUMENT);
+
+    if (offset > MEH_CHACHA20_MAX_OFFSET)
+        return meh_error("offset past the end of the ChaCha20 keystream",
+                         MEH_INVALID_ARGUMENT);
+
+    cc20->state[12] = (uint32_t)block;
+    cc20->wrapped = (block >> 32) ? 1 : 0;
+    cc20->index = 64;
+
+    /* Mid-block: keep that block's keystream for the next update */
+    if (0 != offset % 64)
+    {
+        meh_chacha20_core(cc20->keystream, cc20->state);
+        _meh_chacha20_advance(cc20, 1);
+        cc20->index = (uint32_t)(offset % 64);
+    }
+
+    return MEH_OK;
+}
+
+/* The byte offset the next update will start from. */
+uint64_t meh_tell_chacha20(MehChaCha20 cc20)
+{
+    uint64_t block = cc20->wrapped ? (uint64_t)1 << 32 : cc20->state[12];
+
+    return (64 == cc20->index) ? block * 64 : (block - 1) * 64 + cc20->index;
+}
+
+meh_error_t meh_finish_chacha20(MehChaCha20 cc20, unsigned char* out,
+                                size_t* got)
+{
+    /* This is a dummy function for consistency. */
+    *got = 0;
+
+    return MEH_OK;
+}
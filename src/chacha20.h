@@ -0,0 +1,65 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_CHACHA20_H
+#define MEH_CHACHA20_H
+
+#include "include.h"
+#include "bitwise.h"
+#include "error.h"
+
+#define MEH_CHACHA20_KEY_SIZE 32
+#define MEH_CHACHA20_NONCE_SIZE 12
+
+/* A 32-bit block counter caps one nonce at 2^38 bytes of keystream. */
+#define MEH_CHACHA20_MAX_OFFSET ((uint64_t)1 << 38)
+
+typedef struct meh_chacha20_args_s
+{
+    unsigned char* key,
+                 * nonce;
+    size_t key_size;
+} meh_chacha20_args_t;
+
+typedef struct meh_chacha20_state_s
+{
+    uint32_t state[16],
+             index,
+             wrapped; /* the counter has run past its last block */
+
+    uint8_t keystream[64];
+} meh_chacha20_state_t;
+
+typedef meh_chacha20_state_t* MehChaCha20;
+
+MehChaCha20 meh_get_chacha20(const unsigned char*,
+                             const unsigned char*, size_t);
+meh_error_t meh_reset_chacha20(MehChaCha20, const unsigned char*,
+                               const unsigned char*, size_t);
+meh_error_t meh_update_chacha20(MehChaCha20, const unsigned char*,
+                                unsigned char*, size_t, size_t*);
+meh_error_t meh_seek_chacha20(MehChaCha20, uint64_t);
+uint64_t meh_tell_chacha20(MehChaCha20);
+meh_error_t meh_finish_chacha20(MehChaCha20, unsigned char*, size_t*);
+#define meh_destroy_chacha20(x) free(x)
+
+#endif
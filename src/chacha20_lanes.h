@@ -0,0 +1,134 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/* ChaCha20 keystream for several consecutive blocks at once. Not a
+   normal header: chacha20.c includes it once per vector width, defining
+
+     MEH_CHACHA20_N       blocks per call (4, 8 or 16)
+     MEH_CHACHA20_ATTR    function attributes, e.g. a GCC target
+     MEH_CHACHA20_SUFFIX  appended to every name defined here
+     MEH_CHACHA20_BYTES   1 to rotate by 8 and 16 with byte shuffles
+
+   Lane k of every vector works on the block at counter + k. */
+
+#define MEH_CHACHA20_CAT2(a, b) a##_##b
+#define MEH_CHACHA20_CAT(a, b) MEH_CHACHA20_CAT2(a, b)
+#define MEH_CHACHA20_FN(x) MEH_CHACHA20_CAT(x, MEH_CHACHA20_SUFFIX)
+#define V MEH_CHACHA20_FN(meh_chacha20_v)
+
+typedef uint32_t V __attribute__((vector_size(4 * MEH_CHACHA20_N)));
+
+#define B MEH_CHACHA20_FN(meh_chacha20_b)
+
+typedef unsigned char B __attribute__((vector_size(4 * MEH_CHACHA20_N)));
+
+#define VROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/* Rotations by whole bytes are a byte shuffle, cheaper than two shifts
+   and an OR where there is a byte shuffle but no vector rotate. */
+#if MEH_CHACHA20_BYTES
+#    define VROTL_BYTES(x, n, mask) ((V)__builtin_shuffle((B)(x), mask))
+#else
+#    define VROTL_BYTES(x, n, mask) VROTL(x, n)
+#endif
+
+#define QUARTER(a, b, c, d)                                             \
+    do {                                                                \
+        a += b; d ^= a; d = VROTL_BYTES(d, 16, rot16);                  \
+        c += d; b ^= c; b = VROTL(b, 12);                               \
+        a += b; d ^= a; d = VROTL_BYTES(d,  8, rot8);                   \
+        c += d; b ^= c; b = VROTL(b,  7);                               \
+    } while (0)
+
+/* XOR N blocks of keystream, starting at input's block counter, into
+   64 * N bytes of in. Leaves the counter in input alone; the caller
+   makes sure it does not wrap within the N blocks. */
+MEH_CHACHA20_ATTR
+static void MEH_CHACHA20_FN(_meh_chacha20_blocks)(const uint32_t* input,
+                                                  const unsigned char* in,
+                                                  unsigned char* out)
+{
+    V s[16], x0, x1, x2, x3, x4, x5, x6, x7,
+             x8, x9, x10, x11, x12, x13, x14, x15;
+    uint32_t tmp[16 * MEH_CHACHA20_N], w;
+    unsigned int i, k;
+#if MEH_CHACHA20_BYTES
+    unsigned char bytes[4 * MEH_CHACHA20_N];
+    B rot8, rot16;
+
+    /* Byte j of each word takes byte j - 1 (or j - 2) of the same word */
+    for (i = 0; i < sizeof (bytes); i++)
+        bytes[i] = (unsigned char)((i & ~3u) | ((i + 3) & 3));
+    memcpy(&rot8, bytes, sizeof (B));
+    for (i = 0; i < sizeof (bytes); i++)
+        bytes[i] = (unsigned char)((i & ~3u) | ((i + 2) & 3));
+    memcpy(&rot16, bytes, sizeof (B));
+#endif
+
+    for (i = 0; i < 16; i++)
+        s[i] = (V){0} + input[i];
+
+    for (k = 0; k < MEH_CHACHA20_N; k++)
+        tmp[k] = input[12] + k;
+    memcpy(&s[12], tmp, sizeof (V));
+
+    x0 = s[0]; x1 = s[1]; x2 = s[2]; x3 = s[3];
+    x4 = s[4]; x5 = s[5]; x6 = s[6]; x7 = s[7];
+    x8 = s[8]; x9 = s[9]; x10 = s[10]; x11 = s[11];
+    x12 = s[12]; x13 = s[13]; x14 = s[14]; x15 = s[15];
+
+    for (i = 20; i > 0; i -= 2)
+    {
+        QUARTER(x0, x4,  x8, x12);
+        QUARTER(x1, x5,  x9, x13);
+        QUARTER(x2, x6, x10, x14);
+        QUARTER(x3, x7, x11, x15);
+        QUARTER(x0, x5, x10, x15);
+        QUARTER(x1, x6, x11, x12);
+        QUARTER(x2, x7,  x8, x13);
+        QUARTER(x3, x4,  x9, x14);
+    }
+
+    s[0] += x0; s[1] += x1; s[2] += x2; s[3] += x3;
+    s[4] += x4; s[5] += x5; s[6] += x6; s[7] += x7;
+    s[8] += x8; s[9] += x9; s[10] += x10; s[11] += x11;
+    s[12] += x12; s[13] += x13; s[14] += x14; s[15] += x15;
+    memcpy(tmp, s, sizeof (s));
+
+    /* Lane k is block k; x86 is little-endian, so words go out as-is */
+    for (k = 0; k < MEH_CHACHA20_N; k++)
+        for (i = 0; i < 16; i++)
+        {
+            memcpy(&w, in + 64 * k + 4 * i, 4);
+            w ^= tmp[i * MEH_CHACHA20_N + k];
+            memcpy(out + 64 * k + 4 * i, &w, 4);
+        }
+}
+
+#undef QUARTER
+#undef VROTL
+#undef VROTL_BYTES
+#undef B
+#undef V
+#undef MEH_CHACHA20_FN
+#undef MEH_CHACHA20_CAT
+#undef MEH_CHACHA20_CAT2
@@ -0,0 +1,226 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "chacha20poly1305.h"
+#include "hmac.h" /* _meh_wipe */
+
+/* Encryption and authentication take turns over chunks this big, so
+   each chunk is still in L1 when the second pass reads it. */
+#define MEH_CHACHA20POLY1305_CHUNK 4096
+
+meh_error_t meh_reset_chacha20poly1305(MehChaCha20Poly1305 ccp,
+                                       const unsigned char* key,
+                                       size_t key_size)
+{
+    if (NULL == ccp || NULL == key)
+        return meh_error("null reference passed to meh_reset_chacha20poly1305",
+                         MEH_INVALID_ARGUMENT);
+
+    if (MEH_CHACHA20POLY1305_KEY_SIZE != key_size)
+        return meh_error("invalid key size passed to meh_reset_chacha20poly1305",
+                         MEH_INVALID_KEY_SIZE);
+
+    memcpy(ccp->key, key, key_size);
+
+    return MEH_OK;
+}
+
+/* RFC 8439 section 2.8: the one-time Poly1305 key is the first half of
+   keystream block 0, and the message is encrypted from block 1. The
+   MAC then covers the associated data, before this goes on to the
+   ciphertext. */
+static meh_error_t _meh_start_chacha20poly1305(MehChaCha20Poly1305 ccp,
+                                               const unsigned char* nonce,
+                                               size_t nonce_size,
+                                               const unsigned char* ad,
+                                               size_t ad_len,
+                                               meh_chacha20_state_t* cipher,
+                                               meh_poly1305_state_t* mac)
+{
+    static const unsigned char zeros[16] = {0};
+    unsigned char key[MEH_POLY1305_KEY_SIZE];
+    meh_error_t error;
+    size_t got;
+
+    if (NULL == ccp || NULL == nonce || (NULL == ad && ad_len > 0))
+        return meh_error("null reference passed to meh_seal/open_chacha20poly1305",
+                         MEH_INVALID_ARGUMENT);
+
+    if (MEH_CHACHA20POLY1305_NONCE_SIZE != nonce_size)
+        return meh_error("invalid nonce size passed to meh_seal/open_chacha20poly1305",
+                         MEH_INVALID_IV_SIZE);
+
+    error = meh_reset_chacha20(cipher, ccp->key, nonce, sizeof (ccp->key));
+    if (MEH_OK != error)
+        return error;
+
+    memset(key, 0, sizeof (key));
+    meh_update_chacha20(cipher, key, key, sizeof (key), &got);
+    meh_seek_chacha20(cipher, 64);
+
+    meh_reset_poly1305(mac, key);
+    memset(key, 0, sizeof (key));
+
+    meh_update_poly1305(mac, ad, ad_len);
+    meh_update_poly1305(mac, zeros, (16 - ad_len % 16) % 16);
+
+    return MEH_OK;
+}
+
+/* Forgets the message's keystream and one-time MAC key. */
+static void _meh_clear_chacha20poly1305(meh_chacha20_state_t* cipher,
+                                        meh_poly1305_state_t* mac)
+{
+    _meh_wipe(cipher, sizeof (*cipher));
+    _meh_wipe(mac, sizeof (*mac));
+}
+
+/* Pads the ciphertext and appends both lengths, then writes the tag. */
+static void _meh_end_chacha20poly1305(meh_poly1305_state_t* mac,
+                                      size_t ad_len, size_t len,
+                                      unsigned char* tag)
+{
+    static const unsigned char zeros[16] = {0};
+    unsigned char lengths[16];
+
+    meh_update_poly1305(mac, zeros, (16 - len % 16) % 16);
+
+    U64TO8_LITTLE(lengths, (uint64_t)ad_len, 0);
+    U64TO8_LITTLE(lengths, (uint64_t)len, 8);
+    meh_update_poly1305(mac, lengths, sizeof (lengths));
+
+    meh_finish_poly1305(mac, tag);
+}
+
+/* Encrypts len bytes of in to out (which may be the same buffer) and
+   writes a 16-byte tag over ad and the ciphertext. */
+meh_error_t meh_seal_chacha20poly1305(MehChaCha20Poly1305 ccp,
+                                      const unsigned char* nonce,
+                                      size_t nonce_size,
+                                      const unsigned char* ad, size_t ad_len,
+                                      const unsigned char* in, size_t len,
+                                      unsigned char* out, unsigned char* tag)
+{
+    meh_chacha20_state_t cipher;
+    meh_poly1305_state_t mac;
+    meh_error_t error;
+    size_t done, n, got;
+
+    if (NULL == tag || (len > 0 && (NULL == in || NULL == out)))
+        return meh_error("null reference passed to meh_seal_chacha20poly1305",
+                         MEH_INVALID_ARGUMENT);
+
+    if ((uint64_t)len > MEH_CHACHA20POLY1305_MAX_LEN)
+        return meh_error("message too long for meh_seal_chacha20poly1305",
+                         MEH_SOURCE_EXHAUSTED);
+
+    error = _meh_start_chacha20poly1305(ccp, nonce, nonce_size, ad, ad_len,
+                                        &cipher, &mac);
+    if (MEH_OK != error)
+        return error;
+
+    for (done = 0; done < len; done += n)
+    {
+        n = len - done;
+        if (n > MEH_CHACHA20POLY1305_CHUNK)
+            n = MEH_CHACHA20POLY1305_CHUNK;
+
+        if (MEH_OK != (error = meh_update_chacha20(&cipher, in + done,
+                                                   out + done, n, &got)))
+        {
+            _meh_clear_chacha20poly1305(&cipher, &mac);
+            return error;
+        }
+        meh_update_poly1305(&mac, out + done, n);
+    }
+
+    _meh_end_chacha20poly1305(&mac, ad_len, len, tag);
+    _meh_clear_chacha20poly1305(&cipher, &mac);
+
+    return MEH_OK;
+}
+
+/* Decrypts len bytes of in to out if tag checks out. Decryption runs
+   alongside authentication in the same pass, so on a bad tag out has
+   already been written; it is zeroed before MEH_AUTH_FAILED is
+   returned. */
+meh_error_t meh_open_chacha20poly1305(MehChaCha20Poly1305 ccp,
+                                      const unsigned char* nonce,
+                                      size_t nonce_size,
+                                      const unsigned char* ad, size_t ad_len,
+                                      const unsigned char* in, size_t len,
+                                      unsigned char* out,
+                                      const unsigned char* tag)
+{
+    unsigned char expected[MEH_CHACHA20POLY1305_TAG_SIZE];
+    meh_chacha20_state_t cipher;
+    meh_poly1305_state_t mac;
+    meh_error_t error;
+    size_t done, n, got, i;
+    unsigned char diff;
+
+    if (NULL == tag || (len > 0 && (NULL == in || NULL == out)))
+        return meh_error("null reference passed to meh_open_chacha20poly1305",
+                         MEH_INVALID_ARGUMENT);
+
+    if ((uint64_t)len > MEH_CHACHA20POLY1305_MAX_LEN)
+        return meh_error("message too long for meh_open_chacha20poly1305",
+                         MEH_SOURCE_EXHAUSTED);
+
+    error = _meh_start_chacha20poly1305(ccp, nonce, nonce_size, ad, ad_len,
+                                        &cipher, &mac);
+    if (MEH_OK != error)
+        return error;
+
+    for (done = 0; done < len; done += n)
+    {
+        n = len - done;
+        if (n > MEH_CHACHA20POLY1305_CHUNK)
+            n = MEH_CHACHA20POLY1305_CHUNK;
+
+        meh_update_poly1305(&mac, in + done, n);
+        if (MEH_OK != (error = meh_update_chacha20(&cipher, in + done,
+                                                   out + done, n, &got)))
+        {
+            /* Nothing unauthenticated is released here either */
+            memset(out, 0, len);
+            _meh_clear_chacha20poly1305(&cipher, &mac);
+            return error;
+        }
+    }
+
+    _meh_end_chacha20poly1305(&mac, ad_len, len, expected);
+    _meh_clear_chacha20poly1305(&cipher, &mac);
+
+    /* Compare without an early exit */
+    for (i = 0, diff = 0; i < sizeof (expected); i++)
+        diff |= expected[i] ^ tag[i];
+
+    if (0 != diff)
+    {
+        if (len > 0)
+            memset(out, 0, len);
+        return MEH_AUTH_FAILED;
+    }
+
+    return MEH_OK;
+}
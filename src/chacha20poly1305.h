@@ -0,0 +1,59 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_CHACHA20POLY1305_H
+#define MEH_CHACHA20POLY1305_H
+
+#include "include.h"
+#include "error.h"
+#include "chacha20.h"
+#include "poly1305.h"
+
+#define MEH_CHACHA20POLY1305_KEY_SIZE MEH_CHACHA20_KEY_SIZE
+#define MEH_CHACHA20POLY1305_NONCE_SIZE MEH_CHACHA20_NONCE_SIZE
+#define MEH_CHACHA20POLY1305_TAG_SIZE MEH_POLY1305_TAG_SIZE
+
+/* Longest message under one nonce: the keystream after block 0 */
+#define MEH_CHACHA20POLY1305_MAX_LEN (MEH_CHACHA20_MAX_OFFSET - 64)
+
+/* Only the key is kept; each message sets up its own cipher and MAC. */
+typedef struct meh_chacha20poly1305_state_s
+{
+    unsigned char key[MEH_CHACHA20POLY1305_KEY_SIZE];
+} meh_chacha20poly1305_state_t;
+
+typedef meh_chacha20poly1305_state_t* MehChaCha20Poly1305;
+
+meh_error_t meh_reset_chacha20poly1305(MehChaCha20Poly1305,
+                                       const unsigned char*, size_t);
+meh_error_t meh_seal_chacha20poly1305(MehChaCha20Poly1305,
+                                      const unsigned char*, size_t,
+                                      const unsigned char*, size_t,
+                                      const unsigned char*, size_t,
+                                      unsigned char*, unsigned char*);
+meh_error_t meh_open_chacha20poly1305(MehChaCha20Poly1305,
+                                      const unsigned char*, size_t,
+                                      const unsigned char*, size_t,
+                                      const unsigned char*, size_t,
+                                      unsigned char*, const unsigned char*);
+
+#endif
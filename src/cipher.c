@@ -21,44 +21,209 @@ THE SOFTWARE.
 */
 
 #include "cipher.h"
+#include "thread.h"
+
+static meh_error_t _meh_reset_rc4(meh_cipher_state_t* s, va_list args)
+{
+    meh_rc4_args_t rc4;
+
+    rc4.key = va_arg(args, unsigned char*);
+    rc4.key_size = va_arg(args, size_t);
+
+    return meh_reset_rc4(&s->rc4, rc4.key, rc4.key_size);
+}
+
+static meh_error_t _meh_update_rc4(meh_cipher_state_t* s,
+                                   const unsigned char* in, unsigned char* out,
+                                   size_t len, size_t* got)
+{
+    return meh_update_rc4(&s->rc4, in, out, len, got);
+}
+
+static meh_error_t _meh_finish_rc4(meh_cipher_state_t* s, unsigned char* out,
+                                   size_t* got)
+{
+    return meh_finish_rc4(&s->rc4, out, got);
+}
+
+static const meh_cipher_ops_t meh_rc4_ops =
+{
+    MEH_RC4,
+    _meh_reset_rc4,
+    _meh_update_rc4,
+    NULL,
+    NULL,
+    _meh_finish_rc4
+};
+
+static meh_error_t _meh_reset_salsa20(meh_cipher_state_t* s, va_list args)
+{
+    meh_salsa20_args_t salsa20;
+
+    salsa20.key = va_arg(args, unsigned char*);
+    salsa20.iv = va_arg(args, unsigned char*);
+    salsa20.key_size = va_arg(args, size_t);
+
+    return meh_reset_salsa20(&s->salsa20, salsa20.key, salsa20.iv,
+                             salsa20.key_size);
+}
+
+static meh_error_t _meh_update_salsa20(meh_cipher_state_t* s,
+                                       const unsigned char* in,
+                                       unsigned char* out,
+                                       size_t len, size_t* got)
+{
+    return meh_update_salsa20(&s->salsa20, in, out, len, got);
+}
+
+static meh_error_t _meh_seek_salsa20(meh_cipher_state_t* s, uint64_t offset)
+{
+    return meh_seek_salsa20(&s->salsa20, offset);
+}
+
+static uint64_t _meh_tell_salsa20(meh_cipher_state_t* s)
+{
+    return meh_tell_salsa20(&s->salsa20);
+}
+
+static meh_error_t _meh_finish_salsa20(meh_cipher_state_t* s,
+                                       unsigned char* out, size_t* got)
+{
+    return meh_finish_salsa20(&s->salsa20, out, got);
+}
+
+static const meh_cipher_ops_t meh_salsa20_ops =
+{
+    MEH_SALSA20,
+    _meh_reset_salsa20,
+    _meh_update_salsa20,
+    _meh_seek_salsa20,
+    _meh_tell_salsa20,
+    _meh_finish_salsa20
+};
+
+static meh_error_t _meh_reset_chacha20(meh_cipher_state_t* s, va_list args)
+{
+    meh_chacha20_args_t chacha20;
+
+    chacha20.key = va_arg(args, unsigned char*);
+    chacha20.nonce = va_arg(args, unsigned char*);
+    chacha20.key_size = va_arg(args, size_t);
+
+    return meh_reset_chacha20(&s->chacha20, chacha20.key, chacha20.nonce,
+                              chacha20.key_size);
+}
+
+static meh_error_t _meh_update_chacha20(meh_cipher_state_t* s,
+                                        const unsigned char* in,
+                                        unsigned char* out,
+                                        size_t len, size_t* got)
+{
+    return meh_update_chacha20(&s->chacha20, in, out, len, got);
+}
+
+static meh_error_t _meh_seek_chacha20(meh_cipher_state_t* s, uint64_t offset)
+{
+    return meh_seek_chacha20(&s->chacha20, offset);
+}
+
+static uint64_t _meh_tell_chacha20(meh_cipher_state_t* s)
+{
+    return meh_tell_chacha20(&s->chacha20);
+}
+
+static meh_error_t _meh_finish_chacha20(meh_cipher_state_t* s,
+                                        unsigned char* out, size_t* got)
+{
+    return meh_finish_chacha20(&s->chacha20, out, got);
+}
+
+static const meh_cipher_ops_t meh_chacha20_ops =
+{
+    MEH_CHACHA20,
+    _meh_reset_chacha20,
+    _meh_update_chacha20,
+    _meh_seek_chacha20,
+    _meh_tell_chacha20,
+    _meh_finish_chacha20
+};
+
+/* The one place a cipher id is mapped to its implementation. */
+const meh_cipher_ops_t* meh_cipher_ops(const meh_cipher_id cipher_id)
+{
+    switch (cipher_id)
+    {
+        case MEH_RC4: return &meh_rc4_ops;
+        case MEH_SALSA20: return &meh_salsa20_ops;
+        case MEH_CHACHA20: return &meh_chacha20_ops;
+        default:
+            return NULL;
+    }
+}
+
+size_t meh_cipher_context_size(const meh_cipher_id cipher_id)
+{
+    return (NULL == meh_cipher_ops(cipher_id)) ? 0 : sizeof (meh_cipher_t);
+}
+
+MehCipher _meh_init_cipher(void* mem, size_t size,
+                           const meh_cipher_id cipher_id, va_list args)
+{
+    MehCipher r = mem;
+    size_t need = meh_cipher_context_size(cipher_id);
+
+    if (0 == need || NULL == mem || size < need || !MEH_IS_ALIGNED(mem))
+    {
+        meh_warn("invalid cipher or storage passed to meh_init_cipher");
+        return NULL;
+    }
+
+    r->ops = meh_cipher_ops(cipher_id);
+    r->id = cipher_id;
+    r->allocated = 0;
+
+    return (MEH_OK == r->ops->reset(&r->state, args)) ? r : NULL;
+}
+
+MehCipher meh_init_cipher(void* mem, size_t size,
+                          const meh_cipher_id cipher_id, ...)
+{
+    MehCipher r;
+    va_list args;
+
+    va_start(args, cipher_id);
+    r = _meh_init_cipher(mem, size, cipher_id, args);
+    va_end(args);
+
+    return r;
+}
 
 MehCipher _meh_get_cipher(const meh_cipher_id cipher_id, va_list args)
 {
-    meh_cipher_args_t cipher_args;
-    MehCipher r = malloc(sizeof (meh_cipher_t));
+    MehCipher r;
+    void* mem;
+    size_t size = meh_cipher_context_size(cipher_id);
+
+    if (0 == size)
+    {
+        meh_warn("invalid cipher id passed to _meh_get_cipher");
+        return NULL;
+    }
 
-    if (NULL == r)
+    if (NULL == (mem = malloc(size)))
     {
         meh_warn("could not allocate cipher context in meh_get_cipher");
         return NULL;
     }
 
-    r->id = cipher_id;
-    
-    switch (cipher_id)
+    if (NULL == (r = _meh_init_cipher(mem, size, cipher_id, args)))
     {
-        case MEH_RC4:
-            cipher_args.rc4.key = va_arg(args, unsigned char*);
-            cipher_args.rc4.key_size = va_arg(args, size_t);
-            r->state.rc4 = meh_get_rc4(cipher_args.rc4.key,
-                                       cipher_args.rc4.key_size);
-            break;
-
-        case MEH_SALSA20:
-            cipher_args.salsa20.key = va_arg(args, unsigned char*);
-            cipher_args.salsa20.iv = va_arg(args, unsigned char*);
-            cipher_args.salsa20.key_size = va_arg(args, size_t);
-            r->state.salsa20 = meh_get_salsa20(cipher_args.salsa20.key,
-                                               cipher_args.salsa20.iv,
-                                               cipher_args.salsa20.key_size);
-            break;
-            
-        default: /* shouldn't happen, but just in case */
-            free(r);
-            meh_warn("invalid cipher id passed to _meh_get_cipher");
-            return NULL;
+        free(mem);
+        return NULL;
     }
 
+    r->allocated = 1;
+
     return r;
 }
 
@@ -76,35 +241,7 @@ MehCipher meh_get_cipher(const meh_cipher_id cipher_id, ...)
 
 meh_error_t _meh_reset_cipher(MehCipher cipher, va_list args)
 {
-    meh_cipher_args_t cipher_args;
-    meh_error_t error;
-    
-    switch (cipher->id)
-    {
-        case MEH_RC4:
-            cipher_args.rc4.key = va_arg(args, unsigned char*);
-            cipher_args.rc4.key_size = va_arg(args, size_t);
-            error = meh_reset_rc4(cipher->state.rc4,
-                                  cipher_args.rc4.key,
-                                  cipher_args.rc4.key_size);
-            break;
-
-        case MEH_SALSA20:
-            cipher_args.salsa20.key = va_arg(args, unsigned char*);
-            cipher_args.salsa20.iv = va_arg(args, unsigned char*);
-            cipher_args.salsa20.key_size = va_arg(args, size_t);
-            error = meh_reset_salsa20(cipher->state.salsa20,
-                                      cipher_args.salsa20.key,
-                                      cipher_args.salsa20.iv,
-                                      cipher_args.salsa20.key_size);
-            break;
-            
-        default: /* shouldn't happen, but just in case */
-            return meh_error("invalid cipher id passed to _meh_reset_cipher",
-                             MEH_INVALID_CIPHER);    
-    }
-
-    return error;
+    return cipher->ops->reset(&cipher->state, args);
 }
 
 meh_error_t meh_reset_cipher(MehCipher cipher, ...)
@@ -122,50 +259,115 @@ meh_error_t meh_reset_cipher(MehCipher cipher, ...)
 meh_error_t meh_update_cipher(MehCipher cipher, const unsigned char* in,
                               unsigned char* out, size_t len, size_t* got)
 {
+    return cipher->ops->update(&cipher->state, in, out, len, got);
+}
+
+/* Below this many bytes per thread, starting the thread costs more
+   than it saves. */
+#define MEH_CIPHER_PARALLEL_MIN ((size_t)1 << 16)
+
+typedef struct meh_cipher_chunk_s
+{
+    meh_cipher_t cipher; /* a private copy, seeked to offset */
+    const unsigned char* in;
+    unsigned char* out;
+    size_t len;
+    uint64_t offset;
+} meh_cipher_chunk_t;
+
+static meh_error_t _meh_update_cipher_chunk(void* arg)
+{
+    meh_cipher_chunk_t* chunk = arg;
     meh_error_t error;
-    
-    switch (cipher->id)
-    {
-        case MEH_RC4:
-            error = meh_update_rc4(cipher->state.rc4, in, out, len, got);
-            break;
-
-        case MEH_SALSA20:
-            error = meh_update_salsa20(cipher->state.salsa20,
-                                       in,
-                                       out,
-                                       len,
-                                       got);
-            break;
-            
-        default: /* shouldn't happen, but just in case */
-            return meh_error("invalid cipher id passed to meh_update_cipher",
-                             MEH_INVALID_CIPHER);
-    }
-    
-    return error;
+    size_t got;
+
+    error = chunk->cipher.ops->seek(&chunk->cipher.state, chunk->offset);
+    if (MEH_OK != error)
+        return error;
+
+    return chunk->cipher.ops->update(&chunk->cipher.state, chunk->in,
+                                     chunk->out, chunk->len, &got);
 }
 
-meh_error_t meh_finish_cipher(MehCipher cipher, unsigned char* out, size_t* got)
+/* Like meh_update_cipher, but for a cipher that can seek the buffer is
+   split into chunks that up to threads threads encrypt at once. The
+   context ends up exactly where meh_update_cipher would leave it.
+   Ciphers that cannot seek, and small buffers, go through
+   meh_update_cipher as usual. */
+meh_error_t meh_update_cipher_parallel(MehCipher cipher,
+                                       const unsigned char* in,
+                                       unsigned char* out, size_t len,
+                                       size_t* got, unsigned int threads)
 {
+    meh_cipher_chunk_t* chunks;
+    meh_cipher_t probe;
     meh_error_t error;
-    
-    switch (cipher->id)
+    uint64_t start;
+    size_t i, n, share, done;
+
+    if (NULL == cipher || NULL == in || NULL == out || NULL == got)
+        return meh_error("null reference passed to meh_update_cipher_parallel",
+                         MEH_INVALID_ARGUMENT);
+
+    n = len / MEH_CIPHER_PARALLEL_MIN;
+    if (n > threads)
+        n = threads;
+
+    if (n < 2 || NULL == cipher->ops->seek)
+        return meh_update_cipher(cipher, in, out, len, got);
+
+    /* Chunks are placed by byte offset, which stops at 2^64 while
+       Salsa20's block counter runs on. If the run would cross that, or
+       the context is already past it and tell has wrapped, seeking back
+       to start does not give the same state; go in order then. */
+    start = cipher->ops->tell(&cipher->state);
+    probe = *cipher;
+
+    if (len > UINT64_MAX - start ||
+        MEH_OK != probe.ops->seek(&probe.state, start) ||
+        0 != memcmp(&probe.state, &cipher->state, sizeof (probe.state)))
+        return meh_update_cipher(cipher, in, out, len, got);
+
+    if (NULL == (chunks = malloc(n * sizeof (*chunks))))
+        return meh_update_cipher(cipher, in, out, len, got);
+
+    /* Equal shares in whole 64-byte blocks, the last taking the rest */
+    share = (len / n) & ~(size_t)63;
+
+    for (i = 0, done = 0; i < n; i++, done += share)
     {
-        case MEH_RC4:
-            error = meh_finish_rc4(cipher->state.rc4, out, got);
-            break;
-
-        case MEH_SALSA20:
-            error = meh_finish_salsa20(cipher->state.salsa20, out, got);
-            break;
-            
-        default: /* shouldn't happen, but just in case */
-            return meh_error("invalid cipher id passed to meh_finish_cipher",
-                             MEH_INVALID_CIPHER);
+        chunks[i].cipher = *cipher;
+        chunks[i].in = in + done;
+        chunks[i].out = out + done;
+        chunks[i].len = (i == n - 1) ? len - done : share;
+        chunks[i].offset = start + done;
     }
-    
-    return error;
+
+    error = _meh_run_parallel(_meh_update_cipher_chunk, chunks,
+                              sizeof (*chunks), n, threads);
+    free(chunks);
+
+    if (MEH_OK != error)
+        return error;
+
+    *got = len;
+
+    return cipher->ops->seek(&cipher->state, start + len);
+}
+
+/* Jump to a byte offset in the keystream, for ciphers that allow it. */
+meh_error_t meh_seek_cipher(MehCipher cipher, uint64_t offset)
+{
+    if (NULL == cipher->ops->seek)
+        return meh_error("cipher does not support meh_seek_cipher",
+                         MEH_INVALID_CIPHER);
+
+    return cipher->ops->seek(&cipher->state, offset);
+}
+
+meh_error_t meh_finish_cipher(MehCipher cipher, unsigned char* out, size_t* got)
+{
+    return cipher->ops->finish(&cipher->state, out, got);
 }
 
 meh_error_t meh_cipher(meh_cipher_id cipher_id, ...)
@@ -213,14 +415,7 @@ void meh_destroy_cipher(MehCipher cipher)
         meh_warn("invalid argument passed to meh_destroy_cipher");
         return;
     }
-    
-    switch(cipher->id)
-    {
-        case MEH_RC4:
-            meh_destroy_rc4(cipher->state.rc4); break;
-        default:
-            meh_warn("invalid cipher id passed to meh_destroy_cipher");
-    }
 
-    free(cipher);
+    if (cipher->allocated)
+        free(cipher);
 }
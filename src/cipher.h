@@ -27,24 +27,45 @@ THE SOFTWARE.
 #include "error.h"
 #include "rc4.h"
 #include "salsa20.h"
+#include "chacha20.h"
 
 typedef enum
 {
     MEH_RC4,
-    MEH_SALSA20
+    MEH_SALSA20,
+    MEH_CHACHA20
 } meh_cipher_id;
 
+/* Held by value so a context is one contiguous object. */
 typedef union meh_cipher_state_u
 {
-    MehRC4 rc4;
-    MehSalsa20 salsa20;
-    
+    meh_rc4_state_t rc4;
+    meh_salsa20_state_t salsa20;
+    meh_chacha20_state_t chacha20;
 } meh_cipher_state_t;
 
+/* Resolved once when a context is built; reset takes the same trailing
+   arguments as meh_get_cipher. seek and tell are NULL for ciphers
+   without random access to their keystream. */
+typedef struct meh_cipher_ops_s
+{
+    meh_cipher_id id;
+
+    meh_error_t (*reset)(meh_cipher_state_t*, va_list);
+    meh_error_t (*update)(meh_cipher_state_t*, const unsigned char*,
+                          unsigned char*, size_t, size_t*);
+    meh_error_t (*seek)(meh_cipher_state_t*, uint64_t);
+    uint64_t (*tell)(meh_cipher_state_t*);
+    meh_error_t (*finish)(meh_cipher_state_t*, unsigned char*, size_t*);
+} meh_cipher_ops_t;
+
 typedef struct meh_cipher_s
 {
+    const meh_cipher_ops_t* ops;
     meh_cipher_state_t state;
     meh_cipher_id id;
+
+    int allocated; /* storage came from meh_get_cipher */
 } meh_cipher_t;
 
 typedef meh_cipher_t* MehCipher;
@@ -53,12 +74,20 @@ typedef union meh_cipher_args_u
 {
     meh_rc4_args_t rc4;
     meh_salsa20_args_t salsa20;
+    meh_chacha20_args_t chacha20;
 } meh_cipher_args_t;
 
+const meh_cipher_ops_t* meh_cipher_ops(const meh_cipher_id);
 MehCipher meh_get_cipher(const meh_cipher_id, ...);
+size_t meh_cipher_context_size(const meh_cipher_id);
+MehCipher meh_init_cipher(void*, size_t, const meh_cipher_id, ...);
 meh_error_t meh_reset_cipher(MehCipher, ...);
 meh_error_t meh_update_cipher(MehCipher, const unsigned char*, unsigned char*,
                               size_t, size_t*);
+meh_error_t meh_update_cipher_parallel(MehCipher, const unsigned char*,
+                                       unsigned char*, size_t, size_t*,
+                                       unsigned int);
+meh_error_t meh_seek_cipher(MehCipher, uint64_t);
 meh_error_t meh_finish_cipher(MehCipher, unsigned char*, size_t*);
 void meh_destroy_cipher(MehCipher);
 
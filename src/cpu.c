@@ -0,0 +1,100 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "cpu.h"
+
+#if MEH_HAVE_X86
+#    include <cpuid.h>
+#endif
+
+static int meh_cpu_detected = 0;
+static unsigned int meh_cpu_found = 0,
+                    meh_cpu_allowed = MEH_CPU_ALL;
+
+#if MEH_HAVE_X86
+/* Which register sets the OS saves on a context switch. */
+static uint64_t _meh_xgetbv(void)
+{
+    uint32_t lo, hi;
+
+    __asm__ __volatile__ ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static unsigned int _meh_detect_cpu(void)
+{
+    unsigned int eax, ebx, ecx, edx, r = 0;
+    uint64_t xcr0 = 0;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+
+    if (edx & (1u << 26))
+        r |= MEH_CPU_SSE2;
+    if (ecx & (1u << 9))
+        r |= MEH_CPU_SSSE3;
+    if (ecx & (1u << 19))
+        r |= MEH_CPU_SSE41;
+    if (ecx & (1u << 27)) /* OSXSAVE */
+        xcr0 = _meh_xgetbv();
+
+    if (__get_cpuid_max(0, NULL) < 7)
+        return r;
+
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+    if ((ebx & (1u << 5)) && (xcr0 & 0x06) == 0x06)
+        r |= MEH_CPU_AVX2;
+    if ((ebx & (1u << 16)) && (xcr0 & 0xe6) == 0xe6)
+        r |= MEH_CPU_AVX512;
+    if (ebx & (1u << 29))
+        r |= MEH_CPU_SHA;
+
+    return r;
+}
+#else
+static unsigned int _meh_detect_cpu(void)
+{
+    return 0;
+}
+#endif
+
+/* Instruction set extensions usable on this machine, probed on first
+   use. Racing first calls all store the same answer. */
+unsigned int meh_cpu_features(void)
+{
+    if (!meh_cpu_detected)
+    {
+        meh_cpu_found = _meh_detect_cpu();
+        meh_cpu_detected = 1;
+    }
+
+    return meh_cpu_found & meh_cpu_allowed;
+}
+
+/* Restrict the accelerated paths to those in mask; pass MEH_CPU_ALL to
+   lift the restriction. Handy for testing the portable code. */
+void meh_mask_cpu_features(unsigned int mask)
+{
+    meh_cpu_allowed = mask;
+}
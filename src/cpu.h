@@ -0,0 +1,50 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_CPU_H
+#define MEH_CPU_H
+
+#include "include.h"
+
+/* Accelerated code paths are compiled only where GCC-style target
+   attributes and x86 intrinsics are available, and chosen at run time. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define MEH_HAVE_X86 1
+#else
+#    define MEH_HAVE_X86 0
+#endif
+
+typedef enum
+{
+    MEH_CPU_SSE2   = 1 << 0,
+    MEH_CPU_SSSE3  = 1 << 1,
+    MEH_CPU_SSE41  = 1 << 2,
+    MEH_CPU_AVX2   = 1 << 3,
+    MEH_CPU_AVX512 = 1 << 4,
+    MEH_CPU_SHA    = 1 << 5,
+    MEH_CPU_ALL    = (1 << 6) - 1
+} meh_cpu_feature;
+
+unsigned int meh_cpu_features(void);
+void meh_mask_cpu_features(unsigned int);
+
+#endif
@@ -25,7 +25,8 @@ THE SOFTWARE.
 
 typedef enum
 {
-    MEH_FILE_NOT_FOUND = -16,
+    MEH_AUTH_FAILED = -17, /* Message did not match its tag */
+    MEH_FILE_NOT_FOUND,
     MEH_READ_ERROR,       /* Reading file */
     MEH_WRITE_ERROR,      /* Writing file */
     
@@ -22,66 +22,290 @@ THE SOFTWARE.
 
 #include "hash.h"
 
-/* Is there a better way to do this?
-   Macros are hideous, but an option. */
+/* Adapt each algorithm's functions to the shared state union. The
+   sha224/sha384 names are macros over sha256/sha512 and expand here. */
+#define MEH_HASH_ADAPTERS(name)                                          \
+    static void _meh_reset_##name(meh_hash_state_t* s)                   \
+    {                                                                    \
+        meh_reset_##name(&s->name);                                      \
+    }                                                                    \
+    static void _meh_update_##name(meh_hash_state_t* s,                  \
+                                   const unsigned char* data, size_t len) \
+    {                                                                    \
+        meh_update_##name(&s->name, data, len);                          \
+    }                                                                    \
+    static void _meh_finish_##name(meh_hash_state_t* s,                  \
+                                   unsigned char* output)                \
+    {                                                                    \
+        meh_finish_##name(&s->name, output);                             \
+    }                                                                    \
+    static void _meh_import_##name(meh_hash_state_t* s,                  \
+                                   const unsigned char* input)           \
+    {                                                                    \
+        meh_import_##name(&s->name, input);                              \
+    }
+
+#define MEH_HASH_TABLE(name, NAME, configure, configured_size, squeeze,  \
+                       update_parallel)                                  \
+    static const meh_hash_ops_t meh_##name##_ops =                       \
+    {                                                                    \
+        MEH_##NAME,                                                      \
+        sizeof (meh_##name##_state_t),                                   \
+        MEH_##NAME##_HASH_SIZE,                                          \
+        MEH_##NAME##_BLOCK_SIZE,                                         \
+        1 + MEH_##NAME##_EXPORT_SIZE,                                    \
+        _meh_reset_##name,                                               \
+        _meh_update_##name,                                              \
+        _meh_finish_##name,                                              \
+        _meh_export_##name,                                              \
+        _meh_import_##name,                                              \
+        configure,                                                       \
+        configured_size,                                                 \
+        squeeze,                                                         \
+        update_parallel                                                  \
+    };
+
+#define MEH_HASH_OPS(name, NAME)                                         \
+    MEH_HASH_ADAPTERS(name)                                              \
+    static meh_error_t _meh_export_##name(meh_hash_state_t* s,           \
+                                          unsigned char* output)         \
+    {                                                                    \
+        meh_export_##name(&s->name, output);                             \
+        return MEH_OK;                                                   \
+    }                                                                    \
+    MEH_HASH_TABLE(name, NAME, NULL, NULL, NULL, NULL)
+
+/* Hashes with a key and digest length held in their state. Exporting
+   fails for a keyed context rather than hand out its key. */
+#define MEH_KEYED_HASH_ADAPTERS(name)                                    \
+    static meh_error_t _meh_export_##name(meh_hash_state_t* s,           \
+                                          unsigned char* output)         \
+    {                                                                    \
+        return meh_export_##name(&s->name, output);                      \
+    }                                                                    \
+    static meh_error_t _meh_configure_##name(meh_hash_state_t* s,        \
+                                             const unsigned char* key,   \
+                                             size_t key_size,            \
+                                             size_t hash_size)           \
+    {                                                                    \
+        return meh_configure_##name(&s->name, key, key_size, hash_size); \
+    }                                                                    \
+    static size_t _meh_configured_size_##name(meh_hash_state_t* s)       \
+    {                                                                    \
+        return s->name.hash_size;                                        \
+    }
+
+#define MEH_KEYED_HASH_OPS(name, NAME)                                   \
+    MEH_HASH_ADAPTERS(name)                                              \
+    MEH_KEYED_HASH_ADAPTERS(name)                                        \
+    MEH_HASH_TABLE(name, NAME, _meh_configure_##name,                    \
+                   _meh_configured_size_##name, NULL, NULL)
+
+MEH_HASH_OPS(md5, MD5)
+MEH_HASH_OPS(sha1, SHA1)
+MEH_HASH_OPS(sha224, SHA224)
+MEH_HASH_OPS(sha256, SHA256)
+MEH_HASH_OPS(sha384, SHA384)
+MEH_HASH_OPS(sha512, SHA512)
+MEH_KEYED_HASH_OPS(blake2b, BLAKE2B)
+MEH_KEYED_HASH_OPS(blake2s, BLAKE2S)
+
+/* SHA-3 and SHAKE share one sponge state and differ only in how a
+   reset sets it up. */
+#define MEH_KECCAK_HASH_OPS(name, NAME, squeeze)                         \
+    static void _meh_reset_##name(meh_hash_state_t* s)                   \
+    {                                                                    \
+        meh_reset_##name(&s->keccak);                                    \
+    }                                                                    \
+    static void _meh_update_##name(meh_hash_state_t* s,                  \
+                                   const unsigned char* data, size_t len) \
+    {                                                                    \
+        meh_update_keccak(&s->keccak, data, len);                        \
+    }                                                                    \
+    static void _meh_finish_##name(meh_hash_state_t* s,                  \
+                                   unsigned char* output)                \
+    {                                                                    \
+        meh_finish_keccak(&s->keccak, output);                           \
+    }                                                                    \
+    static meh_error_t _meh_export_##name(meh_hash_state_t* s,           \
+                                          unsigned char* output)         \
+    {                                                                    \
+        meh_export_keccak(&s->keccak, output);                           \
+        return MEH_OK;                                                   \
+    }                                                                    \
+    static void _meh_import_##name(meh_hash_state_t* s,                  \
+                                   const unsigned char* input)           \
+    {                                                                    \
+        meh_import_keccak(&s->keccak, input);                            \
+    }                                                                    \
+    MEH_HASH_TABLE(name, NAME, NULL, NULL, squeeze, NULL)
+
+static void _meh_squeeze_keccak(meh_hash_state_t* s, unsigned char* output,
+                                size_t len)
+{
+    meh_squeeze_keccak(&s->keccak, output, len);
+}
+
+MEH_KECCAK_HASH_OPS(sha3_224, SHA3_224, NULL)
+MEH_KECCAK_HASH_OPS(sha3_256, SHA3_256, NULL)
+MEH_KECCAK_HASH_OPS(sha3_384, SHA3_384, NULL)
+MEH_KECCAK_HASH_OPS(sha3_512, SHA3_512, NULL)
+MEH_KECCAK_HASH_OPS(shake128, SHAKE128, _meh_squeeze_keccak)
+MEH_KECCAK_HASH_OPS(shake256, SHAKE256, _meh_squeeze_keccak)
+
+/* BLAKE3 lives outside the union (see hash.h), at the same address. */
+#define MEH_BLAKE3_OF(s) ((MehBLAKE3)(void*)(s))
+
+static void _meh_reset_blake3(meh_hash_state_t* s)
+{
+    meh_reset_blake3(MEH_BLAKE3_OF(s));
+}
+
+static void _meh_update_blake3(meh_hash_state_t* s, const unsigned char* data,
+                               size_t len)
+{
+    meh_update_blake3(MEH_BLAKE3_OF(s), data, len);
+}
+
+static void _meh_finish_blake3(meh_hash_state_t* s, unsigned char* output)
+{
+    meh_finish_blake3(MEH_BLAKE3_OF(s), output);
+}
+
+static meh_error_t _meh_export_blake3(meh_hash_state_t* s,
+                                      unsigned char* output)
+{
+    return meh_export_blake3(MEH_BLAKE3_OF(s), output);
+}
+
+static void _meh_import_blake3(meh_hash_state_t* s, const unsigned char* input)
+{
+    meh_import_blake3(MEH_BLAKE3_OF(s), input);
+}
+
+static meh_error_t _meh_configure_blake3(meh_hash_state_t* s,
+                                         const unsigned char* key,
+                                         size_t key_size, size_t hash_size)
+{
+    return meh_configure_blake3(MEH_BLAKE3_OF(s), key, key_size, hash_size);
+}
+
+static size_t _meh_configured_size_blake3(meh_hash_state_t* s)
+{
+    return MEH_BLAKE3_OF(s)->hash_size;
+}
+
+static void _meh_squeeze_blake3(meh_hash_state_t* s, unsigned char* output,
+                                size_t len)
+{
+    meh_squeeze_blake3(MEH_BLAKE3_OF(s), output, len);
+}
+
+static meh_error_t _meh_update_parallel_blake3(meh_hash_state_t* s,
+                                               const unsigned char* data,
+                                               size_t len,
+                                               unsigned int threads)
+{
+    return meh_update_blake3_parallel(MEH_BLAKE3_OF(s), data, len, threads);
+}
+
+MEH_HASH_TABLE(blake3, BLAKE3, _meh_configure_blake3,
+               _meh_configured_size_blake3, _meh_squeeze_blake3,
+               _meh_update_parallel_blake3)
+
+/* The one place a hash id is mapped to its implementation. */
+const meh_hash_ops_t* meh_hash_ops(const meh_hash_id hash_id)
+{
+    switch (hash_id)
+    {
+        case MEH_MD5: return &meh_md5_ops;
+        case MEH_SHA1: return &meh_sha1_ops;
+        case MEH_SHA224: return &meh_sha224_ops;
+        case MEH_SHA256: return &meh_sha256_ops;
+        case MEH_SHA384: return &meh_sha384_ops;
+        case MEH_SHA512: return &meh_sha512_ops;
+        case MEH_BLAKE2B: return &meh_blake2b_ops;
+        case MEH_BLAKE2S: return &meh_blake2s_ops;
+        case MEH_BLAKE3: return &meh_blake3_ops;
+        case MEH_SHA3_224: return &meh_sha3_224_ops;
+        case MEH_SHA3_256: return &meh_sha3_256_ops;
+        case MEH_SHA3_384: return &meh_sha3_384_ops;
+        case MEH_SHA3_512: return &meh_sha3_512_ops;
+        case MEH_SHAKE128: return &meh_shake128_ops;
+        case MEH_SHAKE256: return &meh_shake256_ops;
+        default:
+            return NULL;
+    }
+}
+
+size_t meh_hash_context_size(const meh_hash_id hash_id)
+{
+    const meh_hash_ops_t* ops = meh_hash_ops(hash_id);
+
+    if (NULL == ops)
+        return 0;
+
+    /* Only the active member of the state union need be backed. */
+    return MEH_ALIGN(offsetof(meh_hash_t, state) + ops->state_size);
+}
 
 MehHash meh_get_hash(const meh_hash_id hash_id)
 {   
-    MehHash r = malloc(sizeof (meh_hash_t));
+    MehHash r;
+    void* mem;
+    size_t size = meh_hash_context_size(hash_id);
+
+    if (0 == size)
+    {
+        meh_warn("invalid hash id passed to meh_get_hash");
+        return NULL;
+    }
     
-    if (NULL == r)
+    if (NULL == (mem = malloc(size)))
     {
         meh_warn("could not allocate hash context in meh_get_hash");
         return NULL;
     }
+
+    r = meh_init_hash(mem, size, hash_id);
+    r->allocated = 1;
     
-    r->id = hash_id;
-    
-    switch (hash_id)
+    return r;
+}
+
+/* Build a hash context inside size bytes of caller-owned storage; the
+   context lives and dies with that storage. */
+MehHash meh_init_hash(void* mem, size_t size, const meh_hash_id hash_id)
+{
+    MehHash r = mem;
+    size_t need = meh_hash_context_size(hash_id);
+
+    if (0 == need)
     {
-        case MEH_MD5:
-            r->state.md5 = meh_get_md5();
-            if (NULL == r->state.md5)
-                goto meh_get_hash_allocation_failure;
-            break;
-        case MEH_SHA1:
-            r->state.sha1 = meh_get_sha1();
-            if (NULL == r->state.sha1)
-                goto meh_get_hash_allocation_failure;
-            break;
-        case MEH_SHA224:
-            r->state.sha224 = meh_get_sha224();
-            if (NULL == r->state.sha224)
-                goto meh_get_hash_allocation_failure;
-            break;
-        case MEH_SHA256:
-            r->state.sha256 = meh_get_sha256();
-            if (NULL == r->state.sha256)
-                goto meh_get_hash_allocation_failure;
-            break;
-        case MEH_SHA384:
-            r->state.sha384 = meh_get_sha384();
-            if (NULL == r->state.sha384)
-                goto meh_get_hash_allocation_failure;
-            break;
-        case MEH_SHA512:
-            r->state.sha512 = meh_get_sha512();
-            if (NULL == r->state.sha512)
-                goto meh_get_hash_allocation_failure;
-            break;
-        default:
-            meh_warn("invalid hash id passed to meh_get_hash");
-            goto meh_get_hash_allocation_failure;
+        meh_warn("invalid hash id passed to meh_init_hash");
+        return NULL;
+    }
+
+    if (NULL == mem || size < need || !MEH_IS_ALIGNED(mem))
+    {
+        meh_warn("invalid storage passed to meh_init_hash");
+        return NULL;
     }
 
-    r->output_size = meh_hash_output_size(r);
-    r->block_size = meh_hash_block_size(r);
+    r->ops = meh_hash_ops(hash_id);
+    r->id = hash_id;
+    r->allocated = 0;
+
+    r->output_size = r->ops->output_size;
+    r->block_size = r->ops->block_size;
+
+    /* Keyed hashes start unkeyed at their full digest length. */
+    if (NULL != r->ops->configure)
+        r->ops->configure(&r->state, NULL, 0, r->ops->output_size);
+    else
+        r->ops->reset(&r->state);
     
     return r;
-
-meh_get_hash_allocation_failure:
-    free(r);
-    return NULL;
 }
 
 meh_error_t meh_reset_hash(MehHash hash)
@@ -90,18 +314,31 @@ meh_error_t meh_reset_hash(MehHash hash)
         return meh_error("invalid argument passed to meh_reset_hash",
                          MEH_INVALID_ARGUMENT);
     
-    switch (hash->id)
-    {
-        case MEH_MD5: meh_reset_md5(hash->state.md5); break;
-        case MEH_SHA1: meh_reset_sha1(hash->state.sha1); break;
-        case MEH_SHA224: meh_reset_sha224(hash->state.sha224); break;
-        case MEH_SHA256: meh_reset_sha256(hash->state.sha256); break;
-        case MEH_SHA384: meh_reset_sha384(hash->state.sha384); break;
-        case MEH_SHA512: meh_reset_sha512(hash->state.sha512); break;
-        default: /* shouldn't happen, but just in case */
-            return meh_error("invalid hash id passed to meh_reset_hash",
-                             MEH_INVALID_HASH);
-    }
+    hash->ops->reset(&hash->state);
+
+    return MEH_OK;
+}
+
+/* Key the hash and set its digest length, then start over. Only hashes
+   built for it (BLAKE2) accept this; the setting survives resets. */
+meh_error_t meh_configure_hash(MehHash hash, const unsigned char* key,
+                               size_t key_size, size_t output_size)
+{
+    meh_error_t error;
+
+    if (NULL == hash)
+        return meh_error("invalid argument passed to meh_configure_hash",
+                         MEH_INVALID_ARGUMENT);
+
+    if (NULL == hash->ops->configure)
+        return meh_error("hash takes no key or digest size in "
+                         "meh_configure_hash", MEH_INVALID_HASH);
+
+    if ((error = hash->ops->configure(&hash->state, key, key_size,
+                                      output_size)) != MEH_OK)
+        return error;
+
+    hash->output_size = output_size;
 
     return MEH_OK;
 }
@@ -112,47 +349,50 @@ meh_error_t meh_update_hash(MehHash hash, const unsigned char* data, size_t len)
         return meh_error("invalid argument passed to meh_update_hash",
                          MEH_INVALID_ARGUMENT);
 
-    if (0 == len)
-        return MEH_OK;
-    
-    switch (hash->id)
-    {
-        case MEH_MD5: meh_update_md5(hash->state.md5, data, len); break;
-        case MEH_SHA1: meh_update_sha1(hash->state.sha1, data, len); break;
-        case MEH_SHA224:
-            meh_update_sha224(hash->state.sha224, data, len); break;
-        case MEH_SHA256:
-            meh_update_sha256(hash->state.sha256, data, len); break;
-        case MEH_SHA384:
-            meh_update_sha384(hash->state.sha384, data, len); break;
-        case MEH_SHA512:
-            meh_update_sha512(hash->state.sha512, data, len); break;
-        default:
-            return meh_error("invalid hash id passed to meh_update_hash",
-                             MEH_INVALID_HASH);
-    }
+    hash->ops->update(&hash->state, data, len);
     
     return MEH_OK;
 }
 
+/* As meh_update_hash, letting hashes built for it (BLAKE3) spread a
+   large input over up to threads threads. Others just update. */
+meh_error_t meh_update_hash_parallel(MehHash hash, const unsigned char* data,
+                                     size_t len, unsigned int threads)
+{
+    if (NULL == hash || NULL == data)
+        return meh_error("invalid argument passed to meh_update_hash_parallel",
+                         MEH_INVALID_ARGUMENT);
+
+    if (NULL == hash->ops->update_parallel || threads < 2)
+        return meh_update_hash(hash, data, len);
+
+    return hash->ops->update_parallel(&hash->state, data, len, threads);
+}
+
 meh_error_t meh_finish_hash(MehHash hash, unsigned char* output)
 {
     if (NULL == hash || NULL == output)
         return meh_error("invalid argument passed to meh_finish_hash",
                          MEH_INVALID_ARGUMENT);
     
-    switch (hash->id)
-    {
-        case MEH_MD5: meh_finish_md5(hash->state.md5, output); break;
-        case MEH_SHA1: meh_finish_sha1(hash->state.sha1, output); break;
-        case MEH_SHA224: meh_finish_sha224(hash->state.sha224, output); break;
-        case MEH_SHA256: meh_finish_sha256(hash->state.sha256, output); break;
-        case MEH_SHA384: meh_finish_sha384(hash->state.sha384, output); break;
-        case MEH_SHA512: meh_finish_sha512(hash->state.sha512, output); break;
-        default:
-            return meh_error("invalid hash id passed to meh_finish_hash",
-                             MEH_INVALID_HASH);
-    }
+    hash->ops->finish(&hash->state, output);
+
+    return MEH_OK;
+}
+
+/* Read the next len bytes of an extendable-output hash. The first call
+   ends the input; reset before updating again. */
+meh_error_t meh_squeeze_hash(MehHash hash, unsigned char* output, size_t len)
+{
+    if (NULL == hash || NULL == output)
+        return meh_error("invalid argument passed to meh_squeeze_hash",
+                         MEH_INVALID_ARGUMENT);
+
+    if (NULL == hash->ops->squeeze)
+        return meh_error("hash has no extendable output in meh_squeeze_hash",
+                         MEH_INVALID_HASH);
+
+    hash->ops->squeeze(&hash->state, output, len);
 
     return MEH_OK;
 }
@@ -164,20 +404,83 @@ void meh_destroy_hash(MehHash hash)
         meh_warn("invalid argument passed to meh_destroy_hash");
         return;
     }
-    
-    switch (hash->id)
+
+    if (hash->allocated)
+        free(hash);
+}
+
+meh_error_t meh_copy_hash(MehHash dst, const MehHash src)
+{
+    if (NULL == dst || NULL == src || dst->id != src->id)
+        return meh_error("invalid argument passed to meh_copy_hash",
+                         MEH_INVALID_ARGUMENT);
+
+    memcpy(&dst->state, &src->state, src->ops->state_size);
+    dst->output_size = src->output_size;
+
+    return MEH_OK;
+}
+
+/* A new context carrying the same running state as hash. */
+MehHash meh_clone_hash(const MehHash hash)
+{
+    MehHash r;
+
+    if (NULL == hash)
     {
-        case MEH_MD5: meh_destroy_md5(hash->state.md5); break;
-        case MEH_SHA1: meh_destroy_sha1(hash->state.sha1); break;
-        case MEH_SHA224: meh_destroy_sha224(hash->state.sha224); break;
-        case MEH_SHA256: meh_destroy_sha256(hash->state.sha256); break;
-        case MEH_SHA384: meh_destroy_sha384(hash->state.sha384); break;
-        case MEH_SHA512: meh_destroy_sha512(hash->state.sha512); break;
-        default:
-            meh_warn("invalid hash id passed to meh_destroy_hash");
+        meh_warn("invalid argument passed to meh_clone_hash");
+        return NULL;
     }
+
+    if (NULL == (r = meh_get_hash(hash->id)))
+        return NULL;
+
+    meh_copy_hash(r, hash);
+
+    return r;
+}
+
+/* Serialize the chaining state: the hash id followed by the algorithm's
+   own layout, meh_hash_export_size bytes in all. Keyed BLAKE2 and BLAKE3
+   contexts refuse, leaving output untouched, since their state would
+   give away the key. */
+meh_error_t meh_export_hash(MehHash hash, unsigned char* output)
+{
+    meh_error_t error;
+
+    if (NULL == hash || NULL == output)
+        return meh_error("invalid argument passed to meh_export_hash",
+                         MEH_INVALID_ARGUMENT);
+
+    if ((error = hash->ops->export_state(&hash->state, output+1)) != MEH_OK)
+        return error;
+
+    output[0] = (unsigned char)hash->id;
+
+    return MEH_OK;
+}
+
+meh_error_t meh_import_hash(MehHash hash, const unsigned char* input,
+                            size_t len)
+{
+    if (NULL == hash || NULL == input)
+        return meh_error("invalid argument passed to meh_import_hash",
+                         MEH_INVALID_ARGUMENT);
+
+    if (len < meh_hash_export_size(hash))
+        return meh_error("short state passed to meh_import_hash",
+                         MEH_BUFFER_UNDERFLOW);
+
+    if (input[0] != (unsigned char)hash->id)
+        return meh_error("mismatched state passed to meh_import_hash",
+                         MEH_INVALID_HASH);
     
-    free(hash);
+    hash->ops->import_state(&hash->state, input+1);
+
+    if (NULL != hash->ops->configured_size)
+        hash->output_size = hash->ops->configured_size(&hash->state);
+
+    return MEH_OK;
 }
 
 meh_error_t meh_hash(meh_hash_id hash_id, const unsigned char* data,
@@ -229,36 +532,15 @@ meh_error_t meh_hash_file(MehHash hash, FILE* fd)
 
 size_t meh_hash_output_size(MehHash hash)
 {
-    switch (hash->id)
-    {
-        case MEH_MD5: return MEH_MD5_HASH_SIZE;
-        case MEH_SHA1: return MEH_SHA1_HASH_SIZE;
-        case MEH_SHA224: return MEH_SHA224_HASH_SIZE;
-        case MEH_SHA256: return MEH_SHA256_HASH_SIZE;
-        case MEH_SHA384: return MEH_SHA384_HASH_SIZE;
-        case MEH_SHA512: return MEH_SHA512_HASH_SIZE;
-        default: /* shouldn't happen, but just in case */
-            return meh_error(
-                "invalid hash id passed to meh_hash_output_size", -1);
-    }
-
-    return -1;
+    return hash->output_size;
 }
 
 size_t meh_hash_block_size(MehHash hash)
 {
-    switch (hash->id)
-    {
-        case MEH_MD5: return MEH_MD5_BLOCK_SIZE;
-        case MEH_SHA1: return MEH_SHA1_BLOCK_SIZE;
-        case MEH_SHA224: return MEH_SHA224_BLOCK_SIZE;
-        case MEH_SHA256: return MEH_SHA256_BLOCK_SIZE;
-        case MEH_SHA384: return MEH_SHA384_BLOCK_SIZE;
-        case MEH_SHA512: return MEH_SHA512_BLOCK_SIZE;
-        default: /* shouldn't happen, but just in case */
-            return meh_error(
-                "invalid hash id passed to meh_hash_block_size", -1);
-    }
+    return hash->ops->block_size;
+}
 
-    return -1;
+size_t meh_hash_export_size(MehHash hash)
+{
+    return hash->ops->export_size;
 }
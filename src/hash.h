@@ -29,6 +29,10 @@ THE SOFTWARE.
 #include "sha1.h"
 #include "sha256.h"
 #include "sha512.h"
+#include "blake2b.h"
+#include "blake2s.h"
+#include "blake3.h"
+#include "keccak.h"
 
 typedef enum
 {
@@ -37,40 +41,119 @@ typedef enum
     MEH_SHA224,
     MEH_SHA256,
     MEH_SHA384,
-    MEH_SHA512
+    MEH_SHA512,
+    MEH_BLAKE2B,
+    MEH_BLAKE2S,
+    MEH_BLAKE3,
+    MEH_SHA3_224,
+    MEH_SHA3_256,
+    MEH_SHA3_384,
+    MEH_SHA3_512,
+    MEH_SHAKE128,
+    MEH_SHAKE256
 } meh_hash_id;
 
+#define MEH_HASH_MAX_OUTPUT_SIZE MEH_SHA512_HASH_SIZE
+#define MEH_HASH_MAX_BLOCK_SIZE  MEH_SHAKE128_BLOCK_SIZE
+
+/* Held by value so a context is one contiguous object. BLAKE3 is left
+   out: its stack of subtree chaining values would make every context
+   that embeds a hash (HMAC, PBKDF2) several times larger. Its state
+   takes the union's place only in contexts sized for it by
+   meh_hash_context_size. */
 typedef union meh_hash_state_u
 {
-    MehMD5 md5;
-    MehSHA1 sha1;
-    MehSHA256 sha256;
-    MehSHA224 sha224;
-    MehSHA384 sha384;
-    MehSHA512 sha512;
-
+    meh_md5_state_t md5;
+    meh_sha1_state_t sha1;
+    meh_sha256_state_t sha256;
+    meh_sha224_state_t sha224;
+    meh_sha384_state_t sha384;
+    meh_sha512_state_t sha512;
+    meh_blake2b_state_t blake2b;
+    meh_blake2s_state_t blake2s;
+    meh_keccak_state_t keccak; /* every SHA-3 and SHAKE variant */
 } meh_hash_state_t;
 
+/* Everything that differs between hash algorithms, resolved once when a
+   context is built so the hot calls need not switch on the id. */
+typedef struct meh_hash_ops_s
+{
+    meh_hash_id id;
+
+    size_t state_size,
+           output_size,
+           block_size,
+           export_size;
+
+    void (*reset)(meh_hash_state_t*);
+    void (*update)(meh_hash_state_t*, const unsigned char*, size_t);
+    void (*finish)(meh_hash_state_t*, unsigned char*);
+    meh_error_t (*export_state)(meh_hash_state_t*, unsigned char*);
+    void (*import_state)(meh_hash_state_t*, const unsigned char*);
+
+    /* Only for hashes taking a key and digest length; NULL otherwise. */
+    meh_error_t (*configure)(meh_hash_state_t*, const unsigned char*, size_t,
+                             size_t);
+    size_t (*configured_size)(meh_hash_state_t*);
+
+    /* Only for extendable-output hashes; NULL otherwise. */
+    void (*squeeze)(meh_hash_state_t*, unsigned char*, size_t);
+
+    /* Only for hashes that can split one message over threads. */
+    meh_error_t (*update_parallel)(meh_hash_state_t*, const unsigned char*,
+                                   size_t, unsigned int);
+} meh_hash_ops_t;
+
 typedef struct meh_hash_s
 {
-    meh_hash_state_t state;
-    
+    const meh_hash_ops_t* ops;
     meh_hash_id id;
 
     size_t output_size,
            block_size;
+
+    int allocated; /* storage came from meh_get_hash */
+
+    /* Kept last so a standalone context need only be large enough for
+       its own algorithm's state; see meh_hash_context_size. */
+    meh_hash_state_t state;
 } meh_hash_t;
 
 typedef meh_hash_t* MehHash;
 
+const meh_hash_ops_t* meh_hash_ops(const meh_hash_id);
 MehHash meh_get_hash(const meh_hash_id);
+size_t meh_hash_context_size(const meh_hash_id);
+MehHash meh_init_hash(void*, size_t, const meh_hash_id);
 meh_error_t meh_reset_hash(MehHash);
+meh_error_t meh_configure_hash(MehHash, const unsigned char*, size_t, size_t);
 meh_error_t meh_update_hash(MehHash, const unsigned char*, size_t);
+meh_error_t meh_update_hash_parallel(MehHash, const unsigned char*, size_t,
+                                     unsigned int);
 meh_error_t meh_finish_hash(MehHash, unsigned char*);
+meh_error_t meh_squeeze_hash(MehHash, unsigned char*, size_t);
 void meh_destroy_hash(MehHash);
+meh_error_t meh_copy_hash(MehHash, const MehHash);
+MehHash meh_clone_hash(const MehHash);
+meh_error_t meh_export_hash(MehHash, unsigned char*);
+meh_error_t meh_import_hash(MehHash, const unsigned char*, size_t);
 meh_error_t meh_hash(meh_hash_id, const unsigned char*, size_t, unsigned char*);
+meh_error_t meh_hash_many(meh_hash_id, const unsigned char**, const size_t*,
+                          size_t, unsigned char*);
+meh_error_t meh_squeeze_many(meh_hash_id, const unsigned char**,
+                             const size_t*, size_t, unsigned char*, size_t);
+meh_error_t _meh_hash_many_prefixed(meh_hash_id, const unsigned char*,
+                                    const unsigned char**, const size_t*,
+                                    size_t, unsigned char*);
+meh_error_t _meh_hmac_chains(meh_hash_id, const meh_hash_t**,
+                             const meh_hash_t**, unsigned char*, size_t,
+                             unsigned long);
+size_t _meh_hmac_chain_width(meh_hash_id);
 meh_error_t meh_hash_file(MehHash, FILE*);
+meh_error_t meh_hash_path(MehHash, const char*);
+meh_error_t meh_hash_path_parallel(MehHash, const char*, unsigned int);
 size_t meh_hash_output_size(MehHash);
 size_t meh_hash_block_size(MehHash);
+size_t meh_hash_export_size(MehHash);
 
 #endif
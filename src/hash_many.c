@@ -0,0 +1,871 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "hash.h"
+#include "cpu.h"
+#include "bitwise.h"
+
+/* meh_hash_many: many independent messages hashed side by side, one
+   message per vector lane. */
+
+#define MEH_MANY_MAX_LANES 16
+#define MEH_MANY_MAX_WORDS 8
+
+#if MEH_HAVE_X86
+#    define MEH_MANY_N 4
+#    define MEH_MANY_ATTR __attribute__((target("sse2")))
+#    define MEH_MANY_SUFFIX x4
+#    include "hash_many_lanes.h"
+#    undef MEH_MANY_N
+#    undef MEH_MANY_ATTR
+#    undef MEH_MANY_SUFFIX
+
+#    define MEH_MANY_N 8
+#    define MEH_MANY_ATTR __attribute__((target("avx2")))
+#    define MEH_MANY_SUFFIX x8
+#    include "hash_many_lanes.h"
+#    undef MEH_MANY_N
+#    undef MEH_MANY_ATTR
+#    undef MEH_MANY_SUFFIX
+
+#    define MEH_MANY_N 16
+#    define MEH_MANY_ATTR __attribute__((target("avx512f")))
+#    define MEH_MANY_SUFFIX x16
+#    include "hash_many_lanes.h"
+#    undef MEH_MANY_N
+#    undef MEH_MANY_ATTR
+#    undef MEH_MANY_SUFFIX
+#endif
+
+typedef void (*meh_many_fn)(uint32_t*, const unsigned char* const*);
+
+/* How one hash family is padded, laid out and compressed. */
+typedef struct meh_many_alg_s
+{
+    size_t words,        /* 32-bit words of chaining state */
+           output_size;
+    int big_endian,
+        sha_ni; /* one is faster than narrow lanes given MEH_CPU_SHA */
+
+    void (*one)(uint32_t*, const unsigned char*);
+    meh_many_fn x4, x8, x16;
+} meh_many_alg_t;
+
+/* One-block compression through the ordinary context code, so the
+   scalar path keeps whatever acceleration that has. */
+static void _meh_many_one_md5(uint32_t* s, const unsigned char* block)
+{
+    meh_md5_state_t ctx;
+
+    memcpy(ctx.state, s, sizeof (ctx.state));
+    meh_process_md5(&ctx, block);
+    memcpy(s, ctx.state, sizeof (ctx.state));
+}
+
+static void _meh_many_one_sha1(uint32_t* s, const unsigned char* block)
+{
+    meh_sha1_state_t ctx;
+
+    memcpy(ctx.state, s, sizeof (ctx.state));
+    meh_process_sha1(&ctx, block);
+    memcpy(s, ctx.state, sizeof (ctx.state));
+}
+
+static void _meh_many_one_sha256(uint32_t* s, const unsigned char* block)
+{
+    meh_sha256_state_t ctx;
+
+    memcpy(ctx.state, s, sizeof (ctx.state));
+    meh_process_sha256(&ctx, block);
+    memcpy(s, ctx.state, sizeof (ctx.state));
+}
+
+#if MEH_HAVE_X86
+#    define MEH_MANY_KERNELS(name) \
+    _meh_many_##name##_x4, _meh_many_##name##_x8, _meh_many_##name##_x16
+#else
+#    define MEH_MANY_KERNELS(name) NULL, NULL, NULL
+#endif
+
+static const meh_many_alg_t meh_many_md5 =
+{
+    4, MEH_MD5_HASH_SIZE, 0, 0, _meh_many_one_md5, MEH_MANY_KERNELS(md5)
+};
+
+static const meh_many_alg_t meh_many_sha1 =
+{
+    5, MEH_SHA1_HASH_SIZE, 1, 1, _meh_many_one_sha1, MEH_MANY_KERNELS(sha1)
+};
+
+static const meh_many_alg_t meh_many_sha224 =
+{
+    8, MEH_SHA224_HASH_SIZE, 1, 1, _meh_many_one_sha256,
+    MEH_MANY_KERNELS(sha256)
+};
+
+static const meh_many_alg_t meh_many_sha256 =
+{
+    8, MEH_SHA256_HASH_SIZE, 1, 1, _meh_many_one_sha256,
+    MEH_MANY_KERNELS(sha256)
+};
+
+/* A message being fed through a lane one block at a time. */
+typedef struct meh_many_lane_s
+{
+    const unsigned char* data,
+                       * prefix; /* a block to hand out first, or NULL */
+    size_t left,  /* message bytes not yet handed out */
+           total, /* message length, counting the prefix */
+           which; /* index of the message */
+
+    unsigned int tail_blocks, /* padded final blocks; 0 until built */
+                 tail_next;
+    unsigned char tail[128];
+} meh_many_lane_t;
+
+static void _meh_many_start(meh_many_lane_t* lane, const unsigned char* prefix,
+                            const unsigned char* msg, size_t len, size_t which)
+{
+    lane->data = msg;
+    lane->prefix = prefix;
+    lane->left = len;
+    lane->total = len + ((NULL != prefix) ? 64 : 0);
+    lane->which = which;
+    lane->tail_blocks = lane->tail_next = 0;
+}
+
+/* The lane's next block, or NULL once the padding has been handed out. */
+static const unsigned char* _meh_many_next(meh_many_lane_t* lane,
+                                           int big_endian)
+{
+    const unsigned char* r;
+    unsigned char* length;
+    uint32_t hi, lo;
+
+    if (NULL != lane->prefix)
+    {
+        r = lane->prefix;
+        lane->prefix = NULL;
+        return r;
+    }
+
+    if (lane->left >= 64)
+    {
+        r = lane->data;
+        lane->data += 64;
+        lane->left -= 64;
+        return r;
+    }
+
+    if (0 == lane->tail_blocks)
+    {
+        lane->tail_blocks = (lane->left < 56) ? 1 : 2;
+        memset(lane->tail, 0, sizeof (lane->tail));
+        if (lane->left)
+            memcpy(lane->tail, lane->data, lane->left);
+        lane->tail[lane->left] = 0x80;
+
+        hi = (uint32_t)(lane->total >> 29);
+        lo = (uint32_t)(lane->total << 3);
+        length = lane->tail + 64 * lane->tail_blocks - 8;
+        if (big_endian)
+        {
+            U32TO8_BIG(length, hi, 0);
+            U32TO8_BIG(length, lo, 4);
+        }
+        else
+        {
+            U32TO8_LITTLE(length, lo, 0);
+            U32TO8_LITTLE(length, hi, 4);
+        }
+    }
+
+    if (lane->tail_next < lane->tail_blocks)
+        return lane->tail + 64 * lane->tail_next++;
+
+    return NULL;
+}
+
+static void _meh_many_output(const meh_many_alg_t* alg, const uint32_t* s,
+                             size_t stride, unsigned char* out)
+{
+    size_t i;
+
+    for (i = 0; i < alg->output_size / 4; i++)
+    {
+        if (alg->big_endian)
+            U32TO8_BIG(out, s[i * stride], 4 * i);
+        else
+            U32TO8_LITTLE(out, s[i * stride], 4 * i);
+    }
+}
+
+/* Hash msgs[first..n) with lanes-wide kernel fn; lanes the queue can no
+   longer fill are finished one block at a time. Given prefixes, message
+   i is preceded by the 64-byte block at prefixes + 64 * i. */
+static void _meh_many_run(const meh_many_alg_t* alg, const uint32_t* iv,
+                          meh_many_fn fn, size_t lanes,
+                          const unsigned char* prefixes,
+                          const unsigned char** msgs, const size_t* lens,
+                          size_t n, unsigned char* out)
+{
+    meh_many_lane_t lane[MEH_MANY_MAX_LANES];
+    const unsigned char* blocks[MEH_MANY_MAX_LANES];
+    uint32_t state[MEH_MANY_MAX_WORDS * MEH_MANY_MAX_LANES],
+             one[MEH_MANY_MAX_WORDS];
+    int busy[MEH_MANY_MAX_LANES];
+    size_t next = 0, i, j, idle;
+
+    for (i = 0; i < lanes; i++)
+        busy[i] = 0;
+
+    while (NULL != fn)
+    {
+        for (i = 0, idle = 0; i < lanes; i++)
+        {
+            blocks[i] = busy[i] ? _meh_many_next(&lane[i], alg->big_endian)
+                                : NULL;
+            if (NULL != blocks[i])
+                continue;
+
+            if (busy[i])
+                _meh_many_output(alg, state + i, lanes,
+                                 out + lane[i].which * alg->output_size);
+
+            if (next < n)
+            {
+                _meh_many_start(&lane[i],
+                                (NULL != prefixes) ? prefixes + 64 * next
+                                                   : NULL,
+                                msgs[next], lens[next], next);
+                next++;
+                for (j = 0; j < alg->words; j++)
+                    state[j * lanes + i] = iv[j];
+                blocks[i] = _meh_many_next(&lane[i], alg->big_endian);
+                busy[i] = 1;
+            }
+            else
+            {
+                busy[i] = 0;
+                idle++;
+            }
+        }
+
+        if (idle)
+            break;
+
+        fn(state, blocks);
+    }
+
+    /* The ragged end: each half-done lane carries on alone. A lane that
+       already has its next block in hand compresses that first. */
+    for (i = 0; i < lanes; i++)
+    {
+        if (!busy[i])
+            continue;
+
+        for (j = 0; j < alg->words; j++)
+            one[j] = state[j * lanes + i];
+
+        while (NULL != blocks[i])
+        {
+            alg->one(one, blocks[i]);
+            blocks[i] = _meh_many_next(&lane[i], alg->big_endian);
+        }
+
+        _meh_many_output(alg, one, 1, out + lane[i].which * alg->output_size);
+    }
+
+    /* Without a kernel, everything is the ragged end. */
+    for (; next < n; next++)
+    {
+        _meh_many_start(&lane[0],
+                        (NULL != prefixes) ? prefixes + 64 * next : NULL,
+                        msgs[next], lens[next], next);
+        memcpy(one, iv, alg->words * sizeof (uint32_t));
+
+        while (NULL != (blocks[0] = _meh_many_next(&lane[0], alg->big_endian)))
+            alg->one(one, blocks[0]);
+
+        _meh_many_output(alg, one, 1, out + next * alg->output_size);
+    }
+}
+
+/* The messages one after another through a single allocated context,
+   with digests or, given out_len, that much extendable output each. */
+static meh_error_t _meh_hash_each(meh_hash_id hash_id,
+                                  const unsigned char** msgs,
+                                  const size_t* lens, size_t n,
+                                  unsigned char* out, size_t out_len)
+{
+    MehHash h;
+    meh_error_t error = MEH_OK;
+    size_t i;
+
+    if (NULL == (h = meh_get_hash(hash_id)))
+        return meh_error("could not allocate hash context in meh_hash_many",
+                         MEH_OUT_OF_MEMORY);
+
+    for (i = 0; i < n && MEH_OK == error; i++)
+    {
+        meh_reset_hash(h);
+        if (lens[i])
+            error = meh_update_hash(h, msgs[i], lens[i]);
+        if (MEH_OK != error)
+            break;
+        if (out_len)
+            error = meh_squeeze_hash(h, out + i * out_len, out_len);
+        else
+            error = meh_finish_hash(h, out + i * h->output_size);
+    }
+
+    meh_destroy_hash(h);
+
+    return error;
+}
+
+static int _meh_many_valid(const unsigned char** msgs, const size_t* lens,
+                           size_t n, unsigned char* out)
+{
+    size_t i;
+
+    if ((NULL == msgs || NULL == lens || NULL == out) && n > 0)
+        return 0;
+
+    for (i = 0; i < n; i++)
+        if (NULL == msgs[i] && lens[i] > 0)
+            return 0;
+
+    return 1;
+}
+
+/* The lane layout of hash_id with its initial state copied to iv, or
+   NULL for a hash without lane kernels. */
+static const meh_many_alg_t* _meh_many_alg(meh_hash_id hash_id, uint32_t* iv)
+{
+    meh_hash_t ctx;
+
+    switch (hash_id)
+    {
+        case MEH_MD5:
+            meh_init_hash(&ctx, sizeof (ctx), hash_id);
+            memcpy(iv, ctx.state.md5.state, sizeof (ctx.state.md5.state));
+            return &meh_many_md5;
+        case MEH_SHA1:
+            meh_init_hash(&ctx, sizeof (ctx), hash_id);
+            memcpy(iv, ctx.state.sha1.state, sizeof (ctx.state.sha1.state));
+            return &meh_many_sha1;
+        case MEH_SHA224:
+            meh_init_hash(&ctx, sizeof (ctx), hash_id);
+            memcpy(iv, ctx.state.sha224.state, sizeof (ctx.state.sha224.state));
+            return &meh_many_sha224;
+        case MEH_SHA256:
+            meh_init_hash(&ctx, sizeof (ctx), hash_id);
+            memcpy(iv, ctx.state.sha256.state, sizeof (ctx.state.sha256.state));
+            return &meh_many_sha256;
+        default:
+            return NULL;
+    }
+}
+
+/* _meh_many_run with the widest kernel the CPU allows. */
+static void _meh_many_dispatch(const meh_many_alg_t* alg, const uint32_t* iv,
+                               const unsigned char* prefixes,
+                               const unsigned char** msgs, const size_t* lens,
+                               size_t n, unsigned char* out)
+{
+    meh_many_fn fn = NULL;
+    unsigned int features = meh_cpu_features();
+    size_t lanes = 1;
+
+    if (features & MEH_CPU_AVX512)
+    {
+        fn = alg->x16;
+        lanes = 16;
+    }
+    else if (alg->sha_ni && (features & MEH_CPU_SHA))
+    {
+        /* Hardware SHA rounds outrun 4 or 8 lanes; only 16 beat them. */
+        fn = NULL;
+    }
+    else if (features & MEH_CPU_AVX2)
+    {
+        fn = alg->x8;
+        lanes = 8;
+    }
+    else if (features & MEH_CPU_SSE2)
+    {
+        fn = alg->x4;
+        lanes = 4;
+    }
+
+    if (NULL == fn)
+        lanes = 1;
+
+    _meh_many_run(alg, iv, fn, lanes, prefixes, msgs, lens, n, out);
+}
+
+/* Hash n independent messages, writing n digests back to back to out.
+   MD5, SHA-1, SHA-224, SHA-256 and the SHA-3 family are interleaved
+   across vector lanes where the CPU allows; other hashes are done one
+   after another. */
+meh_error_t meh_hash_many(meh_hash_id hash_id, const unsigned char** msgs,
+                          const size_t* lens, size_t n, unsigned char* out)
+{
+    const meh_many_alg_t* alg;
+    meh_hash_t ctx;
+    uint32_t iv[MEH_MANY_MAX_WORDS];
+    size_t i;
+    meh_error_t error;
+
+    if (!_meh_many_valid(msgs, lens, n, out))
+        return meh_error("invalid argument passed to meh_hash_many",
+                         MEH_INVALID_ARGUMENT);
+
+    /* A state too big for the union (BLAKE3) gets a context of its own */
+    if (meh_hash_context_size(hash_id) > sizeof (ctx))
+        return _meh_hash_each(hash_id, msgs, lens, n, out, 0);
+
+    if (NULL != (alg = _meh_many_alg(hash_id, iv)))
+    {
+        _meh_many_dispatch(alg, iv, NULL, msgs, lens, n, out);
+        return MEH_OK;
+    }
+
+    if (NULL == meh_init_hash(&ctx, sizeof (ctx), hash_id))
+        return meh_error("invalid hash id passed to meh_hash_many",
+                         MEH_INVALID_HASH);
+
+    switch (hash_id)
+    {
+        case MEH_SHA3_224:
+        case MEH_SHA3_256:
+        case MEH_SHA3_384:
+        case MEH_SHA3_512:
+        case MEH_SHAKE128:
+        case MEH_SHAKE256:
+            _meh_keccak_many(&ctx.state.keccak, msgs, lens, n, out,
+                             ctx.output_size);
+            return MEH_OK;
+
+        default: /* no lane kernels; hash them in turn */
+            for (i = 0; i < n; i++)
+            {
+                meh_reset_hash(&ctx);
+                if (lens[i] &&
+                    (error = meh_update_hash(&ctx, msgs[i], lens[i])) != MEH_OK)
+                    return error;
+                meh_finish_hash(&ctx, out + i * ctx.output_size);
+            }
+            return MEH_OK;
+    }
+}
+
+/* As meh_hash_many, with message i preceded by the 64-byte block at
+   prefixes + 64 * i; HMAC's key pads go through the lanes this way.
+   Only for the hashes meh_hash_many runs on lane kernels, and
+   MEH_INVALID_HASH for the rest. */
+meh_error_t _meh_hash_many_prefixed(meh_hash_id hash_id,
+                                    const unsigned char* prefixes,
+                                    const unsigned char** msgs,
+                                    const size_t* lens, size_t n,
+                                    unsigned char* out)
+{
+    const meh_many_alg_t* alg;
+    uint32_t iv[MEH_MANY_MAX_WORDS];
+
+    if (NULL == (alg = _meh_many_alg(hash_id, iv)))
+        return MEH_INVALID_HASH;
+
+    _meh_many_dispatch(alg, iv, prefixes, msgs, lens, n, out);
+
+    return MEH_OK;
+}
+
+/* As meh_hash_many for extendable-output hashes, writing out_len bytes
+   of output per message back to back to out. SHAKE squeezes its
+   sponges side by side; BLAKE3 goes one message at a time. */
+meh_error_t meh_squeeze_many(meh_hash_id hash_id, const unsigned char** msgs,
+                             const size_t* lens, size_t n, unsigned char* out,
+                             size_t out_len)
+{
+    const meh_hash_ops_t* ops = meh_hash_ops(hash_id);
+    meh_hash_t ctx;
+
+    if (!_meh_many_valid(msgs, lens, n, out))
+        return meh_error("invalid argument passed to meh_squeeze_many",
+                         MEH_INVALID_ARGUMENT);
+
+    if (NULL == ops || NULL == ops->squeeze)
+        return meh_error("hash has no extendable output in meh_squeeze_many",
+                         MEH_INVALID_HASH);
+
+    if (0 == out_len)
+        return MEH_OK;
+
+    if (MEH_SHAKE128 != hash_id && MEH_SHAKE256 != hash_id)
+        return _meh_hash_each(hash_id, msgs, lens, n, out, out_len);
+
+    meh_init_hash(&ctx, sizeof (ctx), hash_id);
+    _meh_keccak_many(&ctx.state.keccak, msgs, lens, n, out, out_len);
+
+    return MEH_OK;
+}
+
+typedef void (*meh_chains_fn)(const void*, void*, size_t, unsigned long);
+
+/* Word j of an MD5, SHA-1 or SHA-2 context's chaining state. */
+static uint64_t _meh_chain_word(const meh_hash_t* h, size_t j)
+{
+    switch (h->id)
+    {
+        case MEH_MD5:
+            return h->state.md5.state[j];
+        case MEH_SHA1:
+            return h->state.sha1.state[j];
+        case MEH_SHA224:
+            return h->state.sha224.state[j];
+        case MEH_SHA256:
+            return h->state.sha256.state[j];
+        case MEH_SHA384:
+            return h->state.sha384.state[j];
+        default:
+            return h->state.sha512.state[j];
+    }
+}
+
+/* Element i of a word-major buffer of size-byte words. */
+static void _meh_chain_put(unsigned char* buf, size_t size, size_t i,
+                           uint64_t x)
+{
+    uint32_t y = (uint32_t)x;
+
+    if (8 == size)
+        memcpy(buf + 8 * i, &x, 8);
+    else
+        memcpy(buf + 4 * i, &y, 4);
+}
+
+static uint64_t _meh_chain_get(const unsigned char* buf, size_t size,
+                               size_t i)
+{
+    uint64_t x;
+    uint32_t y;
+
+    if (8 == size)
+    {
+        memcpy(&x, buf + 8 * i, 8);
+        return x;
+    }
+
+    memcpy(&y, buf + 4 * i, 4);
+    return y;
+}
+
+static void _meh_many_one_sha512(uint64_t* s, const unsigned char* block)
+{
+    meh_sha512_state_t ctx;
+
+    memcpy(ctx.state, s, sizeof (ctx.state));
+    meh_process_sha512(&ctx, block);
+    memcpy(s, ctx.state, sizeof (ctx.state));
+}
+
+/* One chain without lanes, as _meh_hmac_chains describes. The digest
+   stays in words between rounds: each is written into a block whose
+   padding was laid down once and the next compression starts from a
+   copy of the midstate words, with no context, buffering or
+   finishing in between. */
+static void _meh_chain_one32(const meh_many_alg_t* alg,
+                             const meh_hash_t* inner,
+                             const meh_hash_t* outer, unsigned char* t,
+                             unsigned long count)
+{
+    uint32_t ik[MEH_MANY_MAX_WORDS], ok[MEH_MANY_MAX_WORDS],
+             s[MEH_MANY_MAX_WORDS], acc[MEH_MANY_MAX_WORDS];
+    unsigned char block[64];
+    size_t j, words = alg->output_size / 4;
+    uint32_t bits = (uint32_t)(8 * (64 + alg->output_size));
+
+    for (j = 0; j < alg->words; j++)
+    {
+        ik[j] = (uint32_t)_meh_chain_word(inner, j);
+        ok[j] = (uint32_t)_meh_chain_word(outer, j);
+    }
+
+    for (j = 0; j < words; j++)
+        s[j] = acc[j] = alg->big_endian ? U8TO32_BIG(t, 4 * j)
+                                        : U8TO32_LITTLE(t, 4 * j);
+
+    memset(block, 0, sizeof (block));
+    block[alg->output_size] = 0x80;
+    if (alg->big_endian)
+        U32TO8_BIG(block, bits, 60);
+    else
+        U32TO8_LITTLE(block, bits, 56);
+
+#   define ROUND(key)                                                   \
+    do {                                                                \
+        for (j = 0; j < words; j++)                                     \
+        {                                                               \
+            if (alg->big_endian)                                        \
+                U32TO8_BIG(block, s[j], 4 * j);                         \
+            else                                                        \
+                U32TO8_LITTLE(block, s[j], 4 * j);                      \
+        }                                                               \
+        memcpy(s, key, alg->words * sizeof (uint32_t));                 \
+        alg->one(s, block);                                             \
+    } while (0)
+
+    while (count--)
+    {
+        ROUND(ik);
+        ROUND(ok);
+
+        for (j = 0; j < words; j++)
+            acc[j] ^= s[j];
+    }
+
+#   undef ROUND
+
+    _meh_many_output(alg, acc, 1, t);
+}
+
+static void _meh_chain_one64(const meh_hash_t* inner,
+                             const meh_hash_t* outer, unsigned char* t,
+                             unsigned long count)
+{
+    uint64_t ik[8], ok[8], s[8], acc[8];
+    unsigned char block[128];
+    size_t j, words = inner->output_size / 8;
+
+    for (j = 0; j < 8; j++)
+    {
+        ik[j] = _meh_chain_word(inner, j);
+        ok[j] = _meh_chain_word(outer, j);
+    }
+
+    for (j = 0; j < words; j++)
+        s[j] = acc[j] = U8TO64_BIG(t, 8 * j);
+
+    memset(block, 0, sizeof (block));
+    block[inner->output_size] = 0x80;
+    U32TO8_BIG(block, (uint32_t)(8 * (128 + inner->output_size)), 124);
+
+    while (count--)
+    {
+        for (j = 0; j < words; j++)
+            U64TO8_BIG(block, s[j], 8 * j);
+        memcpy(s, ik, sizeof (s));
+        _meh_many_one_sha512(s, block);
+
+        for (j = 0; j < words; j++)
+            U64TO8_BIG(block, s[j], 8 * j);
+        memcpy(s, ok, sizeof (s));
+        _meh_many_one_sha512(s, block);
+
+        for (j = 0; j < words; j++)
+            acc[j] ^= s[j];
+    }
+
+    for (j = 0; j < words; j++)
+        U64TO8_BIG(t, acc[j], 8 * j);
+}
+
+/* The chain kernels the CPU has for hash_id, widest first, with their
+   widths in chains. Returns how many there are; none for MD5, for
+   hashes without chains, and without x86. */
+static size_t _meh_chain_kernels(meh_hash_id hash_id, meh_chains_fn* fns,
+                                 size_t* widths)
+{
+    size_t kinds = 0;
+#if MEH_HAVE_X86
+    unsigned int features = meh_cpu_features();
+    meh_chains_fn all[3] = { NULL, NULL, NULL };
+    size_t size = 4;
+    int sha_ni = 1;
+
+    switch (hash_id)
+    {
+        case MEH_SHA1:
+            all[0] = _meh_many_chains_sha1_x16;
+            all[1] = _meh_many_chains_sha1_x8;
+            all[2] = _meh_many_chains_sha1_x4;
+            break;
+        case MEH_SHA224:
+        case MEH_SHA256:
+            all[0] = _meh_many_chains_sha256_x16;
+            all[1] = _meh_many_chains_sha256_x8;
+            all[2] = _meh_many_chains_sha256_x4;
+            break;
+        case MEH_SHA384:
+        case MEH_SHA512:
+            all[0] = _meh_many_chains_sha512_x16;
+            all[1] = _meh_many_chains_sha512_x8;
+            all[2] = _meh_many_chains_sha512_x4;
+            size = 8;
+            sha_ni = 0;
+            break;
+        default: /* MD5 chains go one at a time */
+            return 0;
+    }
+
+    /* Widest first. As in _meh_many_dispatch, hardware SHA rounds beat
+       all but the widest lanes; 64-bit words halve every width. */
+    if (features & MEH_CPU_AVX512)
+    {
+        fns[kinds] = all[0];
+        widths[kinds++] = 64 / size;
+    }
+
+    if (!(sha_ni && (features & MEH_CPU_SHA)))
+    {
+        if (features & MEH_CPU_AVX2)
+        {
+            fns[kinds] = all[1];
+            widths[kinds++] = 32 / size;
+        }
+
+        if (features & MEH_CPU_SSE2)
+        {
+            fns[kinds] = all[2];
+            widths[kinds++] = 16 / size;
+        }
+    }
+#else
+    (void)hash_id;
+    (void)fns;
+    (void)widths;
+#endif
+
+    return kinds;
+}
+
+/* How many chains _meh_hmac_chains runs in one pass of its widest
+   kernel; 1 when chains of hash_id run one at a time. */
+size_t _meh_hmac_chain_width(meh_hash_id hash_id)
+{
+    meh_chains_fn fns[3];
+    size_t widths[3];
+
+    return _meh_chain_kernels(hash_id, fns, widths) ? widths[0] : 1;
+}
+
+/* Run n PBKDF2 chains of HMAC-MD5, SHA-1 or SHA-2. Chain i keys its
+   HMACs with the midstates inner[i] and outer[i] and finds its U_1 at
+   t + i * digest size, which is replaced with U_1 ^ ... ^ U_c after
+   count = c - 1 further rounds. Batches take the widest SIMD kernel
+   they fill and a short last batch repeats its final chain in the lanes
+   left over; a lone chain, or every chain when the CPU has no kernel
+   worth using, runs on its own. MEH_INVALID_HASH, with t untouched,
+   for other hashes. */
+meh_error_t _meh_hmac_chains(meh_hash_id hash_id, const meh_hash_t** inner,
+                             const meh_hash_t** outer, unsigned char* t,
+                             size_t n, unsigned long count)
+{
+    unsigned char keys[2 * 8 * 8 * MEH_MANY_MAX_LANES],
+                  u[8 * 8 * MEH_MANY_MAX_LANES];
+    const meh_many_alg_t* alg = NULL;
+    meh_chains_fn fns[3];
+    size_t widths[3], kinds, size = 4, state_words = 8, words, lanes,
+           done, m, i, j, k, from, which;
+    meh_hash_t probe;
+    uint32_t iv[MEH_MANY_MAX_WORDS];
+    uint64_t x;
+
+    switch (hash_id)
+    {
+        case MEH_MD5:
+        case MEH_SHA1:
+        case MEH_SHA224:
+        case MEH_SHA256:
+            alg = _meh_many_alg(hash_id, iv);
+            state_words = alg->words;
+            break;
+        case MEH_SHA384:
+        case MEH_SHA512:
+            size = 8;
+            break;
+        default:
+            return MEH_INVALID_HASH;
+    }
+
+    meh_init_hash(&probe, sizeof (probe), hash_id);
+    words = probe.output_size / size;
+
+    kinds = _meh_chain_kernels(hash_id, fns, widths);
+
+    for (done = 0; done < n; done += m)
+    {
+        for (which = 0; which + 1 < kinds && widths[which] > n - done;
+             which++)
+            ;
+
+        lanes = kinds ? widths[which] : 1;
+        m = (lanes < n - done) ? lanes : n - done;
+
+        if (1 == m)
+        {
+            if (NULL != alg)
+                _meh_chain_one32(alg, inner[done], outer[done],
+                                 t + done * probe.output_size, count);
+            else
+                _meh_chain_one64(inner[done], outer[done],
+                                 t + done * probe.output_size, count);
+            continue;
+        }
+
+        for (i = 0; i < lanes; i++)
+        {
+            from = done + ((i < m) ? i : m - 1);
+
+            for (j = 0; j < state_words; j++)
+            {
+                _meh_chain_put(keys, size, j * lanes + i,
+                               _meh_chain_word(inner[from], j));
+                _meh_chain_put(keys, size, (state_words + j) * lanes + i,
+                               _meh_chain_word(outer[from], j));
+            }
+
+            for (j = 0; j < words; j++)
+            {
+                x = 0;
+                for (k = 0; k < size; k++)
+                    x = (x << 8) | t[from * probe.output_size + j * size + k];
+                _meh_chain_put(u, size, j * lanes + i, x);
+            }
+        }
+
+        fns[which](keys, u, words, count);
+
+        for (i = 0; i < m; i++)
+            for (j = 0; j < words; j++)
+            {
+                x = _meh_chain_get(u, size, j * lanes + i);
+                for (k = size; k > 0; k--, x >>= 8)
+                    t[(done + i) * probe.output_size + j * size + k - 1] =
+                        (unsigned char)x;
+            }
+    }
+
+    return MEH_OK;
+}
@@ -0,0 +1,505 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/* Multi-lane compression functions for meh_hash_many. Not a normal
+   header: hash_many.c includes it once per vector width, defining
+
+     MEH_MANY_N       lanes per vector (4, 8 or 16)
+     MEH_MANY_ATTR    function attributes, e.g. a GCC target
+     MEH_MANY_SUFFIX  appended to every name defined here
+
+   Each function advances N independent states by one block apiece.
+   States are stored word-major: word j of lane i is state[j*N + i]. */
+
+#define MEH_MANY_CAT2(a, b) a##_##b
+#define MEH_MANY_CAT(a, b) MEH_MANY_CAT2(a, b)
+#define MEH_MANY_FN(x) MEH_MANY_CAT(x, MEH_MANY_SUFFIX)
+#define V MEH_MANY_FN(meh_many_v)
+
+typedef uint32_t V __attribute__((vector_size(4 * MEH_MANY_N)));
+
+#define ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/* Every lane's block as 16 vectors of words, word t of lane k landing
+   in w[t][k]; swap is applied to each word as it is read. */
+#define GATHER(w, swap)                                                 \
+    do {                                                                \
+        for (k = 0; k < MEH_MANY_N; k++)                                \
+            for (i = 0; i < 16; i++)                                    \
+            {                                                           \
+                memcpy(&x, blocks[k] + 4 * i, 4);                       \
+                tmp[i * MEH_MANY_N + k] = swap(x);                      \
+            }                                                           \
+        for (i = 0; i < 16; i++)                                        \
+            memcpy(&(w)[i], tmp + i * MEH_MANY_N, sizeof (V));          \
+    } while (0)
+
+#define BSWAP(x) __builtin_bswap32(x)
+#define NOSWAP(x) (x)
+
+#define LOAD_STATE(v, words)                                            \
+    for (i = 0; i < (words); i++)                                       \
+        memcpy(&(v)[i], state + i * MEH_MANY_N, sizeof (V))
+
+#define STORE_STATE(v, words)                                           \
+    for (i = 0; i < (words); i++)                                       \
+        memcpy(state + i * MEH_MANY_N, &(v)[i], sizeof (V))
+
+/* One compression of the states s by the message words W, which are
+   used up as the schedule is expanded in place. */
+MEH_MANY_ATTR
+static inline void MEH_MANY_FN(_meh_many_sha256_core)(V* s, V* W)
+{
+    V a, b, c, d, e, f, g, h, t1;
+    unsigned int j;
+
+    a = s[0]; b = s[1]; c = s[2]; d = s[3];
+    e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+#   define SIGMA0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#   define SIGMA1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#   define THETA0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#   define THETA1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+#   define CH(x, y, z)  ((z) ^ ((x) & ((y) ^ (z))))
+#   define MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#   define EXPAND(t)                                                    \
+    W[t] += THETA1(W[(t + 14) & 15]) + W[(t + 9) & 15] + THETA0(W[(t + 1) & 15])
+#   define STEP(a, b, c, d, e, f, g, h, t)                               \
+    if (j) EXPAND(t);                                                   \
+    t1 = h + SIGMA1(e) + CH(e, f, g) + _meh_sha256_k[j + t] + W[t];     \
+    d += t1;                                                            \
+    h = t1 + SIGMA0(a) + MAJ(a, b, c)
+
+    for (j = 0; j < 64; j += 16)
+    {
+        STEP(a, b, c, d, e, f, g, h,  0);
+        STEP(h, a, b, c, d, e, f, g,  1);
+        STEP(g, h, a, b, c, d, e, f,  2);
+        STEP(f, g, h, a, b, c, d, e,  3);
+        STEP(e, f, g, h, a, b, c, d,  4);
+        STEP(d, e, f, g, h, a, b, c,  5);
+        STEP(c, d, e, f, g, h, a, b,  6);
+        STEP(b, c, d, e, f, g, h, a,  7);
+        STEP(a, b, c, d, e, f, g, h,  8);
+        STEP(h, a, b, c, d, e, f, g,  9);
+        STEP(g, h, a, b, c, d, e, f, 10);
+        STEP(f, g, h, a, b, c, d, e, 11);
+        STEP(e, f, g, h, a, b, c, d, 12);
+        STEP(d, e, f, g, h, a, b, c, 13);
+        STEP(c, d, e, f, g, h, a, b, 14);
+        STEP(b, c, d, e, f, g, h, a, 15);
+    }
+
+#   undef SIGMA0
+#   undef SIGMA1
+#   undef THETA0
+#   undef THETA1
+#   undef CH
+#   undef MAJ
+#   undef EXPAND
+#   undef STEP
+
+    s[0] += a; s[1] += b; s[2] += c; s[3] += d;
+    s[4] += e; s[5] += f; s[6] += g; s[7] += h;
+}
+
+MEH_MANY_ATTR
+static void MEH_MANY_FN(_meh_many_sha256)(uint32_t* state,
+                                          const unsigned char* const* blocks)
+{
+    V s[8], W[16];
+    uint32_t tmp[16 * MEH_MANY_N], x;
+    unsigned int i, k;
+
+    LOAD_STATE(s, 8);
+    GATHER(W, BSWAP);
+    MEH_MANY_FN(_meh_many_sha256_core)(s, W);
+    STORE_STATE(s, 8);
+}
+
+MEH_MANY_ATTR
+static inline void MEH_MANY_FN(_meh_many_sha1_core)(V* s, V* W)
+{
+    V a, b, c, d, e;
+
+    a = s[0]; b = s[1]; c = s[2]; d = s[3]; e = s[4];
+
+#   define F1(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#   define F2(x, y, z) ((x) ^ (y) ^ (z))
+#   define F3(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#   define X(t) (W[(t) & 15] = ROTL(W[((t) + 13) & 15] ^ W[((t) + 8) & 15] ^ \
+                                    W[((t) + 2) & 15] ^ W[(t) & 15], 1))
+#   define STEP(a, b, c, d, e, F, k, w)                                 \
+    e += ROTL(a, 5) + F(b, c, d) + k + (w);                             \
+    b = ROTL(b, 30)
+
+    STEP(a, b, c, d, e, F1, 0x5A827999, W[0]);
+    STEP(e, a, b, c, d, F1, 0x5A827999, W[1]);
+    STEP(d, e, a, b, c, F1, 0x5A827999, W[2]);
+    STEP(c, d, e, a, b, F1, 0x5A827999, W[3]);
+    STEP(b, c, d, e, a, F1, 0x5A827999, W[4]);
+    STEP(a, b, c, d, e, F1, 0x5A827999, W[5]);
+    STEP(e, a, b, c, d, F1, 0x5A827999, W[6]);
+    STEP(d, e, a, b, c, F1, 0x5A827999, W[7]);
+    STEP(c, d, e, a, b, F1, 0x5A827999, W[8]);
+    STEP(b, c, d, e, a, F1, 0x5A827999, W[9]);
+    STEP(a, b, c, d, e, F1, 0x5A827999, W[10]);
+    STEP(e, a, b, c, d, F1, 0x5A827999, W[11]);
+    STEP(d, e, a, b, c, F1, 0x5A827999, W[12]);
+    STEP(c, d, e, a, b, F1, 0x5A827999, W[13]);
+    STEP(b, c, d, e, a, F1, 0x5A827999, W[14]);
+    STEP(a, b, c, d, e, F1, 0x5A827999, W[15]);
+    STEP(e, a, b, c, d, F1, 0x5A827999, X(16));
+    STEP(d, e, a, b, c, F1, 0x5A827999, X(17));
+    STEP(c, d, e, a, b, F1, 0x5A827999, X(18));
+    STEP(b, c, d, e, a, F1, 0x5A827999, X(19));
+    STEP(a, b, c, d, e, F2, 0x6ED9EBA1, X(20));
+    STEP(e, a, b, c, d, F2, 0x6ED9EBA1, X(21));
+    STEP(d, e, a, b, c, F2, 0x6ED9EBA1, X(22));
+    STEP(c, d, e, a, b, F2, 0x6ED9EBA1, X(23));
+    STEP(b, c, d, e, a, F2, 0x6ED9EBA1, X(24));
+    STEP(a, b, c, d, e, F2, 0x6ED9EBA1, X(25));
+    STEP(e, a, b, c, d, F2, 0x6ED9EBA1, X(26));
+    STEP(d, e, a, b, c, F2, 0x6ED9EBA1, X(27));
+    STEP(c, d, e, a, b, F2, 0x6ED9EBA1, X(28));
+    STEP(b, c, d, e, a, F2, 0x6ED9EBA1, X(29));
+    STEP(a, b, c, d, e, F2, 0x6ED9EBA1, X(30));
+    STEP(e, a, b, c, d, F2, 0x6ED9EBA1, X(31));
+    STEP(d, e, a, b, c, F2, 0x6ED9EBA1, X(32));
+    STEP(c, d, e, a, b, F2, 0x6ED9EBA1, X(33));
+    STEP(b, c, d, e, a, F2, 0x6ED9EBA1, X(34));
+    STEP(a, b, c, d, e, F2, 0x6ED9EBA1, X(35));
+    STEP(e, a, b, c, d, F2, 0x6ED9EBA1, X(36));
+    STEP(d, e, a, b, c, F2, 0x6ED9EBA1, X(37));
+    STEP(c, d, e, a, b, F2, 0x6ED9EBA1, X(38));
+    STEP(b, c, d, e, a, F2, 0x6ED9EBA1, X(39));
+    STEP(a, b, c, d, e, F3, 0x8F1BBCDC, X(40));
+    STEP(e, a, b, c, d, F3, 0x8F1BBCDC, X(41));
+    STEP(d, e, a, b, c, F3, 0x8F1BBCDC, X(42));
+    STEP(c, d, e, a, b, F3, 0x8F1BBCDC, X(43));
+    STEP(b, c, d, e, a, F3, 0x8F1BBCDC, X(44));
+    STEP(a, b, c, d, e, F3, 0x8F1BBCDC, X(45));
+    STEP(e, a, b, c, d, F3, 0x8F1BBCDC, X(46));
+    STEP(d, e, a, b, c, F3, 0x8F1BBCDC, X(47));
+    STEP(c, d, e, a, b, F3, 0x8F1BBCDC, X(48));
+    STEP(b, c, d, e, a, F3, 0x8F1BBCDC, X(49));
+    STEP(a, b, c, d, e, F3, 0x8F1BBCDC, X(50));
+    STEP(e, a, b, c, d, F3, 0x8F1BBCDC, X(51));
+    STEP(d, e, a, b, c, F3, 0x8F1BBCDC, X(52));
+    STEP(c, d, e, a, b, F3, 0x8F1BBCDC, X(53));
+    STEP(b, c, d, e, a, F3, 0x8F1BBCDC, X(54));
+    STEP(a, b, c, d, e, F3, 0x8F1BBCDC, X(55));
+    STEP(e, a, b, c, d, F3, 0x8F1BBCDC, X(56));
+    STEP(d, e, a, b, c, F3, 0x8F1BBCDC, X(57));
+    STEP(c, d, e, a, b, F3, 0x8F1BBCDC, X(58));
+    STEP(b, c, d, e, a, F3, 0x8F1BBCDC, X(59));
+    STEP(a, b, c, d, e, F2, 0xCA62C1D6, X(60));
+    STEP(e, a, b, c, d, F2, 0xCA62C1D6, X(61));
+    STEP(d, e, a, b, c, F2, 0xCA62C1D6, X(62));
+    STEP(c, d, e, a, b, F2, 0xCA62C1D6, X(63));
+    STEP(b, c, d, e, a, F2, 0xCA62C1D6, X(64));
+    STEP(a, b, c, d, e, F2, 0xCA62C1D6, X(65));
+    STEP(e, a, b, c, d, F2, 0xCA62C1D6, X(66));
+    STEP(d, e, a, b, c, F2, 0xCA62C1D6, X(67));
+    STEP(c, d, e, a, b, F2, 0xCA62C1D6, X(68));
+    STEP(b, c, d, e, a, F2, 0xCA62C1D6, X(69));
+    STEP(a, b, c, d, e, F2, 0xCA62C1D6, X(70));
+    STEP(e, a, b, c, d, F2, 0xCA62C1D6, X(71));
+    STEP(d, e, a, b, c, F2, 0xCA62C1D6, X(72));
+    STEP(c, d, e, a, b, F2, 0xCA62C1D6, X(73));
+    STEP(b, c, d, e, a, F2, 0xCA62C1D6, X(74));
+    STEP(a, b, c, d, e, F2, 0xCA62C1D6, X(75));
+    STEP(e, a, b, c, d, F2, 0xCA62C1D6, X(76));
+    STEP(d, e, a, b, c, F2, 0xCA62C1D6, X(77));
+    STEP(c, d, e, a, b, F2, 0xCA62C1D6, X(78));
+    STEP(b, c, d, e, a, F2, 0xCA62C1D6, X(79));
+
+#   undef F1
+#   undef F2
+#   undef F3
+#   undef X
+#   undef STEP
+
+    s[0] += a; s[1] += b; s[2] += c; s[3] += d; s[4] += e;
+}
+
+MEH_MANY_ATTR
+static void MEH_MANY_FN(_meh_many_sha1)(uint32_t* state,
+                                        const unsigned char* const* blocks)
+{
+    V s[5], W[16];
+    uint32_t tmp[16 * MEH_MANY_N], x;
+    unsigned int i, k;
+
+    LOAD_STATE(s, 5);
+    GATHER(W, BSWAP);
+    MEH_MANY_FN(_meh_many_sha1_core)(s, W);
+    STORE_STATE(s, 5);
+}
+
+MEH_MANY_ATTR
+static void MEH_MANY_FN(_meh_many_md5)(uint32_t* state,
+                                       const unsigned char* const* blocks)
+{
+    V s[4], a, b, c, d, X[16];
+    uint32_t tmp[16 * MEH_MANY_N], x;
+    unsigned int i, k;
+
+    LOAD_STATE(s, 4);
+    GATHER(X, NOSWAP);
+
+    a = s[0]; b = s[1]; c = s[2]; d = s[3];
+
+#   define F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#   define G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+#   define H(x, y, z) ((x) ^ (y) ^ (z))
+#   define I(x, y, z) ((y) ^ ((x) | ~(z)))
+#   define STEP(f, a, b, c, d, x, r, k) \
+    a += f(b, c, d) + (x) + k; a = ROTL(a, r) + b
+
+    STEP(F, a, b, c, d, X[ 0],  7, 0xD76AA478);
+    STEP(F, d, a, b, c, X[ 1], 12, 0xE8C7B756);
+    STEP(F, c, d, a, b, X[ 2], 17, 0x242070DB);
+    STEP(F, b, c, d, a, X[ 3], 22, 0xC1BDCEEE);
+    STEP(F, a, b, c, d, X[ 4],  7, 0xF57C0FAF);
+    STEP(F, d, a, b, c, X[ 5], 12, 0x4787C62A);
+    STEP(F, c, d, a, b, X[ 6], 17, 0xA8304613);
+    STEP(F, b, c, d, a, X[ 7], 22, 0xFD469501);
+    STEP(F, a, b, c, d, X[ 8],  7, 0x698098D8);
+    STEP(F, d, a, b, c, X[ 9], 12, 0x8B44F7AF);
+    STEP(F, c, d, a, b, X[10], 17, 0xFFFF5BB1);
+    STEP(F, b, c, d, a, X[11], 22, 0x895CD7BE);
+    STEP(F, a, b, c, d, X[12],  7, 0x6B901122);
+    STEP(F, d, a, b, c, X[13], 12, 0xFD987193);
+    STEP(F, c, d, a, b, X[14], 17, 0xA679438E);
+    STEP(F, b, c, d, a, X[15], 22, 0x49B40821);
+
+    STEP(G, a, b, c, d, X[ 1],  5, 0xF61E2562);
+    STEP(G, d, a, b, c, X[ 6],  9, 0xC040B340);
+    STEP(G, c, d, a, b, X[11], 14, 0x265E5A51);
+    STEP(G, b, c, d, a, X[ 0], 20, 0xE9B6C7AA);
+    STEP(G, a, b, c, d, X[ 5],  5, 0xD62F105D);
+    STEP(G, d, a, b, c, X[10],  9, 0x02441453);
+    STEP(G, c, d, a, b, X[15], 14, 0xD8A1E681);
+    STEP(G, b, c, d, a, X[ 4], 20, 0xE7D3FBC8);
+    STEP(G, a, b, c, d, X[ 9],  5, 0x21E1CDE6);
+    STEP(G, d, a, b, c, X[14],  9, 0xC33707D6);
+    STEP(G, c, d, a, b, X[ 3], 14, 0xF4D50D87);
+    STEP(G, b, c, d, a, X[ 8], 20, 0x455A14ED);
+    STEP(G, a, b, c, d, X[13],  5, 0xA9E3E905);
+    STEP(G, d, a, b, c, X[ 2],  9, 0xFCEFA3F8);
+    STEP(G, c, d, a, b, X[ 7], 14, 0x676F02D9);
+    STEP(G, b, c, d, a, X[12], 20, 0x8D2A4C8A);
+
+    STEP(H, a, b, c, d, X[ 5],  4, 0xFFFA3942);
+    STEP(H, d, a, b, c, X[ 8], 11, 0x8771F681);
+    STEP(H, c, d, a, b, X[11], 16, 0x6D9D6122);
+    STEP(H, b, c, d, a, X[14], 23, 0xFDE5380C);
+    STEP(H, a, b, c, d, X[ 1],  4, 0xA4BEEA44);
+    STEP(H, d, a, b, c, X[ 4], 11, 0x4BDECFA9);
+    STEP(H, c, d, a, b, X[ 7], 16, 0xF6BB4B60);
+    STEP(H, b, c, d, a, X[10], 23, 0xBEBFBC70);
+    STEP(H, a, b, c, d, X[13],  4, 0x289B7EC6);
+    STEP(H, d, a, b, c, X[ 0], 11, 0xEAA127FA);
+    STEP(H, c, d, a, b, X[ 3], 16, 0xD4EF3085);
+    STEP(H, b, c, d, a, X[ 6], 23, 0x04881D05);
+    STEP(H, a, b, c, d, X[ 9],  4, 0xD9D4D039);
+    STEP(H, d, a, b, c, X[12], 11, 0xE6DB99E5);
+    STEP(H, c, d, a, b, X[15], 16, 0x1FA27CF8);
+    STEP(H, b, c, d, a, X[ 2], 23, 0xC4AC5665);
+
+    STEP(I, a, b, c, d, X[ 0],  6, 0xF4292244);
+    STEP(I, d, a, b, c, X[ 7], 10, 0x432AFF97);
+    STEP(I, c, d, a, b, X[14], 15, 0xAB9423A7);
+    STEP(I, b, c, d, a, X[ 5], 21, 0xFC93A039);
+    STEP(I, a, b, c, d, X[12],  6, 0x655B59C3);
+    STEP(I, d, a, b, c, X[ 3], 10, 0x8F0CCC92);
+    STEP(I, c, d, a, b, X[10], 15, 0xFFEFF47D);
+    STEP(I, b, c, d, a, X[ 1], 21, 0x85845DD1);
+    STEP(I, a, b, c, d, X[ 8],  6, 0x6FA87E4F);
+    STEP(I, d, a, b, c, X[15], 10, 0xFE2CE6E0);
+    STEP(I, c, d, a, b, X[ 6], 15, 0xA3014314);
+    STEP(I, b, c, d, a, X[13], 21, 0x4E0811A1);
+    STEP(I, a, b, c, d, X[ 4],  6, 0xF7537E82);
+    STEP(I, d, a, b, c, X[11], 10, 0xBD3AF235);
+    STEP(I, c, d, a, b, X[ 2], 15, 0x2AD7D2BB);
+    STEP(I, b, c, d, a, X[ 9], 21, 0xEB86D391);
+
+#   undef F
+#   undef G
+#   undef H
+#   undef I
+#   undef STEP
+
+    s[0] += a; s[1] += b; s[2] += c; s[3] += d;
+
+    STORE_STATE(s, 4);
+}
+
+/* SHA-512's words are twice as wide, so a vector holds N / 2 of them. */
+#define V64 MEH_MANY_FN(meh_many_v64)
+
+typedef uint64_t V64 __attribute__((vector_size(4 * MEH_MANY_N)));
+
+MEH_MANY_ATTR
+static inline void MEH_MANY_FN(_meh_many_sha512_core)(V64* s, V64* W)
+{
+    V64 a, b, c, d, e, f, g, h, t1;
+    unsigned int j;
+
+    a = s[0]; b = s[1]; c = s[2]; d = s[3];
+    e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+#   define SIGMA0(x) (ROTR64(x, 28) ^ ROTR64(x, 34) ^ ROTR64(x, 39))
+#   define SIGMA1(x) (ROTR64(x, 14) ^ ROTR64(x, 18) ^ ROTR64(x, 41))
+#   define THETA0(x) (ROTR64(x, 1) ^ ROTR64(x, 8) ^ ((x) >> 7))
+#   define THETA1(x) (ROTR64(x, 19) ^ ROTR64(x, 61) ^ ((x) >> 6))
+#   define CH(x, y, z)  ((z) ^ ((x) & ((y) ^ (z))))
+#   define MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#   define EXPAND(t)                                                    \
+    W[t] += THETA1(W[(t + 14) & 15]) + W[(t + 9) & 15] + THETA0(W[(t + 1) & 15])
+#   define STEP(a, b, c, d, e, f, g, h, t)                               \
+    if (j) EXPAND(t);                                                   \
+    t1 = h + SIGMA1(e) + CH(e, f, g) + _meh_sha512_k[j + t] + W[t];     \
+    d += t1;                                                            \
+    h = t1 + SIGMA0(a) + MAJ(a, b, c)
+
+    for (j = 0; j < 80; j += 16)
+    {
+        STEP(a, b, c, d, e, f, g, h,  0);
+        STEP(h, a, b, c, d, e, f, g,  1);
+        STEP(g, h, a, b, c, d, e, f,  2);
+        STEP(f, g, h, a, b, c, d, e,  3);
+        STEP(e, f, g, h, a, b, c, d,  4);
+        STEP(d, e, f, g, h, a, b, c,  5);
+        STEP(c, d, e, f, g, h, a, b,  6);
+        STEP(b, c, d, e, f, g, h, a,  7);
+        STEP(a, b, c, d, e, f, g, h,  8);
+        STEP(h, a, b, c, d, e, f, g,  9);
+        STEP(g, h, a, b, c, d, e, f, 10);
+        STEP(f, g, h, a, b, c, d, e, 11);
+        STEP(e, f, g, h, a, b, c, d, 12);
+        STEP(d, e, f, g, h, a, b, c, 13);
+        STEP(c, d, e, f, g, h, a, b, 14);
+        STEP(b, c, d, e, f, g, h, a, 15);
+    }
+
+#   undef SIGMA0
+#   undef SIGMA1
+#   undef THETA0
+#   undef THETA1
+#   undef CH
+#   undef MAJ
+#   undef EXPAND
+#   undef STEP
+
+    s[0] += a; s[1] += b; s[2] += c; s[3] += d;
+    s[4] += e; s[5] += f; s[6] += g; s[7] += h;
+}
+
+/* HMAC chains as PBKDF2 runs them, one per lane. After the first round
+   each HMAC input is the previous output, a single block whose padding
+   never changes, so the chain stays in vectors of words throughout.
+   keys holds every lane's inner then outer midstate and u its U_1 on
+   the way in and U_1 ^ ... ^ U_c on the way out, both word-major like
+   the states above; words is the digest length in words and count is
+   c - 1. */
+#define CHAINS(name, T, E, core, state_words, block)                    \
+MEH_MANY_ATTR                                                           \
+static void MEH_MANY_FN(name)(const void* keys, void* u, size_t words,  \
+                              unsigned long count)                      \
+{                                                                       \
+    const E* k = keys;                                                  \
+    E* p = u;                                                           \
+    enum { L = sizeof (T) / sizeof (E) };                               \
+    T ik[state_words], ok[state_words], s[state_words], acc[8], W[16],  \
+      zero = { 0 };                                                     \
+    size_t i;                                                           \
+                                                                        \
+    for (i = 0; i < (state_words); i++)                                 \
+    {                                                                   \
+        memcpy(&ik[i], k + i * L, sizeof (T));                          \
+        memcpy(&ok[i], k + ((state_words) + i) * L, sizeof (T));        \
+    }                                                                   \
+    for (i = 0; i < words; i++)                                         \
+    {                                                                   \
+        memcpy(&s[i], p + i * L, sizeof (T));                           \
+        acc[i] = s[i];                                                  \
+    }                                                                   \
+                                                                        \
+    /* The padding after a digest-sized message, the same every time */ \
+    W[words] = zero + ((E)1 << (8 * sizeof (E) - 1));                   \
+    for (i = words + 1; i < 15; i++)                                    \
+        W[i] = zero;                                                    \
+    W[15] = zero + (E)(8 * ((block) + words * sizeof (E)));             \
+                                                                        \
+    while (count--)                                                     \
+    {                                                                   \
+        CHAIN_STEP(ik, core, E, block);                                 \
+        CHAIN_STEP(ok, core, E, block);                                 \
+                                                                        \
+        for (i = 0; i < words; i++)                                     \
+            acc[i] ^= s[i];                                             \
+    }                                                                   \
+                                                                        \
+    for (i = 0; i < words; i++)                                         \
+        memcpy(p + i * L, &acc[i], sizeof (T));                         \
+}
+
+/* Hash the digest in s from the midstate key, leaving the result in s.
+   The compression expands the schedule in place, so every word of W
+   but the padding is rebuilt. */
+#define CHAIN_STEP(key, core, E, block)                                 \
+    do {                                                                \
+        for (i = 0; i < words; i++)                                     \
+            W[i] = s[i];                                                \
+        memcpy(s, key, sizeof (key));                                   \
+        core(s, W);                                                     \
+        W[words] = zero + ((E)1 << (8 * sizeof (E) - 1));               \
+        for (i = words + 1; i < 15; i++)                                \
+            W[i] = zero;                                                \
+        W[15] = zero + (E)(8 * ((block) + words * sizeof (E)));         \
+    } while (0)
+
+CHAINS(_meh_many_chains_sha1, V, uint32_t, MEH_MANY_FN(_meh_many_sha1_core),
+       5, 64)
+CHAINS(_meh_many_chains_sha256, V, uint32_t,
+       MEH_MANY_FN(_meh_many_sha256_core), 8, 64)
+CHAINS(_meh_many_chains_sha512, V64, uint64_t,
+       MEH_MANY_FN(_meh_many_sha512_core), 8, 128)
+
+#undef CHAINS
+#undef CHAIN_STEP
+#undef V64
+
+#undef MEH_MANY_CAT2
+#undef MEH_MANY_CAT
+#undef MEH_MANY_FN
+#undef V
+#undef ROTL
+#undef ROTR
+#undef GATHER
+#undef BSWAP
+#undef NOSWAP
+#undef LOAD_STATE
+#undef STORE_STATE
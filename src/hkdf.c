@@ -0,0 +1,227 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "hkdf.h"
+
+/* Stands in for an empty salt, secret or label given as NULL, which
+   the hash update would refuse. */
+static const unsigned char none = 0;
+
+size_t meh_hkdf_context_size(const meh_hash_id hash_id)
+{
+    return meh_hmac_context_size(hash_id) ? sizeof (meh_hkdf_state_t) : 0;
+}
+
+MehHKDF meh_get_hkdf(const meh_hash_id hash_id,
+                     const unsigned char* secret, size_t secret_len,
+                     const unsigned char* salt, size_t salt_len,
+                     const unsigned char* info, size_t info_len)
+{
+    MehHKDF r;
+    void* mem;
+    size_t size = meh_hkdf_context_size(hash_id);
+
+    if (0 == size || NULL == (mem = malloc(size)))
+        return NULL;
+
+    if (NULL == (r = meh_init_hkdf(mem, size, hash_id, secret, secret_len,
+                                   salt, salt_len, info, info_len)))
+    {
+        free(mem);
+        return NULL;
+    }
+
+    r->allocated = 1;
+
+    return r;
+}
+
+MehHKDF meh_init_hkdf(void* mem, size_t size, const meh_hash_id hash_id,
+                      const unsigned char* secret, size_t secret_len,
+                      const unsigned char* salt, size_t salt_len,
+                      const unsigned char* info, size_t info_len)
+{
+    MehHKDF r = mem;
+    size_t need = meh_hkdf_context_size(hash_id);
+
+    if (0 == need || NULL == mem || size < need || !MEH_IS_ALIGNED(mem))
+    {
+        meh_warn("invalid storage passed to meh_init_hkdf");
+        return NULL;
+    }
+
+    if (NULL == meh_init_hmac(&r->hmac, sizeof (meh_hmac_t), hash_id,
+                              &none, 0))
+        return NULL;
+
+    r->allocated = 0;
+
+    if (MEH_OK != meh_reset_hkdf(r, secret, secret_len, salt, salt_len,
+                                 info, info_len))
+        return NULL;
+
+    return r;
+}
+
+/* Extract a pseudorandom key from a new secret and salt, key the HMAC
+   with it and start expanding info. */
+meh_error_t meh_reset_hkdf(MehHKDF kdf,
+                           const unsigned char* secret, size_t secret_len,
+                           const unsigned char* salt, size_t salt_len,
+                           const unsigned char* info, size_t info_len)
+{
+    unsigned char prk[MEH_HASH_MAX_OUTPUT_SIZE];
+    meh_error_t error;
+
+    if (NULL == kdf || (NULL == secret && 0 != secret_len) ||
+        (NULL == salt && 0 != salt_len))
+        return meh_error("invalid argument passed to meh_reset_hkdf",
+                         MEH_INVALID_ARGUMENT);
+
+    /* PRK = HMAC(salt, secret). An empty salt pads out to the same key
+       as the hash length of zeros the RFC asks for. */
+    if (MEH_OK != (error = meh_reset_hmac(&kdf->hmac,
+                                          (NULL == salt) ? &none : salt,
+                                          salt_len)) ||
+        MEH_OK != (error = meh_update_hmac(&kdf->hmac,
+                                           (NULL == secret) ? &none : secret,
+                                           secret_len)) ||
+        MEH_OK != (error = meh_finish_hmac(&kdf->hmac, prk)) ||
+        MEH_OK != (error = meh_reset_hmac(&kdf->hmac, prk,
+                                          kdf->hmac.output_size)))
+    {
+        memset(prk, 0, sizeof (prk));
+        return error;
+    }
+
+    memset(prk, 0, sizeof (prk));
+
+    return meh_expand_hkdf(kdf, info, info_len);
+}
+
+/* Start the output over for another label under the same key. Only
+   the HMAC midstates are reused; nothing is keyed or allocated. */
+meh_error_t meh_expand_hkdf(MehHKDF kdf, const unsigned char* info,
+                            size_t info_len)
+{
+    if (NULL == kdf || (NULL == info && 0 != info_len))
+        return meh_error("invalid argument passed to meh_expand_hkdf",
+                         MEH_INVALID_ARGUMENT);
+
+    kdf->info = (NULL == info) ? &none : info;
+    kdf->info_len = info_len;
+    kdf->counter = 0;
+    kdf->index = kdf->hmac.output_size;
+
+    return MEH_OK;
+}
+
+/* T(i) = HMAC(PRK, T(i - 1) || info || i), with T(0) empty. */
+static meh_error_t _meh_hkdf_block(MehHKDF kdf)
+{
+    unsigned char counter;
+    meh_error_t error;
+
+    if (MEH_HKDF_MAX_BLOCKS == kdf->counter)
+        return meh_error("source exhausted in meh_update_hkdf",
+                         MEH_SOURCE_EXHAUSTED);
+
+    counter = (unsigned char)++kdf->counter;
+
+    if (MEH_OK != (error = meh_restart_hmac(&kdf->hmac)))
+        return error;
+
+    if (kdf->counter > 1 &&
+        MEH_OK != (error = meh_update_hmac(&kdf->hmac, kdf->block,
+                                           kdf->hmac.output_size)))
+        return error;
+
+    if (MEH_OK != (error = meh_update_hmac(&kdf->hmac, kdf->info,
+                                           kdf->info_len)) ||
+        MEH_OK != (error = meh_update_hmac(&kdf->hmac, &counter, 1)) ||
+        MEH_OK != (error = meh_finish_hmac(&kdf->hmac, kdf->block)))
+        return error;
+
+    kdf->index = 0;
+
+    return MEH_OK;
+}
+
+meh_error_t meh_update_hkdf(MehHKDF kdf, unsigned char* output,
+                            size_t want_len, size_t* get_len)
+{
+    meh_error_t error;
+    size_t n;
+
+    *get_len = 0;
+
+    while (*get_len < want_len)
+    {
+        if (kdf->index == kdf->hmac.output_size &&
+            MEH_OK != (error = _meh_hkdf_block(kdf)))
+            return error;
+
+        n = kdf->hmac.output_size - kdf->index;
+        if (n > want_len - *get_len)
+            n = want_len - *get_len;
+
+        memcpy(output + *get_len, kdf->block + kdf->index, n);
+        kdf->index += n;
+        *get_len += n;
+    }
+
+    return MEH_OK;
+}
+
+/* Expand n labels to out_len bytes each, written back to back. */
+meh_error_t meh_expand_many_hkdf(MehHKDF kdf, const unsigned char** infos,
+                                 const size_t* info_lens, size_t n,
+                                 unsigned char* output, size_t out_len)
+{
+    meh_error_t error;
+    size_t i, got;
+
+    if (NULL == kdf || (0 != n && (NULL == infos || NULL == info_lens ||
+                                   (NULL == output && 0 != out_len))))
+        return meh_error("invalid argument passed to meh_expand_many_hkdf",
+                         MEH_INVALID_ARGUMENT);
+
+    for (i = 0; i < n; i++, output += out_len)
+        if (MEH_OK != (error = meh_expand_hkdf(kdf, infos[i],
+                                               info_lens[i])) ||
+            MEH_OK != (error = meh_update_hkdf(kdf, output, out_len, &got)))
+            return error;
+
+    return MEH_OK;
+}
+
+void meh_destroy_hkdf(MehHKDF kdf)
+{
+    if (NULL == kdf)
+    {
+        meh_warn("invalid argument passed to meh_destroy_hkdf");
+        return;
+    }
+
+    if (kdf->allocated)
+        free(kdf);
+}
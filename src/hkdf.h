@@ -0,0 +1,70 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_HKDF_H
+#define MEH_HKDF_H
+
+#include "hmac.h"
+#include "include.h"
+
+/* Each label expands to at most 255 blocks of the hash's output. */
+#define MEH_HKDF_MAX_BLOCKS 255
+
+typedef struct meh_hkdf_state_s
+{
+    meh_hmac_t hmac; /* keyed once with the pseudorandom key */
+
+    /* The current label, referenced rather than copied: it must stay
+       valid until its output has been read. */
+    const unsigned char* info;
+    size_t info_len;
+
+    unsigned char block[MEH_HASH_MAX_OUTPUT_SIZE]; /* T(counter) */
+
+    size_t index; /* bytes of block already read */
+
+    unsigned int counter;
+
+    int allocated; /* storage came from meh_get_hkdf */
+} meh_hkdf_state_t;
+
+typedef meh_hkdf_state_t* MehHKDF;
+
+MehHKDF meh_get_hkdf(const meh_hash_id, const unsigned char*, size_t,
+                     const unsigned char*, size_t, const unsigned char*,
+                     size_t);
+size_t meh_hkdf_context_size(const meh_hash_id);
+MehHKDF meh_init_hkdf(void*, size_t, const meh_hash_id,
+                      const unsigned char*, size_t, const unsigned char*,
+                      size_t, const unsigned char*, size_t);
+meh_error_t meh_reset_hkdf(MehHKDF, const unsigned char*, size_t,
+                           const unsigned char*, size_t,
+                           const unsigned char*, size_t);
+meh_error_t meh_expand_hkdf(MehHKDF, const unsigned char*, size_t);
+meh_error_t meh_update_hkdf(MehHKDF, unsigned char*, size_t, size_t*);
+meh_error_t meh_expand_many_hkdf(MehHKDF, const unsigned char**,
+                                 const size_t*, size_t, unsigned char*,
+                                 size_t);
+#define meh_finish_hkdf(x) MEH_OK
+void meh_destroy_hkdf(MehHKDF);
+
+#endif
@@ -22,65 +22,86 @@ THE SOFTWARE.
 
 #include "hmac.h"
 
+/* The hashes are embedded by value, so only those whose state fits
+   the union (not BLAKE3, which has its own keyed mode) can be used. */
+size_t meh_hmac_context_size(const meh_hash_id hash_id)
+{
+    const meh_hash_ops_t* ops = meh_hash_ops(hash_id);
+
+    if (NULL == ops || ops->state_size > sizeof (meh_hash_state_t))
+        return 0;
+
+    return sizeof (meh_hmac_t);
+}
+
 MehHMAC meh_get_hmac(const meh_hash_id hash_id,
                      const unsigned char* key, size_t len)
 {
-    meh_error_t error;
-    MehHMAC r = malloc(sizeof (meh_hmac_t));
-    
-    if (NULL == r)
-        goto meh_get_hmac_allocation_failure;
-    
-    r->inner = meh_get_hash(hash_id);
+    MehHMAC r;
+    void* mem;
+    size_t size = meh_hmac_context_size(hash_id);
 
-    if (NULL == r->inner)
-        goto meh_get_hmac_inner_allocation_failure;
+    if (0 == size)
+    {
+        meh_warn("invalid hash id passed to meh_get_hmac");
+        return NULL;
+    }
     
-    r->outer = meh_get_hash(hash_id);
+    if (NULL == (mem = malloc(size)))
+    {
+        meh_warn("allocation failure in meh_get_hmac");
+        return NULL;
+    }
 
-    if (NULL == r->outer)
-        goto meh_get_hmac_outer_allocation_failure;
+    if (NULL == (r = meh_init_hmac(mem, size, hash_id, key, len)))
+    {
+        free(mem);
+        return NULL;
+    }
 
-    r->block_size = r->inner->block_size;
-    r->output_size = r->inner->output_size;
-    r->id = r->inner->id;
-    
-    r->opad = malloc(r->block_size);
-    
-    if (NULL == r->opad)
-        goto meh_get_hmac_opad_allocation_failure;
+    r->allocated = 1;
 
-    r->ipad = malloc(r->block_size);
+    return r;
+}
 
-    if (NULL == r->ipad)
-        goto meh_get_hmac_ipad_allocation_failure;
+MehHMAC meh_init_hmac(void* mem, size_t size, const meh_hash_id hash_id,
+                      const unsigned char* key, size_t len)
+{
+    MehHMAC r = mem;
+    size_t need = meh_hmac_context_size(hash_id);
 
-    r->tmp = malloc(r->output_size);
+    if (0 == need)
+    {
+        meh_warn("invalid hash id passed to meh_init_hmac");
+        return NULL;
+    }
 
-    if (NULL == r->tmp)
-        goto meh_get_hmac_tmp_allocation_failure;
+    if (NULL == mem || size < need || !MEH_IS_ALIGNED(mem))
+    {
+        meh_warn("invalid storage passed to meh_init_hmac");
+        return NULL;
+    }
 
-    if ((error = meh_reset_hmac(r, key, len)) != MEH_OK)
-        goto meh_get_hmac_reset_failure;
+    _meh_prepare_hmac(r, hash_id);
+    
+    if (meh_reset_hmac(r, key, len) != MEH_OK)
+        return NULL;
 
     return r;
-    
-meh_get_hmac_reset_failure:
-    free(r->tmp);
-meh_get_hmac_tmp_allocation_failure:
-    free(r->ipad);
-meh_get_hmac_ipad_allocation_failure:
-    free(r->opad);
-meh_get_hmac_opad_allocation_failure:
-    meh_destroy_hash(r->outer);
-meh_get_hmac_outer_allocation_failure:
-    meh_destroy_hash(r->inner);
-meh_get_hmac_inner_allocation_failure:
-    free(r);
-meh_get_hmac_allocation_failure:
-    meh_warn("allocation failure in meh_get_hmac");
-    return NULL;
-    
+}
+
+/* Set up the hashes of checked storage; the caller still has to key it. */
+void _meh_prepare_hmac(MehHMAC hmac, const meh_hash_id hash_id)
+{
+    meh_init_hash(&hmac->inner, sizeof (meh_hash_t), hash_id);
+    meh_init_hash(&hmac->outer, sizeof (meh_hash_t), hash_id);
+    meh_init_hash(&hmac->inner_key, sizeof (meh_hash_t), hash_id);
+    meh_init_hash(&hmac->outer_key, sizeof (meh_hash_t), hash_id);
+
+    hmac->block_size = hmac->inner.block_size;
+    hmac->output_size = hmac->inner.output_size;
+    hmac->id = hmac->inner.id;
+    hmac->allocated = 0;
 }
 
 meh_error_t meh_reset_hmac(MehHMAC hmac, const unsigned char* key, size_t len)
@@ -107,14 +128,33 @@ meh_error_t meh_reset_hmac(MehHMAC hmac, const unsigned char* key, size_t len)
         hmac->opad[i] ^= 0x5c;
     }
 
-    if ((error = meh_reset_hash(hmac->inner)) != MEH_OK)
+    /* Compress the pads once; every message under this key starts
+       from a copy of these states. */
+    if ((error = meh_reset_hash(&hmac->inner_key)) != MEH_OK)
         return error;
 
-    if ((error = meh_reset_hash(hmac->outer)) != MEH_OK)
+    if ((error = meh_reset_hash(&hmac->outer_key)) != MEH_OK)
         return error;
     
-    error = meh_update_hash(hmac->inner, hmac->ipad, hmac->block_size);
-    return error;
+    if ((error = meh_update_hash(&hmac->inner_key,
+                                 hmac->ipad, hmac->block_size)) != MEH_OK)
+        return error;
+
+    if ((error = meh_update_hash(&hmac->outer_key,
+                                 hmac->opad, hmac->block_size)) != MEH_OK)
+        return error;
+
+    return meh_restart_hmac(hmac);
+}
+
+/* Begin a new message under the current key without re-keying. */
+meh_error_t meh_restart_hmac(MehHMAC hmac)
+{
+    if (NULL == hmac)
+        return meh_error("invalid argument passed to meh_restart_hmac",
+                         MEH_INVALID_ARGUMENT);
+
+    return meh_copy_hash(&hmac->inner, &hmac->inner_key);
 }
 
 meh_error_t meh_update_hmac(MehHMAC hmac, const unsigned char* data, size_t len)
@@ -123,7 +163,7 @@ meh_error_t meh_update_hmac(MehHMAC hmac, const unsigned char* data, size_t len)
         return meh_error("invalid argument passed to meh_update_hmac",
                          MEH_INVALID_ARGUMENT);
 
-    return meh_update_hash(hmac->inner, data, len);
+    return meh_update_hash(&hmac->inner, data, len);
 }
 
 meh_error_t meh_finish_hmac(MehHMAC hmac, unsigned char* output)
@@ -134,18 +174,17 @@ meh_error_t meh_finish_hmac(MehHMAC hmac, unsigned char* output)
         return meh_error("invalid argument passed to meh_update_hmac",
                          MEH_INVALID_ARGUMENT);
     
-    if ((error = meh_finish_hash(hmac->inner, hmac->tmp)) != MEH_OK)
+    if ((error = meh_finish_hash(&hmac->inner, hmac->tmp)) != MEH_OK)
         return error;
 
-    if ((error = meh_update_hash(hmac->outer,
-                                 hmac->opad, hmac->block_size)) != MEH_OK)
+    if ((error = meh_copy_hash(&hmac->outer, &hmac->outer_key)) != MEH_OK)
         return error;
 
-    if ((error = meh_update_hash(hmac->outer,
+    if ((error = meh_update_hash(&hmac->outer,
                                  hmac->tmp, hmac->output_size)) != MEH_OK)
         return error;
 
-    if ((error = meh_finish_hash(hmac->outer, output)) != MEH_OK)
+    if ((error = meh_finish_hash(&hmac->outer, output)) != MEH_OK)
         return error;
 
     return MEH_OK;
@@ -158,13 +197,9 @@ void meh_destroy_hmac(MehHMAC hmac)
         meh_warn("invalid argument passed to meh_destroy_hmac");
         return;
     }
-    
-    free(hmac->tmp);
-    free(hmac->ipad);
-    free(hmac->opad);
-    meh_destroy_hash(hmac->outer);
-    meh_destroy_hash(hmac->inner);
-    free(hmac);
+
+    if (hmac->allocated)
+        free(hmac);
 }
 
 meh_error_t meh_hmac(const meh_hash_id hash_id, const unsigned char* data,
@@ -194,6 +229,204 @@ meh_error_t meh_hmac(const meh_hash_id hash_id, const unsigned char* data,
     return MEH_OK;
 }
 
+/* Zero len bytes of key material at p. The stores go through a
+   volatile pointer so they are kept even when p is about to go out of
+   scope or be freed. */
+void _meh_wipe(void* p, size_t len)
+{
+    volatile unsigned char* v = p;
+
+    while (len--)
+        *v++ = 0;
+}
+
+/* Items verified per round of meh_hmac_verify_many, sized so the
+   working buffers fit on the stack. */
+#define MEH_HMAC_MANY_BATCH 128
+
+/* Set bit i of results when tag i matches, compared without an early
+   exit, and count the mismatches. */
+static size_t _meh_hmac_check(const unsigned char* mac, size_t size,
+                              const unsigned char* tag, size_t i,
+                              unsigned char* results)
+{
+    unsigned int diff = 0;
+    size_t j;
+
+    for (j = 0; j < size; j++)
+        diff |= mac[j] ^ tag[j];
+
+    /* 1 when diff is 0, without a branch */
+    diff = 1 & ((diff - 1) >> 8);
+    results[i / 8] |= (unsigned char)(diff << (i % 8));
+
+    return 1 - diff;
+}
+
+/* HMAC every message under its own key one after another, reusing one
+   context on the stack. */
+static meh_error_t _meh_hmac_verify_each(const meh_hash_id hash_id,
+                                         const unsigned char** msgs,
+                                         const size_t* lens,
+                                         const unsigned char** keys,
+                                         const size_t* key_lens,
+                                         const unsigned char** tags, size_t n,
+                                         unsigned char* results,
+                                         size_t* failed)
+{
+    meh_hmac_t hmac;
+    unsigned char mac[MEH_HASH_MAX_OUTPUT_SIZE];
+    meh_error_t error = MEH_OK;
+    size_t i;
+
+    if (NULL == meh_init_hmac(&hmac, sizeof (hmac), hash_id, keys[0],
+                              key_lens[0]))
+    {
+        _meh_wipe(&hmac, sizeof (hmac));
+        return meh_error("invalid hash id passed to meh_hmac_verify_many",
+                         MEH_INVALID_HASH);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if (MEH_OK != (error = meh_reset_hmac(&hmac, keys[i], key_lens[i])) ||
+            (lens[i] &&
+             MEH_OK != (error = meh_update_hmac(&hmac, msgs[i], lens[i]))) ||
+            MEH_OK != (error = meh_finish_hmac(&hmac, mac)))
+            break;
+
+        *failed += _meh_hmac_check(mac, hmac.output_size, tags[i], i,
+                                   results);
+    }
+
+    _meh_wipe(&hmac, sizeof (hmac));
+    _meh_wipe(mac, sizeof (mac));
+
+    return error;
+}
+
+/* Check n (message, key, tag) items, where each tag is a full-length
+   HMAC of its message under its key. Bit i % 8 of results[i / 8] is set
+   when item i matches, so results needs (n + 7) / 8 bytes. Returns
+   MEH_OK when every item matches and MEH_AUTH_FAILED otherwise.
+
+   For MD5, SHA-1, SHA-224 and SHA-256 the items are interleaved across
+   vector lanes as meh_hash_many does: first every inner hash, with the
+   key's ipad block ahead of the message, then every outer hash. Other
+   hashes are done one after another. */
+meh_error_t meh_hmac_verify_many(const meh_hash_id hash_id,
+                                 const unsigned char** msgs,
+                                 const size_t* lens,
+                                 const unsigned char** keys,
+                                 const size_t* key_lens,
+                                 const unsigned char** tags, size_t n,
+                                 unsigned char* results)
+{
+    unsigned char ipads[MEH_HMAC_MANY_BATCH * 64],
+                  opads[MEH_HMAC_MANY_BATCH * 64],
+                  inner[MEH_HMAC_MANY_BATCH * MEH_HASH_MAX_OUTPUT_SIZE],
+                  outer[MEH_HMAC_MANY_BATCH * MEH_HASH_MAX_OUTPUT_SIZE],
+                  * pad;
+    const unsigned char* digests[MEH_HMAC_MANY_BATCH];
+    size_t sizes[MEH_HMAC_MANY_BATCH], first, count, size, i, j,
+           failed = 0;
+    meh_hash_t probe;
+    meh_error_t error;
+
+    if (0 == n)
+        return MEH_OK;
+
+    if (NULL == msgs || NULL == lens || NULL == keys || NULL == key_lens ||
+        NULL == tags || NULL == results)
+        return meh_error("invalid argument passed to meh_hmac_verify_many",
+                         MEH_INVALID_ARGUMENT);
+
+    for (i = 0; i < n; i++)
+        if ((NULL == msgs[i] && 0 != lens[i]) || NULL == keys[i] ||
+            NULL == tags[i])
+            return meh_error("invalid argument passed to meh_hmac_verify_many",
+                             MEH_INVALID_ARGUMENT);
+
+    memset(results, 0, (n + 7) / 8);
+
+    if (NULL == meh_init_hash(&probe, sizeof (probe), hash_id))
+        return meh_error("invalid hash id passed to meh_hmac_verify_many",
+                         MEH_INVALID_HASH);
+
+    size = probe.output_size;
+
+    /* Hashing no messages just asks whether the hash has lane kernels,
+       all of which work on 64-byte blocks */
+    if (MEH_INVALID_HASH == _meh_hash_many_prefixed(hash_id, ipads, msgs,
+                                                    lens, 0, inner))
+    {
+        error = _meh_hmac_verify_each(hash_id, msgs, lens, keys, key_lens,
+                                      tags, n, results, &failed);
+        if (MEH_OK != error)
+            return error;
+
+        return failed ? MEH_AUTH_FAILED : MEH_OK;
+    }
+
+    error = MEH_OK;
+
+    for (first = 0; first < n; first += count)
+    {
+        count = (n - first < MEH_HMAC_MANY_BATCH) ? n - first
+                                                 : MEH_HMAC_MANY_BATCH;
+
+        for (i = 0; i < count && MEH_OK == error; i++)
+        {
+            /* Long keys are hashed in the probe context, on the stack */
+            pad = ipads + 64 * i;
+            memset(pad, 0, 64);
+            if (key_lens[first + i] > 64)
+            {
+                if (MEH_OK == (error = meh_reset_hash(&probe)) &&
+                    MEH_OK == (error = meh_update_hash(&probe,
+                                                       keys[first + i],
+                                                       key_lens[first + i])))
+                    error = meh_finish_hash(&probe, pad);
+            }
+            else
+                memcpy(pad, keys[first + i], key_lens[first + i]);
+
+            for (j = 0; j < 64; j++)
+            {
+                opads[64 * i + j] = pad[j] ^ 0x5c;
+                pad[j] ^= 0x36;
+            }
+
+            digests[i] = inner + size * i;
+            sizes[i] = size;
+        }
+
+        if (MEH_OK != error)
+            break;
+
+        _meh_hash_many_prefixed(hash_id, ipads, msgs + first, lens + first,
+                                count, inner);
+        _meh_hash_many_prefixed(hash_id, opads, digests, sizes, count, outer);
+
+        for (i = 0; i < count; i++)
+            failed += _meh_hmac_check(outer + size * i, size,
+                                      tags[first + i], first + i, results);
+    }
+
+    /* The pads are the keys, outer holds the valid tags and the probe
+       may still hold a long key's hash state */
+    _meh_wipe(ipads, sizeof (ipads));
+    _meh_wipe(opads, sizeof (opads));
+    _meh_wipe(inner, sizeof (inner));
+    _meh_wipe(outer, sizeof (outer));
+    _meh_wipe(&probe, sizeof (probe));
+
+    if (MEH_OK != error)
+        return error;
+
+    return failed ? MEH_AUTH_FAILED : MEH_OK;
+}
+
 meh_error_t meh_hmac_file(MehHMAC hmac, FILE* fd)
 {
     int count;
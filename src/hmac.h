@@ -27,26 +27,43 @@ THE SOFTWARE.
 
 typedef struct meh_hmac_s
 {
-    MehHash inner, outer;
+    meh_hash_t inner, outer;
+
+    /* inner/outer states right after absorbing ipad/opad */
+    meh_hash_t inner_key, outer_key;
     
-    uint8_t* opad,
-           * ipad,
-           * tmp;
+    uint8_t opad[MEH_HASH_MAX_BLOCK_SIZE],
+            ipad[MEH_HASH_MAX_BLOCK_SIZE],
+            tmp[MEH_HASH_MAX_OUTPUT_SIZE];
     
     size_t output_size, block_size;
     
     meh_hash_id id;
+
+    int allocated; /* storage came from meh_get_hmac */
 } meh_hmac_t;
 
 typedef meh_hmac_t* MehHMAC;
 
 MehHMAC meh_get_hmac(const meh_hash_id, const unsigned char*, size_t);
+size_t meh_hmac_context_size(const meh_hash_id);
+MehHMAC meh_init_hmac(void*, size_t, const meh_hash_id,
+                      const unsigned char*, size_t);
 meh_error_t meh_reset_hmac(MehHMAC, const unsigned char*, size_t);
+meh_error_t meh_restart_hmac(MehHMAC);
 meh_error_t meh_update_hmac(MehHMAC, const unsigned char*, size_t);
 meh_error_t meh_finish_hmac(MehHMAC, unsigned char*);
 meh_error_t meh_hmac(const meh_hash_id, const unsigned char*, size_t,
                      const unsigned char*, size_t, unsigned char*);
+meh_error_t meh_hmac_verify_many(const meh_hash_id, const unsigned char**,
+                                 const size_t*, const unsigned char**,
+                                 const size_t*, const unsigned char**, size_t,
+                                 unsigned char*);
 meh_error_t meh_hmac_file(MehHMAC, FILE*);
+meh_error_t meh_hmac_path(MehHMAC, const char*);
 void meh_destroy_hmac(MehHMAC);
 
+void _meh_prepare_hmac(MehHMAC, const meh_hash_id);
+void _meh_wipe(void*, size_t);
+
 #endif
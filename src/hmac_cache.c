@@ -0,0 +1,374 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+/* pthreads are POSIX, outside what -std=c99 exposes. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "hmac_cache.h"
+#include "thread.h"
+
+#if MEH_HAVE_THREADS
+#    include <pthread.h>
+#endif
+
+typedef struct meh_hmac_entry_s
+{
+    /* the compressed inner and outer pad states, then the key */
+    unsigned char* data;
+    size_t key_len,
+           room;
+
+    uint64_t tag,    /* fingerprint of id and key, checked before key */
+             stamp;  /* cache clock at the last use */
+
+    meh_hash_id id;
+    int used;
+} meh_hmac_entry_t;
+
+struct meh_hmac_cache_s
+{
+    meh_hmac_entry_t* entries;
+    size_t sets;
+
+    uint64_t hits, misses, clock;
+
+#if MEH_HAVE_THREADS
+    pthread_mutex_t lock;
+#endif
+};
+
+static void _meh_lock_hmac_cache(MehHMACKeyCache cache)
+{
+#if MEH_HAVE_THREADS
+    pthread_mutex_lock(&cache->lock);
+#else
+    (void)cache;
+#endif
+}
+
+static void _meh_unlock_hmac_cache(MehHMACKeyCache cache)
+{
+#if MEH_HAVE_THREADS
+    pthread_mutex_unlock(&cache->lock);
+#else
+    (void)cache;
+#endif
+}
+
+/* Picks the set and screens out most mismatches before the key itself
+   is compared; it is not relied on for equality. */
+static uint64_t _meh_hmac_cache_tag(const meh_hash_id hash_id,
+                                    const unsigned char* key, size_t len)
+{
+    uint64_t h = UINT64_C(0x9E3779B97F4A7C15) ^ ((uint64_t)hash_id << 32) ^
+                 (uint64_t)len,
+             w;
+    size_t i;
+
+    for (i = 0; i + 8 <= len; i += 8)
+    {
+        memcpy(&w, key + i, 8);
+        h = (h ^ w) * UINT64_C(0xFF51AFD7ED558CCD);
+        h ^= h >> 32;
+    }
+
+    for (; i < len; i++)
+        h = (h ^ key[i]) * UINT64_C(0x100000001B3);
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xC4CEB9FE1A85EC53);
+    h ^= h >> 29;
+
+    return h;
+}
+
+static meh_hmac_entry_t* _meh_hmac_cache_set(MehHMACKeyCache cache,
+                                             uint64_t tag)
+{
+    return cache->entries + (tag % cache->sets) * MEH_HMAC_CACHE_WAYS;
+}
+
+/* Called with the lock held. */
+static meh_hmac_entry_t* _meh_hmac_cache_find(MehHMACKeyCache cache,
+                                              const meh_hash_id hash_id,
+                                              const unsigned char* key,
+                                              size_t len, uint64_t tag)
+{
+    meh_hmac_entry_t* set = _meh_hmac_cache_set(cache, tag);
+    size_t state = meh_hash_ops(hash_id)->state_size;
+    int i;
+
+    for (i = 0; i < MEH_HMAC_CACHE_WAYS; i++)
+        if (set[i].used && set[i].tag == tag && set[i].id == hash_id &&
+            set[i].key_len == len &&
+            (0 == len || 0 == memcmp(set[i].data + 2 * state, key, len)))
+            return &set[i];
+
+    return NULL;
+}
+
+/* Called with the lock held. A key that cannot be copied is simply
+   not cached. */
+static void _meh_hmac_cache_insert(MehHMACKeyCache cache, const MehHMAC hmac,
+                                   const unsigned char* key, size_t len,
+                                   uint64_t tag)
+{
+    meh_hmac_entry_t *set, *e;
+    size_t state = hmac->inner_key.ops->state_size;
+    unsigned char* room;
+    int i;
+
+    /* Another thread may have keyed the same key meanwhile. */
+    if (NULL != (e = _meh_hmac_cache_find(cache, hmac->id, key, len, tag)))
+    {
+        e->stamp = ++cache->clock;
+        return;
+    }
+
+    set = _meh_hmac_cache_set(cache, tag);
+    e = &set[0];
+
+    for (i = 0; i < MEH_HMAC_CACHE_WAYS && e->used; i++)
+        if (!set[i].used || set[i].stamp < e->stamp)
+            e = &set[i];
+
+    /* Nothing of an evicted key is left behind, in place or freed */
+    if (NULL != e->data)
+        _meh_wipe(e->data, e->room);
+    e->used = 0;
+
+    if (e->room < 2 * state + len)
+    {
+        if (NULL == (room = malloc(2 * state + len)))
+            return;
+
+        free(e->data);
+        e->data = room;
+        e->room = 2 * state + len;
+    }
+
+    memcpy(e->data, &hmac->inner_key.state, state);
+    memcpy(e->data + state, &hmac->outer_key.state, state);
+    if (len > 0)
+        memcpy(e->data + 2 * state, key, len);
+
+    e->key_len = len;
+    e->tag = tag;
+    e->id = hmac->id;
+    e->stamp = ++cache->clock;
+    e->used = 1;
+}
+
+/* A cache sized for capacity keys. Sets are kept half full on average
+   so that few keys fall into a set already holding MEH_HMAC_CACHE_WAYS
+   others and evict each other. */
+MehHMACKeyCache meh_get_hmac_cache(size_t capacity)
+{
+    MehHMACKeyCache r;
+    size_t sets = capacity / (MEH_HMAC_CACHE_WAYS / 2) + 1;
+
+    if (0 == capacity ||
+        capacity > SIZE_MAX / (4 * sizeof (meh_hmac_entry_t)))
+    {
+        meh_warn("invalid capacity passed to meh_get_hmac_cache");
+        return NULL;
+    }
+
+    if (NULL == (r = malloc(sizeof (meh_hmac_cache_t))))
+    {
+        meh_warn("allocation failure in meh_get_hmac_cache");
+        return NULL;
+    }
+
+    if (NULL == (r->entries = calloc(sets * MEH_HMAC_CACHE_WAYS,
+                                     sizeof (meh_hmac_entry_t))))
+    {
+        free(r);
+        meh_warn("allocation failure in meh_get_hmac_cache");
+        return NULL;
+    }
+
+#if MEH_HAVE_THREADS
+    if (0 != pthread_mutex_init(&r->lock, NULL))
+    {
+        free(r->entries);
+        free(r);
+        meh_warn("could not create the lock in meh_get_hmac_cache");
+        return NULL;
+    }
+#endif
+
+    r->sets = sets;
+    r->hits = r->misses = r->clock = 0;
+
+    return r;
+}
+
+MehHMAC meh_get_hmac_cached(MehHMACKeyCache cache, const meh_hash_id hash_id,
+                            const unsigned char* key, size_t len)
+{
+    MehHMAC r;
+    void* mem;
+    size_t size = meh_hmac_context_size(hash_id);
+
+    if (0 == size)
+    {
+        meh_warn("invalid hash id passed to meh_get_hmac_cached");
+        return NULL;
+    }
+
+    if (NULL == (mem = malloc(size)))
+    {
+        meh_warn("allocation failure in meh_get_hmac_cached");
+        return NULL;
+    }
+
+    if (NULL == (r = meh_init_hmac_cached(cache, mem, size, hash_id,
+                                          key, len)))
+    {
+        free(mem);
+        return NULL;
+    }
+
+    r->allocated = 1;
+
+    return r;
+}
+
+MehHMAC meh_init_hmac_cached(MehHMACKeyCache cache, void* mem, size_t size,
+                             const meh_hash_id hash_id,
+                             const unsigned char* key, size_t len)
+{
+    MehHMAC r = mem;
+    size_t need = meh_hmac_context_size(hash_id);
+
+    if (0 == need)
+    {
+        meh_warn("invalid hash id passed to meh_init_hmac_cached");
+        return NULL;
+    }
+
+    if (NULL == mem || size < need || !MEH_IS_ALIGNED(mem))
+    {
+        meh_warn("invalid storage passed to meh_init_hmac_cached");
+        return NULL;
+    }
+
+    _meh_prepare_hmac(r, hash_id);
+
+    if (meh_reset_hmac_cached(cache, r, key, len) != MEH_OK)
+        return NULL;
+
+    return r;
+}
+
+/* Same as meh_reset_hmac, taking the pad states from cache when the
+   key has been seen with this hash and leaving them there when not. */
+meh_error_t meh_reset_hmac_cached(MehHMACKeyCache cache, MehHMAC hmac,
+                                  const unsigned char* key, size_t len)
+{
+    meh_hmac_entry_t* e;
+    meh_error_t error;
+    size_t state;
+    uint64_t tag;
+
+    if (NULL == cache || NULL == hmac || NULL == key)
+        return meh_error("invalid argument passed to meh_reset_hmac_cached",
+                         MEH_INVALID_ARGUMENT);
+
+    tag = _meh_hmac_cache_tag(hmac->id, key, len);
+
+    _meh_lock_hmac_cache(cache);
+
+    if (NULL != (e = _meh_hmac_cache_find(cache, hmac->id, key, len, tag)))
+    {
+        state = hmac->inner_key.ops->state_size;
+        memcpy(&hmac->inner_key.state, e->data, state);
+        memcpy(&hmac->outer_key.state, e->data + state, state);
+        e->stamp = ++cache->clock;
+        cache->hits++;
+
+        _meh_unlock_hmac_cache(cache);
+
+        return meh_restart_hmac(hmac);
+    }
+
+    cache->misses++;
+
+    _meh_unlock_hmac_cache(cache);
+
+    /* Key outside the lock; only the copy in needs it. */
+    if ((error = meh_reset_hmac(hmac, key, len)) != MEH_OK)
+        return error;
+
+    _meh_lock_hmac_cache(cache);
+    _meh_hmac_cache_insert(cache, hmac, key, len, tag);
+    _meh_unlock_hmac_cache(cache);
+
+    return MEH_OK;
+}
+
+void meh_hmac_cache_stats(MehHMACKeyCache cache, uint64_t* hits,
+                          uint64_t* misses)
+{
+    if (NULL == cache)
+    {
+        meh_warn("invalid argument passed to meh_hmac_cache_stats");
+        return;
+    }
+
+    _meh_lock_hmac_cache(cache);
+
+    if (NULL != hits)
+        *hits = cache->hits;
+
+    if (NULL != misses)
+        *misses = cache->misses;
+
+    _meh_unlock_hmac_cache(cache);
+}
+
+void meh_destroy_hmac_cache(MehHMACKeyCache cache)
+{
+    size_t i;
+
+    if (NULL == cache)
+    {
+        meh_warn("invalid argument passed to meh_destroy_hmac_cache");
+        return;
+    }
+
+    for (i = 0; i < cache->sets * MEH_HMAC_CACHE_WAYS; i++)
+        if (NULL != cache->entries[i].data)
+        {
+            _meh_wipe(cache->entries[i].data, cache->entries[i].room);
+            free(cache->entries[i].data);
+        }
+
+#if MEH_HAVE_THREADS
+    pthread_mutex_destroy(&cache->lock);
+#endif
+
+    free(cache->entries);
+    free(cache);
+}
@@ -0,0 +1,48 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#ifndef MEH_HMAC_CACHE_H
+#define MEH_HMAC_CACHE_H
+
+#include "hmac.h"
+
+/* Entries per set; a miss replaces the least recently used of its set. */
+#define MEH_HMAC_CACHE_WAYS 8
+
+/* A bounded table of keyed pad states, shared between threads. Contexts
+   keyed through it copy the compressed ipad/opad states of a key seen
+   before instead of hashing the key and the pads again. */
+typedef struct meh_hmac_cache_s meh_hmac_cache_t;
+typedef meh_hmac_cache_t* MehHMACKeyCache;
+
+MehHMACKeyCache meh_get_hmac_cache(size_t);
+MehHMAC meh_get_hmac_cached(MehHMACKeyCache, const meh_hash_id,
+                            const unsigned char*, size_t);
+MehHMAC meh_init_hmac_cached(MehHMACKeyCache, void*, size_t,
+                             const meh_hash_id, const unsigned char*, size_t);
+meh_error_t meh_reset_hmac_cached(MehHMACKeyCache, MehHMAC,
+                                  const unsigned char*, size_t);
+void meh_hmac_cache_stats(MehHMACKeyCache, uint64_t*, uint64_t*);
+void meh_destroy_hmac_cache(MehHMACKeyCache);
+
+#endif
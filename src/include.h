@@ -24,9 +24,30 @@ THE SOFTWARE.
 #ifndef MEH_INCLUDE_H
 #    define MEH_INCLUDE_H
 
+#    include <stddef.h>
 #    include <stdint.h>
 #    include <stdio.h>
 #    include <string.h>
 #    include <stdlib.h>
 #    include <stdarg.h>
+
+/* Storage handed to the meh_init_* functions must be aligned to this. */
+typedef union meh_align_u
+{
+    uint64_t u;
+    void* p;
+    size_t s;
+} meh_align_t;
+
+typedef struct meh_align_probe_s
+{
+    char c;
+    meh_align_t a;
+} meh_align_probe_t;
+
+#    define MEH_CONTEXT_ALIGNMENT (offsetof(meh_align_probe_t, a))
+#    define MEH_ALIGN(x) \
+      (((x) + MEH_CONTEXT_ALIGNMENT - 1) & ~(MEH_CONTEXT_ALIGNMENT - 1))
+#    define MEH_IS_ALIGNED(p) \
+      (0 == ((uintptr_t)(p) & (MEH_CONTEXT_ALIGNMENT - 1)))
 #endif
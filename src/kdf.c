@@ -32,47 +32,436 @@ typedef struct meh_pbkdf2_args_s
     unsigned int iterations;
 } meh_pbkdf2_args_t;
 
-typedef union meh_kdf_args_u
+static size_t _meh_size_pbkdf2(va_list args)
+{
+    return meh_pbkdf2_context_size(va_arg(args, meh_hash_id));
+}
+
+static meh_error_t _meh_init_pbkdf2(meh_kdf_state_t* s, va_list args)
 {
     meh_pbkdf2_args_t pbkdf2;
-} meh_kdf_args_t;
+
+    pbkdf2.prf = va_arg(args, meh_hash_id);
+    pbkdf2.password = va_arg(args, unsigned char*);
+    pbkdf2.pass_len = va_arg(args, size_t);
+    pbkdf2.salt = va_arg(args, unsigned char*);
+    pbkdf2.salt_len = va_arg(args, size_t);
+    pbkdf2.iterations = va_arg(args, unsigned int);
+
+    if (NULL == meh_init_pbkdf2(&s->pbkdf2, sizeof (meh_pbkdf2_state_t),
+                                pbkdf2.prf, pbkdf2.password, pbkdf2.pass_len,
+                                pbkdf2.salt, pbkdf2.salt_len,
+                                pbkdf2.iterations))
+        return MEH_ERROR;
+
+    return MEH_OK;
+}
+
+static meh_error_t _meh_reset_pbkdf2(meh_kdf_state_t* s, va_list args)
+{
+    meh_pbkdf2_args_t pbkdf2;
+
+    pbkdf2.password = va_arg(args, unsigned char*);
+    pbkdf2.pass_len = va_arg(args, size_t);
+    pbkdf2.salt = va_arg(args, unsigned char*);
+    pbkdf2.salt_len = va_arg(args, size_t);
+    pbkdf2.iterations = va_arg(args, unsigned int);
+
+    return meh_reset_pbkdf2(&s->pbkdf2, pbkdf2.password, pbkdf2.pass_len,
+                            pbkdf2.salt, pbkdf2.salt_len, pbkdf2.iterations);
+}
+
+static meh_error_t _meh_update_pbkdf2(meh_kdf_state_t* s,
+                                      unsigned char* output,
+                                      size_t want_len, size_t* get_len)
+{
+    return meh_update_pbkdf2(&s->pbkdf2, output, want_len, get_len);
+}
+
+static meh_error_t _meh_finish_pbkdf2(meh_kdf_state_t* s)
+{
+    return meh_finish_pbkdf2(&s->pbkdf2);
+}
+
+static meh_error_t _meh_set_threads_pbkdf2(meh_kdf_state_t* s,
+                                          unsigned int threads)
+{
+    return meh_set_threads_pbkdf2(&s->pbkdf2, threads);
+}
+
+static const meh_kdf_ops_t meh_pbkdf2_ops =
+{
+    MEH_PBKDF2,
+    _meh_size_pbkdf2,
+    _meh_init_pbkdf2,
+    _meh_reset_pbkdf2,
+    _meh_update_pbkdf2,
+    _meh_finish_pbkdf2,
+    NULL,
+    NULL,
+    _meh_set_threads_pbkdf2
+};
+
+typedef struct meh_scrypt_args_s
+{
+    unsigned char* password,
+                 * salt;
+    size_t pass_len,
+           salt_len;
+    unsigned int N, r, p;
+} meh_scrypt_args_t;
+
+static void _meh_scrypt_args(meh_scrypt_args_t* scrypt, va_list args)
+{
+    scrypt->password = va_arg(args, unsigned char*);
+    scrypt->pass_len = va_arg(args, size_t);
+    scrypt->salt = va_arg(args, unsigned char*);
+    scrypt->salt_len = va_arg(args, size_t);
+    scrypt->N = va_arg(args, unsigned int);
+    scrypt->r = va_arg(args, unsigned int);
+    scrypt->p = va_arg(args, unsigned int);
+}
+
+static size_t _meh_size_scrypt(va_list args)
+{
+    (void)args;
+
+    return meh_scrypt_context_size();
+}
+
+static meh_error_t _meh_init_scrypt(meh_kdf_state_t* s, va_list args)
+{
+    meh_scrypt_args_t scrypt;
+    unsigned int threads;
+
+    _meh_scrypt_args(&scrypt, args);
+    threads = va_arg(args, unsigned int);
+
+    if (NULL == meh_init_scrypt(&s->scrypt, sizeof (meh_scrypt_state_t),
+                                scrypt.password, scrypt.pass_len,
+                                scrypt.salt, scrypt.salt_len,
+                                scrypt.N, scrypt.r, scrypt.p, threads))
+        return MEH_ERROR;
+
+    return MEH_OK;
+}
+
+static meh_error_t _meh_reset_scrypt(meh_kdf_state_t* s, va_list args)
+{
+    meh_scrypt_args_t scrypt;
+
+    _meh_scrypt_args(&scrypt, args);
+
+    return meh_reset_scrypt(&s->scrypt, scrypt.password, scrypt.pass_len,
+                            scrypt.salt, scrypt.salt_len,
+                            scrypt.N, scrypt.r, scrypt.p);
+}
+
+static meh_error_t _meh_update_scrypt(meh_kdf_state_t* s,
+                                      unsigned char* output,
+                                      size_t want_len, size_t* get_len)
+{
+    return meh_update_scrypt(&s->scrypt, output, want_len, get_len);
+}
+
+static meh_error_t _meh_finish_scrypt(meh_kdf_state_t* s)
+{
+    return meh_finish_scrypt(&s->scrypt);
+}
+
+static void _meh_destroy_scrypt(meh_kdf_state_t* s)
+{
+    meh_destroy_scrypt(&s->scrypt);
+}
+
+static const meh_kdf_ops_t meh_scrypt_ops =
+{
+    MEH_SCRYPT,
+    _meh_size_scrypt,
+    _meh_init_scrypt,
+    _meh_reset_scrypt,
+    _meh_update_scrypt,
+    _meh_finish_scrypt,
+    _meh_destroy_scrypt,
+    NULL,
+    NULL
+};
+
+typedef struct meh_argon2_args_s
+{
+    unsigned char* password,
+                 * salt;
+    size_t pass_len,
+           salt_len;
+    unsigned int passes, memory, lanes, tag_len;
+} meh_argon2_args_t;
+
+static void _meh_argon2_args(meh_argon2_args_t* argon2, va_list args)
+{
+    argon2->password = va_arg(args, unsigned char*);
+    argon2->pass_len = va_arg(args, size_t);
+    argon2->salt = va_arg(args, unsigned char*);
+    argon2->salt_len = va_arg(args, size_t);
+    argon2->passes = va_arg(args, unsigned int);
+    argon2->memory = va_arg(args, unsigned int);
+    argon2->lanes = va_arg(args, unsigned int);
+    argon2->tag_len = va_arg(args, unsigned int);
+}
+
+static size_t _meh_size_argon2id(va_list args)
+{
+    (void)args;
+
+    return meh_argon2_context_size();
+}
+
+static meh_error_t _meh_init_argon2id(meh_kdf_state_t* s, va_list args)
+{
+    meh_argon2_args_t argon2;
+    unsigned int threads;
+
+    _meh_argon2_args(&argon2, args);
+    threads = va_arg(args, unsigned int);
+
+    if (NULL == meh_init_argon2id(&s->argon2, sizeof (meh_argon2_state_t),
+                                  argon2.password, argon2.pass_len,
+                                  argon2.salt, argon2.salt_len,
+                                  argon2.passes, argon2.memory, argon2.lanes,
+                                  argon2.tag_len, threads))
+        return MEH_ERROR;
+
+    return MEH_OK;
+}
+
+static meh_error_t _meh_reset_argon2id(meh_kdf_state_t* s, va_list args)
+{
+    meh_argon2_args_t argon2;
+
+    _meh_argon2_args(&argon2, args);
+
+    return meh_reset_argon2id(&s->argon2, argon2.password, argon2.pass_len,
+                              argon2.salt, argon2.salt_len, argon2.passes,
+                              argon2.memory, argon2.lanes, argon2.tag_len);
+}
+
+static meh_error_t _meh_update_argon2id(meh_kdf_state_t* s,
+                                        unsigned char* output,
+                                        size_t want_len, size_t* get_len)
+{
+    return meh_update_argon2id(&s->argon2, output, want_len, get_len);
+}
+
+static meh_error_t _meh_finish_argon2id(meh_kdf_state_t* s)
+{
+    return meh_finish_argon2id(&s->argon2);
+}
+
+static void _meh_destroy_argon2id(meh_kdf_state_t* s)
+{
+    meh_destroy_argon2id(&s->argon2);
+}
+
+static const meh_kdf_ops_t meh_argon2id_ops =
+{
+    MEH_ARGON2ID,
+    _meh_size_argon2id,
+    _meh_init_argon2id,
+    _meh_reset_argon2id,
+    _meh_update_argon2id,
+    _meh_finish_argon2id,
+    _meh_destroy_argon2id,
+    NULL,
+    NULL
+};
+
+typedef struct meh_hkdf_args_s
+{
+    meh_hash_id prf;
+    unsigned char* secret,
+                 * salt,
+                 * info;
+    size_t secret_len,
+           salt_len,
+           info_len;
+} meh_hkdf_args_t;
+
+static void _meh_hkdf_args(meh_hkdf_args_t* hkdf, va_list args)
+{
+    hkdf->secret = va_arg(args, unsigned char*);
+    hkdf->secret_len = va_arg(args, size_t);
+    hkdf->salt = va_arg(args, unsigned char*);
+    hkdf->salt_len = va_arg(args, size_t);
+    hkdf->info = va_arg(args, unsigned char*);
+    hkdf->info_len = va_arg(args, size_t);
+}
+
+static size_t _meh_size_hkdf(va_list args)
+{
+    return meh_hkdf_context_size(va_arg(args, meh_hash_id));
+}
+
+static meh_error_t _meh_init_hkdf(meh_kdf_state_t* s, va_list args)
+{
+    meh_hkdf_args_t hkdf;
+
+    hkdf.prf = va_arg(args, meh_hash_id);
+    _meh_hkdf_args(&hkdf, args);
+
+    if (NULL == meh_init_hkdf(&s->hkdf, sizeof (meh_hkdf_state_t), hkdf.prf,
+                              hkdf.secret, hkdf.secret_len,
+                              hkdf.salt, hkdf.salt_len,
+                              hkdf.info, hkdf.info_len))
+        return MEH_ERROR;
+
+    return MEH_OK;
+}
+
+static meh_error_t _meh_reset_hkdf(meh_kdf_state_t* s, va_list args)
+{
+    meh_hkdf_args_t hkdf;
+
+    _meh_hkdf_args(&hkdf, args);
+
+    return meh_reset_hkdf(&s->hkdf, hkdf.secret, hkdf.secret_len,
+                          hkdf.salt, hkdf.salt_len,
+                          hkdf.info, hkdf.info_len);
+}
+
+static meh_error_t _meh_update_hkdf(meh_kdf_state_t* s,
+                                    unsigned char* output,
+                                    size_t want_len, size_t* get_len)
+{
+    return meh_update_hkdf(&s->hkdf, output, want_len, get_len);
+}
+
+static meh_error_t _meh_finish_hkdf(meh_kdf_state_t* s)
+{
+    return meh_finish_hkdf(&s->hkdf);
+}
+
+static meh_error_t _meh_expand_hkdf(meh_kdf_state_t* s,
+                                    const unsigned char* info,
+                                    size_t info_len)
+{
+    return meh_expand_hkdf(&s->hkdf, info, info_len);
+}
+
+static const meh_kdf_ops_t meh_hkdf_ops =
+{
+    MEH_HKDF,
+    _meh_size_hkdf,
+    _meh_init_hkdf,
+    _meh_reset_hkdf,
+    _meh_update_hkdf,
+    _meh_finish_hkdf,
+    NULL,
+    _meh_expand_hkdf,
+    NULL
+};
+
+/* The one place a KDF id is mapped to its implementation. */
+const meh_kdf_ops_t* meh_kdf_ops(const meh_kdf_id kdf_id)
+{
+    switch (kdf_id)
+    {
+        case MEH_PBKDF2: return &meh_pbkdf2_ops;
+        case MEH_SCRYPT: return &meh_scrypt_ops;
+        case MEH_ARGON2ID: return &meh_argon2id_ops;
+        case MEH_HKDF: return &meh_hkdf_ops;
+        default:
+            return NULL;
+    }
+}
+
+size_t _meh_kdf_context_size(const meh_kdf_id kdf_id, va_list args)
+{
+    const meh_kdf_ops_t* ops = meh_kdf_ops(kdf_id);
+
+    if (NULL == ops || 0 == ops->size(args))
+        return 0;
+
+    return sizeof (meh_kdf_t);
+}
+
+size_t meh_kdf_context_size(const meh_kdf_id kdf_id, ...)
+{
+    size_t r;
+    va_list args;
+
+    va_start(args, kdf_id);
+    r = _meh_kdf_context_size(kdf_id, args);
+    va_end(args);
+
+    return r;
+}
+
+MehKDF _meh_init_kdf(void* mem, size_t size, const meh_kdf_id kdf_id,
+                     va_list args)
+{
+    MehKDF r = mem;
+    va_list peek;
+    size_t need;
+
+    va_copy(peek, args);
+    need = _meh_kdf_context_size(kdf_id, peek);
+    va_end(peek);
+
+    if (0 == need || NULL == mem || size < need || !MEH_IS_ALIGNED(mem))
+    {
+        meh_warn("invalid KDF or storage passed to meh_init_kdf");
+        return NULL;
+    }
+
+    r->ops = meh_kdf_ops(kdf_id);
+    r->id = kdf_id;
+    r->allocated = 0;
+
+    return (MEH_OK == r->ops->init(&r->state, args)) ? r : NULL;
+}
+
+MehKDF meh_init_kdf(void* mem, size_t size, const meh_kdf_id kdf_id, ...)
+{
+    MehKDF r;
+    va_list args;
+
+    va_start(args, kdf_id);
+    r = _meh_init_kdf(mem, size, kdf_id, args);
+    va_end(args);
+
+    return r;
+}
 
 MehKDF _meh_get_kdf(const meh_kdf_id kdf_id, va_list args)
 {
-    meh_kdf_args_t kdf_args;
-    MehKDF r = malloc(sizeof (meh_kdf_t));
+    MehKDF r;
+    void* mem;
+    va_list peek;
+    size_t size;
 
-    if (NULL == r)
+    va_copy(peek, args);
+    size = _meh_kdf_context_size(kdf_id, peek);
+    va_end(peek);
+
+    if (0 == size)
+    {
+        meh_warn("invalid KDF id passed to _meh_get_kdf");
+        return NULL;
+    }
+
+    if (NULL == (mem = malloc(size)))
     {
         meh_warn("could not allocate KDF context in meh_get_kdf");
         return NULL;
     }
 
-    r->id = kdf_id;
-    
-    switch (kdf_id)
+    if (NULL == (r = _meh_init_kdf(mem, size, kdf_id, args)))
     {
-        case MEH_PBKDF2:
-            kdf_args.pbkdf2.prf = va_arg(args, meh_hash_id);
-            kdf_args.pbkdf2.password = va_arg(args, unsigned char*);
-            kdf_args.pbkdf2.pass_len = va_arg(args, size_t);
-            kdf_args.pbkdf2.salt = va_arg(args, unsigned char*);
-            kdf_args.pbkdf2.salt_len = va_arg(args, size_t);
-            kdf_args.pbkdf2.iterations = va_arg(args, unsigned int);
-            r->state.pbkdf2 = meh_get_pbkdf2(kdf_args.pbkdf2.prf,
-                                             kdf_args.pbkdf2.password,
-                                             kdf_args.pbkdf2.pass_len,
-                                             kdf_args.pbkdf2.salt,
-                                             kdf_args.pbkdf2.salt_len,
-                                             kdf_args.pbkdf2.iterations);
-            break;
-            
-        default: /* shouldn't happen, but just in case */
-            free(r);
-            meh_warn("invalid KDF id passed to _meh_get_kdf");
-            return NULL;
+        free(mem);
+        return NULL;
     }
 
+    r->allocated = 1;
+
     return r;
 }
 
@@ -90,31 +479,7 @@ MehKDF meh_get_kdf(const meh_kdf_id kdf_id, ...)
 
 meh_error_t _meh_reset_kdf(MehKDF kdf, va_list args)
 {
-    meh_kdf_args_t kdf_args;
-    meh_error_t error;
-    
-    switch (kdf->id)
-    {
-        case MEH_PBKDF2:
-            kdf_args.pbkdf2.password = va_arg(args, unsigned char*);
-            kdf_args.pbkdf2.pass_len = va_arg(args, size_t);
-            kdf_args.pbkdf2.salt = va_arg(args, unsigned char*);
-            kdf_args.pbkdf2.salt_len = va_arg(args, size_t);
-            kdf_args.pbkdf2.iterations = va_arg(args, unsigned int);
-            error = meh_reset_pbkdf2(kdf->state.pbkdf2,
-                                     kdf_args.pbkdf2.password,
-                                     kdf_args.pbkdf2.pass_len,
-                                     kdf_args.pbkdf2.salt,
-                                     kdf_args.pbkdf2.salt_len,
-                                     kdf_args.pbkdf2.iterations);
-            break;
-            
-        default: /* shouldn't happen, but just in case */
-            return meh_error("invalid KDF id passed to _meh_reset_kdf",
-                             MEH_INVALID_KDF);    
-    }
-
-    return error;
+    return kdf->ops->reset(&kdf->state, args);
 }
 
 meh_error_t meh_reset_kdf(MehKDF kdf, ...)
@@ -131,39 +496,71 @@ meh_error_t meh_reset_kdf(MehKDF kdf, ...)
 
 meh_error_t meh_update_kdf(MehKDF kdf, unsigned char* output,
                            size_t want_len, size_t* get_len)
+{
+    return kdf->ops->update(&kdf->state, output, want_len, get_len);
+}
+
+/* Start the output over from a new label, for KDFs that support it. */
+meh_error_t meh_expand_kdf(MehKDF kdf, const unsigned char* info,
+                           size_t info_len)
+{
+    if (NULL == kdf)
+        return meh_error("invalid argument passed to meh_expand_kdf",
+                         MEH_INVALID_ARGUMENT);
+
+    if (NULL == kdf->ops->expand)
+        return meh_error("KDF cannot expand labels in meh_expand_kdf",
+                         MEH_INVALID_KDF);
+
+    return kdf->ops->expand(&kdf->state, info, info_len);
+}
+
+/* Spread later output over up to threads threads. scrypt and Argon2
+   take their thread count when they are built. */
+meh_error_t meh_set_threads_kdf(MehKDF kdf, unsigned int threads)
+{
+    if (NULL == kdf)
+        return meh_error("invalid argument passed to meh_set_threads_kdf",
+                         MEH_INVALID_ARGUMENT);
+
+    if (NULL == kdf->ops->set_threads)
+        return meh_error("KDF threads are fixed in meh_set_threads_kdf",
+                         MEH_INVALID_KDF);
+
+    return kdf->ops->set_threads(&kdf->state, threads);
+}
+
+/* Derive out_len bytes for each of n labels under the context's key,
+   written back to back, without building a context per label. */
+meh_error_t meh_expand_many_kdf(MehKDF kdf, const unsigned char** infos,
+                                const size_t* info_lens, size_t n,
+                                unsigned char* output, size_t out_len)
 {
     meh_error_t error;
-    
-    switch (kdf->id)
-    {
-        case MEH_PBKDF2:
-            error = meh_update_pbkdf2(kdf->state.pbkdf2,
-                                      output, want_len, get_len);
-            break;
-        default: /* shouldn't happen, but just in case */
-            return meh_error("invalid KDF id passed to meh_update_kdf",
-                             MEH_INVALID_KDF);
-    }
-    
-    return error;
+    size_t i, got;
+
+    if (NULL == kdf || (0 != n && (NULL == infos || NULL == info_lens ||
+                                   (NULL == output && 0 != out_len))))
+        return meh_error("invalid argument passed to meh_expand_many_kdf",
+                         MEH_INVALID_ARGUMENT);
+
+    if (NULL == kdf->ops->expand)
+        return meh_error("KDF cannot expand labels in meh_expand_many_kdf",
+                         MEH_INVALID_KDF);
+
+    for (i = 0; i < n; i++, output += out_len)
+        if (MEH_OK != (error = kdf->ops->expand(&kdf->state, infos[i],
+                                                info_lens[i])) ||
+            MEH_OK != (error = kdf->ops->update(&kdf->state, output,
+                                                out_len, &got)))
+            return error;
+
+    return MEH_OK;
 }
 
 meh_error_t meh_finish_kdf(MehKDF kdf)
 {
-    meh_error_t error;
-    
-    switch (kdf->id)
-    {
-        case MEH_PBKDF2:
-            error = meh_finish_pbkdf2(kdf);
-            break;
-            
-        default: /* shouldn't happen, but just in case */
-            return meh_error("invalid KDF id passed to meh_finish_kdf",
-                             MEH_INVALID_KDF);
-    }
-    
-    return error;
+    return kdf->ops->finish(&kdf->state);
 }
 
 meh_error_t meh_kdf(meh_kdf_id kdf_id, ...)
@@ -209,14 +606,10 @@ void meh_destroy_kdf(MehKDF kdf)
         meh_warn("invalid argument passed to meh_destroy_kdf");
         return;
     }
-    
-    switch(kdf->id)
-    {
-        case MEH_PBKDF2:
-            meh_destroy_pbkdf2(kdf->state.pbkdf2); break;
-        default:
-            meh_warn("invalid kdf id passed to meh_destroy_kdf");
-    }
 
-    free(kdf);
+    if (NULL != kdf->ops->destroy)
+        kdf->ops->destroy(&kdf->state);
+
+    if (kdf->allocated)
+        free(kdf);
 }
@@ -26,28 +26,72 @@ THE SOFTWARE.
 #include "include.h"
 #include "error.h"
 #include "pbkdf2.h"
+#include "scrypt.h"
+#include "argon2.h"
+#include "hkdf.h"
 
 typedef enum
 {
-    MEH_PBKDF2
+    MEH_PBKDF2,
+    MEH_SCRYPT,
+    MEH_ARGON2ID,
+    MEH_HKDF
 } meh_kdf_id;
 
+/* Held by value so a context is one contiguous object. */
 typedef union meh_kdf_state_u
 {
-    MehPBKDF2 pbkdf2;
+    meh_pbkdf2_state_t pbkdf2;
+    meh_scrypt_state_t scrypt;
+    meh_argon2_state_t argon2;
+    meh_hkdf_state_t hkdf;
 } meh_kdf_state_t;
 
+/* Resolved once when a context is built. size and init take the same
+   trailing arguments as meh_get_kdf, reset those of meh_reset_kdf. */
+typedef struct meh_kdf_ops_s
+{
+    meh_kdf_id id;
+
+    size_t (*size)(va_list);
+    meh_error_t (*init)(meh_kdf_state_t*, va_list);
+    meh_error_t (*reset)(meh_kdf_state_t*, va_list);
+    meh_error_t (*update)(meh_kdf_state_t*, unsigned char*, size_t, size_t*);
+    meh_error_t (*finish)(meh_kdf_state_t*);
+
+    /* Only for KDFs holding memory outside the context; NULL otherwise. */
+    void (*destroy)(meh_kdf_state_t*);
+
+    /* Only for KDFs whose output can start over from a new label under
+       the same key (HKDF); NULL otherwise. */
+    meh_error_t (*expand)(meh_kdf_state_t*, const unsigned char*, size_t);
+
+    /* Only for KDFs whose thread count can change after they are built
+       (PBKDF2); NULL otherwise. */
+    meh_error_t (*set_threads)(meh_kdf_state_t*, unsigned int);
+} meh_kdf_ops_t;
+
 typedef struct meh_kdf_s
 {
+    const meh_kdf_ops_t* ops;
     meh_kdf_state_t state;
     meh_kdf_id id;
+
+    int allocated; /* storage came from meh_get_kdf */
 } meh_kdf_t;
 
 typedef meh_kdf_t* MehKDF;
 
+const meh_kdf_ops_t* meh_kdf_ops(const meh_kdf_id);
 MehKDF meh_get_kdf(const meh_kdf_id, ...);
+size_t meh_kdf_context_size(const meh_kdf_id, ...);
+MehKDF meh_init_kdf(void*, size_t, const meh_kdf_id, ...);
 meh_error_t meh_reset_kdf(MehKDF, ...);
 meh_error_t meh_update_kdf(MehKDF, unsigned char*, size_t, size_t*);
+meh_error_t meh_expand_kdf(MehKDF, const unsigned char*, size_t);
+meh_error_t meh_set_threads_kdf(MehKDF, unsigned int);
+meh_error_t meh_expand_many_kdf(MehKDF, const unsigned char**, const size_t*,
+                                size_t, unsigned char*, size_t);
 meh_error_t meh_finish_kdf(MehKDF);
 void meh_destroy_kdf(MehKDF);
 meh_error_t meh_kdf(const meh_kdf_id, ...);
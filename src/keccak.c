@@ -0,0 +1,511 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "keccak.h"
+#include "bitwise.h"
+#include "cpu.h"
+
+#define MEH_KECCAK_SHA3  0x06 /* domain bits and first pad bit */
+#define MEH_KECCAK_SHAKE 0x1F
+
+#define MEH_KECCAK_MAX_LANES 8 /* widest multi-state kernel */
+
+static const uint64_t RC[24] = {
+    UINT64_C(0x0000000000000001), UINT64_C(0x0000000000008082),
+    UINT64_C(0x800000000000808A), UINT64_C(0x8000000080008000),
+    UINT64_C(0x000000000000808B), UINT64_C(0x0000000080000001),
+    UINT64_C(0x8000000080008081), UINT64_C(0x8000000000008009),
+    UINT64_C(0x000000000000008A), UINT64_C(0x0000000000000088),
+    UINT64_C(0x0000000080008009), UINT64_C(0x000000008000000A),
+    UINT64_C(0x000000008000808B), UINT64_C(0x800000000000008B),
+    UINT64_C(0x8000000000008089), UINT64_C(0x8000000000008003),
+    UINT64_C(0x8000000000008002), UINT64_C(0x8000000000000080),
+    UINT64_C(0x000000000000800A), UINT64_C(0x800000008000000A),
+    UINT64_C(0x8000000080008081), UINT64_C(0x8000000000008080),
+    UINT64_C(0x0000000080000001), UINT64_C(0x8000000080008008)
+};
+
+/* The 25 lanes as named locals, row (b, g, k, m, s) then column
+   (a, e, i, o, u), so lane A##ge is word 6 of the state. */
+#define MEH_KECCAK_LANES(A)                                             \
+    A##ba, A##be, A##bi, A##bo, A##bu, A##ga, A##ge, A##gi, A##go, A##gu, \
+    A##ka, A##ke, A##ki, A##ko, A##ku, A##ma, A##me, A##mi, A##mo, A##mu, \
+    A##sa, A##se, A##si, A##so, A##su
+
+#define MEH_KECCAK_EACH(F, A)                                           \
+    F(A##ba,  0) F(A##be,  1) F(A##bi,  2) F(A##bo,  3) F(A##bu,  4)    \
+    F(A##ga,  5) F(A##ge,  6) F(A##gi,  7) F(A##go,  8) F(A##gu,  9)    \
+    F(A##ka, 10) F(A##ke, 11) F(A##ki, 12) F(A##ko, 13) F(A##ku, 14)    \
+    F(A##ma, 15) F(A##me, 16) F(A##mi, 17) F(A##mo, 18) F(A##mu, 19)    \
+    F(A##sa, 20) F(A##se, 21) F(A##si, 22) F(A##so, 23) F(A##su, 24)
+
+/* Chi over one output row, from the five rotated lanes in Ca..Cu. */
+#define MEH_KECCAK_CHI(E, row)                                          \
+    E##row##a = Ca ^ (~Ce & Ci);                                        \
+    E##row##e = Ce ^ (~Ci & Co);                                        \
+    E##row##i = Ci ^ (~Co & Cu);                                        \
+    E##row##o = Co ^ (~Cu & Ca);                                        \
+    E##row##u = Cu ^ (~Ca & Ce);
+
+/* One whole round from the lanes of A into those of E, with theta, rho
+   and pi folded into the gathering of each row for chi. */
+#define MEH_KECCAK_ROUND(A, E, rc)                                      \
+    Ca = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa;                         \
+    Ce = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se;                         \
+    Ci = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si;                         \
+    Co = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so;                         \
+    Cu = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su;                         \
+    Da = Cu ^ ROTL64(Ce, 1);                                            \
+    De = Ca ^ ROTL64(Ci, 1);                                            \
+    Di = Ce ^ ROTL64(Co, 1);                                            \
+    Do = Ci ^ ROTL64(Cu, 1);                                            \
+    Du = Co ^ ROTL64(Ca, 1);                                            \
+                                                                        \
+    Ca = A##ba ^ Da;                                                    \
+    Ce = ROTL64(A##ge ^ De, 44);                                        \
+    Ci = ROTL64(A##ki ^ Di, 43);                                        \
+    Co = ROTL64(A##mo ^ Do, 21);                                        \
+    Cu = ROTL64(A##su ^ Du, 14);                                        \
+    MEH_KECCAK_CHI(E, b)                                                \
+    E##ba ^= (rc);                                                      \
+                                                                        \
+    Ca = ROTL64(A##bo ^ Do, 28);                                        \
+    Ce = ROTL64(A##gu ^ Du, 20);                                        \
+    Ci = ROTL64(A##ka ^ Da, 3);                                         \
+    Co = ROTL64(A##me ^ De, 45);                                        \
+    Cu = ROTL64(A##si ^ Di, 61);                                        \
+    MEH_KECCAK_CHI(E, g)                                                \
+                                                                        \
+    Ca = ROTL64(A##be ^ De, 1);                                         \
+    Ce = ROTL64(A##gi ^ Di, 6);                                         \
+    Ci = ROTL64(A##ko ^ Do, 25);                                        \
+    Co = ROTL64(A##mu ^ Du, 8);                                         \
+    Cu = ROTL64(A##sa ^ Da, 18);                                        \
+    MEH_KECCAK_CHI(E, k)                                                \
+                                                                        \
+    Ca = ROTL64(A##bu ^ Du, 27);                                        \
+    Ce = ROTL64(A##ga ^ Da, 36);                                        \
+    Ci = ROTL64(A##ke ^ De, 10);                                        \
+    Co = ROTL64(A##mi ^ Di, 15);                                        \
+    Cu = ROTL64(A##so ^ Do, 56);                                        \
+    MEH_KECCAK_CHI(E, m)                                                \
+                                                                        \
+    Ca = ROTL64(A##bi ^ Di, 62);                                        \
+    Ce = ROTL64(A##go ^ Do, 55);                                        \
+    Ci = ROTL64(A##ku ^ Du, 39);                                        \
+    Co = ROTL64(A##ma ^ Da, 41);                                        \
+    Cu = ROTL64(A##se ^ De, 2);                                         \
+    MEH_KECCAK_CHI(E, s)
+
+#if MEH_HAVE_X86
+#    define MEH_KECCAK_N 4
+#    define MEH_KECCAK_ATTR __attribute__((target("avx2")))
+#    define MEH_KECCAK_SUFFIX x4
+#    include "keccak_lanes.h"
+#    undef MEH_KECCAK_N
+#    undef MEH_KECCAK_ATTR
+#    undef MEH_KECCAK_SUFFIX
+
+#    define MEH_KECCAK_N 8
+#    define MEH_KECCAK_ATTR __attribute__((target("avx512f")))
+#    define MEH_KECCAK_SUFFIX x8
+#    include "keccak_lanes.h"
+#    undef MEH_KECCAK_N
+#    undef MEH_KECCAK_ATTR
+#    undef MEH_KECCAK_SUFFIX
+#endif
+
+#define LOAD(x, i) x = s[i];
+#define STORE(x, i) s[i] = x;
+
+void meh_keccak_f1600(uint64_t* s)
+{
+    uint64_t MEH_KECCAK_LANES(A), MEH_KECCAK_LANES(E),
+             Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+    unsigned int r;
+
+    MEH_KECCAK_EACH(LOAD, A)
+
+    for (r = 0; r < 24; r += 2)
+    {
+        MEH_KECCAK_ROUND(A, E, RC[r])
+        MEH_KECCAK_ROUND(E, A, RC[r + 1])
+    }
+
+    MEH_KECCAK_EACH(STORE, A)
+}
+
+#undef STORE
+#undef LOAD
+
+/* XOR words whole little-endian words of block into a state whose
+   words are stride apart. */
+static void _meh_keccak_xor(uint64_t* s, size_t stride,
+                            const unsigned char* block, size_t words)
+{
+    size_t i;
+
+    for (i = 0; i < words; i++)
+        s[i * stride] ^= U8TO64_LITTLE(block, 8 * i);
+}
+
+/* len bytes of the state, from byte offset on. */
+static void _meh_keccak_extract(const uint64_t* s, size_t stride,
+                                size_t offset, unsigned char* output,
+                                size_t len)
+{
+    uint64_t w;
+
+    for (; len > 0 && offset % 8; len--, offset++)
+        *output++ = (unsigned char)(s[offset / 8 * stride] >>
+                                    (8 * (offset % 8)));
+
+    for (; len >= 8; len -= 8, offset += 8, output += 8)
+    {
+        w = s[offset / 8 * stride];
+        U64TO8_LITTLE(output, w, 0);
+    }
+
+    for (; len > 0; len--, offset++)
+        *output++ = (unsigned char)(s[offset / 8 * stride] >>
+                                    (8 * (offset % 8)));
+}
+
+static void _meh_keccak_start(MehKeccak ctx, uint32_t rate, uint32_t suffix,
+                              uint32_t hash_size)
+{
+    ctx->rate = rate;
+    ctx->suffix = suffix;
+    ctx->hash_size = hash_size;
+
+    meh_reset_keccak(ctx);
+}
+
+#define MEH_KECCAK_VARIANT(name, NAME, suffix)                          \
+    MehKeccak meh_get_##name(void)                                      \
+    {                                                                   \
+        MehKeccak r = malloc(sizeof (meh_keccak_state_t));              \
+                                                                        \
+        if (NULL == r)                                                  \
+        {                                                               \
+            meh_warn("could not allocate hash context in meh_get_"      \
+                     #name);                                            \
+            return NULL;                                                \
+        }                                                               \
+                                                                        \
+        meh_reset_##name(r);                                            \
+                                                                        \
+        return r;                                                       \
+    }                                                                   \
+    void meh_reset_##name(MehKeccak ctx)                                \
+    {                                                                   \
+        _meh_keccak_start(ctx, MEH_##NAME##_BLOCK_SIZE, suffix,         \
+                          MEH_##NAME##_HASH_SIZE);                      \
+    }
+
+MEH_KECCAK_VARIANT(sha3_224, SHA3_224, MEH_KECCAK_SHA3)
+MEH_KECCAK_VARIANT(sha3_256, SHA3_256, MEH_KECCAK_SHA3)
+MEH_KECCAK_VARIANT(sha3_384, SHA3_384, MEH_KECCAK_SHA3)
+MEH_KECCAK_VARIANT(sha3_512, SHA3_512, MEH_KECCAK_SHA3)
+MEH_KECCAK_VARIANT(shake128, SHAKE128, MEH_KECCAK_SHAKE)
+MEH_KECCAK_VARIANT(shake256, SHAKE256, MEH_KECCAK_SHAKE)
+
+/* Start over as the same variant. */
+void meh_reset_keccak(MehKeccak ctx)
+{
+    memset(ctx->state, 0, sizeof (ctx->state));
+
+    ctx->length = 0;
+    ctx->squeezing = 0;
+}
+
+void meh_update_keccak(MehKeccak ctx, const unsigned char* input, size_t len)
+{
+    for (; len > 0 && ctx->length > 0; len--)
+    {
+        ctx->state[ctx->length / 8] ^= (uint64_t)*input++ <<
+                                       (8 * (ctx->length % 8));
+
+        if (++ctx->length == ctx->rate)
+        {
+            meh_keccak_f1600(ctx->state);
+            ctx->length = 0;
+        }
+    }
+
+    for (; len >= ctx->rate; len -= ctx->rate, input += ctx->rate)
+    {
+        _meh_keccak_xor(ctx->state, 1, input, ctx->rate / 8);
+        meh_keccak_f1600(ctx->state);
+    }
+
+    for (; len > 0; len--, ctx->length++)
+        ctx->state[ctx->length / 8] ^= (uint64_t)*input++ <<
+                                       (8 * (ctx->length % 8));
+}
+
+static void _meh_keccak_pad(uint64_t* s, uint32_t length, uint32_t rate,
+                            uint32_t suffix)
+{
+    s[length / 8] ^= (uint64_t)suffix << (8 * (length % 8));
+    s[(rate - 1) / 8] ^= (uint64_t)0x80 << (8 * ((rate - 1) % 8));
+
+    meh_keccak_f1600(s);
+}
+
+/* The first hash_size bytes of output. This leaves the context as it
+   was, so more input or meh_squeeze_keccak can follow. */
+void meh_finish_keccak(MehKeccak ctx, unsigned char* output)
+{
+    uint64_t s[25];
+
+    memcpy(s, ctx->state, sizeof (s));
+    _meh_keccak_pad(s, ctx->length, ctx->rate, ctx->suffix);
+    _meh_keccak_extract(s, 1, 0, output, ctx->hash_size);
+}
+
+/* The next len bytes of output from SHAKE. The first call ends the
+   input; further updates need a reset first. */
+void meh_squeeze_keccak(MehKeccak ctx, unsigned char* output, size_t len)
+{
+    size_t take;
+
+    if (!ctx->squeezing)
+    {
+        _meh_keccak_pad(ctx->state, ctx->length, ctx->rate, ctx->suffix);
+        ctx->squeezing = 1;
+        ctx->length = 0;
+    }
+
+    while (len > 0)
+    {
+        if (ctx->length == ctx->rate)
+        {
+            meh_keccak_f1600(ctx->state);
+            ctx->length = 0;
+        }
+
+        take = ctx->rate - ctx->length;
+        if (take > len)
+            take = len;
+
+        _meh_keccak_extract(ctx->state, 1, ctx->length, output, take);
+
+        output += take;
+        len -= take;
+        ctx->length += (uint32_t)take;
+    }
+}
+
+void meh_export_keccak(MehKeccak ctx, unsigned char* output)
+{
+    int i;
+
+    for (i = 0; i < 25; i++)
+        U64TO8_LITTLE(output, ctx->state[i], 8*i);
+
+    U32TO8_LITTLE(output, ctx->length, 200);
+    U32TO8_LITTLE(output, ctx->squeezing, 204);
+}
+
+void meh_import_keccak(MehKeccak ctx, const unsigned char* input)
+{
+    int i;
+
+    for (i = 0; i < 25; i++)
+        ctx->state[i] = U8TO64_LITTLE(input, 8*i);
+
+    ctx->length = U8TO32_LITTLE(input, 200);
+    ctx->squeezing = (0 != U8TO32_LITTLE(input, 204));
+
+    /* Keep a damaged state from reaching past the block. Only a sponge
+       being squeezed may have used all of it. */
+    if (ctx->length > ctx->rate ||
+        (ctx->length == ctx->rate && !ctx->squeezing))
+        ctx->length = 0;
+}
+
+typedef void (*meh_keccak_lanes_fn)(uint64_t*);
+
+/* A message going through one sponge of _meh_keccak_many. */
+typedef struct meh_keccak_lane_s
+{
+    const unsigned char* data;
+    unsigned char* output;
+    size_t left,   /* message bytes not yet absorbed */
+           wanted; /* output bytes not yet written */
+    int absorbed;
+} meh_keccak_lane_t;
+
+static void _meh_keccak_lane_start(meh_keccak_lane_t* lane,
+                                   const unsigned char* msg, size_t len,
+                                   unsigned char* output, size_t out_len)
+{
+    lane->data = msg;
+    lane->left = len;
+    lane->output = output;
+    lane->wanted = out_len;
+    lane->absorbed = 0;
+}
+
+/* Before a permutation: the lane's next block, padded if it is the
+   last. Nothing once the lane is being squeezed. */
+static void _meh_keccak_lane_in(meh_keccak_lane_t* lane, uint64_t* s,
+                                size_t stride,
+                                const meh_keccak_state_t* proto)
+{
+    unsigned char tail[MEH_SHAKE128_BLOCK_SIZE];
+
+    if (lane->absorbed)
+        return;
+
+    if (lane->left >= proto->rate)
+    {
+        _meh_keccak_xor(s, stride, lane->data, proto->rate / 8);
+        lane->data += proto->rate;
+        lane->left -= proto->rate;
+        return;
+    }
+
+    memset(tail, 0, proto->rate);
+    if (lane->left)
+        memcpy(tail, lane->data, lane->left);
+    tail[lane->left] ^= (unsigned char)proto->suffix;
+    tail[proto->rate - 1] ^= 0x80;
+
+    _meh_keccak_xor(s, stride, tail, proto->rate / 8);
+    lane->absorbed = 1;
+}
+
+/* After a permutation: output, once the whole message is in. */
+static void _meh_keccak_lane_out(meh_keccak_lane_t* lane, const uint64_t* s,
+                                 size_t stride,
+                                 const meh_keccak_state_t* proto)
+{
+    size_t take;
+
+    if (!lane->absorbed)
+        return;
+
+    take = (lane->wanted < proto->rate) ? lane->wanted : proto->rate;
+    _meh_keccak_extract(s, stride, 0, lane->output, take);
+    lane->output += take;
+    lane->wanted -= take;
+}
+
+/* The rest of a lane's sponge, one permutation at a time. */
+static void _meh_keccak_lane_finish(meh_keccak_lane_t* lane, uint64_t* s,
+                                    const meh_keccak_state_t* proto)
+{
+    while (lane->wanted > 0)
+    {
+        _meh_keccak_lane_in(lane, s, 1, proto);
+        meh_keccak_f1600(s);
+        _meh_keccak_lane_out(lane, s, 1, proto);
+    }
+}
+
+void _meh_keccak_many(const meh_keccak_state_t* proto,
+                      const unsigned char** msgs, const size_t* lens,
+                      size_t n, unsigned char* output, size_t out_len)
+{
+    uint64_t state[25 * MEH_KECCAK_MAX_LANES], one[25];
+    meh_keccak_lane_t lane[MEH_KECCAK_MAX_LANES];
+    meh_keccak_lanes_fn fn = NULL;
+    int busy[MEH_KECCAK_MAX_LANES];
+    size_t lanes = 1, next = 0, i, j, idle;
+
+    if (0 == out_len)
+        return;
+
+#if MEH_HAVE_X86
+    if (meh_cpu_features() & MEH_CPU_AVX512)
+    {
+        fn = _meh_keccak_f1600_x8;
+        lanes = 8;
+    }
+    else if (meh_cpu_features() & MEH_CPU_AVX2)
+    {
+        fn = _meh_keccak_f1600_x4;
+        lanes = 4;
+    }
+#endif
+
+    for (i = 0; i < lanes; i++)
+        busy[i] = 0;
+
+    while (NULL != fn)
+    {
+        /* Refill finished lanes; stop once one can't be refilled. */
+        for (i = 0, idle = 0; i < lanes; i++)
+        {
+            if (busy[i] && lane[i].wanted > 0)
+                continue;
+
+            if (next < n)
+            {
+                _meh_keccak_lane_start(&lane[i], msgs[next], lens[next],
+                                       output + next * out_len, out_len);
+                next++;
+                for (j = 0; j < 25; j++)
+                    state[j * lanes + i] = 0;
+                busy[i] = 1;
+            }
+            else
+            {
+                busy[i] = 0;
+                idle++;
+            }
+        }
+
+        if (idle)
+            break;
+
+        for (i = 0; i < lanes; i++)
+            _meh_keccak_lane_in(&lane[i], state + i, lanes, proto);
+        fn(state);
+        for (i = 0; i < lanes; i++)
+            _meh_keccak_lane_out(&lane[i], state + i, lanes, proto);
+    }
+
+    /* The ragged end: each half-done lane carries on alone. */
+    for (i = 0; i < lanes; i++)
+    {
+        if (!busy[i])
+            continue;
+
+        for (j = 0; j < 25; j++)
+            one[j] = state[j * lanes + i];
+
+        _meh_keccak_lane_finish(&lane[i], one, proto);
+    }
+
+    /* Without a kernel, everything is the ragged end. */
+    for (; next < n; next++)
+    {
+        _meh_keccak_lane_start(&lane[0], msgs[next], lens[next],
+                               output + next * out_len, out_len);
+        memset(one, 0, sizeof (one));
+
+        _meh_keccak_lane_finish(&lane[0], one, proto);
+    }
+}
@@ -0,0 +1,100 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_KECCAK_H
+#define MEH_KECCAK_H
+
+#include "include.h"
+#include "error.h"
+
+/* The sponge rate is the block size: 1600 bits less twice the
+   security level. */
+#define MEH_SHA3_224_HASH_SIZE  28
+#define MEH_SHA3_256_HASH_SIZE  32
+#define MEH_SHA3_384_HASH_SIZE  48
+#define MEH_SHA3_512_HASH_SIZE  64
+#define MEH_SHAKE128_HASH_SIZE  32
+#define MEH_SHAKE256_HASH_SIZE  64
+#define MEH_SHA3_224_BLOCK_SIZE 144
+#define MEH_SHA3_256_BLOCK_SIZE 136
+#define MEH_SHA3_384_BLOCK_SIZE 104
+#define MEH_SHA3_512_BLOCK_SIZE 72
+#define MEH_SHAKE128_BLOCK_SIZE 168
+#define MEH_SHAKE256_BLOCK_SIZE 136
+#define MEH_KECCAK_EXPORT_SIZE  (200 + 4 + 4)
+#define MEH_SHA3_224_EXPORT_SIZE MEH_KECCAK_EXPORT_SIZE
+#define MEH_SHA3_256_EXPORT_SIZE MEH_KECCAK_EXPORT_SIZE
+#define MEH_SHA3_384_EXPORT_SIZE MEH_KECCAK_EXPORT_SIZE
+#define MEH_SHA3_512_EXPORT_SIZE MEH_KECCAK_EXPORT_SIZE
+#define MEH_SHAKE128_EXPORT_SIZE MEH_KECCAK_EXPORT_SIZE
+#define MEH_SHAKE256_EXPORT_SIZE MEH_KECCAK_EXPORT_SIZE
+
+typedef struct meh_keccak_state_s
+{
+    uint64_t state[25];
+
+    uint32_t rate,      /* bytes absorbed or squeezed per permutation */
+             suffix,    /* domain bits: 0x06 for SHA-3, 0x1F for SHAKE */
+             hash_size,
+             length,    /* bytes of the current block used so far */
+             squeezing;
+} meh_keccak_state_t;
+
+typedef meh_keccak_state_t meh_sha3_224_state_t;
+typedef meh_keccak_state_t meh_sha3_256_state_t;
+typedef meh_keccak_state_t meh_sha3_384_state_t;
+typedef meh_keccak_state_t meh_sha3_512_state_t;
+typedef meh_keccak_state_t meh_shake128_state_t;
+typedef meh_keccak_state_t meh_shake256_state_t;
+typedef meh_keccak_state_t* MehKeccak;
+
+MehKeccak meh_get_sha3_224(void);
+MehKeccak meh_get_sha3_256(void);
+MehKeccak meh_get_sha3_384(void);
+MehKeccak meh_get_sha3_512(void);
+MehKeccak meh_get_shake128(void);
+MehKeccak meh_get_shake256(void);
+void meh_reset_sha3_224(MehKeccak);
+void meh_reset_sha3_256(MehKeccak);
+void meh_reset_sha3_384(MehKeccak);
+void meh_reset_sha3_512(MehKeccak);
+void meh_reset_shake128(MehKeccak);
+void meh_reset_shake256(MehKeccak);
+
+/* Shared by every variant once it has been reset. */
+void meh_reset_keccak(MehKeccak);
+void meh_update_keccak(MehKeccak, const unsigned char*, size_t);
+void meh_finish_keccak(MehKeccak, unsigned char*);
+void meh_squeeze_keccak(MehKeccak, unsigned char*, size_t);
+#define meh_destroy_keccak(x) free(x)
+void meh_export_keccak(MehKeccak, unsigned char*);
+void meh_import_keccak(MehKeccak, const unsigned char*);
+
+void meh_keccak_f1600(uint64_t*);
+
+/* For meh_hash_many and meh_squeeze_many: n messages through sponges
+   configured like proto, out_len bytes of output each, side by side in
+   vector lanes where the CPU allows. */
+void _meh_keccak_many(const meh_keccak_state_t*, const unsigned char**,
+                      const size_t*, size_t, unsigned char*, size_t);
+
+#endif
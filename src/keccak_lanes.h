@@ -0,0 +1,68 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/* Keccak-f[1600] on several independent states at once. Not a normal
+   header: keccak.c includes it once per vector width, defining
+
+     MEH_KECCAK_N       states per call (4 or 8)
+     MEH_KECCAK_ATTR    function attributes, e.g. a GCC target
+     MEH_KECCAK_SUFFIX  appended to every name defined here
+
+   The states are interleaved: word i of state k is s[i * MEH_KECCAK_N
+   + k]. The round itself is MEH_KECCAK_ROUND from keccak.c, which
+   works on vector lanes as well as on plain words. */
+
+#define MEH_KECCAK_CAT2(a, b) a##_##b
+#define MEH_KECCAK_CAT(a, b) MEH_KECCAK_CAT2(a, b)
+#define MEH_KECCAK_FN(x) MEH_KECCAK_CAT(x, MEH_KECCAK_SUFFIX)
+#define V MEH_KECCAK_FN(meh_keccak_v)
+
+typedef uint64_t V __attribute__((vector_size(8 * MEH_KECCAK_N)));
+
+#define LOAD(x, i) memcpy(&x, s + (i) * MEH_KECCAK_N, sizeof (V));
+#define STORE(x, i) memcpy(s + (i) * MEH_KECCAK_N, &x, sizeof (V));
+
+MEH_KECCAK_ATTR
+static void MEH_KECCAK_FN(_meh_keccak_f1600)(uint64_t* s)
+{
+    V MEH_KECCAK_LANES(A), MEH_KECCAK_LANES(E),
+      Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+    const V zero = {0};
+    unsigned int r;
+
+    MEH_KECCAK_EACH(LOAD, A)
+
+    for (r = 0; r < 24; r += 2)
+    {
+        MEH_KECCAK_ROUND(A, E, zero + RC[r])
+        MEH_KECCAK_ROUND(E, A, zero + RC[r + 1])
+    }
+
+    MEH_KECCAK_EACH(STORE, A)
+}
+
+#undef STORE
+#undef LOAD
+#undef V
+#undef MEH_KECCAK_FN
+#undef MEH_KECCAK_CAT
+#undef MEH_KECCAK_CAT2
@@ -183,3 +183,30 @@ void meh_finish_md5(MehMD5 ctx, unsigned char* output)
     U32TO8_LITTLE(output, ctx->state[2],  8);
     U32TO8_LITTLE(output, ctx->state[3], 12);
 }
+
+/* Chaining state as bytes: bit count, state words, then the buffer. */
+void meh_export_md5(MehMD5 ctx, unsigned char* output)
+{
+    int i;
+
+    U32TO8_BIG(output, ctx->total[0], 0);
+    U32TO8_BIG(output, ctx->total[1], 4);
+
+    for (i = 0; i < 4; i++)
+        U32TO8_BIG(output, ctx->state[i], 8 + 4*i);
+
+    memcpy(output + 8 + 16, ctx->buffer, MEH_MD5_BLOCK_SIZE);
+}
+
+void meh_import_md5(MehMD5 ctx, const unsigned char* input)
+{
+    int i;
+
+    ctx->total[0] = U8TO32_BIG(input, 0);
+    ctx->total[1] = U8TO32_BIG(input, 4);
+
+    for (i = 0; i < 4; i++)
+        ctx->state[i] = U8TO32_BIG(input, 8 + 4*i);
+
+    memcpy(ctx->buffer, input + 8 + 16, MEH_MD5_BLOCK_SIZE);
+}
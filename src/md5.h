@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #define MEH_MD5_HASH_SIZE   16
 #define MEH_MD5_BLOCK_SIZE  64
+#define MEH_MD5_EXPORT_SIZE (8 + 16 + MEH_MD5_BLOCK_SIZE)
 
 typedef struct meh_md5_state_s
 {
@@ -42,6 +43,9 @@ MehMD5 meh_get_md5(void);
 void meh_reset_md5(MehMD5);
 void meh_update_md5(MehMD5, const unsigned char*, size_t);
 void meh_finish_md5(MehMD5, unsigned char*);
+void meh_process_md5(MehMD5, const unsigned char*);
 #define meh_destroy_md5(x) free(x)
+void meh_export_md5(MehMD5, unsigned char*);
+void meh_import_md5(MehMD5, const unsigned char*);
 
 #endif
@@ -23,8 +23,11 @@ THE SOFTWARE.
 #ifndef MEH_H
 #    define MEH_H
 
+#    include "cpu.h"
 #    include "hash.h"
 #    include "hmac.h"
+#    include "hmac_cache.h"
 #    include "kdf.h"
 #    include "cipher.h"
+#    include "aead.h"
 #endif
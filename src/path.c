@@ -0,0 +1,225 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/* mmap and friends are POSIX, outside what -std=c99 exposes. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "hash.h"
+#include "hmac.h"
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#    define MEH_HAVE_MMAP 1
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#else
+#    define MEH_HAVE_MMAP 0
+#endif
+
+#define MEH_PATH_WINDOW ((size_t)64 << 20) /* bytes mapped at a time */
+#define MEH_PATH_BUFFER ((size_t)1 << 20)  /* bytes read at a time */
+
+typedef meh_error_t (*meh_path_sink)(void*, const unsigned char*, size_t);
+
+static meh_error_t _meh_sink_hash(void* ctx, const unsigned char* data,
+                                  size_t len)
+{
+    return meh_update_hash(ctx, data, len);
+}
+
+typedef struct meh_path_parallel_s
+{
+    MehHash hash;
+    unsigned int threads;
+} meh_path_parallel_t;
+
+static meh_error_t _meh_sink_hash_parallel(void* ctx, const unsigned char* data,
+                                           size_t len)
+{
+    meh_path_parallel_t* p = ctx;
+
+    return meh_update_hash_parallel(p->hash, data, len, p->threads);
+}
+
+static meh_error_t _meh_sink_hmac(void* ctx, const unsigned char* data,
+                                  size_t len)
+{
+    return meh_update_hmac(ctx, data, len);
+}
+
+#if MEH_HAVE_MMAP
+/* Feed a regular file from read-only mappings, a window at a time so the
+   address space and resident set stay bounded on huge files. Sets *done
+   to how far it got, so a failed mapping can be finished by reading. */
+static meh_error_t _meh_map_fd(int fd, off_t size, off_t* done,
+                               meh_path_sink sink, void* ctx)
+{
+    meh_error_t error = MEH_OK;
+    size_t len;
+    void* map;
+
+    for (*done = 0; *done < size && MEH_OK == error; *done += len)
+    {
+        len = (size - *done > (off_t)MEH_PATH_WINDOW) ?
+              MEH_PATH_WINDOW : (size_t)(size - *done);
+
+        map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, *done);
+        if (MAP_FAILED == map)
+            return MEH_READ_ERROR;
+
+        posix_madvise(map, len, POSIX_MADV_SEQUENTIAL);
+        error = sink(ctx, map, len);
+        munmap(map, len);
+    }
+
+    return error;
+}
+
+/* Pipes, devices and anything that would not map. */
+static meh_error_t _meh_read_fd(int fd, meh_path_sink sink, void* ctx)
+{
+    meh_error_t error = MEH_OK;
+    unsigned char* buffer;
+    ssize_t count;
+
+    if (NULL == (buffer = malloc(MEH_PATH_BUFFER)))
+        return meh_error("could not allocate read buffer", MEH_OUT_OF_MEMORY);
+
+    while (MEH_OK == error)
+    {
+        count = read(fd, buffer, MEH_PATH_BUFFER);
+
+        if (count < 0 && EINTR == errno)
+            continue;
+        if (count < 0)
+            error = meh_error("could not read file", MEH_READ_ERROR);
+        if (count <= 0)
+            break;
+
+        error = sink(ctx, buffer, (size_t)count);
+    }
+
+    free(buffer);
+
+    return error;
+}
+
+static meh_error_t _meh_feed_path(const char* path, meh_path_sink sink,
+                                  void* ctx)
+{
+    meh_error_t error;
+    struct stat st;
+    off_t done = 0;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return meh_error("could not open file",
+                         (ENOENT == errno) ? MEH_FILE_NOT_FOUND
+                                           : MEH_READ_ERROR);
+
+    /* Regular files are hashed straight out of the page cache. Files
+       that report no size (as under /proc) are read like a pipe. */
+    if (0 == fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        error = _meh_map_fd(fd, st.st_size, &done, sink, ctx);
+
+        if (MEH_READ_ERROR == error && lseek(fd, done, SEEK_SET) == done)
+            error = _meh_read_fd(fd, sink, ctx);
+    }
+    else
+        error = _meh_read_fd(fd, sink, ctx);
+
+    close(fd);
+
+    return error;
+}
+#else
+static meh_error_t _meh_feed_path(const char* path, meh_path_sink sink,
+                                  void* ctx)
+{
+    meh_error_t error = MEH_OK;
+    unsigned char* buffer;
+    size_t count;
+    FILE* fd;
+
+    if (NULL == (fd = fopen(path, "rb")))
+        return meh_error("could not open file", MEH_FILE_NOT_FOUND);
+
+    if (NULL == (buffer = malloc(MEH_PATH_BUFFER)))
+    {
+        fclose(fd);
+        return meh_error("could not allocate read buffer", MEH_OUT_OF_MEMORY);
+    }
+
+    while (MEH_OK == error &&
+           (count = fread(buffer, 1, MEH_PATH_BUFFER, fd)) != 0)
+        error = sink(ctx, buffer, count);
+
+    if (MEH_OK == error && ferror(fd))
+        error = meh_error("could not read file", MEH_READ_ERROR);
+
+    free(buffer);
+    fclose(fd);
+
+    return error;
+}
+#endif
+
+/* Update hash with the contents of the file at path. Regular files are
+   mapped rather than copied through a buffer; the file must not be
+   truncated while this runs. */
+meh_error_t meh_hash_path(MehHash hash, const char* path)
+{
+    if (NULL == hash || NULL == path)
+        return meh_error("invalid argument passed to meh_hash_path",
+                         MEH_INVALID_ARGUMENT);
+
+    return _meh_feed_path(path, _meh_sink_hash, hash);
+}
+
+/* As meh_hash_path, passing each mapped window to
+   meh_update_hash_parallel. */
+meh_error_t meh_hash_path_parallel(MehHash hash, const char* path,
+                                   unsigned int threads)
+{
+    meh_path_parallel_t p;
+
+    if (NULL == hash || NULL == path)
+        return meh_error("invalid argument passed to meh_hash_path_parallel",
+                         MEH_INVALID_ARGUMENT);
+
+    p.hash = hash;
+    p.threads = threads;
+
+    return _meh_feed_path(path, _meh_sink_hash_parallel, &p);
+}
+
+meh_error_t meh_hmac_path(MehHMAC hmac, const char* path)
+{
+    if (NULL == hmac || NULL == path)
+        return meh_error("invalid argument passed to meh_hmac_path",
+                         MEH_INVALID_ARGUMENT);
+
+    return _meh_feed_path(path, _meh_sink_hmac, hmac);
+}
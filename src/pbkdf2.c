@@ -22,20 +22,22 @@ THE SOFTWARE.
 
 #include "pbkdf2.h"
 #include "bitwise.h"
+#include "thread.h"
 
-void _increment_counter(uint8_t* in, size_t len)
+/* One thread's share of the blocks of _meh_pbkdf2_blocks */
+typedef struct
 {
-    int i;
-
-    if (len <= 0) /* shouldn't happen, but to prevent weird shit */
-    {
-        meh_warn("negative length passed to _increment_counter in pbkdf2");
-        return;
-    }
-    
-    for (i = len-1; i >= 0; i--)
-        if (++in[i])
-            break;
+    meh_hash_t work;
+    const meh_hash_t** inner;
+    const meh_hash_t** outer;
+    unsigned char* t;
+    size_t n;
+    unsigned long count;
+} _meh_pbkdf2_task_t;
+
+size_t meh_pbkdf2_context_size(const meh_hash_id hash_id)
+{
+    return meh_hmac_context_size(hash_id) ? sizeof (meh_pbkdf2_state_t) : 0;
 }
 
 MehPBKDF2 meh_get_pbkdf2(const meh_hash_id hash_id,
@@ -43,45 +45,52 @@ MehPBKDF2 meh_get_pbkdf2(const meh_hash_id hash_id,
                          const unsigned char* salt, size_t salt_len,
                          unsigned int iterations)
 {
-    meh_error_t error;
-    MehPBKDF2 r = malloc(sizeof (meh_pbkdf2_state_t));
+    MehPBKDF2 r;
+    void* mem;
+    size_t size = meh_pbkdf2_context_size(hash_id);
 
-    if (NULL == r)
-        goto meh_get_pbkdf2_allocation_failure;
+    if (0 == size || NULL == (mem = malloc(size)))
+        return NULL;
 
-    r->hmac = meh_get_hmac(hash_id, password, pass_len);
+    if (NULL == (r = meh_init_pbkdf2(mem, size, hash_id, password, pass_len,
+                                     salt, salt_len, iterations)))
+    {
+        free(mem);
+        return NULL;
+    }
 
-    if (NULL == r->hmac)
-        goto meh_get_pbkdf2_hmac_allocation_failure;
+    r->allocated = 1;
     
-    r->buffer = malloc(r->hmac->output_size);
+    return r;
+}   
 
-    if (NULL == r->buffer)
-        goto meh_get_pbkdf2_buffer_allocation_failure;
+MehPBKDF2 meh_init_pbkdf2(void* mem, size_t size, const meh_hash_id hash_id,
+                          const unsigned char* password, size_t pass_len,
+                          const unsigned char* salt, size_t salt_len,
+                          unsigned int iterations)
+{
+    MehPBKDF2 r = mem;
+    size_t need = meh_pbkdf2_context_size(hash_id);
 
-    r->tmp = malloc(r->hmac->output_size);
+    if (0 == need || NULL == mem || size < need || !MEH_IS_ALIGNED(mem))
+    {
+        meh_warn("invalid storage passed to meh_init_pbkdf2");
+        return NULL;
+    }
 
-    if (NULL == r->tmp)
-        goto meh_get_pbkdf2_tmp_allocation_failure;
+    if (NULL == meh_init_hmac(&r->hmac, sizeof (meh_hmac_t), hash_id,
+                              password, pass_len))
+        return NULL;
 
-    r->password = r->salt = NULL;
+    meh_init_hash(&r->salted, sizeof (meh_hash_t), hash_id);
+    r->allocated = 0;
+    r->threads = 1;
     
-    if ((error = meh_reset_pbkdf2(r, password, pass_len,
-                                  salt, salt_len, iterations)) != MEH_OK)
-        goto meh_get_pbkdf2_reset_failure;
+    if (meh_reset_pbkdf2(r, password, pass_len,
+                         salt, salt_len, iterations) != MEH_OK)
+        return NULL;
     
     return r;
-
-meh_get_pbkdf2_reset_failure:
-    free(r->tmp);
-meh_get_pbkdf2_tmp_allocation_failure:
-    free(r->buffer);
-meh_get_pbkdf2_buffer_allocation_failure:
-    meh_destroy_hmac(r->hmac);
-meh_get_pbkdf2_hmac_allocation_failure:
-    free(r);
-meh_get_pbkdf2_allocation_failure:
-    return NULL;
 }   
 
 meh_error_t meh_reset_pbkdf2(MehPBKDF2 kdf,
@@ -89,102 +98,326 @@ meh_error_t meh_reset_pbkdf2(MehPBKDF2 kdf,
                              const unsigned char* salt, size_t salt_len,
                              unsigned int iterations)
 {
+    meh_error_t error;
     
     if (NULL == password || NULL == salt)
         return meh_error("invalid argument passed to meh_reset_pbkdf2",
                          MEH_INVALID_ARGUMENT);
 
-    if (NULL == kdf->password)
-        kdf->password = malloc(pass_len);
-    else if (kdf->pass_len < pass_len)
-        kdf->password = realloc(kdf->password, pass_len);
+    if (0 == iterations)
+        return meh_error("no iterations passed to meh_reset_pbkdf2",
+                         MEH_INVALID_ROUNDS);
+
+    kdf->iterations = iterations;
+
+    kdf->index = kdf->hmac.output_size;
+    
+    memset(kdf->block_count, 0, sizeof (uint32_t));
+
+    /* The password is only needed to key the HMAC and the salt only
+       feeds the first round of each block, so keep midstates of both
+       instead of copies. */
+    if ((error = meh_reset_hmac(&kdf->hmac, password, pass_len)) != MEH_OK)
+        return error;
+
+    if ((error = meh_copy_hash(&kdf->salted, &kdf->hmac.inner_key)) != MEH_OK)
+        return error;
+
+    return meh_update_hash(&kdf->salted, salt, salt_len);
+}
+
+/* U_1 of block number counter, HMAC(password, salt || counter). */
+static void _meh_pbkdf2_first(MehPBKDF2 kdf, uint32_t counter,
+                              unsigned char* t)
+{
+    unsigned char c[4];
+
+    U32TO8_BIG(c, counter, 0);
+
+    meh_copy_hash(&kdf->hmac.inner, &kdf->salted);
+    meh_update_hmac(&kdf->hmac, c, sizeof (c));
+    meh_finish_hmac(&kdf->hmac, t);
+}
 
-    if (NULL == kdf->password)
-        return MEH_OUT_OF_MEMORY;
-        
-    kdf->pass_len = pass_len;
+/* The rest of one block's chain through ordinary contexts: count more
+   rounds of the HMAC keyed by the midstates inner_key and outer_key,
+   each output folded into the len bytes at t. work is scratch. */
+static void _meh_pbkdf2_chain(MehHash work, const meh_hash_t* inner_key,
+                              const meh_hash_t* outer_key, unsigned char* t,
+                              size_t len, unsigned long count)
+{
+    unsigned char u[MEH_HASH_MAX_OUTPUT_SIZE];
+    size_t k;
 
-    memcpy(kdf->password, password, pass_len);
+    memcpy(u, t, len);
 
-    if (NULL == kdf->salt)
+    /* forego "real" error checking for speed */
+    while (count--)
     {
-        kdf->salt = malloc(salt_len);
-        kdf->salt_len = salt_len;
+        meh_copy_hash(work, (MehHash)inner_key);
+        meh_update_hash(work, u, len);
+        meh_finish_hash(work, u);
+
+        meh_copy_hash(work, (MehHash)outer_key);
+        meh_update_hash(work, u, len);
+        meh_finish_hash(work, u);
+
+        for (k = 0; k < len; k++)
+            t[k] ^= u[k];
     }
-    else
-        if (kdf->salt_len < salt_len)
-            kdf->salt = realloc(kdf->salt, salt_len);
+}
 
-    if (NULL == kdf->salt)
+/* Chains already started, their U_1 at t. MD5, SHA-1 and SHA-2 run in
+   words, across SIMD lanes where the CPU has them; other hashes go
+   through ordinary contexts. */
+static void _meh_pbkdf2_finish_chains(MehHash work, const meh_hash_t** inner,
+                                      const meh_hash_t** outer,
+                                      unsigned char* t, size_t n,
+                                      unsigned long count)
+{
+    size_t i, len = work->output_size;
+
+    if (MEH_OK == _meh_hmac_chains(work->id, inner, outer, t, n, count))
+        return;
+
+    for (i = 0; i < n; i++)
+        _meh_pbkdf2_chain(work, inner[i], outer[i], t + i * len, len, count);
+}
+
+static meh_error_t _meh_pbkdf2_task(void* arg)
+{
+    _meh_pbkdf2_task_t* task = arg;
+
+    _meh_pbkdf2_finish_chains(&task->work, task->inner, task->outer,
+                              task->t, task->n, task->count);
+
+    return MEH_OK;
+}
+
+/* Most threads one request is spread over; each takes up to a batch. */
+static size_t _meh_pbkdf2_workers(MehPBKDF2 kdf)
+{
+    return (kdf->threads < MEH_PBKDF2_BATCH) ? kdf->threads
+                                             : MEH_PBKDF2_BATCH;
+}
+
+/* The next n blocks, back to back at t. Every block is an independent
+   chain, so past one thread they are split into contiguous slices of
+   at most a batch each. A slice is made of whole passes of the widest
+   lane kernel, since a thread running a part-filled pass takes as long
+   as one running a full one; blocks that fit one pass stay on one
+   thread. */
+static void _meh_pbkdf2_blocks(MehPBKDF2 kdf, unsigned char* t, size_t n)
+{
+    const meh_hash_t* inner[MEH_PBKDF2_BATCH], * outer[MEH_PBKDF2_BATCH];
+    _meh_pbkdf2_task_t tasks[MEH_PBKDF2_BATCH];
+    uint32_t counter = U8TO32_BIG(kdf->block_count, 0);
+    unsigned long count = (unsigned long)kdf->iterations - 1;
+    size_t i, done, workers, width, passes, len = kdf->hmac.output_size;
+
+    for (i = 0; i < n; i++)
+        _meh_pbkdf2_first(kdf, counter + 1 + (uint32_t)i, t + i * len);
+
+    for (i = 0; i < MEH_PBKDF2_BATCH; i++)
     {
-        free(kdf->password);
-        return MEH_OUT_OF_MEMORY;
+        inner[i] = &kdf->hmac.inner_key;
+        outer[i] = &kdf->hmac.outer_key;
     }
 
-    memcpy(kdf->salt, salt, salt_len);
+    U32TO8_BIG(kdf->block_count, counter + (uint32_t)n, 0);
 
-    kdf->iterations = iterations;
+    width = _meh_hmac_chain_width(kdf->hmac.id);
+    passes = (n + width - 1) / width;
 
-    kdf->index = kdf->hmac->output_size;
-    
-    memset(kdf->block_count, 0, sizeof (uint32_t));
-    
-    return meh_reset_hmac(kdf->hmac, kdf->password, kdf->pass_len);
+    workers = _meh_pbkdf2_workers(kdf);
+    if (workers > passes)
+        workers = passes;
+
+    if (workers <= 1)
+    {
+        _meh_pbkdf2_finish_chains(&kdf->hmac.inner, inner, outer, t, n,
+                                  count);
+        return;
+    }
+
+    for (i = 0, done = 0; i < workers; i++)
+    {
+        meh_init_hash(&tasks[i].work, sizeof (meh_hash_t), kdf->hmac.id);
+        tasks[i].inner = inner;
+        tasks[i].outer = outer;
+        tasks[i].t = t + done * len;
+        tasks[i].n = (passes / workers + (i < passes % workers)) * width;
+        if (tasks[i].n > n - done)
+            tasks[i].n = n - done;
+        tasks[i].count = count;
+        done += tasks[i].n;
+    }
+
+    _meh_run_parallel(_meh_pbkdf2_task, tasks, sizeof (*tasks), workers,
+                      (unsigned int)workers);
+}
+
+/* Derive the blocks of later requests on up to threads threads; 0 is
+   taken as 1. The output is the same for any count. */
+meh_error_t meh_set_threads_pbkdf2(MehPBKDF2 kdf, unsigned int threads)
+{
+    if (NULL == kdf)
+        return meh_error("invalid argument passed to meh_set_threads_pbkdf2",
+                         MEH_INVALID_ARGUMENT);
+
+    kdf->threads = (0 == threads) ? 1 : threads;
+
+    return MEH_OK;
 }
 
 meh_error_t meh_update_pbkdf2(MehPBKDF2 kdf, unsigned char* output,
                               size_t want_len, size_t* get_len)
 {
-    meh_error_t error;
-    int i, j, k;
+    unsigned char t[MEH_PBKDF2_BATCH * MEH_HASH_MAX_OUTPUT_SIZE];
+    size_t n, take, left, len = kdf->hmac.output_size;
+    uint32_t counter;
 
     *get_len = 0;
-    error = MEH_OK;
     
-    for (i = 0; i < want_len; i++)
+    while (*get_len < want_len)
     {
-        if (kdf->index == kdf->hmac->output_size)
+        left = want_len - *get_len;
+
+        if (kdf->index == len)
         {
-            _increment_counter(kdf->block_count, sizeof (uint32_t));
-            if (0 == U8TO32_BIG(kdf->block_count, 0))
-            {
-                /* little hacky but prevents reuse */
-                memset(kdf->block_count, 0xff, sizeof (uint32_t));
-                
+            counter = U8TO32_BIG(kdf->block_count, 0);
+            if (0xFFFFFFFF == counter)
                 return meh_error("source exhausted in meh_update_pbkdf2",
                                  MEH_SOURCE_EXHAUSTED);
-            }
-
-            memset(kdf->buffer, 0, kdf->hmac->output_size);
 
-            /* forego "real" error checking for speed */
-            for (j = 0; j < kdf->iterations; j++)
+            /* Every block the request still needs, a batch per thread
+               at a time, so independent blocks can share the SIMD
+               lanes. A kept partial block must fit t. */
+            n = (left + len - 1) / len;
+            if (n > MEH_PBKDF2_BATCH * _meh_pbkdf2_workers(kdf))
+                n = MEH_PBKDF2_BATCH * _meh_pbkdf2_workers(kdf);
+            if (n > 0xFFFFFFFF - counter)
+                n = 0xFFFFFFFF - counter;
+            if (n > MEH_PBKDF2_BATCH && n * len > left)
+                n--;
+
+            /* Whole blocks are derived in the caller's buffer; only a
+               block that is partly kept goes through the context. */
+            if (n * len <= left)
             {
-                error = meh_reset_hmac(kdf->hmac, kdf->password, kdf->pass_len);
-                
-                if (0 != j)
-                    error = meh_update_hmac(kdf->hmac, kdf->tmp, kdf->hmac->output_size);
-                else
-                {
-                    error = meh_update_hmac(kdf->hmac, kdf->salt, kdf->salt_len);
-                    error = meh_update_hmac(kdf->hmac,
-                                            kdf->block_count, sizeof (uint32_t));
-                }
-                
-                error = meh_finish_hmac(kdf->hmac, kdf->tmp);
-
-                for (k = 0; k < kdf->hmac->output_size; k++)
-                    kdf->buffer[k] ^= kdf->tmp[k];
+                _meh_pbkdf2_blocks(kdf, output + *get_len, n);
+                *get_len += n * len;
+                continue;
             }
 
+            _meh_pbkdf2_blocks(kdf, t, n);
+
+            memcpy(output + *get_len, t, (n - 1) * len);
+            *get_len += (n - 1) * len;
+            left -= (n - 1) * len;
+
+            memcpy(kdf->buffer, t + (n - 1) * len, len);
             kdf->index = 0;
         }
 
-        output[i] = kdf->buffer[kdf->index++];
-        (*get_len)++;
+        take = (len - kdf->index < left) ? len - kdf->index : left;
+        memcpy(output + *get_len, kdf->buffer + kdf->index, take);
+        kdf->index += take;
+        *get_len += take;
+    }
+
+    return MEH_OK;
+}
+
+/* Derive out_len bytes from each of n passwords with its salt, back to
+   back in out. The blocks of every password are interleaved across the
+   SIMD lanes together, so short outputs fill them as well as long. */
+meh_error_t meh_pbkdf2_many(const meh_hash_id hash_id,
+                            const unsigned char** passwords,
+                            const size_t* pass_lens,
+                            const unsigned char** salts,
+                            const size_t* salt_lens, size_t n,
+                            unsigned int iterations, unsigned char* out,
+                            size_t out_len)
+{
+    meh_pbkdf2_state_t kdf;
+    meh_hash_t keys[2 * MEH_PBKDF2_BATCH];
+    const meh_hash_t* inner[MEH_PBKDF2_BATCH], * outer[MEH_PBKDF2_BATCH];
+    unsigned char t[MEH_PBKDF2_BATCH * MEH_HASH_MAX_OUTPUT_SIZE];
+    size_t len, blocks, chains, done, m, i, p, b, keyed = 0;
+    meh_error_t error;
+
+    if (0 == meh_pbkdf2_context_size(hash_id))
+        return meh_error("invalid hash id passed to meh_pbkdf2_many",
+                         MEH_INVALID_HASH);
+
+    if (0 == n || 0 == out_len)
+        return MEH_OK;
+
+    if (NULL == passwords || NULL == pass_lens || NULL == salts ||
+        NULL == salt_lens || NULL == out)
+        return meh_error("invalid argument passed to meh_pbkdf2_many",
+                         MEH_INVALID_ARGUMENT);
+
+    if (0 == iterations)
+        return meh_error("no iterations passed to meh_pbkdf2_many",
+                         MEH_INVALID_ROUNDS);
+
+    if (NULL == meh_init_pbkdf2(&kdf, sizeof (kdf), hash_id, passwords[0],
+                                pass_lens[0], salts[0], salt_lens[0],
+                                iterations))
+        return meh_error("invalid argument passed to meh_pbkdf2_many",
+                         MEH_INVALID_ARGUMENT);
+
+    len = kdf.hmac.output_size;
+    blocks = (out_len + len - 1) / len;
+
+    if (blocks > 0xFFFFFFFF || n > SIZE_MAX / blocks)
+        return meh_error("output too long in meh_pbkdf2_many",
+                         MEH_SOURCE_EXHAUSTED);
+
+    chains = n * blocks;
+
+    for (done = 0; done < chains; done += m)
+    {
+        m = (chains - done < MEH_PBKDF2_BATCH) ? chains - done
+                                               : MEH_PBKDF2_BATCH;
+
+        for (i = 0; i < m; i++)
+        {
+            p = (done + i) / blocks;
+            b = (done + i) % blocks;
+
+            if (p != keyed &&
+                (error = meh_reset_pbkdf2(&kdf, passwords[p], pass_lens[p],
+                                          salts[p], salt_lens[p],
+                                          iterations)) != MEH_OK)
+                return error;
+
+            keyed = p;
+
+            _meh_pbkdf2_first(&kdf, (uint32_t)b + 1, t + i * len);
+
+            keys[2 * i] = kdf.hmac.inner_key;
+            keys[2 * i + 1] = kdf.hmac.outer_key;
+            inner[i] = &keys[2 * i];
+            outer[i] = &keys[2 * i + 1];
+        }
+
+        _meh_pbkdf2_finish_chains(&kdf.hmac.inner, inner, outer, t, m,
+                                  (unsigned long)iterations - 1);
+
+        for (i = 0; i < m; i++)
+        {
+            p = (done + i) / blocks;
+            b = (done + i) % blocks;
+
+            memcpy(out + p * out_len + b * len, t + i * len,
+                   (out_len - b * len < len) ? out_len - b * len : len);
+        }
     }
 
-    return error; /* Yeah, this blows. I'll fix it later--maybe. */
+    return MEH_OK;
 }
 
 void meh_destroy_pbkdf2(MehPBKDF2 kdf)
@@ -195,10 +428,6 @@ void meh_destroy_pbkdf2(MehPBKDF2 kdf)
         return;
     }
     
-    meh_destroy_hmac(kdf->hmac);
-    free(kdf->salt);
-    free(kdf->password);
-    free(kdf->buffer);
-    free(kdf->tmp);
-    free(kdf);
+    if (kdf->allocated)
+        free(kdf);
 }
@@ -26,32 +26,43 @@ THE SOFTWARE.
 #include "hmac.h"
 #include "include.h"
 
+/* Blocks, or chains of meh_pbkdf2_many, taken through the lanes at once */
+#define MEH_PBKDF2_BATCH 16
+
 typedef struct meh_pbkdf2_state_s
 {
-    MehHMAC hmac;
+    meh_hmac_t hmac; /* keyed once with the password */
     
-    unsigned char* salt,
-                 * password;
-
-    size_t salt_len,
-           pass_len;
+    meh_hash_t salted; /* inner HMAC state after ipad || salt */
 
-    unsigned char* buffer,
-                 * tmp;
+    unsigned char buffer[MEH_HASH_MAX_OUTPUT_SIZE]; /* a block partly read */
     
     uint8_t  block_count[4];
     
-    int iterations, index;
+    unsigned int iterations;
+    unsigned int threads; /* blocks of one request derived at once */
+    size_t index;
+
+    int allocated; /* storage came from meh_get_pbkdf2 */
 } meh_pbkdf2_state_t;
 
 typedef meh_pbkdf2_state_t* MehPBKDF2;
 
 MehPBKDF2 meh_get_pbkdf2(const meh_hash_id, const unsigned char*,
                          size_t, const unsigned char*, size_t, unsigned int);
+size_t meh_pbkdf2_context_size(const meh_hash_id);
+MehPBKDF2 meh_init_pbkdf2(void*, size_t, const meh_hash_id,
+                          const unsigned char*, size_t,
+                          const unsigned char*, size_t, unsigned int);
 meh_error_t meh_reset_pbkdf2(MehPBKDF2, const unsigned char*, size_t,
                              const unsigned char*, size_t, unsigned int);
+meh_error_t meh_set_threads_pbkdf2(MehPBKDF2, unsigned int);
 meh_error_t meh_update_pbkdf2(MehPBKDF2, unsigned char*, size_t, size_t*);
 #define meh_finish_pbkdf2(x) MEH_OK
+meh_error_t meh_pbkdf2_many(const meh_hash_id, const unsigned char**,
+                            const size_t*, const unsigned char**,
+                            const size_t*, size_t, unsigned int,
+                            unsigned char*, size_t);
 void meh_destroy_pbkdf2(MehPBKDF2);
 
 #endif
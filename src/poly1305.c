@@ -0,0 +1,249 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "poly1305.h"
+
+#define MASK44 ((uint64_t)0xfffffffffff)
+#define MASK42 ((uint64_t)0x3ffffffffff)
+
+/* 64x64 -> 128-bit products, natively where the compiler has a 128-bit
+   type and from 32-bit halves otherwise. */
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 meh_uint128_t;
+
+#    define MUL(out, a, b) ((out) = (meh_uint128_t)(a) * (b))
+#    define ADD(out, in) ((out) += (in))
+#    define ADDLO(out, in) ((out) += (in))
+#    define SHR(in, shift) ((uint64_t)((in) >> (shift)))
+#    define LO(in) ((uint64_t)(in))
+#else
+typedef struct meh_uint128_s
+{
+    uint64_t lo,
+             hi;
+} meh_uint128_t;
+
+static meh_uint128_t _meh_mul64(uint64_t a, uint64_t b)
+{
+    meh_uint128_t r;
+    uint64_t a0 = (uint32_t)a, a1 = a >> 32,
+             b0 = (uint32_t)b, b1 = b >> 32,
+             p00 = a0 * b0, p01 = a0 * b1,
+             p10 = a1 * b0, p11 = a1 * b1,
+             mid = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+
+    r.lo = (mid << 32) | (uint32_t)p00;
+    r.hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+
+    return r;
+}
+
+#    define MUL(out, a, b) ((out) = _meh_mul64((a), (b)))
+#    define ADD(out, in) \
+       do { (out).lo += (in).lo; \
+            (out).hi += (in).hi + ((out).lo < (in).lo); } while (0)
+#    define ADDLO(out, in) \
+       do { (out).lo += (in); (out).hi += ((out).lo < (in)); } while (0)
+#    define SHR(in, shift) (((in).hi << (64 - (shift))) | ((in).lo >> (shift)))
+#    define LO(in) ((in).lo)
+#endif
+
+/* Key is r (clamped) followed by the pad s. */
+meh_error_t meh_reset_poly1305(MehPoly1305 poly, const unsigned char* key)
+{
+    uint64_t t0, t1;
+
+    if (NULL == poly || NULL == key)
+        return meh_error("null reference passed to meh_reset_poly1305",
+                         MEH_INVALID_ARGUMENT);
+
+    t0 = U8TO64_LITTLE(key, 0);
+    t1 = U8TO64_LITTLE(key, 8);
+
+    poly->r[0] = t0 & 0xffc0fffffff;
+    poly->r[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffff;
+    poly->r[2] = (t1 >> 24) & 0x00ffffffc0f;
+
+    poly->h[0] = 0;
+    poly->h[1] = 0;
+    poly->h[2] = 0;
+
+    poly->pad[0] = U8TO64_LITTLE(key, 16);
+    poly->pad[1] = U8TO64_LITTLE(key, 24);
+
+    poly->leftover = 0;
+
+    return MEH_OK;
+}
+
+/* h = (h + m) * r mod 2^130 - 5 for each 16-byte block. hibit is the
+   2^128 bit that pads every full block; the final partial block pads
+   itself. */
+static void _meh_poly1305_blocks(MehPoly1305 poly, const unsigned char* m,
+                                 size_t blocks, uint64_t hibit)
+{
+    uint64_t r0 = poly->r[0], r1 = poly->r[1], r2 = poly->r[2],
+             h0 = poly->h[0], h1 = poly->h[1], h2 = poly->h[2],
+             s1 = r1 * (5 << 2), s2 = r2 * (5 << 2),
+             t0, t1, c;
+    meh_uint128_t d0, d1, d2, d;
+
+    for (; blocks > 0; blocks--, m += 16)
+    {
+        t0 = U8TO64_LITTLE(m, 0);
+        t1 = U8TO64_LITTLE(m, 8);
+
+        h0 += t0 & MASK44;
+        h1 += ((t0 >> 44) | (t1 << 20)) & MASK44;
+        h2 += ((t1 >> 24) & MASK42) | hibit;
+
+        MUL(d0, h0, r0); MUL(d, h1, s2); ADD(d0, d); MUL(d, h2, s1); ADD(d0, d);
+        MUL(d1, h0, r1); MUL(d, h1, r0); ADD(d1, d); MUL(d, h2, s2); ADD(d1, d);
+        MUL(d2, h0, r2); MUL(d, h1, r1); ADD(d2, d); MUL(d, h2, r0); ADD(d2, d);
+
+        c = SHR(d0, 44); h0 = LO(d0) & MASK44;
+        ADDLO(d1, c); c = SHR(d1, 44); h1 = LO(d1) & MASK44;
+        ADDLO(d2, c); c = SHR(d2, 42); h2 = LO(d2) & MASK42;
+        h0 += c * 5; c = h0 >> 44; h0 &= MASK44;
+        h1 += c;
+    }
+
+    poly->h[0] = h0;
+    poly->h[1] = h1;
+    poly->h[2] = h2;
+}
+
+meh_error_t meh_update_poly1305(MehPoly1305 poly, const unsigned char* in,
+                                size_t len)
+{
+    size_t n;
+
+    if (NULL == poly || (NULL == in && len > 0))
+        return meh_error("null reference passed to meh_update_poly1305",
+                         MEH_INVALID_ARGUMENT);
+
+    /* in may be NULL here, which memcpy must not see even for 0 bytes */
+    if (0 == len)
+        return MEH_OK;
+
+    /* Top up a partial block first */
+    if (poly->leftover > 0)
+    {
+        n = 16 - poly->leftover;
+        if (n > len)
+            n = len;
+
+        memcpy(poly->buffer + poly->leftover, in, n);
+        poly->leftover += n;
+        in += n;
+        len -= n;
+
+        if (poly->leftover < 16)
+            return MEH_OK;
+
+        _meh_poly1305_blocks(poly, poly->buffer, 1, (uint64_t)1 << 40);
+        poly->leftover = 0;
+    }
+
+    if (len >= 16)
+    {
+        _meh_poly1305_blocks(poly, in, len / 16, (uint64_t)1 << 40);
+        in += len & ~(size_t)15;
+        len &= 15;
+    }
+
+    memcpy(poly->buffer, in, len);
+    poly->leftover = len;
+
+    return MEH_OK;
+}
+
+meh_error_t meh_finish_poly1305(MehPoly1305 poly, unsigned char* tag)
+{
+    uint64_t h0, h1, h2, g0, g1, g2, c, t0, t1;
+
+    if (NULL == poly || NULL == tag)
+        return meh_error("null reference passed to meh_finish_poly1305",
+                         MEH_INVALID_ARGUMENT);
+
+    if (poly->leftover > 0)
+    {
+        poly->buffer[poly->leftover] = 1;
+        memset(poly->buffer + poly->leftover + 1, 0, 15 - poly->leftover);
+        _meh_poly1305_blocks(poly, poly->buffer, 1, 0);
+    }
+
+    /* Fully carry h */
+    h0 = poly->h[0];
+    h1 = poly->h[1];
+    h2 = poly->h[2];
+
+    c = h1 >> 44; h1 &= MASK44;
+    h2 += c; c = h2 >> 42; h2 &= MASK42;
+    h0 += c * 5; c = h0 >> 44; h0 &= MASK44;
+    h1 += c; c = h1 >> 44; h1 &= MASK44;
+    h2 += c; c = h2 >> 42; h2 &= MASK42;
+    h0 += c * 5; c = h0 >> 44; h0 &= MASK44;
+    h1 += c;
+
+    /* g = h - p = h + 5 - 2^130, taken in constant time if h >= p */
+    g0 = h0 + 5; c = g0 >> 44; g0 &= MASK44;
+    g1 = h1 + c; c = g1 >> 44; g1 &= MASK44;
+    g2 = h2 + c - ((uint64_t)1 << 42);
+
+    c = (g2 >> 63) - 1;
+    h0 = (h0 & ~c) | (g0 & c);
+    h1 = (h1 & ~c) | (g1 & c);
+    h2 = (h2 & ~c) | (g2 & c);
+
+    /* tag = (h + s) mod 2^128 */
+    t0 = poly->pad[0];
+    t1 = poly->pad[1];
+
+    h0 += t0 & MASK44; c = h0 >> 44; h0 &= MASK44;
+    h1 += (((t0 >> 44) | (t1 << 20)) & MASK44) + c; c = h1 >> 44; h1 &= MASK44;
+    h2 += ((t1 >> 24) & MASK42) + c; h2 &= MASK42;
+
+    h0 |= h1 << 44;
+    h1 = (h1 >> 20) | (h2 << 24);
+
+    U64TO8_LITTLE(tag, h0, 0);
+    U64TO8_LITTLE(tag, h1, 8);
+
+    /* The key is single-use; don't leave it lying around */
+    memset(poly, 0, sizeof (*poly));
+
+    return MEH_OK;
+}
+
+meh_error_t meh_poly1305(const unsigned char* key, const unsigned char* in,
+                         size_t len, unsigned char* tag)
+{
+    meh_poly1305_state_t poly;
+    meh_error_t error;
+
+    if (MEH_OK != (error = meh_reset_poly1305(&poly, key)) ||
+        MEH_OK != (error = meh_update_poly1305(&poly, in, len)))
+        return error;
+
+    return meh_finish_poly1305(&poly, tag);
+}
@@ -0,0 +1,53 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_POLY1305_H
+#define MEH_POLY1305_H
+
+#include "include.h"
+#include "bitwise.h"
+#include "error.h"
+
+#define MEH_POLY1305_KEY_SIZE 32
+#define MEH_POLY1305_TAG_SIZE 16
+
+/* The accumulator and r are held in radix 2^44 (44, 44 and 42 bits),
+   so each block is nine 64x64-bit multiplies. */
+typedef struct meh_poly1305_state_s
+{
+    uint64_t r[3],
+             h[3],
+             pad[2];
+
+    size_t leftover;
+    uint8_t buffer[16];
+} meh_poly1305_state_t;
+
+typedef meh_poly1305_state_t* MehPoly1305;
+
+meh_error_t meh_reset_poly1305(MehPoly1305, const unsigned char*);
+meh_error_t meh_update_poly1305(MehPoly1305, const unsigned char*, size_t);
+meh_error_t meh_finish_poly1305(MehPoly1305, unsigned char*);
+meh_error_t meh_poly1305(const unsigned char*, const unsigned char*, size_t,
+                         unsigned char*);
+
+#endif
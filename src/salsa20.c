@@ -23,6 +23,33 @@ THE SOFTWARE.
 */
 
 #include "salsa20.h"
+#include "cpu.h"
+
+#if MEH_HAVE_X86
+#    define MEH_SALSA20_N 4
+#    define MEH_SALSA20_ATTR __attribute__((target("sse2")))
+#    define MEH_SALSA20_SUFFIX x4
+#    include "salsa20_lanes.h"
+#    undef MEH_SALSA20_N
+#    undef MEH_SALSA20_ATTR
+#    undef MEH_SALSA20_SUFFIX
+
+#    define MEH_SALSA20_N 8
+#    define MEH_SALSA20_ATTR __attribute__((target("avx2")))
+#    define MEH_SALSA20_SUFFIX x8
+#    include "salsa20_lanes.h"
+#    undef MEH_SALSA20_N
+#    undef MEH_SALSA20_ATTR
+#    undef MEH_SALSA20_SUFFIX
+
+#    define MEH_SALSA20_N 16
+#    define MEH_SALSA20_ATTR __attribute__((target("avx512f")))
+#    define MEH_SALSA20_SUFFIX x16
+#    include "salsa20_lanes.h"
+#    undef MEH_SALSA20_N
+#    undef MEH_SALSA20_ATTR
+#    undef MEH_SALSA20_SUFFIX
+#endif
 
 MehSalsa20 meh_get_salsa20(const unsigned char* key,
 			   const unsigned char* iv,
@@ -148,13 +175,43 @@ static void meh_salsa20_core(uint8_t* output, const uint32_t* input)
       U32TO8_LITTLE(output, x[i], 4*i);
 }
 
+/* The 64-bit block counter lives in words 8 and 9. */
+static void _meh_salsa20_advance(uint32_t* state, uint32_t blocks)
+{
+    state[8] += blocks;
+    if (state[8] < blocks)
+        state[9]++;
+}
+
+/* XOR one block of keystream into in, eight bytes at a time. */
+static void _meh_salsa20_xor(unsigned char* out, const unsigned char* in,
+                             const uint8_t* keystream, size_t len)
+{
+    uint64_t a, b;
+    size_t i;
+
+    for (i = 0; i + 8 <= len; i += 8)
+    {
+        memcpy(&a, in + i, 8);
+        memcpy(&b, keystream + i, 8);
+        a ^= b;
+        memcpy(out + i, &a, 8);
+    }
+
+    for (; i < len; i++)
+        out[i] = in[i] ^ keystream[i];
+}
+
 meh_error_t meh_update_salsa20(MehSalsa20 s20, const unsigned char* in,
                                unsigned char* out, size_t len, size_t* got)
 {
-    uint32_t i;
     uint32_t index;
     uint32_t* state;
     uint8_t* keystream;
+    size_t n;
+#if MEH_HAVE_X86
+    unsigned int features;
+#endif
 
     if (NULL == in || NULL == got ||  NULL == out || NULL == s20)
         return meh_error("null reference passed to meh_update_salsa20",
@@ -162,26 +219,91 @@ meh_error_t meh_update_salsa20(MehSalsa20 s20, const unsigned char* in,
 
     state = s20->state;
     keystream = s20->keystream;
-
     index = s20->index;
-    for (i = 0; i < len; i++, index++)
-    {
-        if (64 == index)
+    *got = len;
+
+    /* Use up what is left of the last block */
+    n = (len < 64 - index) ? len : 64 - index;
+    _meh_salsa20_xor(out, in, keystream + index, n);
+    in += n;
+    out += n;
+    len -= n;
+    index += n;
+
+    /* Whole blocks, as many at a time as the CPU allows */
+#if MEH_HAVE_X86
+    features = meh_cpu_features();
+
+    if (features & MEH_CPU_AVX512)
+        for (; len >= 16 * 64; in += 16 * 64, out += 16 * 64, len -= 16 * 64)
+        {
+            _meh_salsa20_blocks_x16(state, in, out);
+            _meh_salsa20_advance(state, 16);
+        }
+
+    if (features & MEH_CPU_AVX2)
+        for (; len >= 8 * 64; in += 8 * 64, out += 8 * 64, len -= 8 * 64)
+        {
+            _meh_salsa20_blocks_x8(state, in, out);
+            _meh_salsa20_advance(state, 8);
+        }
+
+    if (features & MEH_CPU_SSE2)
+        for (; len >= 4 * 64; in += 4 * 64, out += 4 * 64, len -= 4 * 64)
         {
-            meh_salsa20_core(keystream, state);
-            index = 0;
+            _meh_salsa20_blocks_x4(state, in, out);
+            _meh_salsa20_advance(state, 4);
         }
+#endif
 
-        out[i] = in[i] ^ keystream[index];
+    for (; len > 0; in += n, out += n, len -= n)
+    {
+        meh_salsa20_core(keystream, state);
+        _meh_salsa20_advance(state, 1);
+
+        n = (len < 64) ? len : 64;
+        _meh_salsa20_xor(out, in, keystream, n);
+        index = n;
     }
 
     s20->index = index;
 
-    *got = len;
+    return MEH_OK;
+}
+
+/* Position the keystream at byte offset, as though that many bytes had
+   been run through meh_update_salsa20 since the last reset. */
+meh_error_t meh_seek_salsa20(MehSalsa20 s20, uint64_t offset)
+{
+    uint64_t block = offset / 64;
+
+    if (NULL == s20)
+        return meh_error("null reference passed to meh_seek_salsa20",
+                         MEH_INVALID_ARGUMENT);
+
+    s20->state[8] = (uint32_t)block;
+    s20->state[9] = (uint32_t)(block >> 32);
+    s20->index = 64;
+
+    /* Mid-block: keep that block's keystream for the next update */
+    if (0 != offset % 64)
+    {
+        meh_salsa20_core(s20->keystream, s20->state);
+        _meh_salsa20_advance(s20->state, 1);
+        s20->index = (uint32_t)(offset % 64);
+    }
 
     return MEH_OK;
 }
 
+/* The byte offset the next update will start from. */
+uint64_t meh_tell_salsa20(MehSalsa20 s20)
+{
+    uint64_t block = s20->state[8] | (uint64_t)s20->state[9] << 32;
+
+    return (64 == s20->index) ? block * 64 : (block - 1) * 64 + s20->index;
+}
+
 meh_error_t meh_finish_salsa20(MehSalsa20 s20, unsigned char* out, size_t* got)
 {
     /* This is a dummy function for consistency. */
@@ -58,6 +58,8 @@ meh_error_t meh_reset_salsa20(MehSalsa20, const unsigned char*,
                               const unsigned char*, size_t);
 meh_error_t meh_update_salsa20(MehSalsa20, const unsigned char*,
                                unsigned char*, size_t, size_t*);
+meh_error_t meh_seek_salsa20(MehSalsa20, uint64_t);
+uint64_t meh_tell_salsa20(MehSalsa20);
 meh_error_t meh_finish_salsa20(MehSalsa20, unsigned char*, size_t*);
 #define meh_destroy_salsa20(x) free(x)
 
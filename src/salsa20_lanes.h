@@ -0,0 +1,112 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/* Salsa20 keystream for several consecutive blocks at once. Not a
+   normal header: salsa20.c includes it once per vector width, defining
+
+     MEH_SALSA20_N       blocks per call (4, 8 or 16)
+     MEH_SALSA20_ATTR    function attributes, e.g. a GCC target
+     MEH_SALSA20_SUFFIX  appended to every name defined here
+
+   Lane k of every vector works on the block at counter + k. */
+
+#define MEH_SALSA20_CAT2(a, b) a##_##b
+#define MEH_SALSA20_CAT(a, b) MEH_SALSA20_CAT2(a, b)
+#define MEH_SALSA20_FN(x) MEH_SALSA20_CAT(x, MEH_SALSA20_SUFFIX)
+#define V MEH_SALSA20_FN(meh_salsa20_v)
+
+typedef uint32_t V __attribute__((vector_size(4 * MEH_SALSA20_N)));
+
+#define VROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define QUARTER(a, b, c, d)                                             \
+    do {                                                                \
+        b ^= VROTL(a + d,  7);                                          \
+        c ^= VROTL(b + a,  9);                                          \
+        d ^= VROTL(c + b, 13);                                          \
+        a ^= VROTL(d + c, 18);                                          \
+    } while (0)
+
+/* XOR N blocks of keystream, starting at input's block counter, into
+   64 * N bytes of in. Leaves the counter in input alone. */
+MEH_SALSA20_ATTR
+static void MEH_SALSA20_FN(_meh_salsa20_blocks)(const uint32_t* input,
+                                                const unsigned char* in,
+                                                unsigned char* out)
+{
+    V s[16], x0, x1, x2, x3, x4, x5, x6, x7,
+             x8, x9, x10, x11, x12, x13, x14, x15;
+    uint32_t tmp[16 * MEH_SALSA20_N], w;
+    uint64_t counter;
+    unsigned int i, k;
+
+    for (i = 0; i < 16; i++)
+        s[i] = (V){0} + input[i];
+
+    counter = input[8] | (uint64_t)input[9] << 32;
+    for (k = 0; k < MEH_SALSA20_N; k++)
+    {
+        tmp[k] = (uint32_t)(counter + k);
+        tmp[MEH_SALSA20_N + k] = (uint32_t)((counter + k) >> 32);
+    }
+    memcpy(&s[8], tmp, sizeof (V));
+    memcpy(&s[9], tmp + MEH_SALSA20_N, sizeof (V));
+
+    x0 = s[0]; x1 = s[1]; x2 = s[2]; x3 = s[3];
+    x4 = s[4]; x5 = s[5]; x6 = s[6]; x7 = s[7];
+    x8 = s[8]; x9 = s[9]; x10 = s[10]; x11 = s[11];
+    x12 = s[12]; x13 = s[13]; x14 = s[14]; x15 = s[15];
+
+    for (i = 20; i > 0; i -= 2)
+    {
+        QUARTER( x0,  x4,  x8, x12);
+        QUARTER( x5,  x9, x13,  x1);
+        QUARTER(x10, x14,  x2,  x6);
+        QUARTER(x15,  x3,  x7, x11);
+        QUARTER( x0,  x1,  x2,  x3);
+        QUARTER( x5,  x6,  x7,  x4);
+        QUARTER(x10, x11,  x8,  x9);
+        QUARTER(x15, x12, x13, x14);
+    }
+
+    s[0] += x0; s[1] += x1; s[2] += x2; s[3] += x3;
+    s[4] += x4; s[5] += x5; s[6] += x6; s[7] += x7;
+    s[8] += x8; s[9] += x9; s[10] += x10; s[11] += x11;
+    s[12] += x12; s[13] += x13; s[14] += x14; s[15] += x15;
+    memcpy(tmp, s, sizeof (s));
+
+    /* Lane k is block k; x86 is little-endian, so words go out as-is */
+    for (k = 0; k < MEH_SALSA20_N; k++)
+        for (i = 0; i < 16; i++)
+        {
+            memcpy(&w, in + 64 * k + 4 * i, 4);
+            w ^= tmp[i * MEH_SALSA20_N + k];
+            memcpy(out + 64 * k + 4 * i, &w, 4);
+        }
+}
+
+#undef QUARTER
+#undef VROTL
+#undef V
+#undef MEH_SALSA20_FN
+#undef MEH_SALSA20_CAT
+#undef MEH_SALSA20_CAT2
@@ -0,0 +1,448 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "scrypt.h"
+#include "bitwise.h"
+#include "cpu.h"
+#include "thread.h"
+
+#if MEH_HAVE_X86
+#    include <immintrin.h>
+#endif
+
+/* Block words are kept in the order (i * 5) % 16 rather than 0..15.
+   That puts each of Salsa20's diagonals in one SSE2 register, so column
+   and row rounds differ only by rotating lanes. Blocks are converted on
+   the way into and out of SMix; everything in between uses this order. */
+#define MEH_SCRYPT_SLOT(i) (((i) * 5) % 16)
+
+/* BlockMix of 2r blocks of in, XORed with in2 unless that is NULL. */
+typedef void (*meh_scrypt_mix_fn)(const uint32_t*, const uint32_t*,
+                                  uint32_t*, uint32_t);
+
+static void _meh_scrypt_load(uint32_t* X, const unsigned char* B,
+                             size_t blocks)
+{
+    size_t i;
+
+    for (; blocks > 0; blocks--, X += 16, B += 64)
+        for (i = 0; i < 16; i++)
+            X[i] = U8TO32_LITTLE(B, 4 * MEH_SCRYPT_SLOT(i));
+}
+
+static void _meh_scrypt_store(unsigned char* B, const uint32_t* X,
+                              size_t blocks)
+{
+    size_t i;
+
+    for (; blocks > 0; blocks--, X += 16, B += 64)
+        for (i = 0; i < 16; i++)
+            U32TO8_LITTLE(B, X[i], 4 * MEH_SCRYPT_SLOT(i));
+}
+
+#define QR(a, b, c, d)                      \
+    x[b] ^= ROTL32(x[a] + x[d], 7);         \
+    x[c] ^= ROTL32(x[b] + x[a], 9);         \
+    x[d] ^= ROTL32(x[c] + x[b], 13);        \
+    x[a] ^= ROTL32(x[d] + x[c], 18);
+
+/* X = Salsa20/8(X ^ a ^ b) on one block; b may be NULL. */
+static void _meh_scrypt_salsa8(uint32_t* X, const uint32_t* a,
+                               const uint32_t* b)
+{
+    uint32_t t[16], x[16];
+    int i;
+
+    for (i = 0; i < 16; i++)
+    {
+        t[i] = X[i] ^ a[i] ^ ((NULL != b) ? b[i] : 0);
+        x[MEH_SCRYPT_SLOT(i)] = t[i];
+    }
+
+    for (i = 0; i < 8; i += 2)
+    {
+        QR( 0,  4,  8, 12) QR( 5,  9, 13,  1)
+        QR(10, 14,  2,  6) QR(15,  3,  7, 11)
+        QR( 0,  1,  2,  3) QR( 5,  6,  7,  4)
+        QR(10, 11,  8,  9) QR(15, 12, 13, 14)
+    }
+
+    for (i = 0; i < 16; i++)
+        X[i] = t[i] + x[MEH_SCRYPT_SLOT(i)];
+}
+
+#undef QR
+
+/* Even-numbered results go to the first half of out, odd to the second. */
+static void _meh_scrypt_mix(const uint32_t* in, const uint32_t* in2,
+                            uint32_t* out, uint32_t r)
+{
+    uint32_t X[16];
+    size_t i, last = (2 * (size_t)r - 1) * 16;
+
+    for (i = 0; i < 16; i++)
+        X[i] = in[last + i] ^ ((NULL != in2) ? in2[last + i] : 0);
+
+    for (i = 0; i < 2 * (size_t)r; i++)
+    {
+        _meh_scrypt_salsa8(X, in + 16 * i,
+                           (NULL != in2) ? in2 + 16 * i : NULL);
+        memcpy(out + 16 * ((i & 1) * r + i / 2), X, 64);
+    }
+}
+
+#if MEH_HAVE_X86
+
+#define MEH_SCRYPT_SSE2 __attribute__((target("sse2")))
+
+#define ROTL_SSE2(x, n) \
+    _mm_xor_si128(_mm_slli_epi32((x), (n)), _mm_srli_epi32((x), 32 - (n)))
+
+/* As _meh_scrypt_mix, one diagonal per register. */
+MEH_SCRYPT_SSE2
+static void _meh_scrypt_mix_sse2(const uint32_t* in, const uint32_t* in2,
+                                 uint32_t* out, uint32_t r)
+{
+    const __m128i* a = (const __m128i*)in;
+    const __m128i* b = (const __m128i*)in2;
+    __m128i X0, X1, X2, X3, Y0, Y1, Y2, Y3, * o;
+    size_t i, last = (2 * (size_t)r - 1) * 4;
+    int k;
+
+    X0 = _mm_loadu_si128(a + last);
+    X1 = _mm_loadu_si128(a + last + 1);
+    X2 = _mm_loadu_si128(a + last + 2);
+    X3 = _mm_loadu_si128(a + last + 3);
+    if (NULL != b)
+    {
+        X0 = _mm_xor_si128(X0, _mm_loadu_si128(b + last));
+        X1 = _mm_xor_si128(X1, _mm_loadu_si128(b + last + 1));
+        X2 = _mm_xor_si128(X2, _mm_loadu_si128(b + last + 2));
+        X3 = _mm_xor_si128(X3, _mm_loadu_si128(b + last + 3));
+    }
+
+    for (i = 0; i < 2 * (size_t)r; i++)
+    {
+        X0 = _mm_xor_si128(X0, _mm_loadu_si128(a + 4 * i));
+        X1 = _mm_xor_si128(X1, _mm_loadu_si128(a + 4 * i + 1));
+        X2 = _mm_xor_si128(X2, _mm_loadu_si128(a + 4 * i + 2));
+        X3 = _mm_xor_si128(X3, _mm_loadu_si128(a + 4 * i + 3));
+        if (NULL != b)
+        {
+            X0 = _mm_xor_si128(X0, _mm_loadu_si128(b + 4 * i));
+            X1 = _mm_xor_si128(X1, _mm_loadu_si128(b + 4 * i + 1));
+            X2 = _mm_xor_si128(X2, _mm_loadu_si128(b + 4 * i + 2));
+            X3 = _mm_xor_si128(X3, _mm_loadu_si128(b + 4 * i + 3));
+        }
+
+        Y0 = X0; Y1 = X1; Y2 = X2; Y3 = X3;
+
+        for (k = 0; k < 8; k += 2)
+        {
+            /* Columns */
+            X1 = _mm_xor_si128(X1, ROTL_SSE2(_mm_add_epi32(X0, X3), 7));
+            X2 = _mm_xor_si128(X2, ROTL_SSE2(_mm_add_epi32(X1, X0), 9));
+            X3 = _mm_xor_si128(X3, ROTL_SSE2(_mm_add_epi32(X2, X1), 13));
+            X0 = _mm_xor_si128(X0, ROTL_SSE2(_mm_add_epi32(X3, X2), 18));
+
+            X1 = _mm_shuffle_epi32(X1, 0x93);
+            X2 = _mm_shuffle_epi32(X2, 0x4E);
+            X3 = _mm_shuffle_epi32(X3, 0x39);
+
+            /* Rows */
+            X3 = _mm_xor_si128(X3, ROTL_SSE2(_mm_add_epi32(X0, X1), 7));
+            X2 = _mm_xor_si128(X2, ROTL_SSE2(_mm_add_epi32(X3, X0), 9));
+            X1 = _mm_xor_si128(X1, ROTL_SSE2(_mm_add_epi32(X2, X3), 13));
+            X0 = _mm_xor_si128(X0, ROTL_SSE2(_mm_add_epi32(X1, X2), 18));
+
+            X1 = _mm_shuffle_epi32(X1, 0x39);
+            X2 = _mm_shuffle_epi32(X2, 0x4E);
+            X3 = _mm_shuffle_epi32(X3, 0x93);
+        }
+
+        X0 = _mm_add_epi32(X0, Y0);
+        X1 = _mm_add_epi32(X1, Y1);
+        X2 = _mm_add_epi32(X2, Y2);
+        X3 = _mm_add_epi32(X3, Y3);
+
+        o = (__m128i*)(out + 16 * ((i & 1) * r + i / 2));
+        _mm_storeu_si128(o, X0);
+        _mm_storeu_si128(o + 1, X1);
+        _mm_storeu_si128(o + 2, X2);
+        _mm_storeu_si128(o + 3, X3);
+    }
+}
+
+#undef ROTL_SSE2
+
+#endif
+
+static meh_scrypt_mix_fn _meh_scrypt_mixer(void)
+{
+#if MEH_HAVE_X86
+    if (meh_cpu_features() & MEH_CPU_SSE2)
+        return _meh_scrypt_mix_sse2;
+#endif
+    return _meh_scrypt_mix;
+}
+
+/* ROMix of one p lane in place. V holds N states of 32r words, XY two.
+   The first loop writes each BlockMix straight into the next slot of V
+   rather than copying, and the second folds the XOR with V[j] into
+   BlockMix. */
+static void _meh_scrypt_smix(unsigned char* B, uint32_t r, uint32_t N,
+                             uint32_t* V, uint32_t* XY, meh_scrypt_mix_fn mix)
+{
+    size_t words = 32 * (size_t)r, i, j;
+    uint32_t* X = XY,
+            * Y = XY + words;
+
+    _meh_scrypt_load(V, B, 2 * (size_t)r);
+
+    for (i = 0; i + 1 < N; i++)
+        mix(V + i * words, NULL, V + (i + 1) * words, r);
+    mix(V + (N - 1) * words, NULL, X, r);
+
+    /* Integerify is word 0 of the last block, which the slot order
+       leaves in place. N is a power of two, so the loop pairs up. */
+    for (i = 0; i < N; i += 2)
+    {
+        j = X[words - 16] & (N - 1);
+        mix(X, V + j * words, Y, r);
+        j = Y[words - 16] & (N - 1);
+        mix(Y, V + j * words, X, r);
+    }
+
+    _meh_scrypt_store(B, X, 2 * (size_t)r);
+}
+
+/* One thread's share of the p lanes, with its own V and XY. */
+typedef struct meh_scrypt_task_s
+{
+    unsigned char* blocks;
+    uint32_t* V,
+            * XY;
+    uint32_t N, r, p,
+             first,
+             step;
+    meh_scrypt_mix_fn mix;
+} meh_scrypt_task_t;
+
+static meh_error_t _meh_scrypt_task(void* arg)
+{
+    meh_scrypt_task_t* t = arg;
+    uint32_t i;
+
+    for (i = t->first; i < t->p; i += t->step)
+        _meh_scrypt_smix(t->blocks + (size_t)128 * t->r * i, t->r, t->N,
+                         t->V, t->XY, t->mix);
+
+    return MEH_OK;
+}
+
+size_t meh_scrypt_context_size(void)
+{
+    return sizeof (meh_scrypt_state_t);
+}
+
+MehScrypt meh_get_scrypt(const unsigned char* password, size_t pass_len,
+                         const unsigned char* salt, size_t salt_len,
+                         unsigned int N, unsigned int r, unsigned int p,
+                         unsigned int threads)
+{
+    MehScrypt kdf;
+    void* mem;
+    size_t size = meh_scrypt_context_size();
+
+    if (NULL == (mem = malloc(size)))
+        return NULL;
+
+    if (NULL == (kdf = meh_init_scrypt(mem, size, password, pass_len, salt,
+                                       salt_len, N, r, p, threads)))
+    {
+        free(mem);
+        return NULL;
+    }
+
+    kdf->allocated = 1;
+
+    return kdf;
+}
+
+/* threads caps how many p lanes are mixed at once; each one running
+   needs its own 128 * r * N bytes. */
+MehScrypt meh_init_scrypt(void* mem, size_t size,
+                          const unsigned char* password, size_t pass_len,
+                          const unsigned char* salt, size_t salt_len,
+                          unsigned int N, unsigned int r, unsigned int p,
+                          unsigned int threads)
+{
+    MehScrypt kdf = mem;
+
+    if (NULL == mem || size < meh_scrypt_context_size() ||
+        !MEH_IS_ALIGNED(mem))
+    {
+        meh_warn("invalid storage passed to meh_init_scrypt");
+        return NULL;
+    }
+
+    _meh_init_arena(&kdf->arena);
+    kdf->threads = (0 == threads) ? 1 : threads;
+    kdf->allocated = 0;
+
+    if (NULL == meh_init_pbkdf2(&kdf->pbkdf2, sizeof (meh_pbkdf2_state_t),
+                                MEH_SHA256, password, pass_len, salt, salt_len,
+                                1))
+        return NULL;
+
+    if (MEH_OK != meh_reset_scrypt(kdf, password, pass_len, salt, salt_len,
+                                   N, r, p))
+    {
+        _meh_release_arena(&kdf->arena);
+        return NULL;
+    }
+
+    return kdf;
+}
+
+/* Run the memory-hard part for a new password and salt, leaving the
+   output ready to read. The arena is kept from one reset to the next,
+   growing only when the new parameters need more. */
+meh_error_t meh_reset_scrypt(MehScrypt kdf,
+                             const unsigned char* password, size_t pass_len,
+                             const unsigned char* salt, size_t salt_len,
+                             unsigned int N, unsigned int r, unsigned int p)
+{
+    meh_scrypt_task_t* tasks;
+    meh_error_t error;
+    size_t limit, block_len, lane_len, got;
+    unsigned int i, workers;
+
+    if (NULL == kdf)
+        return meh_error("invalid argument passed to meh_reset_scrypt",
+                         MEH_INVALID_ARGUMENT);
+
+    /* Nothing is readable until this reset succeeds; pbkdf2 is still
+       keyed for the last password */
+    kdf->ready = 0;
+
+    if (N < 2 || 0 != (N & (N - 1)) || 0 == r || 0 == p ||
+        (uint64_t)r * p >= ((uint64_t)1 << 30) || (1 == r && N >= 65536))
+        return meh_error("invalid argument passed to meh_reset_scrypt",
+                         MEH_INVALID_ARGUMENT);
+
+    workers = (kdf->threads < p) ? kdf->threads : p;
+
+    /* The p blocks, then per worker V and XY */
+    limit = (size_t)-1 / 128 / r;
+    if ((size_t)N + 2 > limit || p > limit)
+        return meh_error("scrypt parameters too large in meh_reset_scrypt",
+                         MEH_OUT_OF_MEMORY);
+
+    block_len = (size_t)128 * r * p;
+    lane_len = (size_t)128 * r * ((size_t)N + 2);
+
+    if (lane_len > ((size_t)-1 - block_len) / workers)
+        return meh_error("scrypt parameters too large in meh_reset_scrypt",
+                         MEH_OUT_OF_MEMORY);
+
+    if (NULL == (tasks = malloc(workers * sizeof (*tasks))))
+        return meh_error("could not allocate tasks in meh_reset_scrypt",
+                         MEH_OUT_OF_MEMORY);
+
+    if (MEH_OK != (error = _meh_reserve_arena(&kdf->arena,
+                                              block_len + workers * lane_len)))
+    {
+        free(tasks);
+        return error;
+    }
+
+    /* B = PBKDF2(password, salt, 1, p * 128 * r) */
+    if (MEH_OK != (error = meh_reset_pbkdf2(&kdf->pbkdf2, password, pass_len,
+                                            salt, salt_len, 1)) ||
+        MEH_OK != (error = meh_update_pbkdf2(&kdf->pbkdf2, kdf->arena.base,
+                                             block_len, &got)))
+    {
+        free(tasks);
+        return error;
+    }
+
+    for (i = 0; i < workers; i++)
+    {
+        tasks[i].blocks = kdf->arena.base;
+        tasks[i].V = (uint32_t*)(kdf->arena.base + block_len + i * lane_len);
+        tasks[i].XY = tasks[i].V + (size_t)32 * r * N;
+        tasks[i].N = N;
+        tasks[i].r = r;
+        tasks[i].p = p;
+        tasks[i].first = i;
+        tasks[i].step = workers;
+        tasks[i].mix = _meh_scrypt_mixer();
+    }
+
+    error = _meh_run_parallel(_meh_scrypt_task, tasks, sizeof (*tasks),
+                              workers, workers);
+    free(tasks);
+
+    if (MEH_OK != error)
+        return error;
+
+    /* The output is PBKDF2(password, B, 1, dkLen), read on demand */
+    if (MEH_OK != (error = meh_reset_pbkdf2(&kdf->pbkdf2, password, pass_len,
+                                            kdf->arena.base, block_len, 1)))
+        return error;
+
+    kdf->ready = 1;
+
+    return MEH_OK;
+}
+
+meh_error_t meh_update_scrypt(MehScrypt kdf, unsigned char* output,
+                              size_t want_len, size_t* get_len)
+{
+    if (NULL == kdf || NULL == get_len)
+        return meh_error("invalid argument passed to meh_update_scrypt",
+                         MEH_INVALID_ARGUMENT);
+
+    if (!kdf->ready)
+    {
+        *get_len = 0;
+        return meh_error("no output after a failed reset in meh_update_scrypt",
+                         MEH_SOURCE_EXHAUSTED);
+    }
+
+    return meh_update_pbkdf2(&kdf->pbkdf2, output, want_len, get_len);
+}
+
+void meh_destroy_scrypt(MehScrypt kdf)
+{
+    if (NULL == kdf)
+    {
+        meh_warn("invalid argument passed to meh_destroy_scrypt");
+        return;
+    }
+
+    _meh_release_arena(&kdf->arena);
+
+    if (kdf->allocated)
+        free(kdf);
+}
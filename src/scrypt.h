@@ -0,0 +1,61 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_SCRYPT_H
+#define MEH_SCRYPT_H
+
+#include "include.h"
+#include "error.h"
+#include "pbkdf2.h"
+#include "arena.h"
+
+typedef struct meh_scrypt_state_s
+{
+    /* PBKDF2-HMAC-SHA256 of the password over the mixed blocks, from
+       which the output is read */
+    meh_pbkdf2_state_t pbkdf2;
+    int ready; /* the last reset succeeded, so pbkdf2 is this password's */
+
+    meh_arena_t arena; /* the blocks, then each thread's V and XY */
+
+    unsigned int threads;
+
+    int allocated; /* storage came from meh_get_scrypt */
+} meh_scrypt_state_t;
+
+typedef meh_scrypt_state_t* MehScrypt;
+
+MehScrypt meh_get_scrypt(const unsigned char*, size_t, const unsigned char*,
+                         size_t, unsigned int, unsigned int, unsigned int,
+                         unsigned int);
+size_t meh_scrypt_context_size(void);
+MehScrypt meh_init_scrypt(void*, size_t, const unsigned char*, size_t,
+                          const unsigned char*, size_t, unsigned int,
+                          unsigned int, unsigned int, unsigned int);
+meh_error_t meh_reset_scrypt(MehScrypt, const unsigned char*, size_t,
+                             const unsigned char*, size_t, unsigned int,
+                             unsigned int, unsigned int);
+meh_error_t meh_update_scrypt(MehScrypt, unsigned char*, size_t, size_t*);
+#define meh_finish_scrypt(x) MEH_OK
+void meh_destroy_scrypt(MehScrypt);
+
+#endif
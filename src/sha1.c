@@ -23,6 +23,7 @@ THE SOFTWARE.
 #include "sha1.h"
 #include "error.h"
 #include "bitwise.h"
+#include "sha_ni.h"
 
 MehSHA1 meh_get_sha1(void)
 {
@@ -52,7 +53,7 @@ void meh_reset_sha1(MehSHA1 ctx)
     memset(ctx->buffer, 0, MEH_SHA1_BLOCK_SIZE);
 }
 
-void meh_process_sha1(MehSHA1 ctx, const unsigned char* data)
+static void _meh_process_sha1_c(MehSHA1 ctx, const unsigned char* data)
 {
     uint32_t A, B, C, D, E, W[80];
 
@@ -158,6 +159,31 @@ void meh_process_sha1(MehSHA1 ctx, const unsigned char* data)
     ctx->state[4] += E;
 }
 
+/* Compress blocks consecutive blocks, with the SHA extensions when the
+   CPU has them. */
+static void _meh_process_blocks_sha1(MehSHA1 ctx, const unsigned char* data,
+                                     size_t blocks)
+{
+#if MEH_HAVE_X86
+    if (meh_cpu_features() & MEH_CPU_SHA)
+    {
+        meh_process_sha1_ni(ctx->state, data, blocks);
+        return;
+    }
+#endif
+
+    while (blocks--)
+    {
+        _meh_process_sha1_c(ctx, data);
+        data += MEH_SHA1_BLOCK_SIZE;
+    }
+}
+
+void meh_process_sha1(MehSHA1 ctx, const unsigned char* data)
+{
+    _meh_process_blocks_sha1(ctx, data, 1);
+}
+
 void meh_update_sha1(MehSHA1 ctx, const unsigned char* data, size_t len)
 {
     uint32_t left, fill;
@@ -175,17 +201,17 @@ void meh_update_sha1(MehSHA1 ctx, const unsigned char* data, size_t len)
     if(left && len >= fill)
     {
         memcpy(ctx->buffer + left, data, fill);
-        meh_process_sha1(ctx, ctx->buffer);
+        _meh_process_blocks_sha1(ctx, ctx->buffer, 1);
         len -= fill;
         data += fill;
         left = 0;
     }
 
-    while(len >= MEH_SHA1_BLOCK_SIZE)
+    if (len >= MEH_SHA1_BLOCK_SIZE)
     {
-        meh_process_sha1(ctx, data);
-        len -= MEH_SHA1_BLOCK_SIZE;
-        data += MEH_SHA1_BLOCK_SIZE;
+        _meh_process_blocks_sha1(ctx, data, len / MEH_SHA1_BLOCK_SIZE);
+        data += len & ~(size_t)(MEH_SHA1_BLOCK_SIZE - 1);
+        len &= MEH_SHA1_BLOCK_SIZE - 1;
     }
 
     if(len)
@@ -216,3 +242,30 @@ void meh_finish_sha1(MehSHA1 ctx, unsigned char* output)
     U32TO8_BIG(output, ctx->state[3], 12);
     U32TO8_BIG(output, ctx->state[4], 16);
 }
+
+/* Chaining state as bytes: bit count, state words, then the buffer. */
+void meh_export_sha1(MehSHA1 ctx, unsigned char* output)
+{
+    int i;
+
+    U32TO8_BIG(output, ctx->total[0], 0);
+    U32TO8_BIG(output, ctx->total[1], 4);
+
+    for (i = 0; i < 5; i++)
+        U32TO8_BIG(output, ctx->state[i], 8 + 4*i);
+
+    memcpy(output + 8 + 20, ctx->buffer, MEH_SHA1_BLOCK_SIZE);
+}
+
+void meh_import_sha1(MehSHA1 ctx, const unsigned char* input)
+{
+    int i;
+
+    ctx->total[0] = U8TO32_BIG(input, 0);
+    ctx->total[1] = U8TO32_BIG(input, 4);
+
+    for (i = 0; i < 5; i++)
+        ctx->state[i] = U8TO32_BIG(input, 8 + 4*i);
+
+    memcpy(ctx->buffer, input + 8 + 20, MEH_SHA1_BLOCK_SIZE);
+}
@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #define MEH_SHA1_HASH_SIZE   20
 #define MEH_SHA1_BLOCK_SIZE  64
+#define MEH_SHA1_EXPORT_SIZE (8 + 20 + MEH_SHA1_BLOCK_SIZE)
 
 typedef struct meh_sha1_state_s
 {
@@ -42,6 +43,9 @@ MehSHA1 meh_get_sha1(void);
 void meh_reset_sha1(MehSHA1);
 void meh_update_sha1(MehSHA1, const unsigned char*, size_t);
 void meh_finish_sha1(MehSHA1, unsigned char*);
+void meh_process_sha1(MehSHA1, const unsigned char*);
 #define meh_destroy_sha1(x) free(x)
+void meh_export_sha1(MehSHA1, unsigned char*);
+void meh_import_sha1(MehSHA1, const unsigned char*);
 
 #endif
@@ -23,8 +23,9 @@ THE SOFTWARE.
 #include "sha256.h"
 #include "error.h"
 #include "bitwise.h"
+#include "sha_ni.h"
 
-static const uint32_t K[64] ={
+const uint32_t _meh_sha256_k[64] = {
     0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
     0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
     0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
@@ -109,7 +110,7 @@ void meh_reset_sha224(MehSHA224 ctx)
     memset(ctx->buffer, 0, MEH_SHA256_BLOCK_SIZE);
 }
 
-void meh_process_sha256(MehSHA256 ctx, const unsigned char* data)
+static void _meh_process_sha256_c(MehSHA256 ctx, const unsigned char* data)
 {
     uint32_t A, B, C, D, E, F, G, H, W[64], t1, t2;
 
@@ -147,7 +148,7 @@ void meh_process_sha256(MehSHA256 ctx, const unsigned char* data)
 #   define SIGMA1(x)  (ROTR32(x,6)^ROTR32(x,11)^ROTR32(x,25))
 #   define MAJ(x,y,z) ((x&y)|(z&(x^y)))
 #   define CH(x,y,z)  (z^(x&(y^z)))
-#   define T1(x)      (H+SIGMA1(E)+CH(E,F,G)+K[x]+W[x])
+#   define T1(x)      (H+SIGMA1(E)+CH(E,F,G)+_meh_sha256_k[x]+W[x])
 #   define T2(x)      (SIGMA0(A)+MAJ(A,B,C))
 #   define STEP(n)    t1=T1(n);t2=T2(n);H=G;G=F;F=E;E=D+t1;D=C;C=B;B=A;A=t1+t2
 
@@ -195,6 +196,32 @@ void meh_process_sha256(MehSHA256 ctx, const unsigned char* data)
     ctx->state[7] += H;
 }
 
+/* Compress blocks consecutive blocks, with the SHA extensions when the
+   CPU has them. */
+static void _meh_process_blocks_sha256(MehSHA256 ctx,
+                                       const unsigned char* data,
+                                       size_t blocks)
+{
+#if MEH_HAVE_X86
+    if (meh_cpu_features() & MEH_CPU_SHA)
+    {
+        meh_process_sha256_ni(ctx->state, data, blocks);
+        return;
+    }
+#endif
+
+    while (blocks--)
+    {
+        _meh_process_sha256_c(ctx, data);
+        data += MEH_SHA256_BLOCK_SIZE;
+    }
+}
+
+void meh_process_sha256(MehSHA256 ctx, const unsigned char* data)
+{
+    _meh_process_blocks_sha256(ctx, data, 1);
+}
+
 void meh_update_sha256(MehSHA256 ctx, const unsigned char* data, size_t len)
 {
     uint32_t left, fill;
@@ -212,17 +239,17 @@ void meh_update_sha256(MehSHA256 ctx, const unsigned char* data, size_t len)
     if (left && len >= fill)
     {
         memcpy(ctx->buffer + left, data, fill);
-        meh_process_sha256(ctx, ctx->buffer);
+        _meh_process_blocks_sha256(ctx, ctx->buffer, 1);
         len -= fill;
         data += fill;
         left = 0;
     }
 
-    while (len >= MEH_SHA256_BLOCK_SIZE)
+    if  (len >= MEH_SHA256_BLOCK_SIZE)
     {
-        meh_process_sha256(ctx, data);
-        len -= MEH_SHA256_BLOCK_SIZE;
-        data += MEH_SHA256_BLOCK_SIZE;
+        _meh_process_blocks_sha256(ctx, data, len / MEH_SHA256_BLOCK_SIZE);
+        data += len & ~(size_t)(MEH_SHA256_BLOCK_SIZE - 1);
+        len &= MEH_SHA256_BLOCK_SIZE - 1;
     }
 
     if (len)
@@ -258,3 +285,30 @@ void meh_finish_sha256(MehSHA256 ctx, unsigned char* output)
     if (MEH_SHA256_HASH_SIZE == ctx->hash_size)
         U32TO8_BIG(output, ctx->state[7], 28);
 }
+
+/* Chaining state as bytes: bit count, state words, then the buffer. */
+void meh_export_sha256(MehSHA256 ctx, unsigned char* output)
+{
+    int i;
+
+    U32TO8_BIG(output, ctx->total[0], 0);
+    U32TO8_BIG(output, ctx->total[1], 4);
+
+    for (i = 0; i < 8; i++)
+        U32TO8_BIG(output, ctx->state[i], 8 + 4*i);
+
+    memcpy(output + 8 + 32, ctx->buffer, MEH_SHA256_BLOCK_SIZE);
+}
+
+void meh_import_sha256(MehSHA256 ctx, const unsigned char* input)
+{
+    int i;
+
+    ctx->total[0] = U8TO32_BIG(input, 0);
+    ctx->total[1] = U8TO32_BIG(input, 4);
+
+    for (i = 0; i < 8; i++)
+        ctx->state[i] = U8TO32_BIG(input, 8 + 4*i);
+
+    memcpy(ctx->buffer, input + 8 + 32, MEH_SHA256_BLOCK_SIZE);
+}
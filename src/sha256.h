@@ -29,6 +29,8 @@ THE SOFTWARE.
 #define MEH_SHA224_HASH_SIZE   28
 #define MEH_SHA256_BLOCK_SIZE  64
 #define MEH_SHA224_BLOCK_SIZE  64
+#define MEH_SHA256_EXPORT_SIZE (8 + 32 + MEH_SHA256_BLOCK_SIZE)
+#define MEH_SHA224_EXPORT_SIZE MEH_SHA256_EXPORT_SIZE
 
 typedef struct meh_sha256_state_s
 {
@@ -47,13 +49,21 @@ MehSHA256 meh_get_sha256(void);
 void meh_reset_sha256(MehSHA256);
 void meh_update_sha256(MehSHA256, const unsigned char*, size_t);
 void meh_finish_sha256(MehSHA256, unsigned char*);
+void meh_process_sha256(MehSHA256, const unsigned char*);
 #define meh_destroy_sha256(x) free(x)
+void meh_export_sha256(MehSHA256, unsigned char*);
+void meh_import_sha256(MehSHA256, const unsigned char*);
+
+/* The round constants, shared with the SHA extension and many-lane code */
+extern const uint32_t _meh_sha256_k[64];
 
 MehSHA224 meh_get_sha224(void);
 void meh_reset_sha224(MehSHA224);
 #define meh_update_sha224(x, y, z) meh_update_sha256((x), (y), (z))
 #define meh_finish_sha224(x, y) meh_finish_sha256((x), (y))
 #define meh_destroy_sha224(x) free(x)
+#define meh_export_sha224(x, y) meh_export_sha256((x), (y))
+#define meh_import_sha224(x, y) meh_import_sha256((x), (y))
 
 #endif
 
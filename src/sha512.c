@@ -23,8 +23,13 @@ THE SOFTWARE.
 #include "sha512.h"
 #include "error.h"
 #include "bitwise.h"
+#include "cpu.h"
 
-static const uint64_t K[80] = {
+#if MEH_HAVE_X86
+#    include <immintrin.h>
+#endif
+
+const uint64_t _meh_sha512_k[80] = {
     UINT64_C(0x428A2F98D728AE22), UINT64_C(0x7137449123EF65CD),
     UINT64_C(0xB5C0FBCFEC4D3B2F), UINT64_C(0xE9B5DBA58189DBBC),
     UINT64_C(0x3956C25BF348B538), UINT64_C(0x59F111F1B605D019),
@@ -133,61 +138,27 @@ void meh_reset_sha384(MehSHA384 ctx)
     memset(ctx->buffer, 0, MEH_SHA512_BLOCK_SIZE);
 }
 
-void meh_process_sha512(MehSHA512 ctx, const unsigned char* data)
+/* The 80 rounds, given a block's expanded schedule with K[] added in. */
+static void _meh_rounds_sha512(uint64_t* state, const uint64_t* WK)
 {
-    uint64_t A, B, C, D, E, F, G, H, W[80], t1, t2;
-
-    W[ 0] = U8TO64_BIG(data,   0); W[ 1] = U8TO64_BIG(data,   8);
-    W[ 2] = U8TO64_BIG(data,  16); W[ 3] = U8TO64_BIG(data,  24);
-    W[ 4] = U8TO64_BIG(data,  32); W[ 5] = U8TO64_BIG(data,  40);
-    W[ 6] = U8TO64_BIG(data,  48); W[ 7] = U8TO64_BIG(data,  56);
-    W[ 8] = U8TO64_BIG(data,  64); W[ 9] = U8TO64_BIG(data,  72);
-    W[10] = U8TO64_BIG(data,  80); W[11] = U8TO64_BIG(data,  88);
-    W[12] = U8TO64_BIG(data,  96); W[13] = U8TO64_BIG(data, 104);
-    W[14] = U8TO64_BIG(data, 112); W[15] = U8TO64_BIG(data, 120);
-
-#   define THETA0(x) (ROTR64(x,1)^ROTR64(x,8)^(x >> 7))
-#   define THETA1(x) (ROTR64(x,19)^ROTR64(x,61)^(x >> 6))
-#   define EXPAND(x) W[x]=THETA1(W[x-2])+W[x-7]+THETA0(W[x-15])+W[x-16];
-
-    EXPAND(16); EXPAND(17); EXPAND(18); EXPAND(19);
-    EXPAND(20); EXPAND(21); EXPAND(22); EXPAND(23);
-    EXPAND(24); EXPAND(25); EXPAND(26); EXPAND(27);
-    EXPAND(28); EXPAND(29); EXPAND(30); EXPAND(31);
-    EXPAND(32); EXPAND(33); EXPAND(34); EXPAND(35);
-    EXPAND(36); EXPAND(37); EXPAND(38); EXPAND(39);
-    EXPAND(40); EXPAND(41); EXPAND(42); EXPAND(43);
-    EXPAND(44); EXPAND(45); EXPAND(46); EXPAND(47);
-    EXPAND(48); EXPAND(49); EXPAND(50); EXPAND(51);
-    EXPAND(52); EXPAND(53); EXPAND(54); EXPAND(55);
-    EXPAND(56); EXPAND(57); EXPAND(58); EXPAND(59);
-    EXPAND(60); EXPAND(61); EXPAND(62); EXPAND(63);
-    EXPAND(64); EXPAND(65); EXPAND(66); EXPAND(67);
-    EXPAND(68); EXPAND(69); EXPAND(70); EXPAND(71);
-    EXPAND(72); EXPAND(73); EXPAND(74); EXPAND(75);
-    EXPAND(76); EXPAND(77); EXPAND(78); EXPAND(79);
-
-
-#   undef EXPAND
-#   undef THETA0
-#   undef THETA1
+    uint64_t A, B, C, D, E, F, G, H, t1, t2;
 
 #   define SIGMA0(x)  (ROTR64(x,28)^ROTR64(x,34)^ROTR64(x,39))
 #   define SIGMA1(x)  (ROTR64(x,14)^ROTR64(x,18)^ROTR64(x,41))
 #   define MAJ(x,y,z) ((x&y)|(z&(x^y)))
 #   define CH(x,y,z)  (z^(x&(y^z)))
-#   define T1(x)      (H+SIGMA1(E)+CH(E,F,G)+K[x]+W[x])
+#   define T1(x)      (H+SIGMA1(E)+CH(E,F,G)+WK[x])
 #   define T2(x)      (SIGMA0(A)+MAJ(A,B,C))
 #   define STEP(n)    t1=T1(n);t2=T2(n);H=G;G=F;F=E;E=D+t1;D=C;C=B;B=A;A=t1+t2
 
-    A = ctx->state[0];
-    B = ctx->state[1];
-    C = ctx->state[2];
-    D = ctx->state[3];
-    E = ctx->state[4];
-    F = ctx->state[5];
-    G = ctx->state[6];
-    H = ctx->state[7];
+    A = state[0];
+    B = state[1];
+    C = state[2];
+    D = state[3];
+    E = state[4];
+    F = state[5];
+    G = state[6];
+    H = state[7];
 
     STEP( 0); STEP( 1); STEP( 2); STEP( 3);
     STEP( 4); STEP( 5); STEP( 6); STEP( 7);
@@ -218,14 +189,159 @@ void meh_process_sha512(MehSHA512 ctx, const unsigned char* data)
 #   undef T2
 #   undef STEP
 
-    ctx->state[0] += A;
-    ctx->state[1] += B;
-    ctx->state[2] += C;
-    ctx->state[3] += D;
-    ctx->state[4] += E;
-    ctx->state[5] += F;
-    ctx->state[6] += G;
-    ctx->state[7] += H;
+    state[0] += A;
+    state[1] += B;
+    state[2] += C;
+    state[3] += D;
+    state[4] += E;
+    state[5] += F;
+    state[6] += G;
+    state[7] += H;
+}
+
+
+static void _meh_process_sha512_c(MehSHA512 ctx, const unsigned char* data)
+{
+    uint64_t W[80];
+    int i;
+
+    W[ 0] = U8TO64_BIG(data,   0); W[ 1] = U8TO64_BIG(data,   8);
+    W[ 2] = U8TO64_BIG(data,  16); W[ 3] = U8TO64_BIG(data,  24);
+    W[ 4] = U8TO64_BIG(data,  32); W[ 5] = U8TO64_BIG(data,  40);
+    W[ 6] = U8TO64_BIG(data,  48); W[ 7] = U8TO64_BIG(data,  56);
+    W[ 8] = U8TO64_BIG(data,  64); W[ 9] = U8TO64_BIG(data,  72);
+    W[10] = U8TO64_BIG(data,  80); W[11] = U8TO64_BIG(data,  88);
+    W[12] = U8TO64_BIG(data,  96); W[13] = U8TO64_BIG(data, 104);
+    W[14] = U8TO64_BIG(data, 112); W[15] = U8TO64_BIG(data, 120);
+
+#   define THETA0(x) (ROTR64(x,1)^ROTR64(x,8)^(x >> 7))
+#   define THETA1(x) (ROTR64(x,19)^ROTR64(x,61)^(x >> 6))
+#   define EXPAND(x) W[x]=THETA1(W[x-2])+W[x-7]+THETA0(W[x-15])+W[x-16];
+
+    EXPAND(16); EXPAND(17); EXPAND(18); EXPAND(19);
+    EXPAND(20); EXPAND(21); EXPAND(22); EXPAND(23);
+    EXPAND(24); EXPAND(25); EXPAND(26); EXPAND(27);
+    EXPAND(28); EXPAND(29); EXPAND(30); EXPAND(31);
+    EXPAND(32); EXPAND(33); EXPAND(34); EXPAND(35);
+    EXPAND(36); EXPAND(37); EXPAND(38); EXPAND(39);
+    EXPAND(40); EXPAND(41); EXPAND(42); EXPAND(43);
+    EXPAND(44); EXPAND(45); EXPAND(46); EXPAND(47);
+    EXPAND(48); EXPAND(49); EXPAND(50); EXPAND(51);
+    EXPAND(52); EXPAND(53); EXPAND(54); EXPAND(55);
+    EXPAND(56); EXPAND(57); EXPAND(58); EXPAND(59);
+    EXPAND(60); EXPAND(61); EXPAND(62); EXPAND(63);
+    EXPAND(64); EXPAND(65); EXPAND(66); EXPAND(67);
+    EXPAND(68); EXPAND(69); EXPAND(70); EXPAND(71);
+    EXPAND(72); EXPAND(73); EXPAND(74); EXPAND(75);
+    EXPAND(76); EXPAND(77); EXPAND(78); EXPAND(79);
+
+#   undef EXPAND
+#   undef THETA0
+#   undef THETA1
+
+    for (i = 0; i < 80; i++)
+        W[i] += _meh_sha512_k[i];
+
+    _meh_rounds_sha512(ctx->state, W);
+}
+
+#if MEH_HAVE_X86
+/* Schedules for two blocks at once. Each 128-bit half of a vector holds
+   a pair of consecutive words from one block, so the recurrence's taps
+   at t-7 and t-15, which straddle pairs, are one alignr per half. */
+__attribute__((target("avx2")))
+static void _meh_process_sha512_avx2(uint64_t* state, const unsigned char* data,
+                                     size_t blocks)
+{
+    const __m256i swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+                                          15, 14, 13, 12, 11, 10, 9, 8,
+                                          7, 6, 5, 4, 3, 2, 1, 0,
+                                          15, 14, 13, 12, 11, 10, 9, 8);
+    const unsigned char* second;
+    uint64_t WK[2][80];
+    __m256i X[40], t, s0, s1;
+    int j;
+
+#   define ROTR(x, n) \
+    _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - (n)))
+#   define LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+
+    while (blocks)
+    {
+        /* With one block left it rides in both halves. */
+        second = (blocks > 1) ? data + MEH_SHA512_BLOCK_SIZE : data;
+
+        for (j = 0; j < 8; j++)
+        {
+            t = _mm256_castsi128_si256(LOAD(data + 16 * j));
+            t = _mm256_inserti128_si256(t, LOAD(second + 16 * j), 1);
+            X[j] = _mm256_shuffle_epi8(t, swap);
+        }
+
+        for (j = 8; j < 40; j++)
+        {
+            t = _mm256_alignr_epi8(X[j - 7], X[j - 8], 8);
+            s0 = _mm256_xor_si256(_mm256_xor_si256(ROTR(t, 1), ROTR(t, 8)),
+                                  _mm256_srli_epi64(t, 7));
+            t = X[j - 1];
+            s1 = _mm256_xor_si256(_mm256_xor_si256(ROTR(t, 19), ROTR(t, 61)),
+                                  _mm256_srli_epi64(t, 6));
+            t = _mm256_add_epi64(X[j - 8], s0);
+            t = _mm256_add_epi64(t, _mm256_alignr_epi8(X[j - 3], X[j - 4], 8));
+            X[j] = _mm256_add_epi64(t, s1);
+        }
+
+        for (j = 0; j < 40; j++)
+        {
+            t = _mm256_add_epi64(X[j],
+                                 _mm256_broadcastsi128_si256(LOAD(&_meh_sha512_k[2 * j])));
+            _mm_storeu_si128((__m128i*)&WK[0][2 * j],
+                             _mm256_castsi256_si128(t));
+            _mm_storeu_si128((__m128i*)&WK[1][2 * j],
+                             _mm256_extracti128_si256(t, 1));
+        }
+
+        _meh_rounds_sha512(state, WK[0]);
+        data += MEH_SHA512_BLOCK_SIZE;
+        blocks--;
+
+        if (blocks)
+        {
+            _meh_rounds_sha512(state, WK[1]);
+            data += MEH_SHA512_BLOCK_SIZE;
+            blocks--;
+        }
+    }
+
+#   undef ROTR
+#   undef LOAD
+}
+#endif
+
+/* Compress blocks consecutive blocks, computing message schedules with
+   AVX2 when the CPU has it. */
+static void _meh_process_blocks_sha512(MehSHA512 ctx,
+                                       const unsigned char* data,
+                                       size_t blocks)
+{
+#if MEH_HAVE_X86
+    if (meh_cpu_features() & MEH_CPU_AVX2)
+    {
+        _meh_process_sha512_avx2(ctx->state, data, blocks);
+        return;
+    }
+#endif
+
+    while (blocks--)
+    {
+        _meh_process_sha512_c(ctx, data);
+        data += MEH_SHA512_BLOCK_SIZE;
+    }
+}
+
+void meh_process_sha512(MehSHA512 ctx, const unsigned char* data)
+{
+    _meh_process_blocks_sha512(ctx, data, 1);
 }
 
 void meh_update_sha512(MehSHA512 ctx, const unsigned char* data, size_t len)
@@ -245,17 +361,17 @@ void meh_update_sha512(MehSHA512 ctx, const unsigned char* data, size_t len)
     if (left && len >= fill)
     {
         memcpy(ctx->buffer + left, data, fill);
-        meh_process_sha512(ctx, ctx->buffer);
+        _meh_process_blocks_sha512(ctx, ctx->buffer, 1);
         len -= fill;
         data += fill;
         left = 0;
     }
 
-    while (len >= MEH_SHA512_BLOCK_SIZE)
+    if (len >= MEH_SHA512_BLOCK_SIZE)
     {
-        meh_process_sha512(ctx, data);
-        len -= MEH_SHA512_BLOCK_SIZE;
-        data += MEH_SHA512_BLOCK_SIZE;
+        _meh_process_blocks_sha512(ctx, data, len / MEH_SHA512_BLOCK_SIZE);
+        data += len & ~(size_t)(MEH_SHA512_BLOCK_SIZE - 1);
+        len &= MEH_SHA512_BLOCK_SIZE - 1;
     }
 
     if (len)
@@ -293,3 +409,30 @@ void meh_finish_sha512(MehSHA512 ctx, unsigned char* output)
         U64TO8_BIG(output, ctx->state[7], 56);
     }
 }
+
+/* Chaining state as bytes: bit count, state words, then the buffer. */
+void meh_export_sha512(MehSHA512 ctx, unsigned char* output)
+{
+    int i;
+
+    U32TO8_BIG(output, ctx->total[0], 0);
+    U32TO8_BIG(output, ctx->total[1], 4);
+
+    for (i = 0; i < 8; i++)
+        U64TO8_BIG(output, ctx->state[i], 8 + 8*i);
+
+    memcpy(output + 8 + 64, ctx->buffer, MEH_SHA512_BLOCK_SIZE);
+}
+
+void meh_import_sha512(MehSHA512 ctx, const unsigned char* input)
+{
+    int i;
+
+    ctx->total[0] = U8TO32_BIG(input, 0);
+    ctx->total[1] = U8TO32_BIG(input, 4);
+
+    for (i = 0; i < 8; i++)
+        ctx->state[i] = U8TO64_BIG(input, 8 + 8*i);
+
+    memcpy(ctx->buffer, input + 8 + 64, MEH_SHA512_BLOCK_SIZE);
+}
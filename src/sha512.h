@@ -29,6 +29,8 @@ THE SOFTWARE.
 #define MEH_SHA384_HASH_SIZE   48
 #define MEH_SHA512_BLOCK_SIZE  128
 #define MEH_SHA384_BLOCK_SIZE  128
+#define MEH_SHA512_EXPORT_SIZE (8 + 64 + MEH_SHA512_BLOCK_SIZE)
+#define MEH_SHA384_EXPORT_SIZE MEH_SHA512_EXPORT_SIZE
 
 typedef struct meh_sha512_state_s
 {
@@ -48,13 +50,21 @@ MehSHA512 meh_get_sha512(void);
 void meh_reset_sha512(MehSHA512);
 void meh_update_sha512(MehSHA512, const unsigned char*, size_t);
 void meh_finish_sha512(MehSHA512, unsigned char*);
+void meh_process_sha512(MehSHA512, const unsigned char*);
 #define meh_destroy_sha512(x) free(x)
+void meh_export_sha512(MehSHA512, unsigned char*);
+void meh_import_sha512(MehSHA512, const unsigned char*);
+
+/* The round constants, shared with the many-lane code */
+extern const uint64_t _meh_sha512_k[80];
 
 MehSHA384 meh_get_sha384(void);
 void meh_reset_sha384(MehSHA384);
 #define meh_update_sha384(x, y, z) meh_update_sha512((x), (y), (z))
 #define meh_finish_sha384(x, y) meh_finish_sha512((x), (y))
 #define meh_destroy_sha384(x) free(x)
+#define meh_export_sha384(x, y) meh_export_sha512((x), (y))
+#define meh_import_sha384(x, y) meh_import_sha512((x), (y))
 
 #endif
 
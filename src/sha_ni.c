@@ -0,0 +1,171 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "sha_ni.h"
+#include "sha256.h"
+
+#if MEH_HAVE_X86
+
+#include <immintrin.h>
+
+#define MEH_SHA_NI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+
+MEH_SHA_NI_TARGET
+void meh_process_sha256_ni(uint32_t* state, const unsigned char* data,
+                           size_t blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+                                        0x0405060700010203ULL);
+    __m128i s0, s1, save0, save1, msg, tmp, m0, m1, m2, m3;
+
+    /* The instructions want the state as ABEF and CDGH. */
+    tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1);
+    s1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B);
+    s0 = _mm_alignr_epi8(tmp, s1, 8);
+    s1 = _mm_blend_epi16(s1, tmp, 0xF0);
+
+#   define LOAD(m, i) \
+    m = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16*i)), mask)
+#   define ROUNDS(i, m)                                                  \
+    msg = _mm_add_epi32(m, _mm_loadu_si128((const __m128i*)&_meh_sha256_k[4*i])); \
+    s1 = _mm_sha256rnds2_epu32(s1, s0, msg);                             \
+    s0 = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(msg, 0x0E))
+#   define NEXT(mc, mp, mn)                                              \
+    tmp = _mm_alignr_epi8(mc, mp, 4);                                    \
+    mn = _mm_sha256msg2_epu32(_mm_add_epi32(mn, tmp), mc)
+#   define STEP(i, mc, mp, mn) \
+    ROUNDS(i, mc); NEXT(mc, mp, mn); mp = _mm_sha256msg1_epu32(mp, mc)
+
+    while (blocks--)
+    {
+        save0 = s0;
+        save1 = s1;
+
+        LOAD(m0, 0); LOAD(m1, 1); LOAD(m2, 2); LOAD(m3, 3);
+
+        ROUNDS(0, m0);
+        ROUNDS(1, m1); m0 = _mm_sha256msg1_epu32(m0, m1);
+        ROUNDS(2, m2); m1 = _mm_sha256msg1_epu32(m1, m2);
+        STEP( 3, m3, m2, m0); STEP( 4, m0, m3, m1);
+        STEP( 5, m1, m0, m2); STEP( 6, m2, m1, m3);
+        STEP( 7, m3, m2, m0); STEP( 8, m0, m3, m1);
+        STEP( 9, m1, m0, m2); STEP(10, m2, m1, m3);
+        STEP(11, m3, m2, m0); STEP(12, m0, m3, m1);
+        ROUNDS(13, m1); NEXT(m1, m0, m2);
+        ROUNDS(14, m2); NEXT(m2, m1, m3);
+        ROUNDS(15, m3);
+
+        s0 = _mm_add_epi32(s0, save0);
+        s1 = _mm_add_epi32(s1, save1);
+
+        data += 64;
+    }
+
+#   undef LOAD
+#   undef ROUNDS
+#   undef NEXT
+#   undef STEP
+
+    tmp = _mm_shuffle_epi32(s0, 0x1B);
+    s1 = _mm_shuffle_epi32(s1, 0xB1);
+    s0 = _mm_blend_epi16(tmp, s1, 0xF0);
+    s1 = _mm_alignr_epi8(s1, tmp, 8);
+
+    _mm_storeu_si128((__m128i*)&state[0], s0);
+    _mm_storeu_si128((__m128i*)&state[4], s1);
+}
+
+MEH_SHA_NI_TARGET
+void meh_process_sha1_ni(uint32_t* state, const unsigned char* data,
+                         size_t blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL,
+                                        0x08090a0b0c0d0e0fULL);
+    __m128i abcd, e0, e1, save_abcd, save_e, m0, m1, m2, m3;
+
+    abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0x1B);
+    e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+#   define LOAD(m, i) \
+    m = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16*i)), mask)
+#   define ROUNDS(ein, eout, mc, f)                                      \
+    ein = _mm_sha1nexte_epu32(ein, mc);                                  \
+    eout = abcd;                                                         \
+    abcd = _mm_sha1rnds4_epu32(abcd, ein, f)
+    /* Rounds for one group of four, then the schedule work it feeds:
+       finish the next group's words, start those three groups out. */
+#   define STEP(ein, eout, mc, mn, mpp, mp, f)                           \
+    ROUNDS(ein, eout, mc, f);                                            \
+    mn = _mm_sha1msg2_epu32(mn, mc);                                     \
+    mp = _mm_sha1msg1_epu32(mp, mc);                                     \
+    mpp = _mm_xor_si128(mpp, mc)
+
+    while (blocks--)
+    {
+        save_abcd = abcd;
+        save_e = e0;
+
+        LOAD(m0, 0); LOAD(m1, 1); LOAD(m2, 2); LOAD(m3, 3);
+
+        e0 = _mm_add_epi32(e0, m0);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+        ROUNDS(e1, e0, m1, 0); m0 = _mm_sha1msg1_epu32(m0, m1);
+        ROUNDS(e0, e1, m2, 0); m1 = _mm_sha1msg1_epu32(m1, m2);
+        m0 = _mm_xor_si128(m0, m2);
+
+        STEP(e1, e0, m3, m0, m1, m2, 0); STEP(e0, e1, m0, m1, m2, m3, 0);
+        STEP(e1, e0, m1, m2, m3, m0, 1); STEP(e0, e1, m2, m3, m0, m1, 1);
+        STEP(e1, e0, m3, m0, m1, m2, 1); STEP(e0, e1, m0, m1, m2, m3, 1);
+        STEP(e1, e0, m1, m2, m3, m0, 1); STEP(e0, e1, m2, m3, m0, m1, 2);
+        STEP(e1, e0, m3, m0, m1, m2, 2); STEP(e0, e1, m0, m1, m2, m3, 2);
+        STEP(e1, e0, m1, m2, m3, m0, 2); STEP(e0, e1, m2, m3, m0, m1, 2);
+        STEP(e1, e0, m3, m0, m1, m2, 3); STEP(e0, e1, m0, m1, m2, m3, 3);
+
+        ROUNDS(e1, e0, m1, 3);
+        m2 = _mm_sha1msg2_epu32(m2, m1);
+        m3 = _mm_xor_si128(m3, m1);
+        ROUNDS(e0, e1, m2, 3);
+        m3 = _mm_sha1msg2_epu32(m3, m2);
+        ROUNDS(e1, e0, m3, 3);
+
+        e0 = _mm_sha1nexte_epu32(e0, save_e);
+        abcd = _mm_add_epi32(abcd, save_abcd);
+
+        data += 64;
+    }
+
+#   undef LOAD
+#   undef ROUNDS
+#   undef STEP
+
+    _mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+#else
+
+/* Nothing to build without x86 intrinsics; keep the unit non-empty. */
+typedef int meh_sha_ni_unused_t;
+
+#endif
@@ -0,0 +1,134 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/* pthreads are POSIX, outside what -std=c99 exposes. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "thread.h"
+
+#if MEH_HAVE_THREADS
+#    include <pthread.h>
+#endif
+
+typedef struct meh_worker_s
+{
+    meh_task_fn task;
+    unsigned char* tasks;
+    size_t size,
+           count,
+           first,  /* this worker runs first, first + step, ... */
+           step;
+    meh_error_t error;
+} meh_worker_t;
+
+static void* _meh_worker(void* arg)
+{
+    meh_worker_t* w = arg;
+    meh_error_t error;
+    size_t i;
+
+    w->error = MEH_OK;
+    for (i = w->first; i < w->count; i += w->step)
+        if (MEH_OK != (error = w->task(w->tasks + i * w->size)) &&
+            MEH_OK == w->error)
+            w->error = error;
+
+    return NULL;
+}
+
+meh_error_t _meh_run_parallel(meh_task_fn task, void* tasks, size_t size,
+                              size_t count, unsigned int threads)
+{
+    meh_worker_t one;
+    meh_error_t error = MEH_OK;
+#if MEH_HAVE_THREADS
+    meh_worker_t* workers;
+    pthread_t* ids;
+    int* started;
+    size_t i, n;
+
+    n = (threads < count) ? threads : count;
+
+    if (n > 1)
+    {
+        workers = malloc(n * sizeof (*workers));
+        ids = malloc(n * sizeof (*ids));
+        started = malloc(n * sizeof (*started));
+
+        if (NULL != workers && NULL != ids && NULL != started)
+        {
+            for (i = 0; i < n; i++)
+            {
+                workers[i].task = task;
+                workers[i].tasks = tasks;
+                workers[i].size = size;
+                workers[i].count = count;
+                workers[i].first = i;
+                workers[i].step = n;
+            }
+
+            /* Worker 0 is this thread; a share whose thread could not
+               be started is run here too. */
+            for (i = 1; i < n; i++)
+                started[i] = (0 == pthread_create(&ids[i], NULL,
+                                                  _meh_worker, &workers[i]));
+
+            _meh_worker(&workers[0]);
+            error = workers[0].error;
+
+            for (i = 1; i < n; i++)
+            {
+                if (started[i])
+                    pthread_join(ids[i], NULL);
+                else
+                    _meh_worker(&workers[i]);
+
+                if (MEH_OK == error)
+                    error = workers[i].error;
+            }
+
+            free(workers);
+            free(ids);
+            free(started);
+
+            return error;
+        }
+
+        free(workers);
+        free(ids);
+        free(started);
+    }
+#else
+    (void)threads;
+#endif
+
+    one.task = task;
+    one.tasks = tasks;
+    one.size = size;
+    one.count = count;
+    one.first = 0;
+    one.step = 1;
+    _meh_worker(&one);
+    error = one.error;
+
+    return error;
+}
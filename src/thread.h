@@ -0,0 +1,44 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef MEH_THREAD_H
+#define MEH_THREAD_H
+
+#include "include.h"
+#include "error.h"
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#    define MEH_HAVE_THREADS 1
+#else
+#    define MEH_HAVE_THREADS 0
+#endif
+
+typedef meh_error_t (*meh_task_fn)(void*);
+
+/* Run task on each of count records of size bytes starting at tasks,
+   spread over at most threads threads including the caller's. Returns
+   the first error any task reported. Without thread support, or when
+   threads is 0 or 1, the tasks simply run in order. */
+meh_error_t _meh_run_parallel(meh_task_fn, void*, size_t, size_t,
+                              unsigned int);
+
+#endif
@@ -0,0 +1,199 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * Vector taken from RFC 8439, section 2.8.2.
+ */
+START_TEST (test_chacha20_poly1305)
+{
+  const char* plaintext = "Ladies and Gentlemen of the class of '99: "
+                          "If I could offer you only one tip for the "
+                          "future, sunscreen would be it.";
+  const unsigned char nonce[12] = {
+    0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43,
+    0x44, 0x45, 0x46, 0x47
+  };
+  const unsigned char ad[12] = {
+    0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7
+  };
+  unsigned char key[32], data[114], tag[16];
+  MehAEAD a;
+  meh_error_t result;
+  int i;
+
+  for (i = 0; i < 32; i++)
+    key[i] = (unsigned char)(0x80 + i);
+
+  a = meh_get_aead(MEH_CHACHA20_POLY1305, key, sizeof (key));
+  fail_if(NULL == a, "Could not allocate AEAD context.");
+  fail_unless(12 == meh_aead_nonce_size(a), NULL);
+  fail_unless(16 == meh_aead_tag_size(a), NULL);
+
+  result = meh_aead_seal(a, nonce, sizeof (nonce), ad, sizeof (ad),
+                         (const unsigned char *)plaintext, 114, data, tag);
+  fail_unless(MEH_OK == result, NULL);
+  fail_unless(raw_equals_hex(data,
+                             "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+                             "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+                             "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+                             "3ff4def08e4b7a9de576d26586cec64b6116",
+                             114), NULL);
+  fail_unless(raw_equals_hex(tag, "1ae10b594f09e26a7e902ecbd0600691", 16), NULL);
+
+  /* Opens in place */
+  result = meh_aead_open(a, nonce, sizeof (nonce), ad, sizeof (ad),
+                         data, 114, data, tag);
+  fail_unless(MEH_OK == result, NULL);
+  fail_unless(0 == memcmp(data, plaintext, 114), NULL);
+
+  /* Any change to the associated data, ciphertext or tag is caught */
+  meh_aead_seal(a, nonce, sizeof (nonce), ad, sizeof (ad),
+                (const unsigned char *)plaintext, 114, data, tag);
+  result = meh_aead_open(a, nonce, sizeof (nonce), ad, sizeof (ad) - 1,
+                         data, 114, data, tag);
+  fail_unless(MEH_AUTH_FAILED == result, NULL);
+
+  meh_aead_seal(a, nonce, sizeof (nonce), ad, sizeof (ad),
+                (const unsigned char *)plaintext, 114, data, tag);
+  data[100] ^= 1;
+  result = meh_aead_open(a, nonce, sizeof (nonce), ad, sizeof (ad),
+                         data, 114, data, tag);
+  fail_unless(MEH_AUTH_FAILED == result, NULL);
+
+  /* No plaintext is released */
+  for (i = 0; i < 114; i++)
+    fail_unless(0 == data[i], NULL);
+
+  /* Empty associated data may be NULL, as may an empty message */
+  result = meh_aead_seal(a, nonce, sizeof (nonce), NULL, 0,
+                         (const unsigned char *)plaintext, 114, data, tag);
+  fail_unless(MEH_OK == result, NULL);
+  result = meh_aead_open(a, nonce, sizeof (nonce), ad, 0, data, 114, data,
+                         tag);
+  fail_unless(MEH_OK == result, NULL);
+  fail_unless(0 == memcmp(data, plaintext, 114), NULL);
+
+  result = meh_aead_seal(a, nonce, sizeof (nonce), NULL, 0, NULL, 0, NULL,
+                         tag);
+  fail_unless(MEH_OK == result, NULL);
+  result = meh_aead_open(a, nonce, sizeof (nonce), NULL, 0, NULL, 0, NULL,
+                         tag);
+  fail_unless(MEH_OK == result, NULL);
+
+  /* Past the keystream of one nonce: refused before anything is
+     decrypted, so out is left as it was */
+  if (sizeof (size_t) > 4)
+  {
+    memset(data, 0xAA, sizeof (data));
+    result = meh_aead_open(a, nonce, sizeof (nonce), ad, sizeof (ad), data,
+                           (size_t)MEH_CHACHA20POLY1305_MAX_LEN + 1, data,
+                           tag);
+    fail_unless(MEH_SOURCE_EXHAUSTED == result, NULL);
+    for (i = 0; i < 114; i++)
+      fail_unless(0xAA == data[i], NULL);
+
+    result = meh_aead_seal(a, nonce, sizeof (nonce), ad, sizeof (ad), data,
+                           (size_t)MEH_CHACHA20POLY1305_MAX_LEN + 1, data,
+                           tag);
+    fail_unless(MEH_SOURCE_EXHAUSTED == result, NULL);
+  }
+
+  /* Bad sizes */
+  fail_unless(MEH_INVALID_IV_SIZE == meh_aead_seal(a, nonce, 8, ad, 0, data, 0,
+                                                   data, tag), NULL);
+  fail_unless(MEH_INVALID_KEY_SIZE == meh_reset_aead(a, key, 16), NULL);
+
+  meh_destroy_aead(a);
+}
+END_TEST
+
+/**
+ * A message spanning several internal chunks, checked against an
+ * independent implementation, with and without the vector paths.
+ */
+START_TEST (test_chacha20_poly1305_long)
+{
+  const unsigned int masks[] = {MEH_CPU_ALL, 0};
+  const size_t len = 20000;
+  unsigned char key[32], nonce[12], ad[37], tag[16];
+  unsigned char* in,
+               * out;
+  meh_align_t storage[16];
+  MehAEAD a;
+  meh_error_t result;
+  size_t i, j;
+
+  for (i = 0; i < sizeof (key); i++)
+    key[i] = (unsigned char)i;
+  for (i = 0; i < sizeof (nonce); i++)
+    nonce[i] = (unsigned char)i;
+  for (i = 0; i < sizeof (ad); i++)
+    ad[i] = (unsigned char)i;
+
+  in = malloc(len);
+  out = malloc(len);
+  fail_if(NULL == in || NULL == out, "Could not allocate AEAD buffers.");
+
+  for (i = 0; i < len; i++)
+    in[i] = (unsigned char)(i * 31 + 7);
+
+  fail_unless(meh_aead_context_size(MEH_CHACHA20_POLY1305) <= sizeof (storage), NULL);
+  a = meh_init_aead(storage, sizeof (storage), MEH_CHACHA20_POLY1305, key, sizeof (key));
+  fail_if(NULL == a, "Could not build AEAD context.");
+
+  for (j = 0; j < sizeof (masks) / sizeof (masks[0]); j++) {
+    meh_mask_cpu_features(masks[j]);
+
+    result = meh_aead_seal(a, nonce, sizeof (nonce), ad, sizeof (ad),
+                           in, len, out, tag);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(tag, "48b86b204d06e80048f9d683162c5e43", 16), NULL);
+
+    result = meh_aead_open(a, nonce, sizeof (nonce), ad, sizeof (ad),
+                           out, len, out, tag);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(0 == memcmp(in, out, len), NULL);
+  }
+
+  meh_mask_cpu_features(MEH_CPU_ALL);
+  meh_destroy_aead(a);
+  free(in);
+  free(out);
+}
+END_TEST
+
+Suite* aead_suite(void)
+{
+  Suite* test_aeads;
+  TCase* tcase_chacha20_poly1305;
+
+  test_aeads = suite_create("AEADs");
+
+  tcase_chacha20_poly1305 = tcase_create("ChaCha20-Poly1305");
+  tcase_add_test(tcase_chacha20_poly1305, test_chacha20_poly1305);
+  tcase_add_test(tcase_chacha20_poly1305, test_chacha20_poly1305_long);
+
+  suite_add_tcase(test_aeads, tcase_chacha20_poly1305);
+
+  return test_aeads;
+}
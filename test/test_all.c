@@ -62,13 +62,22 @@ bool raw_equals_hex(unsigned char* raw, char* hex, size_t len_raw)
 
 #include "test_hashes.c"
 #include "test_stream_ciphers.c"
+#include "test_macs.c"
+#include "test_kdfs.c"
+#include "test_aeads.c"
 
 int main(void) {
     Suite* test_hashes,
-         * test_stream_ciphers;
+         * test_stream_ciphers,
+         * test_macs,
+         * test_kdfs,
+         * test_aeads;
 
     SRunner* sr_test_hashes,
-           * sr_test_stream_ciphers;
+           * sr_test_stream_ciphers,
+           * sr_test_macs,
+           * sr_test_kdfs,
+           * sr_test_aeads;
 
   test_hashes = hash_suite();
   sr_test_hashes = srunner_create(test_hashes);
@@ -80,5 +89,20 @@ int main(void) {
   srunner_run_all(sr_test_stream_ciphers, CK_NORMAL);
   srunner_free(sr_test_stream_ciphers);
 
+  test_macs = mac_suite();
+  sr_test_macs = srunner_create(test_macs);
+  srunner_run_all(sr_test_macs, CK_NORMAL);
+  srunner_free(sr_test_macs);
+
+  test_kdfs = kdf_suite();
+  sr_test_kdfs = srunner_create(test_kdfs);
+  srunner_run_all(sr_test_kdfs, CK_NORMAL);
+  srunner_free(sr_test_kdfs);
+
+  test_aeads = aead_suite();
+  sr_test_aeads = srunner_create(test_aeads);
+  srunner_run_all(sr_test_aeads, CK_NORMAL);
+  srunner_free(sr_test_aeads);
+
   return EXIT_SUCCESS;
 }
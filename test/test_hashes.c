@@ -746,6 +746,779 @@ START_TEST (test_sha512_large_input_vector)
 }
 END_TEST
 
+/**
+ * BLAKE2b and BLAKE2s at their full digest lengths, including a
+ * message spanning many blocks.
+ */
+START_TEST (test_blake2_standard_vectors)
+{
+  const struct {
+    meh_hash_id id;
+    const char* message;
+    const char* expected;
+  } vectors[] = {
+    {MEH_BLAKE2B, "",
+     "786a02f742015903c6c6fd852552d272912f4740e15847618a86e217f71f5419"
+     "d25e1031afee585313896444934eb04b903a685b1448b755d56f701afe9be2ce"},
+    {MEH_BLAKE2B, "abc",
+     "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+     "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923"},
+    {MEH_BLAKE2B, "message digest",
+     "3c26ce487b1c0f062363afa3c675ebdbf5f4ef9bdc022cfbef91e3111cdc2838"
+     "40d8331fc30a8a0906cff4bcdbcd230c61aaec60fdfad457ed96b709a382359a"},
+    {MEH_BLAKE2S, "",
+     "69217a3079908094e11121d042354a7c1f55b6482ca1a51e1b250dfd1ed0eef9"},
+    {MEH_BLAKE2S, "abc",
+     "508c5e8c327c14e2e1a72ba34eeb452f37458b209ed63a294d999b4c86675982"},
+    {MEH_BLAKE2S, "message digest",
+     "fa10ab775acf89b7d3c8a6e823d586f6b67bdbac4ce207fe145b7d3ac25cd28c"}
+  };
+  MehHash h;
+  meh_error_t result;
+  unsigned char hash[MEH_BLAKE2B_HASH_SIZE];
+  size_t i;
+  int j;
+
+  for (i = 0; i < sizeof (vectors) / sizeof (vectors[0]); i++) {
+    h = meh_get_hash(vectors[i].id);
+    fail_if(NULL == h, "Could not allocate hash context.");
+
+    result = meh_update_hash(h, (const unsigned char*)vectors[i].message,
+                             strlen(vectors[i].message));
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_finish_hash(h, hash);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(hash, (char*)vectors[i].expected,
+                               meh_hash_output_size(h)), NULL);
+
+    meh_destroy_hash(h);
+  }
+
+  /* One million a's, fed ten at a time */
+  h = meh_get_hash(MEH_BLAKE2B);
+  fail_if(NULL == h, "Could not allocate hash context.");
+  for (j = 0; j < 100000; j++)
+    meh_update_hash(h, (const unsigned char*)"aaaaaaaaaa", 10);
+  meh_finish_hash(h, hash);
+  fail_unless(raw_equals_hex(hash,
+			     "98fb3efb7206fd19ebf69b6f312cf7b64e3b94dbe1a17107913975a793f177e1"
+			     "d077609d7fba363cbba00d05f7aa4e4fa8715d6428104c0a75643b0ff3fd3eaf",
+			     MEH_BLAKE2B_HASH_SIZE), NULL);
+  meh_destroy_hash(h);
+
+  h = meh_get_hash(MEH_BLAKE2S);
+  fail_if(NULL == h, "Could not allocate hash context.");
+  for (j = 0; j < 100000; j++)
+    meh_update_hash(h, (const unsigned char*)"aaaaaaaaaa", 10);
+  meh_finish_hash(h, hash);
+  fail_unless(raw_equals_hex(hash,
+			     "bec0c0e6cde5b67acb73b81f79a67a4079ae1c60dac9d2661af18e9f8b50dfa5",
+			     MEH_BLAKE2S_HASH_SIZE), NULL);
+  meh_destroy_hash(h);
+}
+END_TEST
+
+/**
+ * Keyed and shortened BLAKE2 digests; the settings survive a reset
+ * and are refused by hashes that have none.
+ */
+START_TEST (test_blake2_keyed)
+{
+  MehHash h;
+  meh_error_t result;
+  unsigned char key[64], message[200], hash[MEH_BLAKE2B_HASH_SIZE];
+  int i;
+
+  for (i = 0; i < 64; i++)
+    key[i] = (unsigned char)i;
+  for (i = 0; i < 200; i++)
+    message[i] = (unsigned char)i;
+
+  h = meh_get_hash(MEH_BLAKE2B);
+  fail_if(NULL == h, "Could not allocate hash context.");
+
+  result = meh_configure_hash(h, key, 64, 64);
+  fail_unless(MEH_OK == result, NULL);
+  meh_update_hash(h, message, 200);
+  meh_finish_hash(h, hash);
+  fail_unless(raw_equals_hex(hash,
+			     "3095a349d245708c7cf550118703d7302c27b60af5d4e67fc978f8a4e60953c7"
+			     "a04f92fcf41aee64321ccb707a895851552b1e37b00bc5e6b72fa5bcef9e3fff",
+			     64), NULL);
+
+  result = meh_configure_hash(h, key, 16, 32);
+  fail_unless(MEH_OK == result, NULL);
+  fail_unless(32 == meh_hash_output_size(h), NULL);
+
+  for (i = 0; i < 2; i++) {
+    meh_update_hash(h, message, 77);
+    meh_update_hash(h, message + 77, 123);
+    meh_finish_hash(h, hash);
+    fail_unless(raw_equals_hex(hash,
+			       "e5c154eb689623af8ed87abbe8fa2ee8fe13b9691b13dc8c05f06fec8813a213",
+			       32), NULL);
+    meh_reset_hash(h);
+  }
+
+  result = meh_configure_hash(h, key, 65, 64);
+  fail_unless(MEH_INVALID_ARGUMENT == result, NULL);
+  result = meh_configure_hash(h, NULL, 0, 65);
+  fail_unless(MEH_INVALID_ARGUMENT == result, NULL);
+  meh_destroy_hash(h);
+
+  h = meh_get_hash(MEH_BLAKE2S);
+  fail_if(NULL == h, "Could not allocate hash context.");
+
+  result = meh_configure_hash(h, key, 32, 32);
+  fail_unless(MEH_OK == result, NULL);
+  meh_update_hash(h, message, 200);
+  meh_finish_hash(h, hash);
+  fail_unless(raw_equals_hex(hash,
+			     "13c88480a5d00d6c8c7ad2110d76a82d9b70f4fa6696d4e5dd42a066dcaf9920",
+			     32), NULL);
+
+  result = meh_configure_hash(h, NULL, 0, 20);
+  fail_unless(MEH_OK == result, NULL);
+  meh_update_hash(h, message, 200);
+  meh_finish_hash(h, hash);
+  fail_unless(raw_equals_hex(hash, "35ef51251df08437c4d5c7ecd7662b56d0a3f07c",
+                             20), NULL);
+  meh_destroy_hash(h);
+
+  h = meh_get_hash(MEH_SHA256);
+  fail_if(NULL == h, "Could not allocate hash context.");
+  result = meh_configure_hash(h, key, 16, 32);
+  fail_unless(MEH_INVALID_HASH == result, NULL);
+  meh_destroy_hash(h);
+}
+END_TEST
+
+/**
+ * BLAKE3 over the reference test inputs (byte i is i mod 251), plain
+ * and keyed, across chunk and tree boundaries.
+ */
+START_TEST (test_blake3_standard_vectors)
+{
+  const struct {
+    size_t len;
+    const char* plain;
+    const char* keyed;
+  } vectors[] = {
+    {0, "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262",
+        "2e662f6ac66c19ffc6d1d4d9516f4d098d62e82aa155a32ad81ed7aba4de6f9e"},
+    {1, "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213",
+        "9caa3e892eea7e148fa8b3bf2ba78472dd48085101f5f1f1d7c31b004775d0e6"},
+    {1023, "10108970eeda3eb932baac1428c7a2163b0e924c9a9e25b35bba72b28f70bd11",
+           "887daee6a0d32a41133794a1887f6dd9b110120188f0942a2fd6dadd1f45da1b"},
+    {1024, "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7",
+           "4a0cf52c73516ab4f8dd88905b367e90cab58d6adb80cf4a4af2e1106891c99b"},
+    {1025, "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444",
+           "9b9ac718a3b96752b0ca754ca4a97c97df3029c23499ca97674c0b675dcc90ab"},
+    {2049, "5f4d72f40d7a5f82b15ca2b2e44b1de3c2ef86c426c95c1af0b6879522563030",
+           "22f0a3037e48cba42a48bcf1804fafd1d18c559feb4b9231f604ca46c68ebc85"},
+    {8193, "bab6c09cb8ce8cf459261398d2e7aef35700bf488116ceb94a36d0f5f1b7bc3b",
+           "304fd5d1fb5498d0ed0216328d396749ebd40f98121e00f5f559bda82f3ad2bd"},
+    {102400, "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085",
+             "bd24b7fc65c95168788e15707c6415c08d4bb9888bf0ec00def157692ad8875d"}
+  };
+  const unsigned char* key = (const unsigned char*)"whats the Elephant up to?!?!?!??";
+  MehHash h;
+  meh_error_t result;
+  unsigned char* input, hash[MEH_BLAKE3_HASH_SIZE];
+  size_t i, j;
+
+  input = malloc(102400);
+  fail_if(NULL == input, "Could not allocate input buffer.");
+  for (i = 0; i < 102400; i++)
+    input[i] = (unsigned char)(i % 251);
+
+  h = meh_get_hash(MEH_BLAKE3);
+  fail_if(NULL == h, "Could not allocate hash context.");
+
+  for (i = 0; i < sizeof (vectors) / sizeof (vectors[0]); i++) {
+    meh_configure_hash(h, NULL, 0, MEH_BLAKE3_HASH_SIZE);
+    result = meh_update_hash(h, input, vectors[i].len);
+    fail_unless(MEH_OK == result, NULL);
+    meh_finish_hash(h, hash);
+    fail_unless(raw_equals_hex(hash, (char*)vectors[i].plain,
+                               MEH_BLAKE3_HASH_SIZE), NULL);
+
+    /* The same input in uneven pieces, under a key */
+    result = meh_configure_hash(h, key, 32, MEH_BLAKE3_HASH_SIZE);
+    fail_unless(MEH_OK == result, NULL);
+    for (j = 0; j < vectors[i].len; j += 999)
+      meh_update_hash(h, input + j,
+                      (vectors[i].len - j < 999) ? vectors[i].len - j : 999);
+    meh_finish_hash(h, hash);
+    fail_unless(raw_equals_hex(hash, (char*)vectors[i].keyed,
+                               MEH_BLAKE3_HASH_SIZE), NULL);
+  }
+
+  result = meh_configure_hash(h, key, 16, MEH_BLAKE3_HASH_SIZE);
+  fail_unless(MEH_INVALID_ARGUMENT == result, NULL);
+
+  meh_destroy_hash(h);
+  free(input);
+}
+END_TEST
+
+/**
+ * Extendable output read in pieces, and a large input hashed on
+ * several threads, must match the one-piece serial results.
+ */
+START_TEST (test_blake3_xof_and_threads)
+{
+  MehHash h, p;
+  meh_error_t result;
+  unsigned char* input, out[131], expected[MEH_BLAKE3_HASH_SIZE],
+                actual[MEH_BLAKE3_HASH_SIZE];
+  size_t i, len = (5 << 20) + 333;
+
+  input = malloc(len);
+  fail_if(NULL == input, "Could not allocate input buffer.");
+  for (i = 0; i < len; i++)
+    input[i] = (unsigned char)(i % 251);
+
+  h = meh_get_hash(MEH_BLAKE3);
+  fail_if(NULL == h, "Could not allocate hash context.");
+
+  meh_update_hash(h, input, 102400);
+  result = meh_squeeze_hash(h, out, 1);
+  fail_unless(MEH_OK == result, NULL);
+  meh_squeeze_hash(h, out + 1, 64);
+  meh_squeeze_hash(h, out + 65, 66);
+  fail_unless(raw_equals_hex(out,
+			     "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085"
+			     "e01c59dab908c04c3342b816941a26d69c2605ebee5ec5291cc55e15b76146e6"
+			     "745f0601156c3596cb75065a9c57f35585a52e1ac70f69131c23d611ce11ee4a"
+			     "b1ec2c009012d236648e77be9295dd0426f29b764d65de58eb7d01dd42248204"
+			     "f45f8e", 131), NULL);
+
+  meh_reset_hash(h);
+  meh_update_hash(h, input, len);
+  meh_finish_hash(h, expected);
+
+  /* Thread counts that do and don't divide the work evenly, starting
+     on and off a chunk boundary */
+  for (i = 1; i <= 5; i++) {
+    p = meh_get_hash(MEH_BLAKE3);
+    fail_if(NULL == p, "Could not allocate hash context.");
+
+    meh_update_hash(p, input, 1000 * (i - 1));
+    result = meh_update_hash_parallel(p, input + 1000 * (i - 1),
+                                      len - 1000 * (i - 1), (unsigned int)i);
+    fail_unless(MEH_OK == result, NULL);
+    meh_finish_hash(p, actual);
+    fail_unless(0 == memcmp(expected, actual, MEH_BLAKE3_HASH_SIZE), NULL);
+
+    meh_destroy_hash(p);
+  }
+
+  meh_destroy_hash(h);
+
+  /* Fixed-length hashes have no extendable output */
+  h = meh_get_hash(MEH_SHA256);
+  fail_if(NULL == h, "Could not allocate hash context.");
+  result = meh_squeeze_hash(h, out, 10);
+  fail_unless(MEH_INVALID_HASH == result, NULL);
+  result = meh_update_hash_parallel(h, input, 1000, 4);
+  fail_unless(MEH_OK == result, NULL);
+  meh_destroy_hash(h);
+
+  /* BLAKE3 has its own keyed mode and is not offered under HMAC */
+  fail_unless(0 == meh_hmac_context_size(MEH_BLAKE3), NULL);
+
+  free(input);
+}
+END_TEST
+
+/**
+ * SHA-3 and SHAKE at their default lengths; the 200-byte message of
+ * 0xA3 spans a block for every rate.
+ */
+START_TEST (test_sha3_standard_vectors)
+{
+  const struct {
+    meh_hash_id id;
+    const char* message;
+    const char* expected;
+  } vectors[] = {
+    {MEH_SHA3_224, "",
+     "6b4e03423667dbb73b6e15454f0eb1abd4597f9a1b078e3f5b5a6bc7"},
+    {MEH_SHA3_224, "abc",
+     "e642824c3f8cf24ad09234ee7d3c766fc9a3a5168d0c94ad73b46fdf"},
+    {MEH_SHA3_224, NULL,
+     "9376816aba503f72f96ce7eb65ac095deee3be4bf9bbc2a1cb7e11e0"},
+    {MEH_SHA3_256, "",
+     "a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a"},
+    {MEH_SHA3_256, "abc",
+     "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532"},
+    {MEH_SHA3_256, NULL,
+     "79f38adec5c20307a98ef76e8324afbfd46cfd81b22e3973c65fa1bd9de31787"},
+    {MEH_SHA3_384, "abc",
+     "ec01498288516fc926459f58e2c6ad8df9b473cb0fc08c2596da7cf0e49be4b2"
+     "98d88cea927ac7f539f1edf228376d25"},
+    {MEH_SHA3_384, NULL,
+     "1881de2ca7e41ef95dc4732b8f5f002b189cc1e42b74168ed1732649ce1dbcdd"
+     "76197a31fd55ee989f2d7050dd473e8f"},
+    {MEH_SHA3_512, "abc",
+     "b751850b1a57168a5693cd924b6b096e08f621827444f70d884f5d0240d2712e"
+     "10e116e9192af3c91a7ec57647e3934057340b4cf408d5a56592f8274eec53f0"},
+    {MEH_SHA3_512, NULL,
+     "e76dfad22084a8b1467fcf2ffa58361bec7628edf5f3fdc0e4805dc48caeeca8"
+     "1b7c13c30adf52a3659584739a2df46be589c51ca1a4a8416df6545a1ce8ba00"},
+    {MEH_SHAKE128, "",
+     "7f9c2ba4e88f827d616045507605853ed73b8093f6efbc88eb1a6eacfa66ef26"},
+    {MEH_SHAKE128, NULL,
+     "131ab8d2b594946b9c81333f9bb6e0ce75c3b93104fa3469d3917457385da037"},
+    {MEH_SHAKE256, "",
+     "46b9dd2b0ba88d13233b3feb743eeb243fcd52ea62b81b82b50c27646ed5762f"
+     "d75dc4ddd8c0f200cb05019d67b592f6fc821c49479ab48640292eacb3b7c4be"},
+    {MEH_SHAKE256, NULL,
+     "cd8a920ed141aa0407a22d59288652e9d9f1a7ee0c1e7c1ca699424da84a904d"
+     "2d700caae7396ece96604440577da4f3aa22aeb8857f961c4cd8e06f0ae6610b"}
+  };
+  MehHash h;
+  meh_error_t result;
+  unsigned char a3[200], hash[MEH_SHA3_512_HASH_SIZE];
+  size_t i;
+  int j;
+
+  memset(a3, 0xa3, sizeof (a3));
+
+  for (i = 0; i < sizeof (vectors) / sizeof (vectors[0]); i++) {
+    h = meh_get_hash(vectors[i].id);
+    fail_if(NULL == h, "Could not allocate hash context.");
+
+    if (NULL == vectors[i].message)
+      result = meh_update_hash(h, a3, sizeof (a3));
+    else
+      result = meh_update_hash(h, (const unsigned char*)vectors[i].message,
+                               strlen(vectors[i].message));
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_finish_hash(h, hash);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(hash, (char*)vectors[i].expected,
+                               meh_hash_output_size(h)), NULL);
+
+    meh_destroy_hash(h);
+  }
+
+  /* One million a's, fed ten at a time */
+  h = meh_get_hash(MEH_SHA3_256);
+  fail_if(NULL == h, "Could not allocate hash context.");
+  for (j = 0; j < 100000; j++)
+    meh_update_hash(h, (const unsigned char*)"aaaaaaaaaa", 10);
+  meh_finish_hash(h, hash);
+  fail_unless(raw_equals_hex(hash,
+			     "5c8875ae474a3634ba4fd55ec85bffd661f32aca75c6d699d0cdcb6c115891c1",
+			     MEH_SHA3_256_HASH_SIZE), NULL);
+  meh_destroy_hash(h);
+}
+END_TEST
+
+/**
+ * SHAKE output read in pieces across block boundaries, and many
+ * streams squeezed side by side, must match reading it in one go.
+ */
+START_TEST (test_shake_xof_and_many)
+{
+  const unsigned int masks[] = {MEH_CPU_ALL, MEH_CPU_AVX2 | MEH_CPU_SSE2, 0};
+  const unsigned char* msgs[11];
+  size_t lens[11];
+  unsigned char message[1000], out[400], expected[400], * many;
+  MehHash h;
+  meh_error_t result;
+  size_t i, j, k, size;
+
+  h = meh_get_hash(MEH_SHAKE128);
+  fail_if(NULL == h, "Could not allocate hash context.");
+
+  meh_update_hash(h, (const unsigned char*)"abc", 3);
+  result = meh_squeeze_hash(h, out, 7);
+  fail_unless(MEH_OK == result, NULL);
+  meh_squeeze_hash(h, out + 7, 161);
+  meh_squeeze_hash(h, out + 168, 32);
+  fail_unless(raw_equals_hex(out,
+			     "5881092dd818bf5cf8a3ddb793fbcba74097d5c526a6d35f97b83351940f2cc8"
+			     "44c50af32acd3f2cdd066568706f509bc1bdde58295dae3f891a9a0fca578378"
+			     "9a41f8611214ce612394df286a62d1a2252aa94db9c538956c717dc2bed4f232"
+			     "a0294c857c730aa16067ac1062f1201fb0d377cfb9cde4c63599b27f3462bba4"
+			     "a0ed296c801f9ff7f57302bb3076ee145f97a32ae68e76ab66c48d51675bd49a"
+			     "cc29082f5647584e6aa01b3f5af057805f973ff8ecb8b226ac32ada6f01c1fcd"
+			     "4818cb006aa5b4cd", 200), NULL);
+  meh_destroy_hash(h);
+
+  for (i = 0; i < sizeof (message); i++)
+    message[i] = (unsigned char)(i * 11 + 5);
+
+  /* Lengths on and around the rates, so sponges finish absorbing and
+     squeezing at different times */
+  for (i = 0; i < 11; i++) {
+    msgs[i] = message + i;
+    lens[i] = (i * 97) % 400;
+  }
+  lens[3] = 135;
+  lens[4] = 136;
+  lens[5] = 168;
+
+  many = malloc(11 * sizeof (out));
+  fail_if(NULL == many, "Could not allocate output buffer.");
+
+  for (i = 0; i < sizeof (masks) / sizeof (masks[0]); i++) {
+    meh_mask_cpu_features(masks[i]);
+
+    for (size = 1; size <= sizeof (out); size += 133) {
+      result = meh_squeeze_many(MEH_SHAKE256, msgs, lens, 11, many, size);
+      fail_unless(MEH_OK == result, NULL);
+
+      for (j = 0; j < 11; j++) {
+        h = meh_get_hash(MEH_SHAKE256);
+        fail_if(NULL == h, "Could not allocate hash context.");
+        meh_update_hash(h, msgs[j], lens[j]);
+        for (k = 0; k < size; k += 50)
+          meh_squeeze_hash(h, expected + k, (size - k < 50) ? size - k : 50);
+        fail_unless(0 == memcmp(expected, many + j * size, size), NULL);
+        meh_destroy_hash(h);
+      }
+    }
+  }
+
+  meh_mask_cpu_features(MEH_CPU_ALL);
+
+  /* Only SHAKE and BLAKE3 have extendable output */
+  h = meh_get_hash(MEH_SHA3_256);
+  fail_if(NULL == h, "Could not allocate hash context.");
+  result = meh_squeeze_hash(h, out, 10);
+  fail_unless(MEH_INVALID_HASH == result, NULL);
+  meh_destroy_hash(h);
+
+  result = meh_squeeze_many(MEH_SHA3_256, msgs, lens, 11, many, 10);
+  fail_unless(MEH_INVALID_HASH == result, NULL);
+
+  result = meh_squeeze_many(MEH_BLAKE3, msgs, lens, 11, many, 100);
+  fail_unless(MEH_OK == result, NULL);
+  for (j = 0; j < 11; j++) {
+    h = meh_get_hash(MEH_BLAKE3);
+    fail_if(NULL == h, "Could not allocate hash context.");
+    meh_update_hash(h, msgs[j], lens[j]);
+    meh_squeeze_hash(h, expected, 100);
+    fail_unless(0 == memcmp(expected, many + j * 100, 100), NULL);
+    meh_destroy_hash(h);
+  }
+
+  free(many);
+}
+END_TEST
+
+/**
+ * Digests forked from a hashed prefix, either by cloning or by a
+ * serialized midstate, must match hashing from scratch.
+ */
+START_TEST (test_hash_midstate_fork)
+{
+  const meh_hash_id ids[] = {MEH_MD5, MEH_SHA1, MEH_SHA224,
+                             MEH_SHA256, MEH_SHA384, MEH_SHA512,
+                             MEH_BLAKE2B, MEH_BLAKE2S, MEH_BLAKE3,
+                             MEH_SHA3_224, MEH_SHA3_512, MEH_SHAKE128};
+  /* Split points inside, on and just past a block boundary */
+  const size_t splits[] = {0, 127, 128, 611};
+  MehHash prefix, fork, fresh;
+  meh_error_t result;
+  unsigned char message[1000],
+                expected[MEH_SHA512_HASH_SIZE],
+                actual[MEH_SHA512_HASH_SIZE],
+                * saved;
+  size_t i, j, split;
+
+  for (i = 0; i < sizeof (message); i++)
+    message[i] = (unsigned char)(i * 7 + 3);
+
+  for (i = 0; i < sizeof (ids) / sizeof (ids[0]); i++) {
+    prefix = meh_get_hash(ids[i]);
+    fail_if(NULL == prefix, "Could not allocate hash context.");
+
+    result = meh_hash(ids[i], message, sizeof (message), expected);
+    fail_unless(MEH_OK == result, NULL);
+
+    for (j = 0; j < sizeof (splits) / sizeof (splits[0]); j++) {
+      split = splits[j];
+
+      meh_reset_hash(prefix);
+      result = meh_update_hash(prefix, message, split);
+      fail_unless(MEH_OK == result, NULL);
+
+      fork = meh_clone_hash(prefix);
+      fail_if(NULL == fork, "Could not clone hash context.");
+
+      result = meh_update_hash(fork, message + split, sizeof (message) - split);
+      fail_unless(MEH_OK == result, NULL);
+      result = meh_finish_hash(fork, actual);
+      fail_unless(MEH_OK == result, NULL);
+      fail_unless(0 == memcmp(expected, actual, prefix->output_size), NULL);
+
+      saved = malloc(meh_hash_export_size(prefix));
+      fail_if(NULL == saved, "Could not allocate state buffer.");
+
+      result = meh_export_hash(prefix, saved);
+      fail_unless(MEH_OK == result, NULL);
+
+      fresh = meh_get_hash(ids[i]);
+      fail_if(NULL == fresh, "Could not allocate hash context.");
+
+      result = meh_import_hash(fresh, saved, meh_hash_export_size(prefix));
+      fail_unless(MEH_OK == result, NULL);
+      result = meh_update_hash(fresh, message + split, sizeof (message) - split);
+      fail_unless(MEH_OK == result, NULL);
+      result = meh_finish_hash(fresh, actual);
+      fail_unless(MEH_OK == result, NULL);
+      fail_unless(0 == memcmp(expected, actual, prefix->output_size), NULL);
+
+      free(saved);
+      meh_destroy_hash(fresh);
+      meh_destroy_hash(fork);
+    }
+
+    meh_destroy_hash(prefix);
+  }
+}
+END_TEST
+
+/**
+ * Keyed BLAKE2 and BLAKE3 contexts refuse to export, writing nothing,
+ * while the same context with its key dropped exports as usual.
+ */
+START_TEST (test_hash_keyed_export)
+{
+  const meh_hash_id ids[] = {MEH_BLAKE2B, MEH_BLAKE2S, MEH_BLAKE3};
+  const size_t key_sizes[] = {64, 32, 32},
+               hash_sizes[] = {32, 20, 32};
+  MehHash h, fresh;
+  meh_error_t result;
+  unsigned char key[64],
+                expected[MEH_BLAKE2B_HASH_SIZE],
+                actual[MEH_BLAKE2B_HASH_SIZE],
+                * saved;
+  size_t i, j;
+
+  for (i = 0; i < 64; i++)
+    key[i] = (unsigned char)(0xC0 + i);
+
+  for (i = 0; i < sizeof (ids) / sizeof (ids[0]); i++) {
+    h = meh_get_hash(ids[i]);
+    fail_if(NULL == h, "Could not allocate hash context.");
+
+    saved = malloc(meh_hash_export_size(h));
+    fail_if(NULL == saved, "Could not allocate state buffer.");
+    memset(saved, 0xAA, meh_hash_export_size(h));
+
+    result = meh_configure_hash(h, key, key_sizes[i], hash_sizes[i]);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_export_hash(h, saved);
+    fail_unless(MEH_INVALID_ARGUMENT == result, NULL);
+
+    meh_update_hash(h, (const unsigned char*)"abc", 3);
+    result = meh_export_hash(h, saved);
+    fail_unless(MEH_INVALID_ARGUMENT == result, NULL);
+
+    for (j = 0; j < meh_hash_export_size(h); j++)
+      fail_unless(0xAA == saved[j], NULL);
+
+    result = meh_configure_hash(h, NULL, 0, hash_sizes[i]);
+    fail_unless(MEH_OK == result, NULL);
+    meh_update_hash(h, (const unsigned char*)"abc", 3);
+    result = meh_export_hash(h, saved);
+    fail_unless(MEH_OK == result, NULL);
+
+    fresh = meh_get_hash(ids[i]);
+    fail_if(NULL == fresh, "Could not allocate hash context.");
+    result = meh_import_hash(fresh, saved, meh_hash_export_size(h));
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(hash_sizes[i] == meh_hash_output_size(fresh), NULL);
+
+    meh_finish_hash(h, expected);
+    meh_finish_hash(fresh, actual);
+    fail_unless(0 == memcmp(expected, actual, hash_sizes[i]), NULL);
+
+    free(saved);
+    meh_destroy_hash(fresh);
+    meh_destroy_hash(h);
+  }
+}
+END_TEST
+
+/**
+ * A context built in caller-provided storage behaves like an allocated one.
+ */
+START_TEST (test_hash_in_place)
+{
+  meh_align_t storage[64];
+  MehHash h;
+  meh_error_t result;
+  unsigned char hash[MEH_SHA256_HASH_SIZE];
+
+  fail_unless(meh_hash_context_size(MEH_SHA256) <= sizeof (storage), NULL);
+  fail_unless(NULL == meh_init_hash(storage, 8, MEH_SHA256), NULL);
+
+  h = meh_init_hash(storage, sizeof (storage), MEH_SHA256);
+  fail_if(NULL == h, "Could not build hash context.");
+
+  result = meh_update_hash(h, (const unsigned char*)"abc", 3);
+  fail_unless(MEH_OK == result, NULL);
+
+  result = meh_finish_hash(h, hash);
+  fail_unless(MEH_OK == result, NULL);
+
+  fail_unless(raw_equals_hex(hash,
+			     "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+			     MEH_SHA256_HASH_SIZE), NULL);
+
+  /* Releases nothing, since the storage is ours */
+  meh_destroy_hash(h);
+}
+END_TEST
+
+/**
+ * meh_hash_many must agree with hashing each message alone, whichever
+ * lane width is in use and however ragged the lengths.
+ */
+START_TEST (test_hash_many)
+{
+  const meh_hash_id ids[] = {MEH_MD5, MEH_SHA1, MEH_SHA224,
+                             MEH_SHA256, MEH_SHA512, MEH_BLAKE3,
+                             MEH_SHA3_256, MEH_SHAKE128};
+  /* 16, 8 and 4 lanes, then one at a time with and without SHA-NI */
+  const unsigned int masks[] = {MEH_CPU_ALL,
+                                MEH_CPU_ALL & ~(MEH_CPU_AVX512 | MEH_CPU_SHA),
+                                MEH_CPU_SSE2, MEH_CPU_SHA, 0};
+  const unsigned char* msgs[41];
+  size_t lens[41];
+  unsigned char message[1000],
+                expected[MEH_SHA512_HASH_SIZE],
+                actual[41 * MEH_SHA512_HASH_SIZE];
+  MehHash h;
+  meh_error_t result;
+  size_t i, j, k, n, size;
+
+  for (i = 0; i < sizeof (message); i++)
+    message[i] = (unsigned char)(i * 13 + 1);
+
+  /* Lengths around the one- and two-block padding cut-offs, plus longer
+     messages, so lanes finish at different times. */
+  for (i = 0; i < 41; i++) {
+    msgs[i] = message + i;
+    lens[i] = (i * 37) % 130;
+  }
+  lens[7] = sizeof (message) - 7;
+  lens[20] = 55;
+  lens[21] = 56;
+  lens[22] = 64;
+
+  for (i = 0; i < sizeof (masks) / sizeof (masks[0]); i++) {
+    meh_mask_cpu_features(masks[i]);
+
+    for (j = 0; j < sizeof (ids) / sizeof (ids[0]); j++) {
+      h = meh_get_hash(ids[j]);
+      fail_if(NULL == h, "Could not allocate hash context.");
+      size = h->output_size;
+      meh_destroy_hash(h);
+
+      /* A single message, a partly filled set of lanes and a full run */
+      for (n = 1; n <= 41; n += 20) {
+        result = meh_hash_many(ids[j], msgs, lens, n, actual);
+        fail_unless(MEH_OK == result, NULL);
+
+        for (k = 0; k < n; k++) {
+          result = meh_hash(ids[j], msgs[k], lens[k], expected);
+          fail_unless(MEH_OK == result, NULL);
+          fail_unless(0 == memcmp(expected, actual + k * size, size), NULL);
+        }
+      }
+    }
+  }
+
+  meh_mask_cpu_features(MEH_CPU_ALL);
+}
+END_TEST
+
+/**
+ * Hashing a file by path must match hashing its contents in memory,
+ * whether the file is mapped, empty or not a regular file at all.
+ */
+START_TEST (test_hash_path)
+{
+  const char* path = "hash_path.tmp";
+  static unsigned char message[300001];
+  unsigned char expected[MEH_SHA256_HASH_SIZE],
+                actual[MEH_SHA256_HASH_SIZE];
+  MehHash h;
+  meh_error_t result;
+  FILE* fd;
+  size_t i;
+
+  for (i = 0; i < sizeof (message); i++)
+    message[i] = (unsigned char)(i * 7 + 3);
+
+  fd = fopen(path, "wb");
+  fail_if(NULL == fd, "Could not create temporary file.");
+  fail_unless(sizeof (message) == fwrite(message, 1, sizeof (message), fd), NULL);
+  fclose(fd);
+
+  h = meh_get_hash(MEH_SHA256);
+  fail_if(NULL == h, "Could not allocate hash context.");
+
+  result = meh_hash_path(h, path);
+  fail_unless(MEH_OK == result, NULL);
+  result = meh_finish_hash(h, actual);
+  fail_unless(MEH_OK == result, NULL);
+  result = meh_hash(MEH_SHA256, message, sizeof (message), expected);
+  fail_unless(MEH_OK == result, NULL);
+  fail_unless(0 == memcmp(expected, actual, sizeof (actual)), NULL);
+
+  /* An empty file and a device both go through the read path */
+  fd = fopen(path, "wb");
+  fail_if(NULL == fd, "Could not truncate temporary file.");
+  fclose(fd);
+
+  meh_reset_hash(h);
+  result = meh_hash_path(h, path);
+  fail_unless(MEH_OK == result, NULL);
+  result = meh_finish_hash(h, actual);
+  fail_unless(MEH_OK == result, NULL);
+  fail_unless(raw_equals_hex(actual,
+			     "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+			     MEH_SHA256_HASH_SIZE), NULL);
+
+  meh_reset_hash(h);
+  result = meh_hash_path(h, "/dev/null");
+  fail_unless(MEH_OK == result, NULL);
+  result = meh_finish_hash(h, actual);
+  fail_unless(MEH_OK == result, NULL);
+  fail_unless(raw_equals_hex(actual,
+			     "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+			     MEH_SHA256_HASH_SIZE), NULL);
+
+  remove(path);
+
+  result = meh_hash_path(h, path);
+  fail_unless(MEH_FILE_NOT_FOUND == result, NULL);
+
+  meh_destroy_hash(h);
+}
+END_TEST
+
+/**
+ * Run the SHA vectors again with the CPU-specific compression
+ * functions switched off, so both paths are checked.
+ */
+void portable_setup(void) {
+  meh_mask_cpu_features(0);
+}
+
+void portable_teardown(void) {
+  meh_mask_cpu_features(MEH_CPU_ALL);
+}
+
 Suite* hash_suite(void) {
   Suite* test_hashes;
   TCase* test_md5,
@@ -753,7 +1526,14 @@ Suite* hash_suite(void) {
        * test_sha224,
        * test_sha256,
        * test_sha384,
-       * test_sha512;
+       * test_sha512,
+       * test_blake2,
+       * test_blake3,
+       * test_sha3,
+       * test_midstate,
+       * test_batch,
+       * test_files,
+       * test_portable;
 
   test_hashes = suite_create("Hashes");
 
@@ -781,12 +1561,58 @@ Suite* hash_suite(void) {
   tcase_add_test(test_sha512, test_sha512_standard_vectors);
   tcase_add_test(test_sha512, test_sha512_large_input_vector);
 
+  test_blake2 = tcase_create("BLAKE2");
+  tcase_add_test(test_blake2, test_blake2_standard_vectors);
+  tcase_add_test(test_blake2, test_blake2_keyed);
+
+  test_blake3 = tcase_create("BLAKE3");
+  tcase_add_test(test_blake3, test_blake3_standard_vectors);
+  tcase_add_test(test_blake3, test_blake3_xof_and_threads);
+
+  test_sha3 = tcase_create("SHA3");
+  tcase_add_test(test_sha3, test_sha3_standard_vectors);
+  tcase_add_test(test_sha3, test_shake_xof_and_many);
+
+  test_midstate = tcase_create("Midstate");
+  tcase_add_test(test_midstate, test_hash_midstate_fork);
+  tcase_add_test(test_midstate, test_hash_in_place);
+
+  test_batch = tcase_create("Batch");
+  tcase_add_test(test_batch, test_hash_many);
+
+  test_files = tcase_create("Files");
+  tcase_add_test(test_files, test_hash_path);
+
+  test_portable = tcase_create("Portable");
+  tcase_add_checked_fixture(test_portable, portable_setup, portable_teardown);
+  tcase_add_test(test_portable, test_sha1_standard_vectors);
+  tcase_add_test(test_portable, test_sha1_large_input_vector);
+  tcase_add_test(test_portable, test_sha224_standard_vectors);
+  tcase_add_test(test_portable, test_sha256_standard_vectors);
+  tcase_add_test(test_portable, test_sha256_large_input_vector);
+  tcase_add_test(test_portable, test_sha384_standard_vectors);
+  tcase_add_test(test_portable, test_sha512_standard_vectors);
+  tcase_add_test(test_portable, test_sha512_large_input_vector);
+  tcase_add_test(test_portable, test_blake2_standard_vectors);
+  tcase_add_test(test_portable, test_blake2_keyed);
+  tcase_add_test(test_portable, test_blake3_standard_vectors);
+  tcase_add_test(test_portable, test_sha3_standard_vectors);
+  tcase_add_test(test_portable, test_hash_midstate_fork);
+  tcase_add_test(test_portable, test_hash_keyed_export);
+
   suite_add_tcase(test_hashes, test_md5);
   suite_add_tcase(test_hashes, test_sha1);
   suite_add_tcase(test_hashes, test_sha224);
   suite_add_tcase(test_hashes, test_sha256);
   suite_add_tcase(test_hashes, test_sha384);
   suite_add_tcase(test_hashes, test_sha512);
+  suite_add_tcase(test_hashes, test_blake2);
+  suite_add_tcase(test_hashes, test_blake3);
+  suite_add_tcase(test_hashes, test_sha3);
+  suite_add_tcase(test_hashes, test_midstate);
+  suite_add_tcase(test_hashes, test_batch);
+  suite_add_tcase(test_hashes, test_files);
+  suite_add_tcase(test_hashes, test_portable);
 
   return test_hashes;
 }
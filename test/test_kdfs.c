@@ -0,0 +1,840 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * Vectors taken from RFC 6070.
+ */
+START_TEST (test_pbkdf2_sha1_vectors)
+{
+    unsigned char output[32];
+    meh_error_t result;
+    size_t got;
+
+    result = meh_kdf(MEH_PBKDF2, MEH_SHA1,
+                     (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"salt", (size_t)4, 1U,
+                     output, (size_t)20, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(got == 20, NULL);
+    fail_unless(raw_equals_hex(output, "0c60c80f961f0e71f3a9b524af6012062fe037a6", 20), NULL);
+
+    result = meh_kdf(MEH_PBKDF2, MEH_SHA1,
+                     (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"salt", (size_t)4, 2U,
+                     output, (size_t)20, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output, "ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957", 20), NULL);
+
+    result = meh_kdf(MEH_PBKDF2, MEH_SHA1,
+                     (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"salt", (size_t)4, 4096U,
+                     output, (size_t)20, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output, "4b007901b765489abead49d926f721d065a429c1", 20), NULL);
+
+    /* Output spanning two blocks */
+    result = meh_kdf(MEH_PBKDF2, MEH_SHA1,
+                     (const unsigned char *)"passwordPASSWORDpassword", (size_t)24,
+                     (const unsigned char *)"saltSALTsaltSALTsaltSALTsaltSALTsalt", (size_t)36,
+                     4096U, output, (size_t)25, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(got == 25, NULL);
+    fail_unless(raw_equals_hex(output, "3d2eec4fe41c849b80c8d83662c0e44a8b291a964cf2f07038", 25), NULL);
+
+    result = meh_kdf(MEH_PBKDF2, MEH_SHA1,
+                     (const unsigned char *)"pass\0word", (size_t)9,
+                     (const unsigned char *)"sa\0lt", (size_t)5, 4096U,
+                     output, (size_t)16, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output, "56fa6aa75548099dcc37d7f03425e0c3", 16), NULL);
+}
+END_TEST
+
+START_TEST (test_pbkdf2_sha2_vectors)
+{
+    unsigned char output[64];
+    meh_error_t result;
+    size_t got;
+
+    result = meh_kdf(MEH_PBKDF2, MEH_SHA256,
+                     (const unsigned char *)"passwordPASSWORDpassword", (size_t)24,
+                     (const unsigned char *)"saltSALTsaltSALTsaltSALTsaltSALTsalt", (size_t)36,
+                     4096U, output, (size_t)40, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(got == 40, NULL);
+    fail_unless(raw_equals_hex(output,
+                               "348c89dbcbd32b2f32d814b8116e84cf2b17347ebc1800181c4e2a1fb8dd53e1"
+                               "c635518c7dac47e9", 40), NULL);
+
+    result = meh_kdf(MEH_PBKDF2, MEH_SHA512,
+                     (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"salt", (size_t)4, 1000U,
+                     output, (size_t)64, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output,
+                               "afe6c5530785b6cc6b1c6453384731bd5ee432ee549fd42fb6695779ad8a1c5b"
+                               "f59de69c48f774efc4007d5298f9033c0241d5ab69305e7b64eceeb8d834cfec",
+                               64), NULL);
+
+    result = meh_kdf(MEH_PBKDF2, MEH_BLAKE2S,
+                     (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"salt", (size_t)4, 4096U,
+                     output, (size_t)40, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output,
+                               "072b63e2cfe4d20cd2086a6be6ec8e1fd1bf2b797fa272a749a761faad66beb6"
+                               "1c8071a4aae2fe3e", 40), NULL);
+}
+END_TEST
+
+/**
+ * Output requested in pieces and after a reset must match.
+ */
+START_TEST (test_pbkdf2_incremental)
+{
+    MehKDF k;
+    meh_error_t result;
+    unsigned char output[32];
+    size_t got;
+
+    k = meh_get_kdf(MEH_PBKDF2, MEH_SHA1,
+                    (const unsigned char *)"password", (size_t)8,
+                    (const unsigned char *)"salt", (size_t)4, 2U);
+    fail_if(NULL == k, "Could not allocate KDF context.");
+
+    result = meh_reset_kdf(k, (const unsigned char *)"password", (size_t)8,
+                           (const unsigned char *)"ATHENA.MIT.EDUraeburn", (size_t)21,
+                           1200U);
+    fail_unless(MEH_OK == result, NULL);
+
+    result = meh_update_kdf(k, output, 7, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(got == 7, NULL);
+
+    result = meh_update_kdf(k, output + 7, 25, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(got == 25, NULL);
+
+    fail_unless(raw_equals_hex(output,
+                               "5c08eb61fdf71e4e4ec3cf6ba1f5512ba7e52ddbc5e5142f708a31e2e62b1e13",
+                               32), NULL);
+
+    result = meh_finish_kdf(k);
+    fail_unless(MEH_OK == result, NULL);
+    meh_destroy_kdf(k);
+}
+END_TEST
+
+/**
+ * Blocks derived together across SIMD lanes, by every lane width and
+ * past a batch, match blocks derived one byte at a time, and the
+ * RFC 6070 two-block vector holds on every path.
+ */
+START_TEST (test_pbkdf2_lanes)
+{
+    static const meh_hash_id ids[] =
+    {
+        MEH_SHA1, MEH_SHA224, MEH_SHA256, MEH_SHA384, MEH_SHA512, MEH_MD5
+    };
+    static const unsigned int masks[] =
+    {
+        0, MEH_CPU_SSE2, MEH_CPU_AVX2 | MEH_CPU_SSE2, MEH_CPU_ALL
+    };
+    static unsigned char want[19 * 64], output[19 * 64];
+    MehKDF k;
+    meh_error_t result;
+    size_t i, j, m, got, len;
+
+    for (i = 0; i < sizeof (ids) / sizeof (ids[0]); i++)
+    {
+        k = meh_get_kdf(MEH_PBKDF2, ids[i],
+                        (const unsigned char *)"password", (size_t)8,
+                        (const unsigned char *)"salt", (size_t)4, 5U);
+        fail_if(NULL == k, "Could not allocate KDF context.");
+
+        len = 19 * meh_hash_ops(ids[i])->output_size - 3;
+        for (j = 0; j < len; j++)
+        {
+            result = meh_update_kdf(k, want + j, 1, &got);
+            fail_unless(MEH_OK == result && 1 == got, NULL);
+        }
+
+        for (m = 0; m < sizeof (masks) / sizeof (masks[0]); m++)
+        {
+            meh_mask_cpu_features(masks[m]);
+
+            result = meh_reset_kdf(k, (const unsigned char *)"password",
+                                   (size_t)8, (const unsigned char *)"salt",
+                                   (size_t)4, 5U);
+            fail_unless(MEH_OK == result, NULL);
+
+            memset(output, 0, sizeof (output));
+            result = meh_update_kdf(k, output, 5, &got);
+            fail_unless(MEH_OK == result && 5 == got, NULL);
+            result = meh_update_kdf(k, output + 5, len - 5, &got);
+            fail_unless(MEH_OK == result && len - 5 == got, NULL);
+            fail_unless(0 == memcmp(output, want, len), NULL);
+
+            result = meh_kdf(MEH_PBKDF2, MEH_SHA1,
+                             (const unsigned char *)"passwordPASSWORDpassword", (size_t)24,
+                             (const unsigned char *)"saltSALTsaltSALTsaltSALTsaltSALTsalt", (size_t)36,
+                             4096U, output, (size_t)25, &got);
+            fail_unless(MEH_OK == result, NULL);
+            fail_unless(raw_equals_hex(output, "3d2eec4fe41c849b80c8d83662c0e44a8b291a964cf2f07038", 25), NULL);
+        }
+
+        meh_mask_cpu_features(MEH_CPU_ALL);
+        meh_destroy_kdf(k);
+    }
+
+    result = meh_kdf(MEH_PBKDF2, MEH_SHA1,
+                     (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"salt", (size_t)4, 0U,
+                     output, (size_t)20, &got);
+    fail_unless(MEH_OK != result, NULL);
+}
+END_TEST
+
+/**
+ * Requests that start and end inside blocks, on block boundaries and
+ * across several blocks all read the same stream, with and without
+ * SIMD lanes.
+ */
+START_TEST (test_pbkdf2_pieces)
+{
+    static const size_t pieces[] = { 1, 31, 32, 64, 7, 100, 25, 96, 0, 4 };
+    static const unsigned int masks[] = { 0, MEH_CPU_ALL };
+    unsigned char want[360], output[360];
+    MehKDF k;
+    meh_error_t result;
+    size_t i, m, at, got;
+
+    result = meh_kdf(MEH_PBKDF2, MEH_SHA256,
+                     (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"salt", (size_t)4, 77U,
+                     want, sizeof (want), &got);
+    fail_unless(MEH_OK == result && sizeof (want) == got, NULL);
+
+    for (m = 0; m < sizeof (masks) / sizeof (masks[0]); m++)
+    {
+        meh_mask_cpu_features(masks[m]);
+
+        k = meh_get_kdf(MEH_PBKDF2, MEH_SHA256,
+                        (const unsigned char *)"password", (size_t)8,
+                        (const unsigned char *)"salt", (size_t)4, 77U);
+        fail_if(NULL == k, "Could not allocate KDF context.");
+
+        for (i = 0, at = 0; i < sizeof (pieces) / sizeof (pieces[0]); i++)
+        {
+            result = meh_update_kdf(k, output + at, pieces[i], &got);
+            fail_unless(MEH_OK == result && pieces[i] == got, NULL);
+            at += got;
+        }
+
+        fail_unless(sizeof (want) == at, NULL);
+        fail_unless(0 == memcmp(output, want, sizeof (want)), NULL);
+        meh_destroy_kdf(k);
+    }
+
+    meh_mask_cpu_features(MEH_CPU_ALL);
+}
+END_TEST
+
+/**
+ * Spreading the blocks over threads changes nothing in the output, in
+ * whole blocks or in pieces, and KDFs with fixed threads say so.
+ */
+START_TEST (test_pbkdf2_threads)
+{
+    static const unsigned int threads[] = { 1, 2, 4, 8, 0, 3 };
+    static const unsigned int masks[] = { 0, MEH_CPU_ALL };
+    unsigned char want[900], output[900];
+    MehKDF k;
+    meh_error_t result;
+    size_t i, m, at, got;
+
+    result = meh_kdf(MEH_PBKDF2, MEH_SHA1,
+                     (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"salt", (size_t)4, 50U,
+                     want, sizeof (want), &got);
+    fail_unless(MEH_OK == result && sizeof (want) == got, NULL);
+
+    /* Slices follow the lane width, one chain wide without kernels */
+    for (m = 0; m < sizeof (masks) / sizeof (masks[0]); m++)
+    {
+        meh_mask_cpu_features(masks[m]);
+
+        for (i = 0; i < sizeof (threads) / sizeof (threads[0]); i++)
+        {
+            k = meh_get_kdf(MEH_PBKDF2, MEH_SHA1,
+                            (const unsigned char *)"password", (size_t)8,
+                            (const unsigned char *)"salt", (size_t)4, 50U);
+            fail_if(NULL == k, "Could not allocate KDF context.");
+            fail_unless(MEH_OK == meh_set_threads_kdf(k, threads[i]), NULL);
+
+            /* all at once, then again in uneven pieces */
+            result = meh_update_kdf(k, output, sizeof (output), &got);
+            fail_unless(MEH_OK == result && sizeof (output) == got, NULL);
+            fail_unless(0 == memcmp(output, want, sizeof (want)), NULL);
+
+            meh_reset_kdf(k, (const unsigned char *)"password", (size_t)8,
+                          (const unsigned char *)"salt", (size_t)4, 50U);
+
+            for (at = 0; at < sizeof (output); at += got)
+            {
+                result = meh_update_kdf(k, output + at,
+                                        (sizeof (output) - at < 333) ?
+                                        sizeof (output) - at : 333, &got);
+                fail_unless(MEH_OK == result, NULL);
+            }
+
+            fail_unless(0 == memcmp(output, want, sizeof (want)), NULL);
+            meh_destroy_kdf(k);
+        }
+    }
+
+    meh_mask_cpu_features(MEH_CPU_ALL);
+
+    k = meh_get_kdf(MEH_HKDF, MEH_SHA256,
+                    (const unsigned char *)"master secret", (size_t)13,
+                    (const unsigned char *)"salt", (size_t)4,
+                    NULL, (size_t)0);
+    fail_if(NULL == k, "Could not allocate KDF context.");
+    fail_unless(MEH_INVALID_KDF == meh_set_threads_kdf(k, 4), NULL);
+    meh_destroy_kdf(k);
+}
+END_TEST
+
+/**
+ * A batch of passwords, each with its own salt and several blocks of
+ * output, matches deriving them one by one, on every lane width.
+ */
+START_TEST (test_pbkdf2_many)
+{
+    static const meh_hash_id ids[] =
+    {
+        MEH_SHA1, MEH_SHA256, MEH_SHA512, MEH_BLAKE2S
+    };
+    static const unsigned int masks[] =
+    {
+        0, MEH_CPU_SSE2, MEH_CPU_AVX2 | MEH_CPU_SSE2, MEH_CPU_ALL
+    };
+    enum { COUNT = 23, OUT = 70 };
+    static unsigned char data[200], want[COUNT * OUT], output[COUNT * OUT];
+    const unsigned char* passwords[COUNT], * salts[COUNT];
+    size_t pass_lens[COUNT], salt_lens[COUNT], i, j, m, got;
+    meh_error_t result;
+
+    for (i = 0; i < sizeof (data); i++)
+        data[i] = (unsigned char)(i * 5 + 9);
+
+    for (i = 0; i < COUNT; i++)
+    {
+        passwords[i] = data + i;
+        pass_lens[i] = (i * 29) % 140; /* some longer than a block */
+        salts[i] = data + 100 + i % 7;
+        salt_lens[i] = (i * 3) % 40;
+    }
+
+    for (i = 0; i < sizeof (ids) / sizeof (ids[0]); i++)
+    {
+        for (j = 0; j < COUNT; j++)
+        {
+            result = meh_kdf(MEH_PBKDF2, ids[i], passwords[j], pass_lens[j],
+                             salts[j], salt_lens[j], 3U, want + j * OUT,
+                             (size_t)OUT, &got);
+            fail_unless(MEH_OK == result, NULL);
+        }
+
+        for (m = 0; m < sizeof (masks) / sizeof (masks[0]); m++)
+        {
+            meh_mask_cpu_features(masks[m]);
+            memset(output, 0, sizeof (output));
+            result = meh_pbkdf2_many(ids[i], passwords, pass_lens, salts,
+                                     salt_lens, COUNT, 3U, output, OUT);
+            fail_unless(MEH_OK == result, NULL);
+            fail_unless(0 == memcmp(output, want, sizeof (want)), NULL);
+        }
+
+        meh_mask_cpu_features(MEH_CPU_ALL);
+    }
+
+    result = meh_pbkdf2_many(MEH_SHA256, passwords, pass_lens, salts,
+                             salt_lens, 0, 3U, NULL, OUT);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_pbkdf2_many(MEH_SHA256, passwords, pass_lens, salts,
+                             salt_lens, COUNT, 0U, output, OUT);
+    fail_unless(MEH_INVALID_ROUNDS == result, NULL);
+}
+END_TEST
+
+/**
+ * A context built in caller-provided storage behaves like an allocated one.
+ */
+START_TEST (test_pbkdf2_in_place)
+{
+    meh_align_t storage[512];
+    MehKDF k;
+    meh_error_t result;
+    unsigned char output[20];
+    size_t got;
+
+    fail_unless(meh_kdf_context_size(MEH_PBKDF2, MEH_SHA512) <= sizeof (storage), NULL);
+
+    k = meh_init_kdf(storage, sizeof (storage), MEH_PBKDF2, MEH_SHA1,
+                     (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"salt", (size_t)4, 4096U);
+    fail_if(NULL == k, "Could not build KDF context.");
+
+    result = meh_update_kdf(k, output, 20, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output, "4b007901b765489abead49d926f721d065a429c1", 20), NULL);
+
+    meh_destroy_kdf(k);
+}
+END_TEST
+
+/**
+ * Vectors taken from RFC 7914.
+ */
+START_TEST (test_scrypt_vectors)
+{
+    unsigned char output[64];
+    meh_error_t result;
+    size_t got;
+
+    result = meh_kdf(MEH_SCRYPT, (const unsigned char *)"", (size_t)0,
+                     (const unsigned char *)"", (size_t)0, 16U, 1U, 1U, 1U,
+                     output, (size_t)64, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(got == 64, NULL);
+    fail_unless(raw_equals_hex(output,
+                               "77d6576238657b203b19ca42c18a0497f16b4844e3074ae8dfdffa3fede21442"
+                               "fcd0069ded0948f8326a753a0fc81f17e8d3e0fb2e0d3628cf35e20c38d18906",
+                               64), NULL);
+
+    result = meh_kdf(MEH_SCRYPT, (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"NaCl", (size_t)4, 1024U, 8U, 16U, 1U,
+                     output, (size_t)64, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output,
+                               "fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b373162"
+                               "2eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640",
+                               64), NULL);
+
+    result = meh_kdf(MEH_SCRYPT, (const unsigned char *)"pleaseletmein", (size_t)13,
+                     (const unsigned char *)"SodiumChloride", (size_t)14,
+                     16384U, 8U, 1U, 1U, output, (size_t)64, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output,
+                               "7023bdcb3afd7348461c06cd81fd38ebfda8fbba904f8e3ea9b543f6545da1f2"
+                               "d5432955613f0fcf62d49705242a9af9e61e85dc0d651e40dfcf017b45575887",
+                               64), NULL);
+}
+END_TEST
+
+/**
+ * The p lanes give the same key on any number of threads and without
+ * SSE2, a context survives resets to other costs, and bad costs are
+ * refused.
+ */
+START_TEST (test_scrypt_threads_and_reset)
+{
+    const char* expected =
+        "fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b373162"
+        "2eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640";
+    MehKDF k;
+    meh_error_t result;
+    unsigned char output[64];
+    unsigned int threads;
+    size_t got;
+
+    for (threads = 2; threads <= 5; threads++)
+    {
+        k = meh_get_kdf(MEH_SCRYPT, (const unsigned char *)"password", (size_t)8,
+                        (const unsigned char *)"NaCl", (size_t)4,
+                        1024U, 8U, 16U, threads);
+        fail_if(NULL == k, "Could not allocate KDF context.");
+
+        result = meh_update_kdf(k, output, 64, &got);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(raw_equals_hex(output, (char *)expected, 64), NULL);
+
+        /* Smaller, then larger, than the arena already holds */
+        result = meh_reset_kdf(k, (const unsigned char *)"", (size_t)0,
+                               (const unsigned char *)"", (size_t)0,
+                               16U, 1U, 1U);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_kdf(k, output, 10, &got);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_kdf(k, output + 10, 54, &got);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(raw_equals_hex(output,
+                                   "77d6576238657b203b19ca42c18a0497f16b4844e3074ae8dfdffa3fede21442"
+                                   "fcd0069ded0948f8326a753a0fc81f17e8d3e0fb2e0d3628cf35e20c38d18906",
+                                   64), NULL);
+
+        result = meh_reset_kdf(k, (const unsigned char *)"pleaseletmein", (size_t)13,
+                               (const unsigned char *)"SodiumChloride", (size_t)14,
+                               16384U, 8U, 1U);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_kdf(k, output, 32, &got);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(raw_equals_hex(output,
+                                   "7023bdcb3afd7348461c06cd81fd38ebfda8fbba904f8e3ea9b543f6545da1f2",
+                                   32), NULL);
+
+        /* A rejected reset leaves nothing of the last key to read */
+        result = meh_reset_kdf(k, (const unsigned char *)"pleaseletmein", (size_t)13,
+                               (const unsigned char *)"SodiumChloride", (size_t)14,
+                               1000U, 8U, 1U);
+        fail_unless(MEH_INVALID_ARGUMENT == result, NULL);
+        result = meh_update_kdf(k, output, 32, &got);
+        fail_unless(MEH_SOURCE_EXHAUSTED == result, NULL);
+        fail_unless(got == 0, NULL);
+
+        meh_destroy_kdf(k);
+    }
+
+    meh_mask_cpu_features(0);
+    result = meh_kdf(MEH_SCRYPT, (const unsigned char *)"password", (size_t)8,
+                     (const unsigned char *)"NaCl", (size_t)4, 1024U, 8U, 16U, 3U,
+                     output, (size_t)64, &got);
+    meh_mask_cpu_features(MEH_CPU_ALL);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output, (char *)expected, 64), NULL);
+
+    /* N must be a power of two, and below 2^16 when r is 1 */
+    k = meh_get_kdf(MEH_SCRYPT, (const unsigned char *)"password", (size_t)8,
+                    (const unsigned char *)"NaCl", (size_t)4, 1000U, 8U, 1U, 1U);
+    fail_unless(NULL == k, NULL);
+    k = meh_get_kdf(MEH_SCRYPT, (const unsigned char *)"password", (size_t)8,
+                    (const unsigned char *)"NaCl", (size_t)4, 65536U, 1U, 1U, 1U);
+    fail_unless(NULL == k, NULL);
+}
+END_TEST
+
+/**
+ * Vectors taken from the Argon2 reference implementation's tests.
+ */
+START_TEST (test_argon2id_vectors)
+{
+    static const struct
+    {
+        unsigned int passes, memory, lanes;
+        const char* tag;
+    } vectors[] =
+    {
+        { 2, 65536, 1,
+          "09316115d5cf24ed5a15a31a3ba326e5cf32edc24702987c02b6566f61913cf7" },
+        { 2, 256, 1,
+          "9dfeb910e80bad0311fee20f9c0e2b12c17987b4cac90c2ef54d5b3021c68bfe" },
+        { 2, 256, 2,
+          "6d093c501fd5999645e0ea3bf620d7b8be7fd2db59c20d9fff9539da2bf57037" },
+        { 1, 65536, 1,
+          "f6a5adc1ba723dddef9b5ac1d464e180fcd9dffc9d1cbf76cca2fed795d9ca98" }
+    };
+    unsigned char output[32];
+    meh_error_t result;
+    size_t i, got;
+
+    for (i = 0; i < sizeof (vectors) / sizeof (vectors[0]); i++)
+    {
+        result = meh_kdf(MEH_ARGON2ID,
+                         (const unsigned char *)"password", (size_t)8,
+                         (const unsigned char *)"somesalt", (size_t)8,
+                         vectors[i].passes, vectors[i].memory,
+                         vectors[i].lanes, 32U, 1U,
+                         output, (size_t)32, &got);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(got == 32, NULL);
+        fail_unless(raw_equals_hex(output, (char *)vectors[i].tag, 32), NULL);
+    }
+}
+END_TEST
+
+/**
+ * Lanes give the same tag on any number of threads and on every
+ * compression path, a context survives resets to other costs, and the
+ * tag can be read in pieces but no further than its length.
+ */
+START_TEST (test_argon2id_threads_and_reset)
+{
+    static const unsigned int masks[] =
+    {
+        0, MEH_CPU_AVX2 | MEH_CPU_SSE2, MEH_CPU_ALL
+    };
+    const char* expected = "2a70f4cb341c08b798e2e9ac68f85907";
+    const char* long_tag =
+        "89ac35e3a19f9c06198032d823dc548b2be49025de356183c461064b5c702ce2"
+        "5342c76d5ee8939ec4fffa253180ce4cdc223d9f781845bf6f608c9800d9fb86"
+        "c2b1f258bcf9c985315633b240b595bf59fb26daa647c74878eb32f18e45fce3"
+        "0b1d8a64";
+    MehKDF k;
+    meh_error_t result;
+    unsigned char output[100];
+    unsigned int threads;
+    size_t i, got;
+
+    for (threads = 1; threads <= 4; threads++)
+    {
+        k = meh_get_kdf(MEH_ARGON2ID,
+                        (const unsigned char *)"pleaseletmein", (size_t)13,
+                        (const unsigned char *)"SodiumChloride", (size_t)14,
+                        3U, 1024U, 8U, 16U, threads);
+        fail_if(NULL == k, "Could not allocate KDF context.");
+
+        result = meh_update_kdf(k, output, 16, &got);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(raw_equals_hex(output, (char *)expected, 16), NULL);
+
+        /* Smaller than the arena already holds, tag longer than 64 */
+        result = meh_reset_kdf(k, (const unsigned char *)"password", (size_t)8,
+                               (const unsigned char *)"somesalt", (size_t)8,
+                               3U, 64U, 4U, 100U);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_kdf(k, output, 30, &got);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_kdf(k, output + 30, 70, &got);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(got == 70, NULL);
+        fail_unless(raw_equals_hex(output, (char *)long_tag, 100), NULL);
+
+        result = meh_update_kdf(k, output, 1, &got);
+        fail_unless(MEH_SOURCE_EXHAUSTED == result, NULL);
+        fail_unless(got == 0, NULL);
+
+        /* Larger */
+        result = meh_reset_kdf(k, (const unsigned char *)"password", (size_t)8,
+                               (const unsigned char *)"somesalt", (size_t)8,
+                               2U, 65536U, 1U, 32U);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_kdf(k, output, 32, &got);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(raw_equals_hex(output,
+                                   "09316115d5cf24ed5a15a31a3ba326e5cf32edc24702987c02b6566f61913cf7",
+                                   32), NULL);
+
+        /* A rejected reset leaves nothing of the last tag to read */
+        result = meh_reset_kdf(k, (const unsigned char *)"password", (size_t)8,
+                               (const unsigned char *)"somesalt", (size_t)8,
+                               2U, 65536U, 0U, 32U);
+        fail_unless(MEH_INVALID_ARGUMENT == result, NULL);
+        result = meh_update_kdf(k, output, 32, &got);
+        fail_unless(MEH_SOURCE_EXHAUSTED == result, NULL);
+        fail_unless(got == 0, NULL);
+
+        meh_destroy_kdf(k);
+    }
+
+    for (i = 0; i < sizeof (masks) / sizeof (masks[0]); i++)
+    {
+        meh_mask_cpu_features(masks[i]);
+        result = meh_kdf(MEH_ARGON2ID,
+                         (const unsigned char *)"pleaseletmein", (size_t)13,
+                         (const unsigned char *)"SodiumChloride", (size_t)14,
+                         3U, 1024U, 8U, 16U, 3U, output, (size_t)16, &got);
+        meh_mask_cpu_features(MEH_CPU_ALL);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(raw_equals_hex(output, (char *)expected, 16), NULL);
+    }
+
+    /* At least 8 KiB per lane, a tag of 4 bytes or more */
+    k = meh_get_kdf(MEH_ARGON2ID, (const unsigned char *)"password", (size_t)8,
+                    (const unsigned char *)"somesalt", (size_t)8,
+                    1U, 31U, 4U, 32U, 1U);
+    fail_unless(NULL == k, NULL);
+    k = meh_get_kdf(MEH_ARGON2ID, (const unsigned char *)"password", (size_t)8,
+                    (const unsigned char *)"somesalt", (size_t)8,
+                    1U, 64U, 1U, 3U, 1U);
+    fail_unless(NULL == k, NULL);
+}
+END_TEST
+
+/**
+ * Test cases 1 to 4 of RFC 5869.
+ */
+START_TEST (test_hkdf_vectors)
+{
+    unsigned char ikm[80], salt[80], info[80], output[82];
+    meh_error_t result;
+    size_t i, got;
+
+    for (i = 0; i < 80; i++)
+    {
+        ikm[i] = (unsigned char)i;
+        salt[i] = (unsigned char)(0x60 + i);
+        info[i] = (unsigned char)(0xb0 + i);
+    }
+
+    result = meh_kdf(MEH_HKDF, MEH_SHA256, ikm, (size_t)80, salt, (size_t)80,
+                     info, (size_t)80, output, (size_t)82, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(got == 82, NULL);
+    fail_unless(raw_equals_hex(output,
+                               "b11e398dc80327a1c8e7f78c596a49344f012eda2d4efad8a050cc4c19afa97c"
+                               "59045a99cac7827271cb41c65e590e09da3275600c2f09b8367793a9aca3db71"
+                               "cc30c58179ec3e87c14c01d5c1f3434f1d87",
+                               82), NULL);
+
+    for (i = 0; i < 22; i++)
+        ikm[i] = 0x0b;
+    for (i = 0; i < 13; i++)
+        salt[i] = (unsigned char)i;
+    for (i = 0; i < 10; i++)
+        info[i] = (unsigned char)(0xf0 + i);
+
+    result = meh_kdf(MEH_HKDF, MEH_SHA256, ikm, (size_t)22, salt, (size_t)13,
+                     info, (size_t)10, output, (size_t)42, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output,
+                               "3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf"
+                               "34007208d5b887185865",
+                               42), NULL);
+
+    result = meh_kdf(MEH_HKDF, MEH_SHA256, ikm, (size_t)22, NULL, (size_t)0,
+                     NULL, (size_t)0, output, (size_t)42, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output,
+                               "8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d"
+                               "9d201395faa4b61a96c8",
+                               42), NULL);
+
+    result = meh_kdf(MEH_HKDF, MEH_SHA1, ikm, (size_t)11, salt, (size_t)13,
+                     info, (size_t)10, output, (size_t)42, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(output,
+                               "085a01ea1b10f36933068b56efa5ad81a4f14b822f5b091568a9cdd4f155fda2"
+                               "c22e422478d305f3f896",
+                               42), NULL);
+}
+END_TEST
+
+/**
+ * Labels expanded one at a time or in a batch from one extraction
+ * match separate derivations, output stops at 255 blocks, and KDFs
+ * without labels refuse to expand.
+ */
+START_TEST (test_hkdf_expand_many)
+{
+    static const char* expected[] =
+    {
+        "9304eb6c78ac4017f9922136a297ea1ad2d3c42aed514c775537cea5d148c0126c90f0f11a25a1de",
+        "8449d6e942d2ef7a1dcf542d55f23bcb5f3801c71d80ce469eee94a828dd885ac29df4990383c143",
+        "04cca8ce36f72146373ac5513121908602209d283549f713e67c7215a19d3b1dc64aad57aa883c4c",
+        "c2fd7f3a48f7d81c32a84449169e0d736a27d0bba9a4e8abda225fc5c6318824f6f5adbccd7d3eb4"
+    };
+    unsigned char x[100], output[4 * 40], big[255 * 32 + 1];
+    const unsigned char* labels[4];
+    size_t lens[4], i, got;
+    meh_error_t result;
+    MehKDF k;
+
+    memset(x, 'x', sizeof (x));
+    labels[0] = (const unsigned char *)"client key"; lens[0] = 10;
+    labels[1] = (const unsigned char *)"server key"; lens[1] = 10;
+    labels[2] = (const unsigned char *)""; lens[2] = 0;
+    labels[3] = x; lens[3] = sizeof (x);
+
+    k = meh_get_kdf(MEH_HKDF, MEH_SHA512,
+                    (const unsigned char *)"master secret", (size_t)13,
+                    (const unsigned char *)"salt", (size_t)4,
+                    labels[0], lens[0]);
+    fail_if(NULL == k, "Could not allocate KDF context.");
+
+    result = meh_expand_many_kdf(k, labels, lens, 4, output, 40);
+    fail_unless(MEH_OK == result, NULL);
+    for (i = 0; i < 4; i++)
+        fail_unless(raw_equals_hex(output + 40 * i, (char *)expected[i], 40),
+                    NULL);
+
+    for (i = 0; i < 4; i++)
+    {
+        result = meh_expand_kdf(k, labels[i], lens[i]);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_kdf(k, output, 15, &got);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_kdf(k, output + 15, 25, &got);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(raw_equals_hex(output, (char *)expected[i], 40), NULL);
+    }
+
+    meh_destroy_kdf(k);
+
+    k = meh_get_kdf(MEH_HKDF, MEH_SHA256, x, (size_t)32, NULL, (size_t)0,
+                    NULL, (size_t)0);
+    fail_if(NULL == k, "Could not allocate KDF context.");
+    result = meh_update_kdf(k, big, sizeof (big), &got);
+    fail_unless(MEH_SOURCE_EXHAUSTED == result, NULL);
+    fail_unless(got == 255 * 32, NULL);
+    meh_destroy_kdf(k);
+
+    k = meh_get_kdf(MEH_PBKDF2, MEH_SHA1,
+                    (const unsigned char *)"password", (size_t)8,
+                    (const unsigned char *)"salt", (size_t)4, 1);
+    fail_if(NULL == k, "Could not allocate KDF context.");
+    fail_unless(MEH_INVALID_KDF == meh_expand_kdf(k, x, 1), NULL);
+    fail_unless(MEH_INVALID_KDF ==
+                meh_expand_many_kdf(k, labels, lens, 4, output, 40), NULL);
+    meh_destroy_kdf(k);
+}
+END_TEST
+
+Suite* kdf_suite(void)
+{
+  Suite* test_kdfs;
+  TCase* tcase_pbkdf2,
+       * tcase_scrypt,
+       * tcase_argon2,
+       * tcase_hkdf;
+
+  test_kdfs = suite_create("Key Derivation Functions");
+
+  tcase_pbkdf2 = tcase_create("PBKDF2");
+  tcase_add_test(tcase_pbkdf2, test_pbkdf2_sha1_vectors);
+  tcase_add_test(tcase_pbkdf2, test_pbkdf2_sha2_vectors);
+  tcase_add_test(tcase_pbkdf2, test_pbkdf2_incremental);
+  tcase_add_test(tcase_pbkdf2, test_pbkdf2_in_place);
+  tcase_add_test(tcase_pbkdf2, test_pbkdf2_lanes);
+  tcase_add_test(tcase_pbkdf2, test_pbkdf2_pieces);
+  tcase_add_test(tcase_pbkdf2, test_pbkdf2_many);
+  tcase_add_test(tcase_pbkdf2, test_pbkdf2_threads);
+
+  tcase_scrypt = tcase_create("scrypt");
+  tcase_add_test(tcase_scrypt, test_scrypt_vectors);
+  tcase_add_test(tcase_scrypt, test_scrypt_threads_and_reset);
+
+  tcase_argon2 = tcase_create("Argon2");
+  tcase_add_test(tcase_argon2, test_argon2id_vectors);
+  tcase_add_test(tcase_argon2, test_argon2id_threads_and_reset);
+
+  tcase_hkdf = tcase_create("HKDF");
+  tcase_add_test(tcase_hkdf, test_hkdf_vectors);
+  tcase_add_test(tcase_hkdf, test_hkdf_expand_many);
+
+  suite_add_tcase(test_kdfs, tcase_pbkdf2);
+  suite_add_tcase(test_kdfs, tcase_scrypt);
+  suite_add_tcase(test_kdfs, tcase_argon2);
+  suite_add_tcase(test_kdfs, tcase_hkdf);
+
+  return test_kdfs;
+}
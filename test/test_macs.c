@@ -0,0 +1,410 @@
+/*
+Copyright (c) 2026 Thomas Dixon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/**
+ * Vectors taken from RFC 2202 and RFC 4231.
+ */
+START_TEST (test_hmac_standard_vectors)
+{
+    unsigned char mac[MEH_SHA512_HASH_SIZE],
+                  key[140];
+    meh_error_t result;
+
+    memset(key, 0x0b, 20);
+    result = meh_hmac(MEH_SHA256, (const unsigned char *)"Hi There", 8,
+                      key, 20, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac,
+                               "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+                               MEH_SHA256_HASH_SIZE), NULL);
+
+    result = meh_hmac(MEH_MD5, (const unsigned char *)"what do ya want for nothing?", 28,
+                      (const unsigned char *)"Jefe", 4, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac, "750c783e6ab0b503eaa86e310a5db738",
+                               MEH_MD5_HASH_SIZE), NULL);
+
+    result = meh_hmac(MEH_SHA1, (const unsigned char *)"what do ya want for nothing?", 28,
+                      (const unsigned char *)"Jefe", 4, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac, "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+                               MEH_SHA1_HASH_SIZE), NULL);
+
+    result = meh_hmac(MEH_SHA256, (const unsigned char *)"what do ya want for nothing?", 28,
+                      (const unsigned char *)"Jefe", 4, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac,
+                               "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+                               MEH_SHA256_HASH_SIZE), NULL);
+
+    /* Key longer than the block size */
+    memset(key, 0xaa, 131);
+    result = meh_hmac(MEH_SHA256,
+                      (const unsigned char *)"Test Using Larger Than Block-Size Key - Hash Key First", 54,
+                      key, 131, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac,
+                               "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54",
+                               MEH_SHA256_HASH_SIZE), NULL);
+
+    result = meh_hmac(MEH_SHA512,
+                      (const unsigned char *)"Test Using Larger Than Block-Size Key - Hash Key First", 54,
+                      key, 131, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac,
+                               "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352"
+                               "6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598",
+                               MEH_SHA512_HASH_SIZE), NULL);
+
+    /* BLAKE2 goes through the same construction */
+    result = meh_hmac(MEH_BLAKE2B,
+                      (const unsigned char *)"The quick brown fox jumps over the lazy dog", 43,
+                      (const unsigned char *)"key", 3, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac,
+                               "92294f92c0dfb9b00ec9ae8bd94d7e7d8a036b885a499f149dfe2fd2199394aa"
+                               "af6b8894a1730cccb2cd050f9bcf5062a38b51b0dab33207f8ef35ae2c9df51b",
+                               MEH_BLAKE2B_HASH_SIZE), NULL);
+
+    result = meh_hmac(MEH_BLAKE2S,
+                      (const unsigned char *)"The quick brown fox jumps over the lazy dog", 43,
+                      (const unsigned char *)"key", 3, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac,
+                               "f93215bb90d4af4c3061cd932fb169fb8bb8a91d0b4022baea1271e1323cd9a0",
+                               MEH_BLAKE2S_HASH_SIZE), NULL);
+
+    /* SHA-3 pads the key to its rate, wider than any SHA-2 block */
+    result = meh_hmac(MEH_SHA3_256,
+                      (const unsigned char *)"The quick brown fox jumps over the lazy dog", 43,
+                      (const unsigned char *)"key", 3, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac,
+                               "8c6e0683409427f8931711b10ca92a506eb1fafa48fadd66d76126f47ac2c333",
+                               MEH_SHA3_256_HASH_SIZE), NULL);
+
+    memset(key, 0xaa, 140);
+    result = meh_hmac(MEH_SHA3_224,
+                      (const unsigned char *)"Test Using Larger Than Block-Size Key - Hash Key First", 54,
+                      key, 140, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac,
+                               "45398b28a3f834d9138085ebbf6f0bde8a9cb98b148d3e3935435987",
+                               MEH_SHA3_224_HASH_SIZE), NULL);
+}
+END_TEST
+
+/**
+ * Several messages under one key must not disturb each other.
+ */
+START_TEST (test_hmac_restart)
+{
+    MehHMAC m;
+    meh_error_t result;
+    unsigned char mac[MEH_SHA256_HASH_SIZE];
+    int i;
+
+    m = meh_get_hmac(MEH_SHA256, (const unsigned char *)"Jefe", 4);
+    fail_if(NULL == m, "Could not allocate HMAC context.");
+
+    for (i = 0; i < 3; i++) {
+        result = meh_update_hmac(m, (const unsigned char *)"what do ya want ", 16);
+        fail_unless(MEH_OK == result, NULL);
+
+        result = meh_update_hmac(m, (const unsigned char *)"for nothing?", 12);
+        fail_unless(MEH_OK == result, NULL);
+
+        result = meh_finish_hmac(m, mac);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(raw_equals_hex(mac,
+                                   "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+                                   MEH_SHA256_HASH_SIZE), NULL);
+
+        result = meh_restart_hmac(m);
+        fail_unless(MEH_OK == result, NULL);
+    }
+
+    meh_destroy_hmac(m);
+}
+END_TEST
+
+/**
+ * A MAC over a file by path matches the MAC over the same bytes.
+ */
+START_TEST (test_hmac_path)
+{
+    const char* path = "hmac_path.tmp";
+    MehHMAC m;
+    meh_error_t result;
+    unsigned char mac[MEH_SHA256_HASH_SIZE];
+    FILE* fd;
+
+    fd = fopen(path, "wb");
+    fail_if(NULL == fd, "Could not create temporary file.");
+    fputs("what do ya want for nothing?", fd);
+    fclose(fd);
+
+    m = meh_get_hmac(MEH_SHA256, (const unsigned char *)"Jefe", 4);
+    fail_if(NULL == m, "Could not allocate HMAC context.");
+
+    result = meh_hmac_path(m, path);
+    fail_unless(MEH_OK == result, NULL);
+
+    result = meh_finish_hmac(m, mac);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(mac,
+                               "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+                               MEH_SHA256_HASH_SIZE), NULL);
+
+    remove(path);
+    meh_destroy_hmac(m);
+}
+END_TEST
+
+/**
+ * Contexts keyed through a small cache, fetched, re-keyed and built in
+ * place, MAC like meh_hmac while keys are evicted and seen again, and
+ * every keying is counted as a hit or a miss.
+ */
+START_TEST (test_hmac_key_cache)
+{
+    static const meh_hash_id ids[] = { MEH_SHA256, MEH_SHA512, MEH_SHA1 };
+    enum { KEYS = 12, ROUNDS = 5 };
+    static unsigned char data[300];
+    unsigned char mac[MEH_HASH_MAX_OUTPUT_SIZE],
+                  expect[MEH_HASH_MAX_OUTPUT_SIZE];
+    meh_hmac_t storage;
+    MehHMACKeyCache cache;
+    MehHMAC m, r;
+    uint64_t hits, misses;
+    size_t i, j, k, n = 0, key_len;
+    meh_error_t result;
+
+    for (i = 0; i < sizeof (data); i++)
+        data[i] = (unsigned char)(i * 11 + 3);
+
+    cache = meh_get_hmac_cache(8);
+    fail_if(NULL == cache, "Could not allocate HMAC key cache.");
+
+    r = meh_get_hmac_cached(cache, MEH_SHA256, data, 0);
+    fail_if(NULL == r, "Could not allocate HMAC context.");
+    n++;
+
+    for (k = 0; k < ROUNDS; k++)
+    {
+        for (i = 0; i < sizeof (ids) / sizeof (ids[0]); i++)
+        {
+            for (j = 0; j < KEYS; j++)
+            {
+                /* keys up to twice a SHA-512 block, so some get hashed */
+                key_len = (j * 23) % 257;
+                meh_hmac(ids[i], data + j, 40, data + j, key_len, expect);
+
+                m = meh_init_hmac_cached(cache, &storage, sizeof (storage),
+                                         ids[i], data + j, key_len);
+                fail_if(NULL == m, NULL);
+                n++;
+                result = meh_update_hmac(m, data + j, 40);
+                fail_unless(MEH_OK == result, NULL);
+                result = meh_finish_hmac(m, mac);
+                fail_unless(MEH_OK == result, NULL);
+                fail_unless(0 == memcmp(mac, expect, m->output_size), NULL);
+                meh_destroy_hmac(m);
+
+                if (MEH_SHA256 != ids[i])
+                    continue;
+
+                result = meh_reset_hmac_cached(cache, r, data + j, key_len);
+                fail_unless(MEH_OK == result, NULL);
+                n++;
+                result = meh_update_hmac(r, data + j, 40);
+                fail_unless(MEH_OK == result, NULL);
+                result = meh_finish_hmac(r, mac);
+                fail_unless(MEH_OK == result, NULL);
+                fail_unless(0 == memcmp(mac, expect, r->output_size), NULL);
+            }
+        }
+    }
+
+    meh_hmac_cache_stats(cache, &hits, &misses);
+    fail_unless(hits + misses == n, NULL);
+    fail_unless(hits > 0 && misses > 0, NULL);
+
+    /* a cache large enough for every key misses only once per key */
+    meh_destroy_hmac_cache(cache);
+    cache = meh_get_hmac_cache(64);
+    fail_if(NULL == cache, "Could not allocate HMAC key cache.");
+
+    for (k = 0; k < ROUNDS; k++)
+        for (j = 0; j < KEYS; j++)
+        {
+            result = meh_reset_hmac_cached(cache, r, data + j, j * 23 % 257);
+            fail_unless(MEH_OK == result, NULL);
+        }
+
+    meh_hmac_cache_stats(cache, &hits, &misses);
+    fail_unless(KEYS == misses, NULL);
+    fail_unless((ROUNDS - 1) * KEYS == hits, NULL);
+
+    result = meh_reset_hmac_cached(cache, r, NULL, 0);
+    fail_unless(MEH_INVALID_ARGUMENT == result, NULL);
+    fail_unless(NULL == meh_get_hmac_cache(0), NULL);
+
+    meh_destroy_hmac(r);
+    meh_destroy_hmac_cache(cache);
+}
+END_TEST
+
+/**
+ * Batch verification agrees with meh_hmac item by item, across batch
+ * boundaries, key and message lengths, hashes and lane widths, and
+ * flags exactly the corrupted tags.
+ */
+START_TEST (test_hmac_verify_many)
+{
+    static const meh_hash_id ids[] =
+    {
+        MEH_MD5, MEH_SHA1, MEH_SHA224, MEH_SHA256, MEH_SHA512, MEH_SHA3_256
+    };
+    static const unsigned int masks[] =
+    {
+        0, MEH_CPU_SSE2, MEH_CPU_AVX2 | MEH_CPU_SSE2, MEH_CPU_ALL
+    };
+    enum { COUNT = 300 };
+    static unsigned char data[400], tag_data[COUNT * MEH_HASH_MAX_OUTPUT_SIZE];
+    const unsigned char* msgs[COUNT], * keys[COUNT], * tags[COUNT];
+    size_t lens[COUNT], key_lens[COUNT], i, j, k;
+    unsigned char results[(COUNT + 7) / 8];
+    meh_error_t result;
+
+    for (i = 0; i < sizeof (data); i++)
+        data[i] = (unsigned char)(i * 7 + 1);
+
+    for (i = 0; i < COUNT; i++)
+    {
+        msgs[i] = data + i % 50;
+        lens[i] = (i * 37) % 200;
+        keys[i] = data + 200 + i % 30;
+        key_lens[i] = (i * 13) % 150; /* some longer than a block */
+        tags[i] = tag_data + i * MEH_HASH_MAX_OUTPUT_SIZE;
+    }
+
+    for (i = 0; i < sizeof (ids) / sizeof (ids[0]); i++)
+    {
+        for (j = 0; j < COUNT; j++)
+            meh_hmac(ids[i], msgs[j], lens[j], keys[j], key_lens[j],
+                     tag_data + j * MEH_HASH_MAX_OUTPUT_SIZE);
+
+        for (k = 0; k < sizeof (masks) / sizeof (masks[0]); k++)
+        {
+            meh_mask_cpu_features(masks[k]);
+            result = meh_hmac_verify_many(ids[i], msgs, lens, keys, key_lens,
+                                          tags, COUNT, results);
+            fail_unless(MEH_OK == result, NULL);
+            for (j = 0; j < COUNT; j++)
+                fail_unless(results[j / 8] & (1 << (j % 8)), NULL);
+        }
+
+        /* Every seventh tag loses a bit at the end */
+        for (j = 0; j < COUNT; j += 7)
+            tag_data[j * MEH_HASH_MAX_OUTPUT_SIZE + 15] ^= 0x01;
+
+        for (k = 0; k < sizeof (masks) / sizeof (masks[0]); k++)
+        {
+            meh_mask_cpu_features(masks[k]);
+            result = meh_hmac_verify_many(ids[i], msgs, lens, keys, key_lens,
+                                          tags, COUNT, results);
+            fail_unless(MEH_AUTH_FAILED == result, NULL);
+            for (j = 0; j < COUNT; j++)
+                fail_unless(!(results[j / 8] & (1 << (j % 8))) ==
+                            (0 == j % 7), NULL);
+        }
+
+        meh_mask_cpu_features(MEH_CPU_ALL);
+    }
+
+    result = meh_hmac_verify_many(MEH_SHA256, msgs, lens, keys, key_lens,
+                                  tags, 0, NULL);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_hmac_verify_many(MEH_SHA256, msgs, lens, keys, key_lens,
+                                  tags, COUNT, NULL);
+    fail_unless(MEH_INVALID_ARGUMENT == result, NULL);
+}
+END_TEST
+
+/**
+ * Vector taken from RFC 8439, section 2.5.2, whole and fed a few bytes
+ * at a time.
+ */
+START_TEST (test_poly1305)
+{
+    const unsigned char key[32] = {
+        0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33,
+        0x7f, 0x44, 0x52, 0xfe, 0x42, 0xd5, 0x06, 0xa8,
+        0x01, 0x03, 0x80, 0x8a, 0xfb, 0x0d, 0xb2, 0xfd,
+        0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49, 0xf5, 0x1b
+    };
+    const unsigned char* message =
+        (const unsigned char *)"Cryptographic Forum Research Group";
+    meh_poly1305_state_t poly;
+    meh_error_t result;
+    unsigned char tag[16];
+    size_t i;
+
+    result = meh_poly1305(key, message, 34, tag);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(tag, "a8061dc1305136c6c22b8baf0c0127a9", 16), NULL);
+
+    meh_reset_poly1305(&poly, key);
+    for (i = 0; i < 34; i += 5) {
+        result = meh_update_poly1305(&poly, message + i, (34 - i < 5) ? 34 - i : 5);
+        fail_unless(MEH_OK == result, NULL);
+    }
+    result = meh_finish_poly1305(&poly, tag);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(tag, "a8061dc1305136c6c22b8baf0c0127a9", 16), NULL);
+}
+END_TEST
+
+Suite* mac_suite(void)
+{
+  Suite* test_macs;
+  TCase* tcase_hmac,
+       * tcase_poly1305;
+
+  test_macs = suite_create("MACs");
+
+  tcase_hmac = tcase_create("HMAC");
+  tcase_add_test(tcase_hmac, test_hmac_standard_vectors);
+  tcase_add_test(tcase_hmac, test_hmac_restart);
+  tcase_add_test(tcase_hmac, test_hmac_path);
+  tcase_add_test(tcase_hmac, test_hmac_verify_many);
+  tcase_add_test(tcase_hmac, test_hmac_key_cache);
+
+  tcase_poly1305 = tcase_create("Poly1305");
+  tcase_add_test(tcase_poly1305, test_poly1305);
+
+  suite_add_tcase(test_macs, tcase_hmac);
+  suite_add_tcase(test_macs, tcase_poly1305);
+
+  return test_macs;
+}
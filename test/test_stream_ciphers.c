@@ -124,22 +124,451 @@ START_TEST (test_salsa20)
 }
 END_TEST
 
+/**
+ * Keystream well past the first block, from eSTREAM set 1 vector 0,
+ * must come out the same through every block width and however the
+ * input is split across calls.
+ */
+START_TEST (test_salsa20_long)
+{
+    const unsigned int masks[] = {MEH_CPU_ALL, MEH_CPU_AVX2 | MEH_CPU_SSE2,
+                                  MEH_CPU_SSE2, 0};
+    const size_t chunks[] = {1, 63, 64, 65, 300, 1000};
+    MehCipher c;
+    meh_error_t result;
+    unsigned char zeros[2048], stream[2048], data[2048];
+    size_t got, i, j, done, n;
+
+    memset(zeros, 0, sizeof (zeros));
+
+    c = meh_get_cipher(MEH_SALSA20,
+                       (const unsigned char *)"\x80\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0",
+                       (const unsigned char *)"\0\0\0\0\0\0\0\0",
+                       16);
+    fail_if(NULL == c, "Could not allocate cipher context.");
+
+    for (i = 0; i < sizeof (masks) / sizeof (masks[0]); i++) {
+        meh_mask_cpu_features(masks[i]);
+
+        result = meh_reset_cipher(c,
+                                  (const unsigned char *)"\x80\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0",
+                                  (const unsigned char *)"\0\0\0\0\0\0\0\0",
+                                  16);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_cipher(c, zeros, stream, sizeof (zeros), &got);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(got == sizeof (zeros), NULL);
+
+        fail_unless(raw_equals_hex(stream,
+                                   "4dfa5e481da23ea09a31022050859936da52fcee218005164f267cb65f5cfd7f"
+                                   "2b4f97e0ff16924a52df269515110a07f9e460bc65ef95da58f740b7d1dbb0aa",
+                                   64), NULL);
+        fail_unless(raw_equals_hex(stream + 192,
+                                   "da9c1581f429e0a00f7d67e23b730676783b262e8eb43a25f55fb90b3e753aef"
+                                   "8c6713ec66c51881111593ccb3e8cb8f8de124080501eeeb389c4bcb6977cf95",
+                                   64), NULL);
+        fail_unless(raw_equals_hex(stream + 256,
+                                   "7d5789631eb4554400e1e025935dfa7b3e9039d61bdc58a8697d36815bf1985c"
+                                   "efdf7ae112e5bb81e37ecf0616ce7147fc08a93a367e08631f23c03b00a8da2f",
+                                   64), NULL);
+        fail_unless(raw_equals_hex(stream + 448,
+                                   "b375703739daced4dd4059fd71c3c47fc2f9939670fad4a46066adcc6a564578"
+                                   "3308b90ffb72be04a6b147cbe38cc0c3b9267c296a92a7c69873f9f263be9703",
+                                   64), NULL);
+
+        /* Split into ragged pieces, in place */
+        for (j = 0; j < sizeof (chunks) / sizeof (chunks[0]); j++) {
+            meh_reset_cipher(c,
+                             (const unsigned char *)"\x80\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0",
+                             (const unsigned char *)"\0\0\0\0\0\0\0\0",
+                             16);
+            memset(data, 0, sizeof (data));
+
+            for (done = 0; done < sizeof (data); done += n) {
+                n = sizeof (data) - done < chunks[j] ? sizeof (data) - done : chunks[j];
+                result = meh_update_cipher(c, data + done, data + done, n, &got);
+                fail_unless(MEH_OK == result, NULL);
+                fail_unless(got == n, NULL);
+            }
+
+            fail_unless(0 == memcmp(stream, data, sizeof (data)), NULL);
+        }
+    }
+
+    meh_mask_cpu_features(MEH_CPU_ALL);
+    meh_destroy_cipher(c);
+}
+END_TEST
+
+/**
+ * Seeking lands on the same keystream as running up to the offset,
+ * including mid-block and across the low counter word's carry.
+ */
+START_TEST (test_salsa20_seek)
+{
+    MehCipher c;
+    meh_error_t result;
+    unsigned char zeros[512], stream[512], data[512];
+    size_t got;
+
+    memset(zeros, 0, sizeof (zeros));
+
+    c = meh_get_cipher(MEH_SALSA20,
+                       (const unsigned char *)"\x80\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0",
+                       (const unsigned char *)"\0\0\0\0\0\0\0\0",
+                       16);
+    fail_if(NULL == c, "Could not allocate cipher context.");
+
+    result = meh_update_cipher(c, zeros, stream, sizeof (zeros), &got);
+    fail_unless(MEH_OK == result, NULL);
+
+    /* eSTREAM set 1 vector 0, stream[448..511] then stream[192..255] */
+    result = meh_seek_cipher(c, 448);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_update_cipher(c, zeros, data, 64, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(data,
+                               "b375703739daced4dd4059fd71c3c47fc2f9939670fad4a46066adcc6a564578"
+                               "3308b90ffb72be04a6b147cbe38cc0c3b9267c296a92a7c69873f9f263be9703",
+                               64), NULL);
+
+    result = meh_seek_cipher(c, 192);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_update_cipher(c, zeros, data, 64, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(data,
+                               "da9c1581f429e0a00f7d67e23b730676783b262e8eb43a25f55fb90b3e753aef"
+                               "8c6713ec66c51881111593ccb3e8cb8f8de124080501eeeb389c4bcb6977cf95",
+                               64), NULL);
+
+    /* Mid-block, continuing through several blocks */
+    result = meh_seek_cipher(c, 37);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_update_cipher(c, zeros, data, 5, &got);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_update_cipher(c, zeros, data + 5, 400, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(0 == memcmp(stream + 37, data, 405), NULL);
+
+    /* Block 2^32 - 1, byte 10, into block 2^32 */
+    result = meh_seek_cipher(c, ((uint64_t)0xffffffff << 6) + 10);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_update_cipher(c, zeros, data, 128, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(data,
+                               "cfa1906bc71e1ef404317423ac64c769ca42504c51a719ec263a6db00e3326cb"
+                               "94cbf0fabd0bfb8feeb4d07d1bbad5356f3410eccacad858b435c4226eb94682"
+                               "02f2179ce06367729263178498f37eb3e7a3278f18084ffa03743a16a183e1f1"
+                               "073c7be927494284256105bf20b92da83e896567cea7a1e7b5758a2fc369f163",
+                               128), NULL);
+
+    meh_destroy_cipher(c);
+
+    /* RC4 has no random access */
+    c = meh_get_cipher(MEH_RC4, (const unsigned char *)"\0\0\0\0\0\0\0\0", 8);
+    fail_if(NULL == c, "Could not allocate cipher context.");
+    fail_unless(MEH_INVALID_CIPHER == meh_seek_cipher(c, 64), NULL);
+    meh_destroy_cipher(c);
+}
+END_TEST
+
+/**
+ * Splitting a large update across threads gives the same output, and
+ * leaves the context in the same place, as one sequential update.
+ */
+START_TEST (test_cipher_parallel)
+{
+    const unsigned int threads[] = {1, 2, 3, 8};
+    const size_t len = (1 << 20) + 37;
+    MehCipher seq, par;
+    meh_error_t result;
+    unsigned char* in,
+                 * expected,
+                 * actual;
+    unsigned char tail[2][100];
+    size_t got, i, j;
+
+    in = malloc(len);
+    expected = malloc(len);
+    actual = malloc(len);
+    fail_if(NULL == in || NULL == expected || NULL == actual,
+            "Could not allocate cipher buffers.");
+
+    for (i = 0; i < len; i++)
+        in[i] = (unsigned char)(i * 31 + 7);
+
+    for (j = 0; j < sizeof (threads) / sizeof (threads[0]); j++) {
+        seq = meh_get_cipher(MEH_SALSA20, in, in + 32, (size_t)32);
+        par = meh_get_cipher(MEH_SALSA20, in, in + 32, (size_t)32);
+        fail_if(NULL == seq || NULL == par, "Could not allocate cipher context.");
+
+        /* Start mid-block */
+        meh_update_cipher(seq, in, tail[0], 5, &got);
+        meh_update_cipher(par, in, tail[1], 5, &got);
+
+        result = meh_update_cipher(seq, in, expected, len, &got);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_cipher_parallel(par, in, actual, len, &got, threads[j]);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(got == len, NULL);
+        fail_unless(0 == memcmp(expected, actual, len), NULL);
+
+        meh_update_cipher(seq, in, tail[0], sizeof (tail[0]), &got);
+        meh_update_cipher(par, in, tail[1], sizeof (tail[1]), &got);
+        fail_unless(0 == memcmp(tail[0], tail[1], sizeof (tail[0])), NULL);
+
+        meh_destroy_cipher(seq);
+        meh_destroy_cipher(par);
+    }
+
+    /* RC4 cannot be split, so it just runs in order */
+    seq = meh_get_cipher(MEH_RC4, in, (size_t)16);
+    par = meh_get_cipher(MEH_RC4, in, (size_t)16);
+    fail_if(NULL == seq || NULL == par, "Could not allocate cipher context.");
+    meh_update_cipher(seq, in, expected, len, &got);
+    result = meh_update_cipher_parallel(par, in, actual, len, &got, 4);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(0 == memcmp(expected, actual, len), NULL);
+    meh_destroy_cipher(seq);
+    meh_destroy_cipher(par);
+
+    free(in);
+    free(expected);
+    free(actual);
+}
+END_TEST
+
+/**
+ * Salsa20's 64-bit block counter outruns 64-bit byte offsets. Runs that
+ * cross 2^64 bytes, or start past it, must still match a sequential
+ * update and leave the context in the same place.
+ */
+START_TEST (test_cipher_parallel_wrap)
+{
+    const size_t len = (1 << 20) + 37;
+    MehCipher seq, par;
+    meh_error_t result;
+    unsigned char* in,
+                 * expected,
+                 * actual;
+    unsigned char tail[2][100];
+    size_t got, i, j;
+
+    in = malloc(len);
+    expected = malloc(len);
+    actual = malloc(len);
+    fail_if(NULL == in || NULL == expected || NULL == actual,
+            "Could not allocate cipher buffers.");
+
+    for (i = 0; i < len; i++)
+        in[i] = (unsigned char)(i * 31 + 7);
+
+    seq = meh_get_cipher(MEH_SALSA20, in, in + 32, (size_t)32);
+    par = meh_get_cipher(MEH_SALSA20, in, in + 32, (size_t)32);
+    fail_if(NULL == seq || NULL == par, "Could not allocate cipher context.");
+
+    meh_seek_cipher(seq, UINT64_MAX - (1 << 19) - 4);
+    meh_seek_cipher(par, UINT64_MAX - (1 << 19) - 4);
+
+    /* across 2^64 bytes, then entirely past it */
+    for (j = 0; j < 2; j++) {
+        result = meh_update_cipher(seq, in, expected, len, &got);
+        fail_unless(MEH_OK == result, NULL);
+        result = meh_update_cipher_parallel(par, in, actual, len, &got, 4);
+        fail_unless(MEH_OK == result && got == len, NULL);
+        fail_unless(0 == memcmp(expected, actual, len), NULL);
+
+        meh_update_cipher(seq, in, tail[0], sizeof (tail[0]), &got);
+        meh_update_cipher(par, in, tail[1], sizeof (tail[1]), &got);
+        fail_unless(0 == memcmp(tail[0], tail[1], sizeof (tail[0])), NULL);
+    }
+
+    meh_destroy_cipher(seq);
+    meh_destroy_cipher(par);
+
+    free(in);
+    free(expected);
+    free(actual);
+}
+END_TEST
+
+/**
+ * Vectors taken from RFC 8439, sections 2.4.2 and A.2.
+ */
+START_TEST (test_chacha20)
+{
+    const unsigned char key[32] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+        0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+    };
+    const char* plaintext = "Ladies and Gentlemen of the class of '99: "
+                            "If I could offer you only one tip for the "
+                            "future, sunscreen would be it.";
+    unsigned char zeros[64], data[128];
+    MehCipher c;
+    meh_error_t result;
+    size_t got;
+
+    memset(zeros, 0, sizeof (zeros));
+
+    /* All zero key and nonce, block 0 */
+    c = meh_get_cipher(MEH_CHACHA20, zeros, zeros, (size_t)32);
+    fail_if(NULL == c, "Could not allocate cipher context.");
+
+    result = meh_update_cipher(c, zeros, data, 64, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(got == 64, NULL);
+    fail_unless(raw_equals_hex(data,
+                               "76b8e0ada0f13d90405d6ae55386bd28bdd219b8a08ded1aa836efcc8b770dc7"
+                               "da41597c5157488d7724e03fb8d84a376a43b8f41518a11cc387b669b2ee6586",
+                               64), NULL);
+
+    /* Sunscreen, starting from block 1 */
+    result = meh_reset_cipher(c, key,
+                              (const unsigned char *)"\0\0\0\0\0\0\0\x4a\0\0\0\0",
+                              (size_t)32);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_seek_cipher(c, 64);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_update_cipher(c, (const unsigned char *)plaintext, data, 114, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(got == 114, NULL);
+    fail_unless(raw_equals_hex(data,
+                               "6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0b"
+                               "f91b65c5524733ab8f593dabcd62b3571639d624e65152ab8f530c359f0861d8"
+                               "07ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab7793736"
+                               "5af90bbf74a35be6b40b8eedf2785e42874d",
+                               114), NULL);
+
+    /* Wrong key size */
+    fail_if(MEH_OK == meh_reset_cipher(c, key, zeros, (size_t)16), NULL);
+
+    meh_destroy_cipher(c);
+}
+END_TEST
+
+/**
+ * Long keystream through every block width and call pattern, and the
+ * end of the 32-bit counter.
+ */
+START_TEST (test_chacha20_long)
+{
+    const unsigned int masks[] = {MEH_CPU_ALL, MEH_CPU_AVX2 | MEH_CPU_SSE2,
+                                  MEH_CPU_SSE2, 0};
+    const size_t chunks[] = {1, 63, 64, 65, 300, 1000};
+    MehCipher c;
+    meh_error_t result;
+    unsigned char zeros[2048], stream[2048], data[2048];
+    size_t got, i, j, done, n;
+
+    memset(zeros, 0, sizeof (zeros));
+
+    c = meh_get_cipher(MEH_CHACHA20, zeros, zeros, (size_t)32);
+    fail_if(NULL == c, "Could not allocate cipher context.");
+
+    for (i = 0; i < sizeof (masks) / sizeof (masks[0]); i++) {
+        meh_mask_cpu_features(masks[i]);
+
+        meh_reset_cipher(c, zeros, zeros, (size_t)32);
+        result = meh_update_cipher(c, zeros, stream, sizeof (zeros), &got);
+        fail_unless(MEH_OK == result, NULL);
+        fail_unless(raw_equals_hex(stream,
+                                   "76b8e0ada0f13d90405d6ae55386bd28bdd219b8a08ded1aa836efcc8b770dc7"
+                                   "da41597c5157488d7724e03fb8d84a376a43b8f41518a11cc387b669b2ee6586",
+                                   64), NULL);
+        fail_unless(raw_equals_hex(stream + 1000,
+                                   "b95182dbc5eec042b89e22f11a085b739a3611cd8d836018c4fff0b86c02ed66"
+                                   "2d2d2522647a1f09a7b2f9eea56e7e20b1f06ccdd9cec37e3b2d20812df36997",
+                                   64), NULL);
+
+        for (j = 0; j < sizeof (chunks) / sizeof (chunks[0]); j++) {
+            meh_reset_cipher(c, zeros, zeros, (size_t)32);
+            memset(data, 0, sizeof (data));
+
+            for (done = 0; done < sizeof (data); done += n) {
+                n = sizeof (data) - done < chunks[j] ? sizeof (data) - done : chunks[j];
+                result = meh_update_cipher(c, data + done, data + done, n, &got);
+                fail_unless(MEH_OK == result, NULL);
+            }
+
+            fail_unless(0 == memcmp(stream, data, sizeof (data)), NULL);
+        }
+    }
+
+    meh_mask_cpu_features(MEH_CPU_ALL);
+
+    /* The last ten bytes of block 2^32 - 1, and nothing after */
+    result = meh_seek_cipher(c, ((uint64_t)1 << 38) - 10);
+    fail_unless(MEH_OK == result, NULL);
+    result = meh_update_cipher(c, zeros, data, 11, &got);
+    fail_unless(MEH_SOURCE_EXHAUSTED == result, NULL);
+    result = meh_update_cipher(c, zeros, data, 10, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(data, "3e684593937023b58b1d", 10), NULL);
+    result = meh_update_cipher(c, zeros, data, 1, &got);
+    fail_unless(MEH_SOURCE_EXHAUSTED == result, NULL);
+
+    meh_destroy_cipher(c);
+}
+END_TEST
+
+/**
+ * A context built in caller-provided storage behaves like an allocated one.
+ */
+START_TEST (test_cipher_in_place)
+{
+    meh_align_t storage[64];
+    MehCipher c;
+    meh_error_t result;
+    unsigned char data[8];
+    size_t got;
+
+    fail_unless(meh_cipher_context_size(MEH_RC4) <= sizeof (storage), NULL);
+    fail_unless(meh_cipher_context_size(MEH_SALSA20) <= sizeof (storage), NULL);
+    fail_unless(meh_cipher_context_size(MEH_CHACHA20) <= sizeof (storage), NULL);
+
+    c = meh_init_cipher(storage, sizeof (storage), MEH_RC4,
+                        (const unsigned char *)"\0\0\0\0\0\0\0\0", (size_t)8);
+    fail_if(NULL == c, "Could not build cipher context.");
+
+    memset(data, 0, 8);
+    result = meh_update_cipher(c, data, data, 8, &got);
+    fail_unless(MEH_OK == result, NULL);
+    fail_unless(raw_equals_hex(data, "de188941a3375d3a", 8), NULL);
+
+    meh_destroy_cipher(c);
+}
+END_TEST
+
 Suite* stream_cipher_suite(void)
 {
   Suite* test_stream_ciphers;
   TCase* tcase_rc4,
-       * tcase_salsa20;
+       * tcase_salsa20,
+       * tcase_chacha20;
 
   test_stream_ciphers = suite_create("Stream Ciphers");
 
   tcase_rc4 = tcase_create("RC4");
   tcase_add_test(tcase_rc4, test_rc4);
+  tcase_add_test(tcase_rc4, test_cipher_in_place);
 
   tcase_salsa20 = tcase_create("Salsa20");
   tcase_add_test(tcase_salsa20, test_salsa20);
+  tcase_add_test(tcase_salsa20, test_salsa20_long);
+  tcase_add_test(tcase_salsa20, test_salsa20_seek);
+  tcase_add_test(tcase_salsa20, test_cipher_parallel);
+  tcase_add_test(tcase_salsa20, test_cipher_parallel_wrap);
+
+  tcase_chacha20 = tcase_create("ChaCha20");
+  tcase_add_test(tcase_chacha20, test_chacha20);
+  tcase_add_test(tcase_chacha20, test_chacha20_long);
 
   suite_add_tcase(test_stream_ciphers, tcase_rc4);
   suite_add_tcase(test_stream_ciphers, tcase_salsa20);
+  suite_add_tcase(test_stream_ciphers, tcase_chacha20);
 
   return test_stream_ciphers;
 }